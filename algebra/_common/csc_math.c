@@ -165,6 +165,36 @@ void csc_Axpy_sym_triu(const OSQPCscMatrix* A,
     }}}
 }
 
+/* y = alpha*A*x + beta*y, where A is symmetric and both triangles are stored.
+ * Every entry of y is gathered from its own column of A, so unlike the upper
+ * triangular product the columns are independent and are split among the
+ * OpenMP threads. */
+void csc_Axpy_sym_full(const OSQPCscMatrix* A,
+                       const OSQPFloat*     x,
+                             OSQPFloat*     y,
+                             OSQPFloat      alpha,
+                             OSQPFloat      beta) {
+
+    OSQPInt    j, k;
+    OSQPInt*   Ap = A->p;
+    OSQPInt*   Ai = A->i;
+    OSQPInt    An = A->n;
+    OSQPFloat* Ax = A->x;
+    OSQPFloat  yj;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(k, yj) schedule(static)
+#endif
+    for (j = 0; j < An; j++) {
+        yj = 0.0;
+        for (k = Ap[j]; k < Ap[j + 1]; k++) {
+            yj += Ax[k] * x[Ai[k]];
+        }
+        // y is not read when beta = 0, as in the other products
+        y[j] = (beta == 0.0) ? alpha * yj : alpha * yj + beta * y[j];
+    }
+}
+
 //y = alpha*A*x + beta*y
 void csc_Axpy(const OSQPCscMatrix* A,
               const OSQPFloat*     x,
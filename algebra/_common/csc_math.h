@@ -59,6 +59,13 @@ void csc_Axpy_sym_triu(const OSQPCscMatrix* A,
                              OSQPFloat      alpha,
                              OSQPFloat      beta);
 
+//y = alpha*A*x + beta*y, where A is symmetric and both triangles are stored
+void csc_Axpy_sym_full(const OSQPCscMatrix* A,
+                       const OSQPFloat*     x,
+                             OSQPFloat*     y,
+                             OSQPFloat      alpha,
+                             OSQPFloat      beta);
+
 //y = alpha*A*x + beta*y
 void csc_Axpy(const OSQPCscMatrix* A,
               const OSQPFloat*     x,
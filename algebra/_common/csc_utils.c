@@ -114,9 +114,9 @@ OSQPCscMatrix* csc_spalloc(OSQPInt m,
   A->nzmax = nzmax = c_max(nzmax, 0);
   A->nz    = triplet ? 0 : -1;         /* allocate triplet or comp.col */
   A->p     = csc_malloc(triplet ? nzmax : n + 1, sizeof(OSQPInt));
-  A->i     = values ? csc_malloc(nzmax,  sizeof(OSQPInt)) : OSQP_NULL;
+  A->i     = csc_malloc(nzmax,  sizeof(OSQPInt));
   A->x     = values ? csc_malloc(nzmax,  sizeof(OSQPFloat)) : OSQP_NULL;
-  if (!A->p || (values && !A->i ) || (values && !A->x)){
+  if (!A->p || !A->i || (values && !A->x)){
     csc_spfree(A);
     return OSQP_NULL;
   } else return A;
@@ -285,6 +285,42 @@ OSQPCscMatrix* triplet_to_csr(const OSQPCscMatrix* T, OSQPInt* TtoC) {
   return csc_done(C, w, OSQP_NULL, 1);     /* success; free w and return C */
 }
 
+OSQPCscMatrix* csc_transpose(const OSQPCscMatrix* A, OSQPInt* AtoC) {
+  OSQPInt    m, n, p, j, k;
+  OSQPInt*   Cp;
+  OSQPInt*   Ci;
+  OSQPInt*   w;
+  OSQPFloat* Cx;
+  OSQPCscMatrix* C;
+
+  m = A->m;
+  n = A->n;
+  C = csc_spalloc(n, m, A->p[n], A->x != OSQP_NULL, 0);  /* allocate result */
+  w = csc_calloc(m, sizeof(OSQPInt));                      /* get workspace */
+
+  if (!C || !w) return csc_done(C, w, OSQP_NULL, 0);     /* out of memory */
+
+  Cp = C->p;
+  Ci = C->i;
+  Cx = C->x;
+
+  for (k = 0; k < A->p[n]; k++) w[A->i[k]]++;  /* row counts */
+  csc_cumsum(Cp, w, m);                        /* row pointers */
+
+  for (j = 0; j < n; j++) {
+    for (k = A->p[j]; k < A->p[j+1]; k++) {
+      Ci[p = w[A->i[k]]++] = j;                /* A(i,j) is the pth entry in C */
+
+      if (Cx) {
+        Cx[p] = A->x[k];
+
+        if (AtoC != OSQP_NULL) AtoC[k] = p;    // Assign vector of indices
+      }
+    }
+  }
+  return csc_done(C, w, OSQP_NULL, 1);         /* success; free w and return C */
+}
+
 #endif /* OSQP_EMBEDDED_MODE */
 
 void csc_extract_diag(const OSQPCscMatrix* A,
@@ -126,6 +126,21 @@ OSQPCscMatrix* triplet_to_csr(const OSQPCscMatrix* T,
                                     OSQPInt*       TtoC);
 
 
+/**
+ * C = A' in compressed-column format
+ *
+ * The row indices within every column of C are sorted.
+ * AtoC stores the vector of indices from A to C
+ *  -> C[AtoC[i]] = A[i]
+ *
+ * @param  A    matrix in CSC format
+ * @param  AtoC vector of indices from A to C (or OSQP_NULL)
+ * @return      transposed matrix in CSC format
+ */
+OSQPCscMatrix* csc_transpose(const OSQPCscMatrix* A,
+                                   OSQPInt*       AtoC);
+
+
 // /**
 //  * Convert square CSC matrix into upper triangular one
 //  *
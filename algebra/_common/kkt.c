@@ -341,6 +341,246 @@ OSQPCscMatrix* form_KKT(OSQPCscMatrix* P,
   return KKT;
 }
 
+//assemble the upper triangular part of the KKT matrix permuted
+//by Pinv (identity if null) in CSC format. Each entry (i,j) of
+//the unpermuted KKT lands in column max(Pinv[i],Pinv[j]).
+//K values are only filled if K->x is allocated
+static void _kkt_assemble_perm(OSQPCscMatrix* K,
+                               OSQPInt*       PtoKKT,
+                               OSQPInt*       AtoKKT,
+                               OSQPInt*       rhotoKKT,
+                               OSQPCscMatrix* P,
+                               OSQPCscMatrix* A,
+                               OSQPFloat      param1,
+                               OSQPFloat*     param2,
+                               OSQPFloat      param2_sc,
+                               const OSQPInt* Pinv) {
+
+    OSQPInt i, j, k, pi, pj, dest;
+    OSQPInt m = A->m;
+    OSQPInt n = P->n;
+
+    //use K.p to hold nnz entries in each
+    //column of the permuted KKT matrix
+    for(j=0; j <= (m+n); j++){K->p[j] = 0;}
+
+    for(j = 0; j < n; j++){
+        pj = Pinv ? Pinv[j] : j;
+        for(k = P->p[j]; k < P->p[j+1]; k++){
+            pi = Pinv ? Pinv[P->i[k]] : P->i[k];
+            K->p[c_max(pi,pj)]++;
+        }
+        if((P->p[j] == P->p[j+1]) || (P->i[P->p[j+1]-1] != j)){
+            K->p[pj]++;
+        }
+    }
+    for(j = 0; j < n; j++){
+        pj = Pinv ? Pinv[j] : j;
+        for(k = A->p[j]; k < A->p[j+1]; k++){
+            pi = Pinv ? Pinv[n + A->i[k]] : n + A->i[k];
+            K->p[c_max(pi,pj)]++;
+        }
+    }
+    for(i = 0; i < m; i++){
+        K->p[Pinv ? Pinv[n + i] : n + i]++;
+    }
+
+    //cumsum total entries to convert to K.p
+    _kkt_colcount_to_colptr(K);
+
+    //fill in P with param1 added to its diagonal,
+    //and param1 where the diagonal of P is missing
+    for(j = 0; j < n; j++){
+        pj = Pinv ? Pinv[j] : j;
+        for(k = P->p[j]; k < P->p[j+1]; k++){
+            pi         = Pinv ? Pinv[P->i[k]] : P->i[k];
+            dest       = K->p[c_max(pi,pj)]++;
+            K->i[dest] = c_min(pi,pj);
+            if(K->x){K->x[dest] = P->i[k] == j ? P->x[k] + param1 : P->x[k];}
+            if(PtoKKT != OSQP_NULL){PtoKKT[k] = dest;}
+        }
+        if((P->p[j] == P->p[j+1]) || (P->i[P->p[j+1]-1] != j)){
+            dest       = K->p[pj]++;
+            K->i[dest] = pj;
+            if(K->x){K->x[dest] = param1;}
+        }
+    }
+
+    //fill in A, which is the upper right block A' before permuting
+    for(j = 0; j < n; j++){
+        pj = Pinv ? Pinv[j] : j;
+        for(k = A->p[j]; k < A->p[j+1]; k++){
+            pi         = Pinv ? Pinv[n + A->i[k]] : n + A->i[k];
+            dest       = K->p[c_max(pi,pj)]++;
+            K->i[dest] = c_min(pi,pj);
+            if(K->x){K->x[dest] = A->x[k];}
+            if(AtoKKT != OSQP_NULL){AtoKKT[k] = dest;}
+        }
+    }
+
+    //fill in lower right with -param2
+    for(i = 0; i < m; i++){
+        pi         = Pinv ? Pinv[n + i] : n + i;
+        dest       = K->p[pi]++;
+        K->i[dest] = pi;
+        if(K->x){K->x[dest] = param2 ? -param2[i] : -param2_sc;}
+        if(rhotoKKT != OSQP_NULL){rhotoKKT[i] = dest;}
+    }
+
+    //backshift the colptrs to recover K.p again
+    _kkt_backshift_colptrs(K);
+
+    return;
+}
+
+//allocate the KKT matrix, with or without values
+static OSQPCscMatrix* _kkt_alloc(OSQPCscMatrix* P,
+                                 OSQPCscMatrix* A,
+                                 OSQPInt        values) {
+  OSQPInt m = A->m;
+  OSQPInt n = P->n;
+
+  // Number of nonzero elements of the upper triangular part:
+  // P, param1 * I without the double count on the diagonal, A and - diag(param2)
+  return csc_spalloc(m + n, m + n,
+                     P->p[n] + n - _count_diagonal_entries(P) + A->p[n] + m,
+                     values, 0);
+}
+
+OSQPCscMatrix* form_KKT_pattern(OSQPCscMatrix* P,
+                                OSQPCscMatrix* A) {
+
+  OSQPCscMatrix* KKT = _kkt_alloc(P, A, 0);
+
+  if (!KKT) return OSQP_NULL;
+
+  _kkt_assemble_perm(KKT, OSQP_NULL, OSQP_NULL, OSQP_NULL, P, A,
+                     0.0, OSQP_NULL, 0.0, OSQP_NULL);
+
+  return KKT;
+}
+
+OSQPCscMatrix* form_KKT_perm(OSQPCscMatrix* P,
+                             OSQPCscMatrix* A,
+                             OSQPFloat      param1,
+                             OSQPFloat*     param2,
+                             OSQPFloat      param2_sc,
+                             const OSQPInt* Pinv,
+                             OSQPInt*       PtoKKT,
+                             OSQPInt*       AtoKKT,
+                             OSQPInt*       param2toKKT) {
+
+  OSQPCscMatrix* KKT = _kkt_alloc(P, A, 1);
+
+  if (!KKT) return OSQP_NULL;
+
+  _kkt_assemble_perm(KKT, PtoKKT, AtoKKT, param2toKKT, P, A,
+                     param1, param2, param2_sc, Pinv);
+
+  return KKT;
+}
+
+//visit the entries of column j of the upper triangular part of A'*A:
+//the columns k <= j of every row of A with an entry in column j.
+//Rows of At are sorted, so each row is left at the first k > j.
+OSQPCscMatrix* form_reduced_KKT_pattern(const OSQPCscMatrix* P,
+                                        const OSQPCscMatrix* A,
+                                        const OSQPCscMatrix* At) {
+
+  OSQPInt  n = P->n;
+  OSQPInt  i, j, k, q, pass, nnz = 0;
+  OSQPInt* mark = (OSQPInt *)c_malloc(n * sizeof(OSQPInt));
+  OSQPCscMatrix* R = OSQP_NULL;
+
+  if (!mark) return OSQP_NULL;
+
+  //count the entries of every column, then fill them
+  for (pass = 0; pass < 2; pass++) {
+    if (pass) {
+      R = csc_spalloc(n, n, nnz, 0, 0);
+      if (!R) break;
+      nnz = 0;
+    }
+
+    for (j = 0; j < n; j++) mark[j] = -1;
+
+    for (j = 0; j < n; j++) {
+      if (R) R->p[j] = nnz;
+
+      //diagonal (sigma), then P
+      mark[j] = j;
+      if (R) R->i[nnz] = j;
+      nnz++;
+
+      for (k = P->p[j]; k < P->p[j+1]; k++) {
+        i = P->i[k];
+        if (mark[i] != j) {
+          mark[i] = j;
+          if (R) R->i[nnz] = i;
+          nnz++;
+        }
+      }
+
+      //A' diag(param2) A
+      for (k = A->p[j]; k < A->p[j+1]; k++) {
+        for (q = At->p[A->i[k]]; q < At->p[A->i[k] + 1]; q++) {
+          i = At->i[q];
+          if (i > j) break;
+          if (mark[i] != j) {
+            mark[i] = j;
+            if (R) R->i[nnz] = i;
+            nnz++;
+          }
+        }
+      }
+    }
+  }
+
+  if (R) R->p[n] = nnz;
+  c_free(mark);
+
+  return R;
+}
+
+void update_reduced_KKT(OSQPCscMatrix*       KKT,
+                        const OSQPInt*       RtoKKT,
+                        const OSQPCscMatrix* R,
+                        const OSQPCscMatrix* P,
+                        const OSQPCscMatrix* A,
+                        const OSQPCscMatrix* At,
+                        OSQPFloat            param1,
+                        const OSQPFloat*     param2,
+                        OSQPFloat            param2_sc,
+                        OSQPFloat*           work) {
+
+  OSQPInt   i, j, k, q, row;
+  OSQPFloat a;
+
+  for (j = 0; j < R->n; j++) {
+    //scatter column j into work, which is only read on the pattern of R
+    for (k = R->p[j]; k < R->p[j+1]; k++) work[R->i[k]] = 0.0;
+
+    work[j] = param1;
+
+    for (k = P->p[j]; k < P->p[j+1]; k++) work[P->i[k]] += P->x[k];
+
+    for (k = A->p[j]; k < A->p[j+1]; k++) {
+      row = A->i[k];
+      a   = A->x[k] * (param2 ? param2[row] : param2_sc);
+      for (q = At->p[row]; q < At->p[row+1]; q++) {
+        i = At->i[q];
+        if (i > j) break;
+        work[i] += a * At->x[q];
+      }
+    }
+
+    //gather
+    for (k = R->p[j]; k < R->p[j+1]; k++) {
+      KKT->x[RtoKKT ? RtoKKT[k] : k] = work[R->i[k]];
+    }
+  }
+}
+
 #endif /* ifndef OSQP_EMBEDDED_MODE */
 
 
@@ -44,6 +44,92 @@ extern "C" {
                          OSQPInt*       PtoKKT,
                          OSQPInt*       AtoKKT,
                          OSQPInt*       param2toKKT);
+
+/**
+ * Form the sparsity pattern of the KKT matrix built by form_KKT in CSC format,
+ * without allocating its values (e.g. to compute a fill-reducing ordering)
+ *
+ * @param  P          data for P in csc format (triu form)
+ * @param  A          data for A in csc format
+ * @return            KKT pattern (x is OSQP_NULL), or OSQP_NULL on failure
+ */
+ OSQPCscMatrix* form_KKT_pattern(OSQPCscMatrix* P,
+                                 OSQPCscMatrix* A);
+
+/**
+ * Form the symmetrically permuted KKT matrix Pm * KKT * Pm' in CSC format,
+ * where KKT is the matrix built by form_KKT, without forming KKT itself
+ *
+ * NB: Only the upper triangular part is filled and the row indices within a
+ * column are not sorted
+ *
+ * @param  P          data for P in csc format (triu form)
+ * @param  A          data for A in csc format
+ * @param  param1     regularization parameter
+ * @param  param2     regularization parameter (vector)
+ * @param  param2_sc  regularization parameter (scalar, used if param2 is NULL)
+ * @param  Pinv       inverse permutation; row/column k of KKT is row/column Pinv[k]
+ * @param  PtoKKT     (modified) index mapping from elements of P to KKT matrix
+ * @param  AtoKKT     (modified) index mapping from elements of A to KKT matrix
+ * @param  param2toKKT(modified) index mapping from param2 to elements of KKT
+ * @return            permuted KKT matrix, or OSQP_NULL on failure
+ */
+ OSQPCscMatrix* form_KKT_perm(OSQPCscMatrix* P,
+                              OSQPCscMatrix* A,
+                              OSQPFloat      param1,
+                              OSQPFloat*     param2,
+                              OSQPFloat      param2_sc,
+                              const OSQPInt* Pinv,
+                              OSQPInt*       PtoKKT,
+                              OSQPInt*       AtoKKT,
+                              OSQPInt*       param2toKKT);
+
+/**
+ * Form the sparsity pattern of the reduced KKT matrix
+ *
+ * P + param1 I + A' diag(param2) A
+ *
+ * NB: Only the upper triangular part is formed, the diagonal is always
+ * present and the row indices within a column are not sorted
+ *
+ * @param  P          data for P in csc format (triu form)
+ * @param  A          data for A in csc format
+ * @param  At         transpose of A, with sorted row indices (see csc_transpose)
+ * @return            reduced KKT pattern (x is OSQP_NULL), or OSQP_NULL on failure
+ */
+ OSQPCscMatrix* form_reduced_KKT_pattern(const OSQPCscMatrix* P,
+                                         const OSQPCscMatrix* A,
+                                         const OSQPCscMatrix* At);
+
+/**
+ * Compute the values of the reduced KKT matrix
+ *
+ * P + param1 I + A' diag(param2) A
+ *
+ * on the pattern R built by form_reduced_KKT_pattern, and store them in KKT
+ * (which may be R itself, or a permutation of it)
+ *
+ * @param  KKT        matrix receiving the values
+ * @param  RtoKKT     index mapping from elements of R to KKT (OSQP_NULL if KKT is R)
+ * @param  R          reduced KKT pattern
+ * @param  P          data for P in csc format (triu form)
+ * @param  A          data for A in csc format
+ * @param  At         transpose of A, with the values of A
+ * @param  param1     regularization parameter
+ * @param  param2     weights of the rows of A (vector)
+ * @param  param2_sc  weight of the rows of A (scalar, used if param2 is NULL)
+ * @param  work       workspace of size P->n
+ */
+ void update_reduced_KKT(OSQPCscMatrix*       KKT,
+                         const OSQPInt*       RtoKKT,
+                         const OSQPCscMatrix* R,
+                         const OSQPCscMatrix* P,
+                         const OSQPCscMatrix* A,
+                         const OSQPCscMatrix* At,
+                         OSQPFloat            param1,
+                         const OSQPFloat*     param2,
+                         OSQPFloat            param2_sc,
+                         OSQPFloat*           work);
 # endif // ifndef OSQP_EMBEDDED_MODE
 
 
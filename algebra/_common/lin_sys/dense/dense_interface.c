@@ -0,0 +1,490 @@
+#include "glob_opts.h"
+#include "algebra_impl.h"
+#include "printing.h"
+#include "profilers.h"
+
+#include "error.h"
+#include "dense_interface.h"
+#include "dense_kernels.h"
+#include "util.h"
+
+
+/* Estimated bytes read and written by a solve with the dense factors: the nonzero
+ * part of L is streamed by both triangular solves, while every right-hand side
+ * entry is touched by the permutations, the diagonal scaling and the two solves */
+#define DENSE_SOLVE_BYTES(nnz, n) \
+  ((2.0 * (nnz) + 8.0 * (n)) * sizeof(OSQPFloat))
+
+
+void update_settings_linsys_solver_dense(dense_solver*       s,
+                                         const OSQPSettings* settings) {
+    /* No settings to update */
+    OSQP_UnusedVar(s);
+    OSQP_UnusedVar(settings);
+    return;
+}
+
+void warm_start_linsys_solver_dense(dense_solver*      s,
+                                    const OSQPVectorf* x) {
+    /* Warm starting not used by direct solvers */
+    OSQP_UnusedVar(s);
+    OSQP_UnusedVar(x);
+    return;
+}
+
+// Free dense LDL' structure
+void free_linsys_solver_dense(dense_solver* s) {
+    if (s) {
+        if (s->KKT)         c_free(s->KKT);
+        if (s->L)           c_free(s->L);
+        if (s->D)           c_free(s->D);
+        if (s->Dinv)        c_free(s->Dinv);
+        if (s->sol)         c_free(s->sol);
+        if (s->bp)          c_free(s->bp);
+        if (s->work)        c_free(s->work);
+        if (s->rho_inv_vec) c_free(s->rho_inv_vec);
+        c_free(s);
+    }
+}
+
+const char* name_dense(dense_solver* s) {
+    OSQP_UnusedVar(s);
+
+    return "dense LDL";
+}
+
+
+OSQPInt use_linsys_solver_dense(const OSQPMatrix*   P,
+                                const OSQPMatrix*   A,
+                                const OSQPSettings* settings) {
+
+    OSQPInt   dim = OSQPMatrix_get_n(P) + OSQPMatrix_get_m(A);
+    OSQPFloat nnz;
+
+    if (settings->kkt_system == OSQP_KKT_SYSTEM_DENSE)
+        return 1;
+
+    // The user permutation orders the sparse KKT matrix, so it keeps the sparse factorization
+    if (settings->kkt_system != OSQP_KKT_SYSTEM_AUTO ||
+        settings->kkt_ordering == OSQP_ORDERING_USER ||
+        dim >= OSQP_AUTO_DENSE_KKT_DIM)
+        return 0;
+
+    // Nonzeros in the lower triangle of the KKT matrix (the diagonal of P is counted twice)
+    nnz = (OSQPFloat)OSQPMatrix_get_nz(P) + OSQPMatrix_get_nz(A) + dim;
+
+    return nnz >= OSQP_AUTO_DENSE_KKT_DENSITY * 0.5 * dim * (dim + 1);
+}
+
+
+/*
+ * Set the diagonal of the constraint block of the KKT matrix to -1/rho
+ */
+static void dense_KKT_rho(dense_solver* s) {
+
+    OSQPInt    i;
+    OSQPInt    dim = s->dim;
+    OSQPFloat* K   = s->KKT;
+
+    if (s->rho_inv_vec) {
+        for (i = 0; i < s->m; i++) K[i * (dim + 1)] = -s->rho_inv_vec[i];
+    }
+    else {
+        for (i = 0; i < s->m; i++) K[i * (dim + 1)] = -s->rho_inv;
+    }
+}
+
+/*
+ * Form the lower triangle of the KKT matrix with the constraint rows first
+ *
+ * [ -diag(1/rho)              ]
+ * [ A'            P + sigma I ]
+ *
+ * as a dense column-major array
+ */
+static void dense_KKT_form(dense_solver*        s,
+                           const OSQPCscMatrix* P,
+                           const OSQPCscMatrix* A) {
+
+    OSQPInt    j, k;
+    OSQPInt    m   = s->m;
+    OSQPInt    dim = s->dim;
+    OSQPFloat* K   = s->KKT;
+
+    for (k = 0; k < dim * dim; k++) K[k] = 0.0;
+
+    // Column j of A is row m + j of the KKT matrix
+    for (j = 0; j < s->n; j++) {
+        for (k = A->p[j]; k < A->p[j+1]; k++) {
+            K[m + j + A->i[k] * dim] = A->x[k];
+        }
+    }
+
+    // Only the upper triangle of P is stored, which is the lower triangle by rows
+    for (j = 0; j < s->n; j++) {
+        for (k = P->p[j]; k < P->p[j+1]; k++) {
+            K[m + j + (m + P->i[k]) * dim] += P->x[k];
+        }
+        K[(m + j) * (dim + 1)] += s->sigma;
+    }
+
+    dense_KKT_rho(s);
+}
+
+/*
+ * Store pivot j of the factorization, and scale column j of L by its inverse
+ * from row i0 on (the rows above are zero)
+ *
+ * With dynamic regularization, pivots with magnitude at most dyn_reg_eps are
+ * replaced by dyn_reg_delta with the sign they have in a quasidefinite KKT
+ * matrix, as in the sparse factorization: negative for the constraint rows,
+ * positive for the rows of P + sigma I.
+ *
+ * Returns 1 for a positive pivot, 0 for a negative one and -1 for a zero one.
+ */
+static OSQPInt dense_pivot(dense_solver* s,
+                           OSQPInt       j,
+                           OSQPInt       i0) {
+
+    OSQPInt    i;
+    OSQPInt    dim = s->dim;
+    OSQPFloat* l   = s->L + j * dim;
+    OSQPFloat  d   = l[j];
+
+    if (s->dyn_reg && c_absval(d) <= s->dyn_reg_eps) {
+        d = j < s->m ? -s->dyn_reg_delta : s->dyn_reg_delta;
+        s->nreg++;
+    }
+    else if (d == 0.0) {
+        return -1;
+    }
+
+    s->D[j]    = d;
+    s->Dinv[j] = 1.0 / d;
+    for (i = i0; i < dim; i++) l[i] *= s->Dinv[j];
+
+    return d > 0.0;
+}
+
+/*
+ * Numeric LDL' factorization of the KKT matrix
+ *
+ * The constraint block comes first and is diagonal, so its columns are only
+ * scaled, and applying them to the primal block forms the Schur complement
+ * P + sigma I + A' diag(rho) A. The primal block is then factored by blocks of
+ * columns: the columns of a block are factored left-looking among themselves,
+ * and the block is then applied to the columns to its right at once.
+ *
+ * Returns the number of positive pivots, or -1 on a zero pivot.
+ */
+static OSQPInt dense_factor(dense_solver* s) {
+
+    OSQPInt    j, k, c, kb, ke;
+    OSQPInt    pos = 0;
+    OSQPInt    m   = s->m;
+    OSQPInt    dim = s->dim;
+    OSQPInt    positiveValuesInD = 0;
+    OSQPFloat* L = s->L;
+    OSQPFloat* w = s->work;
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+
+    for (k = 0; k < dim * dim; k++) L[k] = s->KKT[k];
+    s->nreg = 0;
+
+    // Constraint block
+    for (j = 0; j < m; j++) {
+        pos = dense_pivot(s, j, m);
+        if (pos < 0) break;
+        positiveValuesInD += pos;
+    }
+    for (kb = 0; pos >= 0 && kb < m; kb += DENSE_BLOCK) {
+        ke = c_min(kb + DENSE_BLOCK, m);
+        for (c = m; c < dim; c++) {
+            for (k = kb; k < ke; k++) w[k] = L[c + k * dim] * s->D[k];
+            dense_update_column(L + c * dim, L, w, dim, c, kb, ke);
+        }
+    }
+
+    // Primal block
+    for (kb = m; pos >= 0 && kb < dim; kb += DENSE_BLOCK) {
+        ke = c_min(kb + DENSE_BLOCK, dim);
+
+        // Factor the columns of the block
+        for (j = kb; j < ke; j++) {
+            for (k = kb; k < j; k++) w[k] = L[j + k * dim] * s->D[k];
+            dense_update_column(L + j * dim, L, w, dim, j, kb, j);
+
+            pos = dense_pivot(s, j, j + 1);
+            if (pos < 0) break;
+            positiveValuesInD += pos;
+        }
+
+        // Apply the block to the trailing matrix
+        for (c = ke; pos >= 0 && c < dim; c++) {
+            for (k = kb; k < ke; k++) w[k] = L[c + k * dim] * s->D[k];
+            dense_update_column(L + c * dim, L, w, dim, c, kb, ke);
+        }
+    }
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+
+    return pos < 0 ? -1 : positiveValuesInD;
+}
+
+/* solve LDL' x = b in place (the columns of the constraint block are zero above row m) */
+static void dense_LDLSolve(const dense_solver* s,
+                           OSQPFloat*          x) {
+
+    OSQPInt          i, j;
+    OSQPInt          m   = s->m;
+    OSQPInt          dim = s->dim;
+    const OSQPFloat* l;
+    OSQPFloat        xj;
+
+    for (j = 0; j < dim; j++) {
+        l  = s->L + j * dim;
+        xj = x[j];
+        for (i = c_max(j + 1, m); i < dim; i++) x[i] -= l[i] * xj;
+    }
+
+    for (j = 0; j < dim; j++) x[j] *= s->Dinv[j];
+
+    for (j = dim - 1; j >= 0; j--) {
+        l  = s->L + j * dim;
+        xj = 0.0;
+        for (i = c_max(j + 1, m); i < dim; i++) xj += l[i] * x[i];
+        x[j] -= xj;
+    }
+}
+
+/*
+ * solve KKT x = b for x, in the ordering of the dense KKT matrix
+ *
+ * When the factorization replaced some pivots, the solution is refined against
+ * the stored KKT matrix:
+ *   r = b - KKT x,  x = x + (LDL')^{-1} r
+ */
+static void dense_solve(dense_solver*    s,
+                        OSQPFloat*       x,
+                        const OSQPFloat* b) {
+
+    OSQPInt    i, j, iter;
+    OSQPInt    dim = s->dim;
+    OSQPFloat* K   = s->KKT;
+    OSQPFloat* r   = s->work;
+    OSQPFloat  norm_b = 0.0;
+    OSQPFloat  norm_r, xj, rj;
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+    osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE, DENSE_SOLVE_BYTES(s->factor_nnz, dim));
+
+    for (j = 0; j < dim; j++) {
+        x[j]   = b[j];
+        norm_b = c_max(norm_b, c_absval(b[j]));
+    }
+
+    dense_LDLSolve(s, x);
+
+    for (iter = 0; s->nreg && iter < s->refine_iter; iter++) {
+        // r = b - KKT x, with only the lower triangular part of KKT stored
+        for (j = 0; j < dim; j++) r[j] = b[j];
+        for (j = 0; j < dim; j++) {
+            xj = x[j];
+            rj = K[j * (dim + 1)] * xj;
+            for (i = c_max(j + 1, s->m); i < dim; i++) {
+                r[i] -= K[i + j * dim] * xj;
+                rj   += K[i + j * dim] * x[i];
+            }
+            r[j] -= rj;
+        }
+
+        norm_r = 0.0;
+        for (j = 0; j < dim; j++) norm_r = c_max(norm_r, c_absval(r[j]));
+        if (norm_r <= DENSE_REFINE_TOL * (1.0 + norm_b)) break;
+
+        dense_LDLSolve(s, r);
+        for (j = 0; j < dim; j++) x[j] += r[j];
+    }
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+}
+
+
+// Initialize dense LDL' solver
+OSQPInt init_linsys_solver_dense(dense_solver**      sp,
+                                 const OSQPMatrix*   P,
+                                 const OSQPMatrix*   A,
+                                 const OSQPVectorf*  rho_vec,
+                                 const OSQPSettings* settings,
+                                 OSQPInt             polishing) {
+
+    OSQPInt i, dim;
+    OSQPInt n = P->csc->n;
+    OSQPInt m = A->csc->m;
+
+    dense_solver* s = c_calloc(1, sizeof(dense_solver));
+    *sp = s;
+
+    if (!s) return OSQP_MEM_ALLOC_ERROR;
+
+    dim    = n + m;
+    s->n   = n;
+    s->m   = m;
+    s->dim = dim;
+
+    // Scalar parameters (the constraint block of the polishing KKT matrix is -sigma I)
+    s->sigma     = settings->sigma;
+    s->rho_inv   = polishing ? settings->sigma : 1. / settings->rho;
+    s->polishing = polishing;
+
+    // Dynamic regularization
+    s->dyn_reg       = settings->dyn_reg;
+    s->dyn_reg_eps   = settings->dyn_reg_eps;
+    s->dyn_reg_delta = settings->dyn_reg_delta;
+    s->refine_iter   = settings->dyn_reg_refine_iter;
+
+    // Link Functions
+    s->name            = &name_dense;
+    s->solve           = &solve_linsys_dense;
+    s->update_settings = &update_settings_linsys_solver_dense;
+    s->warm_start      = &warm_start_linsys_solver_dense;
+    s->free            = &free_linsys_solver_dense;
+    s->update_matrices = &update_linsys_solver_matrices_dense;
+    s->update_rho_vec  = &update_linsys_solver_rho_vec_dense;
+
+    // Assign type
+    s->type = OSQP_DIRECT_SOLVER;
+
+    // Set number of threads to 1 (single threaded)
+    s->nthreads = 1;
+
+    // Strictly lower triangle, without the zeros of the constraint block
+    s->factor_nnz = n * m + n * (n - 1) / 2;
+
+    s->KKT  = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim * dim);
+    s->L    = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim * dim);
+    s->D    = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim);
+    s->Dinv = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim);
+    s->sol  = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim);
+    s->bp   = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim);
+    s->work = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim);
+
+    if (rho_vec && !polishing) {
+        s->rho_inv_vec = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * m);
+        if (m && !s->rho_inv_vec) dim = -1;
+        else for (i = 0; i < m; i++) s->rho_inv_vec[i] = 1. / rho_vec->values[i];
+    }
+
+    if (dim < 0 || (dim && (!s->KKT || !s->L || !s->D || !s->Dinv || !s->sol || !s->bp || !s->work))) {
+        c_eprint("Error allocating the dense KKT matrix");
+        free_linsys_solver_dense(s);
+        *sp = OSQP_NULL;
+        return OSQP_LINSYS_SOLVER_INIT_ERROR;
+    }
+
+    dense_KKT_form(s, P->csc, A->csc);
+
+    // Number of positive elements of D should be equal to n
+    if (dense_factor(s) != n) {
+        c_eprint("Error in dense KKT matrix LDL factorization. The problem seems to be non-convex");
+        free_linsys_solver_dense(s);
+        *sp = OSQP_NULL;
+        return OSQP_NONCVX_ERROR;
+    }
+
+    return 0;
+}
+
+
+OSQPInt solve_linsys_dense(dense_solver* s,
+                           OSQPVectorf*  b,
+                           OSQPInt       admm_iter) {
+
+    OSQPInt    j;
+    OSQPInt    n  = s->n;
+    OSQPInt    m  = s->m;
+    OSQPFloat* bv = b->values;
+
+    // Direct solver doesn't care about the ADMM iteration
+    OSQP_UnusedVar(admm_iter);
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_SOLVE);
+
+    /* the constraint rows come first in the dense KKT matrix */
+    for (j = 0; j < m; j++) s->bp[j]     = bv[n + j];
+    for (j = 0; j < n; j++) s->bp[m + j] = bv[j];
+
+    dense_solve(s, s->sol, s->bp);
+
+    /* copy x_tilde from s->sol */
+    for (j = 0; j < n; j++) {
+        bv[j] = s->sol[m + j];
+    }
+
+    if (s->polishing) {
+        /* stores solution to the KKT system in b */
+        for (j = 0; j < m; j++) {
+            bv[j + n] = s->sol[j];
+        }
+    }
+    else if (s->rho_inv_vec) {
+        /* compute z_tilde from b and s->sol */
+        for (j = 0; j < m; j++) {
+            bv[j + n] += s->rho_inv_vec[j] * s->sol[j];
+        }
+    }
+    else {
+        for (j = 0; j < m; j++) {
+            bv[j + n] += s->rho_inv * s->sol[j];
+        }
+    }
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_SOLVE);
+    return 0;
+}
+
+
+OSQPInt update_linsys_solver_matrices_dense(dense_solver*     s,
+                                            const OSQPMatrix* P,
+                                            const OSQPInt*    Px_new_idx,
+                                            OSQPInt           P_new_n,
+                                            const OSQPMatrix* A,
+                                            const OSQPInt*    Ax_new_idx,
+                                            OSQPInt           A_new_n) {
+
+    // Forming the dense matrix again costs less than its factorization
+    OSQP_UnusedVar(Px_new_idx);
+    OSQP_UnusedVar(P_new_n);
+    OSQP_UnusedVar(Ax_new_idx);
+    OSQP_UnusedVar(A_new_n);
+
+    dense_KKT_form(s, P->csc, A->csc);
+
+    //number of positive elements in D should match the
+    //dimension of P if P + \sigma I is PD.   Error otherwise.
+    return (dense_factor(s) == s->n) ? 0 : 1;
+}
+
+
+OSQPInt update_linsys_solver_rho_vec_dense(dense_solver*      s,
+                                           const OSQPVectorf* rho_vec,
+                                           OSQPFloat          rho_sc) {
+
+    OSQPInt i;
+
+    // Update internal rho_inv_vec
+    if (s->rho_inv_vec) {
+        for (i = 0; i < s->m; i++) {
+            s->rho_inv_vec[i] = 1. / rho_vec->values[i];
+        }
+    }
+    else {
+        s->rho_inv = 1. / rho_sc;
+    }
+
+    // Update KKT matrix with new rho_vec
+    dense_KKT_rho(s);
+
+    return (dense_factor(s) < 0);
+}
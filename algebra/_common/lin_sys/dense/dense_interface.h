@@ -0,0 +1,189 @@
+#ifndef DENSE_INTERFACE_H
+#define DENSE_INTERFACE_H
+
+
+#include "osqp.h"
+#include "types.h"  //OSQPMatrix and OSQPVector[fi] types
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Dense LDL' solver structure
+ *
+ * The KKT matrix is stored as a dense column-major array, of which only the
+ * lower triangle is used, with the constraint rows first. Eliminating the
+ * diagonal constraint block first leaves a dense factorization of the Schur
+ * complement P + sigma I + A' diag(rho) A. This avoids the ordering and the
+ * index handling of the sparse factorization, which dominate on small
+ * problems with dense P and A.
+ */
+typedef struct dense dense_solver;
+
+struct dense {
+    enum osqp_linsys_solver_type type;
+
+    /**
+     * @name Functions
+     * @{
+     */
+    const char* (*name)(struct dense* s);
+
+    OSQPInt (*solve)(struct dense* self,
+                     OSQPVectorf*  b,
+                     OSQPInt       admm_iter);
+
+    void (*update_settings)(struct dense*       self,
+                            const OSQPSettings* settings);
+
+    void (*warm_start)(struct dense*      self,
+                       const OSQPVectorf* x);
+
+    OSQPInt (*adjoint_derivative)(struct dense* self);
+
+    void (*free)(struct dense* self);
+
+    OSQPInt (*update_matrices)(struct dense*     self,
+                               const OSQPMatrix* P,
+                               const OSQPInt*    Px_new_idx,
+                               OSQPInt           P_new_n,
+                               const OSQPMatrix* A,
+                               const OSQPInt*    Ax_new_idx,
+                               OSQPInt           A_new_n);   ///< Update solver matrices
+
+    OSQPInt (*update_rho_vec)(struct dense*      self,
+                              const OSQPVectorf* rho_vec,
+                              OSQPFloat          rho_sc);    ///< Update rho_vec parameter
+
+    OSQPInt nthreads;
+    OSQPInt factor_nnz;   ///< nonzeros in the strictly lower triangle of the factor
+
+    /** @} */
+
+    /**
+     * @name Attributes
+     * @{
+     */
+    OSQPInt    n;             ///< number of QP variables
+    OSQPInt    m;             ///< number of QP constraints
+    OSQPInt    dim;           ///< dimension of the KKT matrix (n + m)
+    OSQPFloat* KKT;           ///< KKT matrix with the constraint rows first (dense, column-major, lower triangle)
+    OSQPFloat* L;             ///< unit lower triangular factor (dense, column-major, strictly lower triangle)
+    OSQPFloat* D;             ///< diagonal matrix of the factorization (as a vector)
+    OSQPFloat* Dinv;          ///< inverse of D
+    OSQPFloat* sol;           ///< solution to the KKT system (constraint rows first)
+    OSQPFloat* bp;            ///< right-hand side (constraint rows first)
+    OSQPFloat* work;          ///< refinement workspace
+    OSQPFloat* rho_inv_vec;   ///< parameter vector
+    OSQPFloat  sigma;         ///< scalar parameter
+    OSQPFloat  rho_inv;       ///< scalar parameter (used if rho_inv_vec == NULL)
+    OSQPInt    polishing;     ///< polishing flag
+
+    // Dynamic regularization
+    OSQPInt    dyn_reg;       ///< replace tiny pivots by pivots of the expected sign
+    OSQPFloat  dyn_reg_eps;   ///< pivots with magnitude at most dyn_reg_eps are replaced
+    OSQPFloat  dyn_reg_delta; ///< magnitude of the replacement pivots
+    OSQPInt    refine_iter;   ///< iterative refinement steps when pivots were replaced
+    OSQPInt    nreg;          ///< number of pivots replaced in the last factorization
+
+    /** @} */
+};
+
+
+/**
+ * Decide whether the direct solver uses the dense factorization
+ *
+ * OSQP_KKT_SYSTEM_DENSE always does. OSQP_KKT_SYSTEM_AUTO does for KKT matrices
+ * with fewer than OSQP_AUTO_DENSE_KKT_DIM rows whose lower triangle is at least
+ * OSQP_AUTO_DENSE_KKT_DENSITY full, unless a user ordering is requested.
+ *
+ * @param  P         Objective function matrix (upper triangular form)
+ * @param  A         Constraints matrix
+ * @param  settings  Solver settings
+ * @return           1 if the dense factorization should be used, 0 otherwise
+ */
+OSQPInt use_linsys_solver_dense(const OSQPMatrix*   P,
+                                const OSQPMatrix*   A,
+                                const OSQPSettings* settings);
+
+/**
+ * Initialize dense LDL' Solver
+ *
+ * @param  s         Pointer to a private structure
+ * @param  P         Objective function matrix (upper triangular form)
+ * @param  A         Constraints matrix
+ * @param  rho_vec   Algorithm parameter. If polish, then rho_vec = OSQP_NULL.
+ * @param  settings  Solver settings
+ * @param  polishing Flag whether we are initializing for polishing or not
+ * @return           Exitflag for error (0 if no errors)
+ */
+OSQPInt init_linsys_solver_dense(dense_solver**      sp,
+                                 const OSQPMatrix*   P,
+                                 const OSQPMatrix*   A,
+                                 const OSQPVectorf*  rho_vec,
+                                 const OSQPSettings* settings,
+                                 OSQPInt             polishing);
+
+/**
+ * Get the user-friendly name of the dense solver.
+ * @return The user-friendly name
+ */
+const char* name_dense(dense_solver* s);
+
+/**
+ * Solve linear system and store result in b
+ * @param  s        Linear system solver structure
+ * @param  b        Right-hand side
+ * @return          Exitflag
+ */
+OSQPInt solve_linsys_dense(dense_solver* s,
+                           OSQPVectorf*  b,
+                           OSQPInt       admm_iter);
+
+void update_settings_linsys_solver_dense(dense_solver*       s,
+                                         const OSQPSettings* settings);
+
+void warm_start_linsys_solver_dense(dense_solver*      s,
+                                    const OSQPVectorf* x);
+
+/**
+ * Update linear system solver matrices
+ * @param  s          Linear system solver structure
+ * @param  P          Matrix P
+ * @param  Px_new_idx elements of P to update,
+ * @param  P_new_n    number of elements to update
+ * @param  A          Matrix A
+ * @param  Ax_new_idx elements of A to update,
+ * @param  A_new_n    number of elements to update
+ * @return            Exitflag
+ */
+OSQPInt update_linsys_solver_matrices_dense(dense_solver*     s,
+                                            const OSQPMatrix* P,
+                                            const OSQPInt*    Px_new_idx,
+                                            OSQPInt           P_new_n,
+                                            const OSQPMatrix* A,
+                                            const OSQPInt*    Ax_new_idx,
+                                            OSQPInt           A_new_n);
+
+/**
+ * Update rho_vec parameter in linear system solver structure
+ * @param  s        Linear system solver structure
+ * @param  rho_vec  new rho_vec value
+ * @return          exitflag
+ */
+OSQPInt update_linsys_solver_rho_vec_dense(dense_solver*      s,
+                                           const OSQPVectorf* rho_vec,
+                                           OSQPFloat          rho_sc);
+
+/**
+ * Free linear system solver
+ * @param s linear system solver object
+ */
+void free_linsys_solver_dense(dense_solver* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DENSE_INTERFACE_H */
@@ -0,0 +1,40 @@
+#include "dense_kernels.h"
+
+
+/*
+ * Four columns of L are applied at a time, so y is loaded and stored once for
+ * every four columns and the loop over i vectorizes.
+ */
+void dense_update_column(OSQPFloat*       y,
+                         const OSQPFloat* L,
+                         const OSQPFloat* w,
+                         OSQPInt          ld,
+                         OSQPInt          i0,
+                         OSQPInt          k0,
+                         OSQPInt          k1) {
+
+    OSQPInt          i, k;
+    OSQPFloat        w0, w1, w2, w3;
+    const OSQPFloat *l0, *l1, *l2, *l3;
+
+    for (k = k0; k + 4 <= k1; k += 4) {
+        l0 = L + k * ld;
+        l1 = l0 + ld;
+        l2 = l1 + ld;
+        l3 = l2 + ld;
+        w0 = w[k];
+        w1 = w[k+1];
+        w2 = w[k+2];
+        w3 = w[k+3];
+        for (i = i0; i < ld; i++) {
+            y[i] -= l0[i] * w0 + l1[i] * w1 + l2[i] * w2 + l3[i] * w3;
+        }
+    }
+    for (; k < k1; k++) {
+        l0 = L + k * ld;
+        w0 = w[k];
+        for (i = i0; i < ld; i++) {
+            y[i] -= l0[i] * w0;
+        }
+    }
+}
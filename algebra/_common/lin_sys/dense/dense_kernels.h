@@ -0,0 +1,47 @@
+#ifndef DENSE_KERNELS_H
+#define DENSE_KERNELS_H
+
+
+#include "osqp.h"
+
+/* Width of the column blocks of the factorization. A block of columns below
+ * the diagonal is reused for every column of the trailing matrix it updates,
+ * so it should fit in the L1 cache together with the updated column. */
+#define DENSE_BLOCK (32)
+
+/* Refinement stops once the residual is below this tolerance relative to b */
+#define DENSE_REFINE_TOL (1e-12)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Apply columns k0, ..., k1 - 1 of a dense column-major matrix to a column
+ *
+ *   y[i] -= sum_{k = k0}^{k1 - 1} L[i + k * ld] * w[k]  for i = i0, ..., ld - 1
+ *
+ * This is the update of the dense LDL' factorizations and of the triangular
+ * solves with several right-hand sides.
+ *
+ * @param  y   Updated column
+ * @param  L   Dense matrix with leading dimension ld
+ * @param  w   Weights of the columns of L
+ * @param  ld  Leading dimension of L, and end of the updated rows
+ * @param  i0  First updated row
+ * @param  k0  First applied column
+ * @param  k1  End of the applied columns
+ */
+void dense_update_column(OSQPFloat*       y,
+                         const OSQPFloat* L,
+                         const OSQPFloat* w,
+                         OSQPInt          ld,
+                         OSQPInt          i0,
+                         OSQPInt          k0,
+                         OSQPInt          k1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DENSE_KERNELS_H */
@@ -0,0 +1,776 @@
+#include "glob_opts.h"
+#include "algebra_impl.h"
+#include "printing.h"
+#include "profilers.h"
+
+#include "error.h"
+#include "stage_interface.h"
+#include "dense_kernels.h"
+#include "util.h"
+
+
+/* Estimated bytes read and written by a solve with the stage factors: the stored
+ * part of L is streamed by both triangular solves, every dense right-hand side
+ * entry is touched by the scatter, the diagonal scaling and the two solves, and
+ * the entries of the eliminated constraints are read twice */
+#define STAGE_SOLVE_BYTES(nnz, n, nloc) \
+  ((2.0 * (nnz) + 8.0 * (n) + 4.0 * (nloc)) * sizeof(OSQPFloat))
+
+
+void update_settings_linsys_solver_stage(stage_solver*       s,
+                                         const OSQPSettings* settings) {
+    /* No settings to update */
+    OSQP_UnusedVar(s);
+    OSQP_UnusedVar(settings);
+    return;
+}
+
+void warm_start_linsys_solver_stage(stage_solver*      s,
+                                    const OSQPVectorf* x) {
+    /* Warm starting not used by direct solvers */
+    OSQP_UnusedVar(s);
+    OSQP_UnusedVar(x);
+    return;
+}
+
+// Free stagewise LDL' structure
+void free_linsys_solver_stage(stage_solver* s) {
+    if (s) {
+        if (s->blk_d)       c_free(s->blk_d);
+        if (s->blk_r)       c_free(s->blk_r);
+        if (s->blk_f)       c_free(s->blk_f);
+        if (s->blk_off)     c_free(s->blk_off);
+        if (s->L_off)       c_free(s->L_off);
+        if (s->kkt_pos)     c_free(s->kkt_pos);
+        if (s->kkt_row)     c_free(s->kkt_row);
+        if (s->loc_row)     c_free(s->loc_row);
+        if (s->loc_stage)   c_free(s->loc_stage);
+        if (s->loc_p)       c_free(s->loc_p);
+        if (s->loc_i)       c_free(s->loc_i);
+        if (s->loc_x)       c_free(s->loc_x);
+        if (s->Pmap)        c_free(s->Pmap);
+        if (s->Amap)        c_free(s->Amap);
+        if (s->Kp)          c_free(s->Kp);
+        if (s->KKT)         c_free(s->KKT);
+        if (s->L)           c_free(s->L);
+        if (s->D)           c_free(s->D);
+        if (s->Dinv)        c_free(s->Dinv);
+        if (s->sol)         c_free(s->sol);
+        if (s->bp)          c_free(s->bp);
+        if (s->work)        c_free(s->work);
+        if (s->rho_inv_vec) c_free(s->rho_inv_vec);
+        c_free(s);
+    }
+}
+
+const char* name_stage(stage_solver* s) {
+    OSQP_UnusedVar(s);
+
+    return "stagewise LDL";
+}
+
+
+OSQPInt use_linsys_solver_stage(const OSQPSettings* settings,
+                                OSQPInt             polishing) {
+
+    return !polishing && settings->kkt_system == OSQP_KKT_SYSTEM_STAGED;
+}
+
+
+/*
+ * Index in KKT of the entry between the dense KKT rows a and b, which belong
+ * to the same stage or to consecutive ones
+ */
+static OSQPInt stage_offset(const stage_solver* s,
+                            const OSQPInt*      stages,
+                            OSQPInt             a,
+                            OSQPInt             b) {
+
+    OSQPInt ka = stages[a];
+    OSQPInt kb = stages[b];
+    OSQPInt ia = s->kkt_pos[a] - s->blk_off[ka];
+    OSQPInt ib = s->kkt_pos[b] - s->blk_off[kb];
+    OSQPInt t;
+
+    // Row a comes after row b in the block ordering
+    if (ka < kb || (ka == kb && ia < ib)) {
+        t = ka; ka = kb; kb = t;
+        t = ia; ia = ib; ib = t;
+    }
+
+    if (ka == kb)
+        return s->L_off[ka] + ia + ib * s->blk_d[ka];
+
+    // Row a is one of the leading rows of its block, row b one of the trailing rows of its block
+    return s->L_off[s->nstages + ka] + ia + (ib - s->blk_d[kb] + s->blk_f[kb]) * s->blk_r[ka];
+}
+
+/*
+ * Set the rho terms of the blocks: -1/rho on the diagonal of the dense
+ * constraint rows, and rho a a' for every eliminated constraint a' x
+ */
+static void stage_KKT_rho(stage_solver* s) {
+
+    OSQPInt    i, j, k, l, a, b, d, r;
+    OSQPFloat  rho, xa;
+    OSQPFloat* Kb;
+
+    for (k = 0; k < s->nkkt; k++) s->KKT[k] = s->Kp[k];
+
+    for (k = 0; k < s->nstages; k++) {
+        d  = s->blk_d[k];
+        Kb = s->KKT + s->L_off[k];
+        for (i = 0; i < d; i++) {
+            r = s->kkt_row[s->blk_off[k] + i] - s->n;
+            if (r >= 0) Kb[i * (d + 1)] = s->rho_inv_vec ? -s->rho_inv_vec[r] : -s->rho_inv;
+        }
+    }
+
+    for (l = 0; l < s->nloc; l++) {
+        k   = s->loc_stage[l];
+        d   = s->blk_d[k];
+        Kb  = s->KKT + s->L_off[k];
+        rho = 1. / (s->rho_inv_vec ? s->rho_inv_vec[s->loc_row[l]] : s->rho_inv);
+        for (a = s->loc_p[l]; a < s->loc_p[l+1]; a++) {
+            i  = s->loc_i[a];
+            xa = rho * s->loc_x[a];
+            for (b = s->loc_p[l]; b < s->loc_p[l+1]; b++) {
+                j = s->loc_i[b];
+                if (i >= j) Kb[i + j * d] += xa * s->loc_x[b];
+            }
+        }
+    }
+}
+
+/*
+ * Scatter P + sigma I and A into the blocks and the eliminated constraints
+ */
+static void stage_KKT_form(stage_solver*        s,
+                           const OSQPCscMatrix* P,
+                           const OSQPCscMatrix* A) {
+
+    OSQPInt i, k, d;
+
+    for (k = 0; k < s->nkkt; k++) s->Kp[k] = 0.0;
+
+    for (k = 0; k < P->p[P->n]; k++) s->Kp[s->Pmap[k]] = P->x[k];
+
+    for (k = 0; k < A->p[A->n]; k++) {
+        if (s->Amap[k] >= 0) s->Kp[s->Amap[k]]       = A->x[k];
+        else                 s->loc_x[-1 - s->Amap[k]] = A->x[k];
+    }
+
+    for (k = 0; k < s->nstages; k++) {
+        d = s->blk_d[k];
+        for (i = 0; i < d; i++) {
+            if (s->kkt_row[s->blk_off[k] + i] < s->n) s->Kp[s->L_off[k] + i * (d + 1)] += s->sigma;
+        }
+    }
+
+    stage_KKT_rho(s);
+}
+
+/*
+ * Store the pivot of dense row p, which is column j of its block of dimension
+ * d, and scale the column below the diagonal by its inverse
+ *
+ * With dynamic regularization, pivots with magnitude at most dyn_reg_eps are
+ * replaced by dyn_reg_delta with the sign they have in a quasidefinite KKT
+ * matrix: negative for the constraint rows, positive for the variable rows.
+ *
+ * Returns 1 for a positive pivot, 0 for a negative one and -1 for a zero one.
+ */
+static OSQPInt stage_pivot(stage_solver* s,
+                           OSQPInt       p,
+                           OSQPFloat*    l,
+                           OSQPInt       j,
+                           OSQPInt       d) {
+
+    OSQPInt   i;
+    OSQPFloat dj = l[j];
+
+    if (s->dyn_reg && c_absval(dj) <= s->dyn_reg_eps) {
+        dj = s->kkt_row[p] >= s->n ? -s->dyn_reg_delta : s->dyn_reg_delta;
+        s->nreg++;
+    }
+    else if (dj == 0.0) {
+        return -1;
+    }
+
+    s->D[p]    = dj;
+    s->Dinv[p] = 1.0 / dj;
+    for (i = j + 1; i < d; i++) l[i] *= s->Dinv[p];
+
+    return dj > 0.0;
+}
+
+/*
+ * Numeric LDL' factorization of the block tridiagonal matrix
+ *
+ * Stage k is coupled to stage k - 1 by the block C in its leading r rows and
+ * the trailing f columns of stage k - 1. With the factorization
+ * L_{k-1} D_{k-1} L_{k-1}' of the previous stage,
+ *   G = C L_{k-1}^{-T}
+ * is computed column by column, and is zero outside of the same trailing
+ * columns since L_{k-1} is lower triangular. The leading block of stage k is
+ * updated by -G D_{k-1}^{-1} G', and G D_{k-1}^{-1} is kept as the coupling
+ * block of the factor. The block of stage k is then factored like the dense
+ * KKT matrix.
+ *
+ * Returns the number of positive pivots, or -1 on a zero pivot.
+ */
+static OSQPInt stage_factor(stage_solver* s) {
+
+    OSQPInt    j, k, l, c, kb, ke, d, r, f, dp, off;
+    OSQPInt    pos = 0;
+    OSQPInt    positiveValuesInD = 0;
+    OSQPFloat *Lk, *Lp, *F;
+    OSQPFloat* Dinvp;
+    OSQPFloat* w = s->work;
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+
+    for (j = 0; j < s->nkkt; j++) s->L[j] = s->KKT[j];
+    s->nreg = 0;
+
+    for (k = 0; pos >= 0 && k < s->nstages; k++) {
+        d   = s->blk_d[k];
+        r   = s->blk_r[k];
+        off = s->blk_off[k];
+        Lk  = s->L + s->L_off[k];
+
+        // Coupling to the previous stage
+        if (k > 0 && r > 0) {
+            dp    = s->blk_d[k-1];
+            f     = s->blk_f[k-1];
+            Lp    = s->L + s->L_off[k-1] + (dp - f) * (dp + 1);
+            Dinvp = s->Dinv + s->blk_off[k] - f;
+            F     = s->L + s->L_off[s->nstages + k];
+
+            for (j = 0; j < f; j++) {
+                for (l = 0; l < j; l++) w[l] = Lp[j + l * dp];
+                dense_update_column(F + j * r, F, w, r, 0, 0, j);
+            }
+
+            for (c = 0; c < r; c++) {
+                for (l = 0; l < f; l++) w[l] = F[c + l * r] * Dinvp[l];
+                dense_update_column(Lk + c * d, F, w, r, c, 0, f);
+            }
+
+            for (l = 0; l < f; l++) {
+                for (j = 0; j < r; j++) F[j + l * r] *= Dinvp[l];
+            }
+        }
+
+        // Block of the stage
+        for (kb = 0; pos >= 0 && kb < d; kb += DENSE_BLOCK) {
+            ke = c_min(kb + DENSE_BLOCK, d);
+
+            for (j = kb; j < ke; j++) {
+                for (l = kb; l < j; l++) w[l] = Lk[j + l * d] * s->D[off + l];
+                dense_update_column(Lk + j * d, Lk, w, d, j, kb, j);
+
+                pos = stage_pivot(s, off + j, Lk + j * d, j, d);
+                if (pos < 0) break;
+                positiveValuesInD += pos;
+            }
+
+            for (c = ke; pos >= 0 && c < d; c++) {
+                for (l = kb; l < ke; l++) w[l] = Lk[c + l * d] * s->D[off + l];
+                dense_update_column(Lk + c * d, Lk, w, d, c, kb, ke);
+            }
+        }
+    }
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+
+    return pos < 0 ? -1 : positiveValuesInD;
+}
+
+/* solve LDL' x = b in place, one stage at a time */
+static void stage_LDLSolve(const stage_solver* s,
+                           OSQPFloat*          x) {
+
+    OSQPInt          i, j, k, d, r, f;
+    OSQPInt          N = s->nstages;
+    const OSQPFloat *Lk, *F;
+    OSQPFloat       *xk, *x1;
+    OSQPFloat        xj;
+
+    for (k = 0; k < N; k++) {
+        d  = s->blk_d[k];
+        xk = x + s->blk_off[k];
+        Lk = s->L + s->L_off[k];
+
+        if (k > 0) {
+            F = s->L + s->L_off[N + k];
+            dense_update_column(xk, F, xk - s->blk_f[k-1], s->blk_r[k], 0, 0, s->blk_f[k-1]);
+        }
+
+        for (j = 0; j < d; j++) {
+            xj = xk[j];
+            for (i = j + 1; i < d; i++) xk[i] -= Lk[i + j * d] * xj;
+        }
+    }
+
+    for (j = 0; j < s->ndense; j++) x[j] *= s->Dinv[j];
+
+    for (k = N - 1; k >= 0; k--) {
+        d  = s->blk_d[k];
+        xk = x + s->blk_off[k];
+        Lk = s->L + s->L_off[k];
+
+        if (k + 1 < N) {
+            r  = s->blk_r[k+1];
+            f  = s->blk_f[k];
+            F  = s->L + s->L_off[N + k + 1];
+            x1 = x + s->blk_off[k+1];
+            for (j = 0; j < f; j++) {
+                xj = 0.0;
+                for (i = 0; i < r; i++) xj += F[i + j * r] * x1[i];
+                xk[d - f + j] -= xj;
+            }
+        }
+
+        for (j = d - 1; j >= 0; j--) {
+            xj = 0.0;
+            for (i = j + 1; i < d; i++) xj += Lk[i + j * d] * xk[i];
+            xk[j] -= xj;
+        }
+    }
+}
+
+/*
+ * solve the block tridiagonal system for x in the dense rows
+ *
+ * When the factorization replaced some pivots, the solution is refined against
+ * the stored blocks:
+ *   r = b - KKT x,  x = x + (LDL')^{-1} r
+ */
+static void stage_solve(stage_solver*    s,
+                        OSQPFloat*       x,
+                        const OSQPFloat* b) {
+
+    OSQPInt    i, j, k, l, d, r, f, iter;
+    OSQPInt    N = s->nstages;
+    OSQPFloat* res = s->work;
+    OSQPFloat  norm_b = 0.0;
+    OSQPFloat  norm_r, xj, rj;
+    OSQPFloat *Kb, *C, *xk, *rk;
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+    osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE,
+                            STAGE_SOLVE_BYTES(s->factor_nnz, s->ndense, s->loc_p[s->nloc]));
+
+    for (j = 0; j < s->ndense; j++) {
+        x[j]   = b[j];
+        norm_b = c_max(norm_b, c_absval(b[j]));
+    }
+
+    stage_LDLSolve(s, x);
+
+    for (iter = 0; s->nreg && iter < s->refine_iter; iter++) {
+        // r = b - KKT x, with only the lower triangular part of the blocks stored
+        for (j = 0; j < s->ndense; j++) res[j] = b[j];
+        for (k = 0; k < N; k++) {
+            d  = s->blk_d[k];
+            Kb = s->KKT + s->L_off[k];
+            xk = x + s->blk_off[k];
+            rk = res + s->blk_off[k];
+
+            for (j = 0; j < d; j++) {
+                xj = xk[j];
+                rj = Kb[j * (d + 1)] * xj;
+                for (i = j + 1; i < d; i++) {
+                    rk[i] -= Kb[i + j * d] * xj;
+                    rj    += Kb[i + j * d] * xk[i];
+                }
+                rk[j] -= rj;
+            }
+
+            if (k > 0) {
+                r = s->blk_r[k];
+                f = s->blk_f[k-1];
+                C = s->KKT + s->L_off[N + k];
+                for (l = 0; l < f; l++) {
+                    xj = xk[l - f];
+                    rj = 0.0;
+                    for (i = 0; i < r; i++) {
+                        rk[i] -= C[i + l * r] * xj;
+                        rj    += C[i + l * r] * xk[i];
+                    }
+                    rk[l - f] -= rj;
+                }
+            }
+        }
+
+        norm_r = 0.0;
+        for (j = 0; j < s->ndense; j++) norm_r = c_max(norm_r, c_absval(res[j]));
+        if (norm_r <= DENSE_REFINE_TOL * (1.0 + norm_b)) break;
+
+        stage_LDLSolve(s, res);
+        for (j = 0; j < s->ndense; j++) x[j] += res[j];
+    }
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+}
+
+
+// Initialize stagewise LDL' solver
+OSQPInt init_linsys_solver_stage(stage_solver**      sp,
+                                 const OSQPMatrix*   P,
+                                 const OSQPMatrix*   A,
+                                 const OSQPVectorf*  rho_vec,
+                                 const OSQPSettings* settings,
+                                 OSQPInt             polishing) {
+
+    OSQPInt        i, j, k, l, a, N, sa, sb;
+    OSQPInt        n      = P->csc->n;
+    OSQPInt        m      = A->csc->m;
+    OSQPInt        dim    = n + m;
+    OSQPInt        nnzP   = P->csc->p[n];
+    OSQPInt        nnzA   = A->csc->p[n];
+    const OSQPInt* stages = settings->kkt_stages;
+    OSQPInt*       kind   = OSQP_NULL;
+    OSQPInt*       next   = OSQP_NULL;
+    OSQPInt        err    = 0;
+
+    static const OSQPInt group_kind[4] = {3, 1, 7, 5};
+
+    // The polishing system has no stages, see use_linsys_solver_stage
+    OSQP_UnusedVar(polishing);
+
+    stage_solver* s = c_calloc(1, sizeof(stage_solver));
+    *sp = s;
+
+    if (!s) return OSQP_MEM_ALLOC_ERROR;
+
+    s->n = n;
+    s->m = m;
+
+    // Scalar parameters
+    s->sigma   = settings->sigma;
+    s->rho_inv = 1. / settings->rho;
+
+    // Dynamic regularization
+    s->dyn_reg       = settings->dyn_reg;
+    s->dyn_reg_eps   = settings->dyn_reg_eps;
+    s->dyn_reg_delta = settings->dyn_reg_delta;
+    s->refine_iter   = settings->dyn_reg_refine_iter;
+
+    // Link Functions
+    s->name            = &name_stage;
+    s->solve           = &solve_linsys_stage;
+    s->update_settings = &update_settings_linsys_solver_stage;
+    s->warm_start      = &warm_start_linsys_solver_stage;
+    s->free            = &free_linsys_solver_stage;
+    s->update_matrices = &update_linsys_solver_matrices_stage;
+    s->update_rho_vec  = &update_linsys_solver_rho_vec_stage;
+
+    // Assign type
+    s->type = OSQP_DIRECT_SOLVER;
+
+    // Set number of threads to 1 (single threaded)
+    s->nthreads = 1;
+
+    N = 0;
+    for (i = 0; i < dim; i++) {
+        if (stages[i] < 0 || stages[i] >= dim) {
+            c_eprint("kkt_stages entries must be between 0 and n+m-1");
+            err = 1;
+            break;
+        }
+        N = c_max(N, stages[i] + 1);
+    }
+    s->nstages = N;
+
+    /* Kind of each KKT row: 1 for the rows of the dense blocks, plus 2 for
+     * the rows coupled to the previous stage and 4 for the rows coupled to
+     * the next stage. The constraint rows involving a single stage stay 0 and
+     * are eliminated. */
+    kind = err ? OSQP_NULL : (OSQPInt *)c_calloc(dim, sizeof(OSQPInt));
+    if (kind) {
+        for (i = 0; i < n; i++) kind[i] = 1;
+
+        for (j = 0; j < n && !err; j++) {
+            for (a = P->csc->p[j]; a < P->csc->p[j+1]; a++) {
+                i  = P->csc->i[a];
+                sa = stages[i];
+                sb = stages[j];
+                if (sa != sb) {
+                    kind[sa > sb ? i : j] |= 2;
+                    kind[sa > sb ? j : i] |= 4;
+                }
+                err |= c_absval(sa - sb) > 1;
+            }
+            for (a = A->csc->p[j]; a < A->csc->p[j+1]; a++) {
+                i  = n + A->csc->i[a];
+                sa = stages[i];
+                sb = stages[j];
+                if (sa != sb) {
+                    kind[i] |= 1;
+                    kind[sa > sb ? i : j] |= 2;
+                    kind[sa > sb ? j : i] |= 4;
+                }
+                err |= c_absval(sa - sb) > 1;
+            }
+        }
+
+        if (err) {
+            c_eprint("P and A couple variables and constraints of stages that are not consecutive");
+        }
+    }
+
+    s->blk_d   = (OSQPInt *)c_calloc(N + 1, sizeof(OSQPInt));
+    s->blk_r   = (OSQPInt *)c_calloc(N + 1, sizeof(OSQPInt));
+    s->blk_f   = (OSQPInt *)c_calloc(N + 1, sizeof(OSQPInt));
+    s->blk_off = (OSQPInt *)c_calloc(N + 1, sizeof(OSQPInt));
+    s->L_off   = (OSQPInt *)c_calloc(2 * N + 1, sizeof(OSQPInt));
+    s->kkt_pos = (OSQPInt *)c_malloc(dim * sizeof(OSQPInt));
+    next       = (OSQPInt *)c_calloc(4 * N + m + 1, sizeof(OSQPInt));
+
+    if (!err && kind && s->blk_d && s->blk_r && s->blk_f && s->blk_off && s->L_off && s->kkt_pos && next) {
+        /* Every block holds the rows coupled only to the previous stage, the
+         * uncoupled rows, the rows coupled to both neighbours and the rows
+         * coupled only to the next stage, in this order (kinds 3, 1, 7, 5).
+         * next holds the number of rows of each group, stage by stage. */
+        for (i = 0; i < dim; i++) {
+            if (kind[i]) next[4 * stages[i] + (kind[i] >> 1)]++;
+            s->nloc += (kind[i] == 0);
+        }
+        for (k = 0; k < N; k++) {
+            s->blk_d[k] = next[4*k] + next[4*k+1] + next[4*k+2] + next[4*k+3];
+            s->blk_r[k] = next[4*k+1] + (next[4*k+3] ? next[4*k] + next[4*k+3] : 0);
+            s->blk_f[k] = next[4*k+2] + next[4*k+3];
+        }
+        for (k = 0; k < N; k++) {
+            s->blk_off[k+1] = s->blk_off[k] + s->blk_d[k];
+            s->L_off[k+1]   = s->L_off[k] + s->blk_d[k] * s->blk_d[k];
+            s->factor_nnz  += s->blk_d[k] * (s->blk_d[k] - 1) / 2;
+        }
+        // The coupling blocks follow the stage blocks, the first stage has none
+        s->L_off[N+1] = s->L_off[N];
+        for (k = 1; k < N; k++) {
+            s->L_off[N+k+1] = s->L_off[N+k] + s->blk_r[k] * s->blk_f[k-1];
+            s->factor_nnz  += s->blk_r[k] * s->blk_f[k-1];
+        }
+        s->ndense = s->blk_off[N];
+        s->nkkt   = s->L_off[2 * N];
+
+        s->kkt_row   = (OSQPInt *)c_malloc(s->ndense * sizeof(OSQPInt));
+        s->loc_row   = (OSQPInt *)c_malloc((s->nloc + 1) * sizeof(OSQPInt));
+        s->loc_stage = (OSQPInt *)c_malloc((s->nloc + 1) * sizeof(OSQPInt));
+        s->loc_p     = (OSQPInt *)c_calloc(s->nloc + 1, sizeof(OSQPInt));
+    }
+    else {
+        err = 1;
+    }
+
+    if (!err && s->kkt_row && s->loc_row && s->loc_stage && s->loc_p) {
+        // Row positions within the blocks, group by group
+        for (k = 0; k < N; k++) next[k] = 0;
+        for (a = 0; a < 4; a++) {
+            for (i = 0; i < dim; i++) {
+                if (kind[i] == group_kind[a]) {
+                    k = stages[i];
+                    s->kkt_pos[i] = s->blk_off[k] + next[k]++;
+                    s->kkt_row[s->kkt_pos[i]] = i;
+                }
+            }
+        }
+
+        // Eliminated constraints
+        l = 0;
+        for (i = n; i < dim; i++) {
+            if (kind[i] == 0) {
+                s->kkt_pos[i]   = -1 - l;
+                s->loc_row[l]   = i - n;
+                s->loc_stage[l] = stages[i];
+                l++;
+            }
+        }
+        for (a = 0; a < nnzA; a++) {
+            i = s->kkt_pos[n + A->csc->i[a]];
+            if (i < 0) s->loc_p[-i]++;
+        }
+        for (l = 0; l < s->nloc; l++) s->loc_p[l+1] += s->loc_p[l];
+
+        s->loc_i = (OSQPInt *)c_malloc((s->loc_p[s->nloc] + 1) * sizeof(OSQPInt));
+        s->loc_x = (OSQPFloat *)c_malloc((s->loc_p[s->nloc] + 1) * sizeof(OSQPFloat));
+        s->Pmap  = (OSQPInt *)c_malloc((nnzP + 1) * sizeof(OSQPInt));
+        s->Amap  = (OSQPInt *)c_malloc((nnzA + 1) * sizeof(OSQPInt));
+    }
+    else {
+        err = 1;
+    }
+
+    if (!err && s->loc_i && s->loc_x && s->Pmap && s->Amap) {
+        // Scatter maps
+        for (l = 0; l < s->nloc; l++) next[l] = s->loc_p[l];
+        for (j = 0; j < n; j++) {
+            for (a = P->csc->p[j]; a < P->csc->p[j+1]; a++) {
+                s->Pmap[a] = stage_offset(s, stages, P->csc->i[a], j);
+            }
+            for (a = A->csc->p[j]; a < A->csc->p[j+1]; a++) {
+                i = n + A->csc->i[a];
+                if (s->kkt_pos[i] >= 0) {
+                    s->Amap[a] = stage_offset(s, stages, i, j);
+                }
+                else {
+                    l = -1 - s->kkt_pos[i];
+                    s->loc_i[next[l]] = s->kkt_pos[j] - s->blk_off[stages[j]];
+                    s->Amap[a] = -1 - next[l]++;
+                }
+            }
+        }
+
+        s->Kp   = (OSQPFloat *)c_malloc(s->nkkt * sizeof(OSQPFloat));
+        s->KKT  = (OSQPFloat *)c_malloc(s->nkkt * sizeof(OSQPFloat));
+        s->L    = (OSQPFloat *)c_malloc(s->nkkt * sizeof(OSQPFloat));
+        s->D    = (OSQPFloat *)c_malloc(s->ndense * sizeof(OSQPFloat));
+        s->Dinv = (OSQPFloat *)c_malloc(s->ndense * sizeof(OSQPFloat));
+        s->sol  = (OSQPFloat *)c_malloc(s->ndense * sizeof(OSQPFloat));
+        s->bp   = (OSQPFloat *)c_malloc(s->ndense * sizeof(OSQPFloat));
+        s->work = (OSQPFloat *)c_malloc(s->ndense * sizeof(OSQPFloat));
+
+        if (rho_vec) {
+            s->rho_inv_vec = (OSQPFloat *)c_malloc((m + 1) * sizeof(OSQPFloat));
+            if (s->rho_inv_vec) {
+                for (i = 0; i < m; i++) s->rho_inv_vec[i] = 1. / rho_vec->values[i];
+            }
+        }
+
+        err = !s->Kp || !s->KKT || !s->L || !s->D || !s->Dinv || !s->sol ||
+              !s->bp || !s->work || (rho_vec && !s->rho_inv_vec);
+    }
+    else {
+        err = 1;
+    }
+
+    c_free(kind);
+    c_free(next);
+
+    if (err) {
+        c_eprint("Error setting up the stagewise KKT factorization");
+        free_linsys_solver_stage(s);
+        *sp = OSQP_NULL;
+        return OSQP_LINSYS_SOLVER_INIT_ERROR;
+    }
+
+    stage_KKT_form(s, P->csc, A->csc);
+
+    // Number of positive elements of D should be equal to n
+    if (stage_factor(s) != n) {
+        c_eprint("Error in stagewise KKT matrix LDL factorization. The problem seems to be non-convex");
+        free_linsys_solver_stage(s);
+        *sp = OSQP_NULL;
+        return OSQP_NONCVX_ERROR;
+    }
+
+    return 0;
+}
+
+
+OSQPInt solve_linsys_stage(stage_solver* s,
+                           OSQPVectorf*  b,
+                           OSQPInt       admm_iter) {
+
+    OSQPInt    j, l, a, r, off;
+    OSQPInt    n  = s->n;
+    OSQPFloat* bv = b->values;
+    OSQPFloat  rho_inv, xj;
+
+    // Direct solver doesn't care about the ADMM iteration
+    OSQP_UnusedVar(admm_iter);
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_SOLVE);
+
+    for (j = 0; j < n + s->m; j++) {
+        if (s->kkt_pos[j] >= 0) s->bp[s->kkt_pos[j]] = bv[j];
+    }
+
+    /* Eliminating the constraint a' x - y / rho = b adds rho b a to the
+     * right-hand side of the variables */
+    for (l = 0; l < s->nloc; l++) {
+        r       = s->loc_row[l];
+        off     = s->blk_off[s->loc_stage[l]];
+        rho_inv = s->rho_inv_vec ? s->rho_inv_vec[r] : s->rho_inv;
+        xj      = bv[n + r] / rho_inv;
+        for (a = s->loc_p[l]; a < s->loc_p[l+1]; a++) {
+            s->bp[off + s->loc_i[a]] += xj * s->loc_x[a];
+        }
+    }
+
+    stage_solve(s, s->sol, s->bp);
+
+    /* copy x_tilde from s->sol */
+    for (j = 0; j < n; j++) {
+        bv[j] = s->sol[s->kkt_pos[j]];
+    }
+
+    /* compute z_tilde from b and s->sol */
+    for (r = 0; r < s->m; r++) {
+        if (s->kkt_pos[n + r] >= 0) {
+            rho_inv    = s->rho_inv_vec ? s->rho_inv_vec[r] : s->rho_inv;
+            bv[n + r] += rho_inv * s->sol[s->kkt_pos[n + r]];
+        }
+    }
+
+    /* z_tilde = b + y / rho = a' x for the eliminated constraints */
+    for (l = 0; l < s->nloc; l++) {
+        off = s->blk_off[s->loc_stage[l]];
+        xj  = 0.0;
+        for (a = s->loc_p[l]; a < s->loc_p[l+1]; a++) {
+            xj += s->loc_x[a] * s->sol[off + s->loc_i[a]];
+        }
+        bv[n + s->loc_row[l]] = xj;
+    }
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_SOLVE);
+    return 0;
+}
+
+
+OSQPInt update_linsys_solver_matrices_stage(stage_solver*     s,
+                                            const OSQPMatrix* P,
+                                            const OSQPInt*    Px_new_idx,
+                                            OSQPInt           P_new_n,
+                                            const OSQPMatrix* A,
+                                            const OSQPInt*    Ax_new_idx,
+                                            OSQPInt           A_new_n) {
+
+    // Scattering all the entries again costs less than the factorization
+    OSQP_UnusedVar(Px_new_idx);
+    OSQP_UnusedVar(P_new_n);
+    OSQP_UnusedVar(Ax_new_idx);
+    OSQP_UnusedVar(A_new_n);
+
+    stage_KKT_form(s, P->csc, A->csc);
+
+    //number of positive elements in D should match the
+    //dimension of P if P + \sigma I is PD.   Error otherwise.
+    return (stage_factor(s) == s->n) ? 0 : 1;
+}
+
+
+OSQPInt update_linsys_solver_rho_vec_stage(stage_solver*      s,
+                                           const OSQPVectorf* rho_vec,
+                                           OSQPFloat          rho_sc) {
+
+    OSQPInt i;
+
+    // Update internal rho_inv_vec
+    if (s->rho_inv_vec) {
+        for (i = 0; i < s->m; i++) {
+            s->rho_inv_vec[i] = 1. / rho_vec->values[i];
+        }
+    }
+    else {
+        s->rho_inv = 1. / rho_sc;
+    }
+
+    // Update the blocks with new rho_vec
+    stage_KKT_rho(s);
+
+    return (stage_factor(s) < 0);
+}
@@ -0,0 +1,215 @@
+#ifndef STAGE_INTERFACE_H
+#define STAGE_INTERFACE_H
+
+
+#include "osqp.h"
+#include "types.h"  //OSQPMatrix and OSQPVector[fi] types
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Stagewise LDL' solver structure
+ *
+ * Every variable and constraint belongs to a stage given in
+ * OSQPSettings::kkt_stages. Constraints that only involve variables of their
+ * own stage are eliminated exactly. The remaining rows are grouped by stage
+ * into dense blocks, so the KKT matrix is block tridiagonal and is factored by
+ * a forward recursion over the stages, as a Riccati recursion would.
+ *
+ * Within a stage block, the rows coupled to the previous stage come first and
+ * the rows coupled to the next stage come last, so the coupling blocks of the
+ * factor only span the leading rows of one block and the trailing columns of
+ * the other.
+ */
+typedef struct stage stage_solver;
+
+struct stage {
+    enum osqp_linsys_solver_type type;
+
+    /**
+     * @name Functions
+     * @{
+     */
+    const char* (*name)(struct stage* s);
+
+    OSQPInt (*solve)(struct stage* self,
+                     OSQPVectorf*  b,
+                     OSQPInt       admm_iter);
+
+    void (*update_settings)(struct stage*       self,
+                            const OSQPSettings* settings);
+
+    void (*warm_start)(struct stage*      self,
+                       const OSQPVectorf* x);
+
+    OSQPInt (*adjoint_derivative)(struct stage* self);
+
+    void (*free)(struct stage* self);
+
+    OSQPInt (*update_matrices)(struct stage*     self,
+                               const OSQPMatrix* P,
+                               const OSQPInt*    Px_new_idx,
+                               OSQPInt           P_new_n,
+                               const OSQPMatrix* A,
+                               const OSQPInt*    Ax_new_idx,
+                               OSQPInt           A_new_n);   ///< Update solver matrices
+
+    OSQPInt (*update_rho_vec)(struct stage*      self,
+                              const OSQPVectorf* rho_vec,
+                              OSQPFloat          rho_sc);    ///< Update rho_vec parameter
+
+    OSQPInt nthreads;
+    OSQPInt factor_nnz;   ///< nonzeros in the strictly lower triangle of the factor
+
+    /** @} */
+
+    /**
+     * @name Attributes
+     * @{
+     */
+    OSQPInt    n;             ///< number of QP variables
+    OSQPInt    m;             ///< number of QP constraints
+    OSQPInt    nstages;       ///< number of stages
+    OSQPInt    ndense;        ///< number of rows in the dense blocks
+    OSQPInt    nloc;          ///< number of eliminated constraints
+
+    // Block structure
+    OSQPInt*   blk_d;         ///< dimension of the block of each stage
+    OSQPInt*   blk_r;         ///< leading rows of each block coupled to the previous stage
+    OSQPInt*   blk_f;         ///< trailing rows of each block coupled to the next stage
+    OSQPInt*   blk_off;       ///< offset of each block in the dense vectors
+    OSQPInt*   L_off;         ///< offset of each block, then of each coupling block, in KKT and L
+    OSQPInt*   kkt_pos;       ///< dense row of each KKT row, or -1 - (index of the eliminated constraint)
+    OSQPInt*   kkt_row;       ///< KKT row of each dense row
+
+    // Eliminated constraints (rows of A by stage)
+    OSQPInt*   loc_row;       ///< constraint index
+    OSQPInt*   loc_stage;     ///< stage
+    OSQPInt*   loc_p;         ///< row pointers
+    OSQPInt*   loc_i;         ///< rows of the entries in the block of the stage
+    OSQPFloat* loc_x;         ///< entries
+
+    // Scatter maps of the matrix entries
+    OSQPInt*   Pmap;          ///< index in KKT of each entry of P
+    OSQPInt*   Amap;          ///< index in KKT of each entry of A, or -1 - (index in loc_x)
+
+    // Blocks and factors (dense, column-major): stage blocks, then coupling blocks
+    OSQPInt    nkkt;          ///< number of stored entries
+    OSQPFloat* Kp;            ///< blocks without the rho terms
+    OSQPFloat* KKT;           ///< blocks of the KKT matrix with eliminated constraints
+    OSQPFloat* L;             ///< unit lower triangular factors and scaled coupling blocks
+    OSQPFloat* D;             ///< diagonal matrix of the factorization (as a vector)
+    OSQPFloat* Dinv;          ///< inverse of D
+    OSQPFloat* sol;           ///< solution in the dense rows
+    OSQPFloat* bp;            ///< right-hand side in the dense rows
+    OSQPFloat* work;          ///< factorization and refinement workspace
+    OSQPFloat* rho_inv_vec;   ///< parameter vector
+    OSQPFloat  sigma;         ///< scalar parameter
+    OSQPFloat  rho_inv;       ///< scalar parameter (used if rho_inv_vec == NULL)
+
+    // Dynamic regularization
+    OSQPInt    dyn_reg;       ///< replace tiny pivots by pivots of the expected sign
+    OSQPFloat  dyn_reg_eps;   ///< pivots with magnitude at most dyn_reg_eps are replaced
+    OSQPFloat  dyn_reg_delta; ///< magnitude of the replacement pivots
+    OSQPInt    refine_iter;   ///< iterative refinement steps when pivots were replaced
+    OSQPInt    nreg;          ///< number of pivots replaced in the last factorization
+
+    /** @} */
+};
+
+
+/**
+ * Decide whether the direct solver uses the stagewise factorization
+ *
+ * It does when kkt_system is OSQP_KKT_SYSTEM_STAGED, except for polishing,
+ * whose reduced constraints have no stages.
+ *
+ * @param  settings  Solver settings
+ * @param  polishing Flag whether we are initializing for polishing or not
+ * @return           1 if the stagewise factorization should be used, 0 otherwise
+ */
+OSQPInt use_linsys_solver_stage(const OSQPSettings* settings,
+                                OSQPInt             polishing);
+
+/**
+ * Initialize stagewise LDL' Solver
+ *
+ * @param  s         Pointer to a private structure
+ * @param  P         Objective function matrix (upper triangular form)
+ * @param  A         Constraints matrix
+ * @param  rho_vec   Algorithm parameter
+ * @param  settings  Solver settings
+ * @param  polishing Flag whether we are initializing for polishing or not (not supported)
+ * @return           Exitflag for error (0 if no errors)
+ */
+OSQPInt init_linsys_solver_stage(stage_solver**      sp,
+                                 const OSQPMatrix*   P,
+                                 const OSQPMatrix*   A,
+                                 const OSQPVectorf*  rho_vec,
+                                 const OSQPSettings* settings,
+                                 OSQPInt             polishing);
+
+/**
+ * Get the user-friendly name of the stagewise solver.
+ * @return The user-friendly name
+ */
+const char* name_stage(stage_solver* s);
+
+/**
+ * Solve linear system and store result in b
+ * @param  s        Linear system solver structure
+ * @param  b        Right-hand side
+ * @return          Exitflag
+ */
+OSQPInt solve_linsys_stage(stage_solver* s,
+                           OSQPVectorf*  b,
+                           OSQPInt       admm_iter);
+
+void update_settings_linsys_solver_stage(stage_solver*       s,
+                                         const OSQPSettings* settings);
+
+void warm_start_linsys_solver_stage(stage_solver*      s,
+                                    const OSQPVectorf* x);
+
+/**
+ * Update linear system solver matrices
+ * @param  s          Linear system solver structure
+ * @param  P          Matrix P
+ * @param  Px_new_idx elements of P to update,
+ * @param  P_new_n    number of elements to update
+ * @param  A          Matrix A
+ * @param  Ax_new_idx elements of A to update,
+ * @param  A_new_n    number of elements to update
+ * @return            Exitflag
+ */
+OSQPInt update_linsys_solver_matrices_stage(stage_solver*     s,
+                                            const OSQPMatrix* P,
+                                            const OSQPInt*    Px_new_idx,
+                                            OSQPInt           P_new_n,
+                                            const OSQPMatrix* A,
+                                            const OSQPInt*    Ax_new_idx,
+                                            OSQPInt           A_new_n);
+
+/**
+ * Update rho_vec parameter in linear system solver structure
+ * @param  s        Linear system solver structure
+ * @param  rho_vec  new rho_vec value
+ * @return          exitflag
+ */
+OSQPInt update_linsys_solver_rho_vec_stage(stage_solver*      s,
+                                           const OSQPVectorf* rho_vec,
+                                           OSQPFloat          rho_sc);
+
+/**
+ * Free linear system solver
+ * @param s linear system solver object
+ */
+void free_linsys_solver_stage(stage_solver* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STAGE_INTERFACE_H */
@@ -40,6 +40,8 @@ file(
 
 set( LIN_SYS_QDLDL_NON_EMBEDDED_SRC_FILES
      ${AMD_SRC_FILES}
+     ${OSQP_ALGEBRA_ROOT}/_common/lin_sys/qdldl/qdldl_ordering.h
+     ${OSQP_ALGEBRA_ROOT}/_common/lin_sys/qdldl/qdldl_ordering.c
      )
 
 set( LIN_SYS_QDLDL_EMBEDDED_SRC_FILES
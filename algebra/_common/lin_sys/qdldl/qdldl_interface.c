@@ -9,7 +9,11 @@
 #include "util.h"
 
 #ifndef OSQP_EMBEDDED_MODE
-#include "amd.h"
+#include "qdldl_ordering.h"
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
 #endif
 
 #if OSQP_EMBEDDED_MODE != 1
@@ -53,6 +57,20 @@ void free_linsys_solver_qdldl(qdldl_solver* s) {
         if (s->bp)          c_free(s->bp);
         if (s->sol)         c_free(s->sol);
         if (s->rho_inv_vec) c_free(s->rho_inv_vec);
+        if (s->refine_work) c_free(s->refine_work);
+
+        // Reduced system
+        if (s->At)      csc_spfree(s->At);
+        if (s->AtoAt)   c_free(s->AtoAt);
+        if (s->Rpat)    csc_spfree(s->Rpat);
+        if (s->RtoKKT)  c_free(s->RtoKKT);
+        if (s->rho_vec) c_free(s->rho_vec);
+
+        // Level scheduled solves
+        if (s->lvl_p)    c_free(s->lvl_p);
+        if (s->lvl_rows) c_free(s->lvl_rows);
+        if (s->Lt)       csc_spfree(s->Lt);
+        if (s->LtoLt)    c_free(s->LtoLt);
 
         // These are required for matrix updates
         if (s->KKT)       csc_spfree(s->KKT);
@@ -60,7 +78,7 @@ void free_linsys_solver_qdldl(qdldl_solver* s) {
         if (s->AtoKKT)    c_free(s->AtoKKT);
         if (s->rhotoKKT)  c_free(s->rhotoKKT);
 
-        if (s->adj)         c_free(s->adj);
+        if (s->adj)         csc_spfree(s->adj);
 
         // QDLDL workspace
         if (s->D)         c_free(s->D);
@@ -75,6 +93,240 @@ void free_linsys_solver_qdldl(qdldl_solver* s) {
 }
 
 
+/* Pivots that are neither marked nor reached by the elimination tree */
+#define DYN_REG_UNUSED  (0)
+#define DYN_REG_USED    (1)
+#define DYN_REG_UNKNOWN (-1)
+
+/*
+ * Numeric LDL factorization of the permuted KKT matrix with dynamic regularization
+ *
+ * Same as QDLDL_factor, except that pivots with magnitude at most dyn_reg_eps are
+ * replaced by dyn_reg_delta with the sign they have in a quasidefinite KKT matrix:
+ * positive for the rows of P + sigma I, negative for the rows of -diag(1/rho).
+ * Pivots of the wrong sign and larger magnitude are kept, so non-convex problems
+ * are still detected.
+ *
+ * Returns the number of positive pivots, and stores the number of replaced
+ * pivots in s->nreg.
+ */
+static OSQPInt LDL_factor_dynreg(const OSQPCscMatrix* A,
+                                 qdldl_solver*        s) {
+
+    OSQPInt      n = A->n;
+    OSQPInt      i, j, k, nnzY, bidx, cidx, nextIdx, nnzE, tmpIdx;
+    OSQPInt      positiveValuesInD = 0;
+    OSQPInt*     Lp = s->L->p;
+    OSQPInt*     Li = s->L->i;
+    OSQPFloat*   Lx = s->L->x;
+    OSQPInt*     yIdx            = s->iwork;
+    OSQPInt*     elimBuffer      = s->iwork + n;
+    OSQPInt*     LNextSpaceInCol = s->iwork + 2 * n;
+    OSQPFloat*   yVals           = s->fwork;
+    QDLDL_bool*  yMarkers        = s->bwork;
+    OSQPFloat    yVals_cidx;
+
+    s->nreg = 0;
+
+    Lp[0] = 0;
+    for (i = 0; i < n; i++) {
+        Lp[i+1]            = Lp[i] + s->Lnz[i];
+        yMarkers[i]        = DYN_REG_UNUSED;
+        yVals[i]           = 0.0;
+        s->D[i]            = 0.0;
+        LNextSpaceInCol[i] = Lp[i];
+    }
+
+    for (k = 0; k < n; k++) {
+        // Scatter column k of A and find the pattern of row k of L
+        nnzY = 0;
+        for (i = A->p[k]; i < A->p[k+1]; i++) {
+            bidx = A->i[i];
+            if (bidx == k) {
+                s->D[k] = A->x[i];
+                continue;
+            }
+            yVals[bidx] = A->x[i];
+
+            nextIdx = bidx;
+            if (yMarkers[nextIdx] == DYN_REG_UNUSED) {
+                yMarkers[nextIdx] = DYN_REG_USED;
+                elimBuffer[0]     = nextIdx;
+                nnzE              = 1;
+
+                nextIdx = s->etree[bidx];
+                while (nextIdx != DYN_REG_UNKNOWN && nextIdx < k) {
+                    if (yMarkers[nextIdx] == DYN_REG_USED) break;
+                    yMarkers[nextIdx]  = DYN_REG_USED;
+                    elimBuffer[nnzE++] = nextIdx;
+                    nextIdx            = s->etree[nextIdx];
+                }
+                while (nnzE) yIdx[nnzY++] = elimBuffer[--nnzE];
+            }
+        }
+
+        // Compute row k of L and the pivot
+        for (i = nnzY - 1; i >= 0; i--) {
+            cidx       = yIdx[i];
+            tmpIdx     = LNextSpaceInCol[cidx];
+            yVals_cidx = yVals[cidx];
+            for (j = Lp[cidx]; j < tmpIdx; j++) {
+                yVals[Li[j]] -= Lx[j] * yVals_cidx;
+            }
+            Li[tmpIdx] = k;
+            Lx[tmpIdx] = yVals_cidx * s->Dinv[cidx];
+            s->D[k]   -= yVals_cidx * Lx[tmpIdx];
+            LNextSpaceInCol[cidx]++;
+
+            yVals[cidx]    = 0.0;
+            yMarkers[cidx] = DYN_REG_UNUSED;
+        }
+
+        if (c_absval(s->D[k]) <= s->dyn_reg_eps) {
+            s->D[k] = s->P[k] < s->n ? s->dyn_reg_delta : -s->dyn_reg_delta;
+            s->nreg++;
+        }
+        if (s->D[k] > 0.0) positiveValuesInD++;
+        s->Dinv[k] = 1.0 / s->D[k];
+    }
+
+    return positiveValuesInD;
+}
+
+#endif  // OSQP_EMBEDDED_MODE
+
+#if OSQP_EMBEDDED_MODE != 1
+
+#if !defined(OSQP_EMBEDDED_MODE) && defined(_OPENMP)
+
+/* Minimum average number of entries of L per level for the level scheduled
+ * solves, which synchronize the threads once per level */
+#define LDL_LEVEL_MIN_NNZ (500)
+
+/* Copy the values of L into its transpose after a factorization */
+static void LDL_levels_update(qdldl_solver* s) {
+    OSQPInt k;
+
+    for (k = 0; k < s->L->p[s->L->n]; k++) {
+        s->Lt->x[s->LtoLt[k]] = s->L->x[k];
+    }
+}
+
+/*
+ * Set up the level scheduled triangular solves
+ *
+ * Every row of L only involves its descendants in the elimination tree, so the
+ * rows with the same height in the tree are independent in the forward solve,
+ * and, in the reverse order of the heights, in the backward solve. The forward
+ * solve gathers each row from the transpose of L, so that no two threads write
+ * to the same entry.
+ *
+ * Nothing is set up with a single OpenMP thread, or when the levels are too
+ * many for the synchronization to pay off. Returns 1 on allocation failure.
+ */
+static OSQPInt LDL_levels_init(qdldl_solver* s) {
+
+    OSQPInt  i, j, k, nlevels;
+    OSQPInt  n   = s->L->n;
+    OSQPInt  Lnz = s->L->p[n];
+    OSQPInt* height;
+    OSQPInt* next;
+
+    if (omp_get_max_threads() <= 1) return 0;
+
+    // Height of every node in the elimination tree, whose parents come later
+    height = (OSQPInt *)c_calloc(n + 1, sizeof(OSQPInt));
+    if (!height) return 1;
+
+    nlevels = 0;
+    for (j = 0; j < n; j++) {
+        if (s->etree[j] >= 0) height[s->etree[j]] = c_max(height[s->etree[j]], height[j] + 1);
+        nlevels = c_max(nlevels, height[j] + 1);
+    }
+
+    if ((OSQPFloat)nlevels * LDL_LEVEL_MIN_NNZ > Lnz) {
+        c_free(height);
+        return 0;
+    }
+
+    s->nlevels  = nlevels;
+    s->lvl_p    = (OSQPInt *)c_calloc(nlevels + 1, sizeof(OSQPInt));
+    s->lvl_rows = (OSQPInt *)c_malloc((n + 1) * sizeof(OSQPInt));
+    s->Lt       = csc_spalloc(n, n, Lnz, 1, 0);
+    s->LtoLt    = (OSQPInt *)c_malloc((Lnz + 1) * sizeof(OSQPInt));
+    next        = (OSQPInt *)c_calloc(n + 1, sizeof(OSQPInt));
+
+    if (!s->lvl_p || !s->lvl_rows || !s->Lt || !s->LtoLt || !next) {
+        c_free(height);
+        c_free(next);
+        return 1;
+    }
+
+    // Rows by level
+    for (j = 0; j < n; j++) s->lvl_p[height[j] + 1]++;
+    for (k = 0; k < nlevels; k++) s->lvl_p[k + 1] += s->lvl_p[k];
+    for (k = 0; k < nlevels; k++) next[k] = s->lvl_p[k];
+    for (j = 0; j < n; j++) s->lvl_rows[next[height[j]]++] = j;
+
+    // Transpose of L
+    for (j = 0; j <= n; j++) next[j] = 0;
+    for (k = 0; k < Lnz; k++) next[s->L->i[k] + 1]++;
+    for (i = 0; i < n; i++) next[i + 1] += next[i];
+    for (i = 0; i <= n; i++) s->Lt->p[i] = next[i];
+    for (j = 0; j < n; j++) {
+        for (k = s->L->p[j]; k < s->L->p[j + 1]; k++) {
+            i = s->L->i[k];
+            s->Lt->i[next[i]] = j;
+            s->LtoLt[k]       = next[i]++;
+        }
+    }
+
+    c_free(height);
+    c_free(next);
+
+    LDL_levels_update(s);
+    return 0;
+}
+
+#endif
+
+/* Numeric LDL factorization of the permuted KKT matrix A, returning the number
+ * of positive pivots or a negative value on failure */
+static OSQPInt LDL_numeric_factor(const OSQPCscMatrix* A,
+                                  qdldl_solver*        s) {
+    OSQPInt factor_status;
+
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+#ifndef OSQP_EMBEDDED_MODE
+    if (s->dyn_reg) {
+        factor_status = LDL_factor_dynreg(A, s);
+
+        // The solves of the ADMM iterations are refined against the stored KKT matrix
+        if (s->nreg && !s->polishing && !s->refine_work) {
+            s->refine_work = (OSQPFloat *)c_malloc(2 * A->n * sizeof(OSQPFloat));
+            if (!s->refine_work) factor_status = -1;
+        }
+    }
+    else
+#endif
+    {
+        factor_status = QDLDL_factor(A->n, A->p, A->i, A->x,
+                                     s->L->p, s->L->i, s->L->x,
+                                     s->D, s->Dinv, s->Lnz,
+                                     s->etree, s->bwork, s->iwork, s->fwork);
+    }
+#if !defined(OSQP_EMBEDDED_MODE) && defined(_OPENMP)
+    if (s->lvl_p && factor_status >= 0) LDL_levels_update(s);
+#endif
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+
+    return factor_status;
+}
+
+#endif
+
+#ifndef OSQP_EMBEDDED_MODE
+
 /**
  * Compute LDL factorization of matrix A
  * @param  A    Matrix to be factorized
@@ -110,14 +362,10 @@ static OSQPInt LDL_factor(OSQPCscMatrix* A,
     p->L->i = (OSQPInt *)c_malloc(sizeof(OSQPInt)*sum_Lnz);
     p->L->x = (OSQPFloat *)c_malloc(sizeof(OSQPFloat)*sum_Lnz);
     p->L->nzmax = sum_Lnz;
+    p->factor_nnz = sum_Lnz;
 
     // Factor matrix
-    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
-    factor_status = QDLDL_factor(A->n, A->p, A->i, A->x,
-                                 p->L->p, p->L->i, p->L->x,
-                                 p->D, p->Dinv, p->Lnz,
-                                 p->etree, p->bwork, p->iwork, p->fwork);
-    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+    factor_status = LDL_numeric_factor(A, p);
 
     if (factor_status < 0){
       // Error
@@ -129,86 +377,241 @@ static OSQPInt LDL_factor(OSQPCscMatrix* A,
       return -2;
     }
 
+#ifdef _OPENMP
+    // The pattern of L is known after the first factorization
+    if (LDL_levels_init(p)) {
+      c_eprint("Error in KKT matrix LDL factorization when setting up the solve levels (out of memory)");
+      return -1;
+    }
+#endif
+
     return 0;
 
 }
 
 
+/* Permute an assembled KKT matrix by the default ordering (AMD) */
 static OSQPInt permute_KKT(OSQPCscMatrix** KKT,
-                           qdldl_solver*   p,
-                           OSQPInt         Pnz,
-                           OSQPInt         Anz,
-                           OSQPInt         m,
-                           OSQPInt*        PtoKKT,
-                           OSQPInt*        AtoKKT,
-                           OSQPInt*        rhotoKKT) {
-    OSQPFloat* info;
-    OSQPInt    amd_status;
+                           qdldl_solver*   p) {
+    OSQPInt    order_status;
     OSQPInt*   Pinv;
-    OSQPInt*   KtoPKPt;
-    OSQPInt    i; // Indexing
 
     OSQPCscMatrix* KKT_temp;
 
-    info = (OSQPFloat *)c_malloc(AMD_INFO * sizeof(OSQPFloat));
-
-    // Compute permutation matrix P using AMD
-#ifdef OSQP_USE_LONG
-    amd_status = amd_l_order((*KKT)->n, (*KKT)->p, (*KKT)->i, p->P, (OSQPFloat *)OSQP_NULL, info);
-#else
-    amd_status = amd_order((*KKT)->n, (*KKT)->p, (*KKT)->i, p->P, (OSQPFloat *)OSQP_NULL, info);
-#endif
-    if (amd_status < 0) {
-        // Free Amd info and return an error
-        c_free(info);
-        return amd_status;
+    // Compute the fill-reducing permutation P
+    order_status = kkt_ordering(p->P, *KKT, OSQP_NULL, 0);
+    if (order_status < 0) {
+        return order_status;
     }
 
-
     // Inverse of the permutation vector
     Pinv = csc_pinv(p->P, (*KKT)->n);
 
     // Permute KKT matrix
-    if (!PtoKKT && !AtoKKT && !rhotoKKT){  // No vectors to be stored
-        // Assign values of mapping
-        KKT_temp = csc_symperm((*KKT), Pinv, OSQP_NULL, 1);
-    }
-    else {
-        // Allocate vector of mappings from unpermuted to permuted
-        KtoPKPt = c_malloc((*KKT)->p[(*KKT)->n] * sizeof(OSQPInt));
-        KKT_temp = csc_symperm((*KKT), Pinv, KtoPKPt, 1);
-
-        // Update vectors PtoKKT, AtoKKT and rhotoKKT
-        if (PtoKKT){
-            for (i = 0; i < Pnz; i++){
-                PtoKKT[i] = KtoPKPt[PtoKKT[i]];
-            }
-        }
-        if (AtoKKT){
-            for (i = 0; i < Anz; i++){
-                AtoKKT[i] = KtoPKPt[AtoKKT[i]];
-            }
-        }
-        if (rhotoKKT){
-            for (i = 0; i < m; i++){
-                rhotoKKT[i] = KtoPKPt[rhotoKKT[i]];
-            }
-        }
-
-        // Cleanup vector of mapping
-        c_free(KtoPKPt);
-    }
+    KKT_temp = Pinv ? csc_symperm((*KKT), Pinv, OSQP_NULL, 1) : OSQP_NULL;
+    c_free(Pinv);
+    if (!KKT_temp) return -1;
 
-    // Cleanup
     // Free previous KKT matrix and assign pointer to new one
     csc_spfree((*KKT));
     (*KKT) = KKT_temp;
-    // Free Pinv
+
+    return 0;
+}
+
+/*
+ * Order the KKT matrix from its sparsity pattern and assemble it directly in
+ * permuted form, so the unpermuted matrix with its values is never built.
+ * If ordered is set, p->P already holds the ordering.
+ */
+static OSQPCscMatrix* form_permuted_KKT(qdldl_solver*       p,
+                                        const OSQPSettings* settings,
+                                        OSQPInt             allow_user,
+                                        OSQPInt             ordered,
+                                        OSQPCscMatrix*      P,
+                                        OSQPCscMatrix*      A,
+                                        OSQPFloat           param1,
+                                        OSQPFloat*          param2,
+                                        OSQPFloat           param2_sc,
+                                        OSQPInt*            PtoKKT,
+                                        OSQPInt*            AtoKKT,
+                                        OSQPInt*            rhotoKKT) {
+    OSQPInt        order_status;
+    OSQPInt*       Pinv;
+    OSQPCscMatrix* KKT;
+
+    // Compute the fill-reducing permutation P from the pattern of the KKT matrix
+    if (!ordered) {
+        KKT = form_KKT_pattern(P, A);
+        if (!KKT) return OSQP_NULL;
+
+        order_status = kkt_ordering(p->P, KKT, settings, allow_user);
+        csc_spfree(KKT);
+        if (order_status < 0) return OSQP_NULL;
+    }
+
+    // Inverse of the permutation vector
+    Pinv = csc_pinv(p->P, P->n + A->m);
+    if (!Pinv) return OSQP_NULL;
+
+    KKT = form_KKT_perm(P, A, param1, param2, param2_sc, Pinv, PtoKKT, AtoKKT, rhotoKKT);
     c_free(Pinv);
-    // Free Amd info
-    c_free(info);
 
+    return KKT;
+}
+
+
+/*
+ * Form the reduced system P + sigma I + A' diag(rho) A of the ADMM iterations
+ * in permuted form. The ordering is computed from its pattern unless ordered
+ * is set, in which case p->P already holds it.
+ */
+static OSQPCscMatrix* form_permuted_reduced_KKT(qdldl_solver*       p,
+                                                const OSQPSettings* settings,
+                                                OSQPInt             ordered) {
+    OSQPInt        n    = p->n;
+    OSQPInt        nnzA = p->Ared->p[n];
+    OSQPInt*       Pinv;
+    OSQPCscMatrix* KKT;
+
+    // Rows of A, and the pattern of the reduced matrix (unless already formed)
+    if (!p->At) {
+        p->AtoAt = (OSQPInt *)c_malloc(nnzA * sizeof(OSQPInt));
+        if (nnzA && !p->AtoAt) return OSQP_NULL;
+
+        p->At = csc_transpose(p->Ared, p->AtoAt);
+        if (!p->At) return OSQP_NULL;
+    }
+    if (!p->Rpat) {
+        p->Rpat = form_reduced_KKT_pattern(p->Pred, p->Ared, p->At);
+        if (!p->Rpat) return OSQP_NULL;
+    }
+
+    if (!ordered && kkt_ordering(p->P, p->Rpat, settings, 0) < 0) return OSQP_NULL;
+
+    Pinv      = csc_pinv(p->P, n);
+    p->RtoKKT = (OSQPInt *)c_malloc(p->Rpat->p[n] * sizeof(OSQPInt));
+    KKT       = (Pinv && p->RtoKKT) ? csc_symperm(p->Rpat, Pinv, p->RtoKKT, 0) : OSQP_NULL;
+    c_free(Pinv);
+    if (!KKT) return OSQP_NULL;
+
+    KKT->x = (OSQPFloat *)c_malloc(KKT->nzmax * sizeof(OSQPFloat));
+    if (!KKT->x) {
+        csc_spfree(KKT);
+        return OSQP_NULL;
+    }
+
+    update_reduced_KKT(KKT, p->RtoKKT, p->Rpat, p->Pred, p->Ared, p->At,
+                       p->sigma, p->rho_vec, p->rho, p->fwork);
+
+    return KKT;
+}
+
+
+/* Solves weighed against every factorization when comparing the systems
+ * (rho, and with it the matrix, changes at most every few dozen iterations) */
+#define KKT_SYSTEM_SOLVES (25)
+
+/*
+ * Choose between the KKT matrix and the reduced system for the ADMM iterations
+ *
+ * OSQP_KKT_SYSTEM_AUTO orders both systems and predicts the cost of a
+ * factorization and KKT_SYSTEM_SOLVES solves with each. The reduced system
+ * also pays for forming A' diag(rho) A and for two products with A per solve,
+ * and is not considered when forming it alone costs more than the KKT matrix
+ * (e.g. with dense rows in A). The ordering of the selected system is kept in
+ * p->P, and the function returns whether it was computed.
+ */
+static OSQPInt select_kkt_system(qdldl_solver*       p,
+                                 const OSQPSettings* settings) {
+#ifdef OSQP_USE_FLOAT
+    // The reduced system squares the conditioning of A, too much for single
+    // precision, so it is only used when requested
+    p->reduced = settings->kkt_system == OSQP_KKT_SYSTEM_REDUCED;
     return 0;
+#else
+    OSQPInt        n    = p->n;
+    OSQPInt        m    = p->m;
+    OSQPInt        nnzA = p->Ared->p[n];
+    OSQPInt        i, r, LnzK, LnzR = -1;
+    OSQPInt*       permR = OSQP_NULL;
+    OSQPFloat      flopsK, flopsR, costK, costR, form = 0.0;
+    OSQPCscMatrix* K;
+
+    p->reduced = settings->kkt_system == OSQP_KKT_SYSTEM_REDUCED;
+
+    // The user permutation orders the KKT matrix, so it keeps the KKT matrix
+    if (settings->kkt_system != OSQP_KKT_SYSTEM_AUTO ||
+        settings->kkt_ordering == OSQP_ORDERING_USER ||
+        n + m < OSQP_AUTO_KKT_SYSTEM_DIM)
+        return 0;
+
+    // KKT matrix
+    p->P = (OSQPInt *)c_malloc((n + m) * sizeof(OSQPInt));
+    K    = p->P ? form_KKT_pattern(p->Pred, p->Ared) : OSQP_NULL;
+    if (!K || kkt_ordering(p->P, K, settings, 1) < 0 ||
+        kkt_ordering_fill(p->P, K, &LnzK, &flopsK) < 0) {
+        csc_spfree(K);
+        return -1;
+    }
+    csc_spfree(K);
+    costK = flopsK + KKT_SYSTEM_SOLVES * 4.0 * LnzK;
+
+    // Forming A' diag(rho) A takes a multiply-add per pair of entries in a row of A
+    p->AtoAt = (OSQPInt *)c_malloc(nnzA * sizeof(OSQPInt));
+    p->At    = (p->AtoAt || !nnzA) ? csc_transpose(p->Ared, p->AtoAt) : OSQP_NULL;
+    if (!p->At) return -1;
+
+    for (i = 0; i < m; i++) {
+        r     = p->At->p[i+1] - p->At->p[i];
+        form += 0.5 * r * (r + 1);
+    }
+    costR = form;
+
+    // Reduced system
+    if (form < costK) {
+        p->Rpat = form_reduced_KKT_pattern(p->Pred, p->Ared, p->At);
+        permR   = (OSQPInt *)c_malloc(n * sizeof(OSQPInt));
+        if (!p->Rpat || !permR || kkt_ordering(permR, p->Rpat, settings, 0) < 0 ||
+            kkt_ordering_fill(permR, p->Rpat, &LnzR, &flopsR) < 0) {
+            c_free(permR);
+            return -1;
+        }
+        costR += flopsR + KKT_SYSTEM_SOLVES * 4.0 * (LnzR + nnzA);
+    }
+
+    p->reduced = LnzR >= 0 && costR < costK;
+
+#ifdef OSQP_ENABLE_PRINTING
+    if (settings->verbose) {
+        c_print("kkt system (n = %i, m = %i):\n", (int)n, (int)m);
+        c_print("  full     nnz(L) = %i, cost = %.2e flops%s\n",
+                (int)LnzK, costK, p->reduced ? "" : " (selected)");
+        if (LnzR >= 0)
+            c_print("  reduced  nnz(L) = %i, cost = %.2e flops%s\n",
+                    (int)LnzR, costR, p->reduced ? " (selected)" : "");
+        else
+            c_print("  reduced  not formed, A'A alone costs %.2e flops\n", form);
+    }
+#endif
+
+    // Keep the ordering of the selected system, and what it is formed from
+    if (p->reduced) {
+        c_free(p->P);
+        p->P = permR;
+    }
+    else {
+        c_free(permR);
+        csc_spfree(p->At);
+        csc_spfree(p->Rpat);
+        c_free(p->AtoAt);
+        p->At    = OSQP_NULL;
+        p->Rpat  = OSQP_NULL;
+        p->AtoAt = OSQP_NULL;
+    }
+
+    return 1;
+#endif /* OSQP_USE_FLOAT */
 }
 
 
@@ -224,7 +627,8 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
     OSQPCscMatrix* KKT_temp; // Temporary KKT pointer
     OSQPInt    i;         // Loop counter
     OSQPInt    m, n;      // Dimensions of A
-    OSQPInt    n_plus_m;  // Define n_plus_m dimension
+    OSQPInt    n_plus_m;  // Dimension of the factored matrix
+    OSQPInt    ordered = 0;
     OSQPFloat* rhov;      // used for direct access to rho_vec data when polishing=false
     OSQPFloat  sigma = settings->sigma;
 
@@ -246,6 +650,12 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
     // Polishing flag
     s->polishing = polishing;
 
+    // Dynamic regularization
+    s->dyn_reg       = settings->dyn_reg;
+    s->dyn_reg_eps   = settings->dyn_reg_eps;
+    s->dyn_reg_delta = settings->dyn_reg_delta;
+    s->refine_iter   = settings->dyn_reg_refine_iter;
+
     // Link Functions
     s->name            = &name_qdldl;
     s->solve           = &solve_linsys_qdldl;
@@ -269,6 +679,21 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
     // Set number of threads to 1 (single threaded)
     s->nthreads = 1;
 
+    // The ADMM iterations can factor the reduced system instead of the KKT matrix
+    if (!polishing) {
+        s->Pred = P->csc;
+        s->Ared = A->csc;
+
+        ordered = select_kkt_system(s, settings);
+        if (ordered < 0) {
+            c_eprint("Error selecting the linear system");
+            free_linsys_solver_qdldl(s);
+            *sp = OSQP_NULL;
+            return OSQP_LINSYS_SOLVER_INIT_ERROR;
+        }
+        if (s->reduced) n_plus_m = n;
+    }
+
     // Sparse matrix L (lower triangular)
     // NB: We don not allocate L completely (CSC elements)
     //      L will be allocated during the factorization depending on the
@@ -283,8 +708,9 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
     s->Dinv = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * n_plus_m);
     s->D    = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * n_plus_m);
 
-    // Permutation vector P
-    s->P    = (QDLDL_int *)c_malloc(sizeof(QDLDL_int) * n_plus_m);
+    // Permutation vector P (unless computed when selecting the system)
+    if (!s->P)
+      s->P  = (QDLDL_int *)c_malloc(sizeof(QDLDL_int) * n_plus_m);
 
     // Working vector
     s->bp   = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * n_plus_m);
@@ -293,7 +719,9 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
     s->sol  = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * n_plus_m);
 
     // Parameter vector
-    if (rho_vec)
+    if (rho_vec && s->reduced)
+      s->rho_vec = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * m);
+    else if (rho_vec)
       s->rho_inv_vec = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * m);
     // else it is NULL
 
@@ -314,14 +742,22 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
     // Form and permute KKT matrix
     if (polishing){ // Called from polish()
 
-        KKT_temp = form_KKT(P->csc,A->csc,
-                            0, //format = 0 means CSC
-                            sigma, s->rho_inv_vec, sigma,
-                            OSQP_NULL, OSQP_NULL, OSQP_NULL);
+        // The user permutation is only defined for the ADMM KKT
+        KKT_temp = form_permuted_KKT(s, settings, 0, 0, P->csc, A->csc,
+                                     sigma, s->rho_inv_vec, sigma,
+                                     OSQP_NULL, OSQP_NULL, OSQP_NULL);
+    }
+    else if (s->reduced) { // Called from ADMM algorithm, reduced system
+        if (rho_vec) {
+          for (i = 0; i < m; i++) {
+              s->rho_vec[i] = rho_vec->values[i];
+          }
+        }
+        else {
+          s->rho = settings->rho;
+        }
 
-        // Permute matrix
-        if (KKT_temp)
-            permute_KKT(&KKT_temp, s, OSQP_NULL, OSQP_NULL, OSQP_NULL, OSQP_NULL, OSQP_NULL, OSQP_NULL);
+        KKT_temp = form_permuted_reduced_KKT(s, settings, ordered);
     }
     else { // Called from ADMM algorithm
 
@@ -341,15 +777,9 @@ OSQPInt init_linsys_solver_qdldl(qdldl_solver**      sp,
           s->rho_inv = 1. / settings->rho;
         }
 
-        KKT_temp = form_KKT(P->csc,A->csc,
-                            0, //format = 0 means CSC format
-                            sigma, s->rho_inv_vec, s->rho_inv,
-                            s->PtoKKT, s->AtoKKT,s->rhotoKKT);
-
-        // Permute matrix
-        if (KKT_temp){
-            permute_KKT(&KKT_temp, s, P->csc->p[n], A->csc->p[n], m, s->PtoKKT, s->AtoKKT, s->rhotoKKT);
-        }
+        KKT_temp = form_permuted_KKT(s, settings, 1, ordered, P->csc, A->csc,
+                                     sigma, s->rho_inv_vec, s->rho_inv,
+                                     s->PtoKKT, s->AtoKKT, s->rhotoKKT);
     }
 
     // Check if matrix has been created
@@ -390,23 +820,164 @@ const char* name_qdldl(qdldl_solver* s) {
 }
 
 
+/* Estimated bytes read and written by a solve with the LDL factors: the values
+ * and row indices of L are streamed by both triangular solves, while every
+ * right-hand side entry is touched by the permutations, the diagonal scaling
+ * and the two solves */
+#define LDL_SOLVE_BYTES(n, Lnz, nrhs) \
+  (2.0 * (Lnz) * (sizeof(OSQPFloat) + sizeof(OSQPInt)) + \
+   (OSQPFloat)(n) * ((nrhs) * 11.0 * sizeof(OSQPFloat) + 4.0 * sizeof(OSQPInt)))
+
+/* Same for the solve of the ADMM iterations, which touches every right-hand
+ * side entry once by the gather, twice by each triangular solve and once or
+ * twice by the store */
+#define LDL_SOLVE_KKT_BYTES(n, Lnz) \
+  (2.0 * (Lnz) * (sizeof(OSQPFloat) + sizeof(OSQPInt)) + \
+   (OSQPFloat)(n) * (7.0 * sizeof(OSQPFloat) + 2.0 * sizeof(OSQPInt)))
+
+#ifndef OSQP_ENABLE_LDL_UNROLL
+
+#if !defined(OSQP_EMBEDDED_MODE) && defined(_OPENMP)
+/* solve LDL' x = b in place with the rows of every level split among the threads */
+static void LDLSolve_levels(const qdldl_solver* s,
+                            OSQPFloat*          x) {
+
+  OSQPInt          i, k, l, t;
+  OSQPInt          nlevels = s->nlevels;
+  const OSQPInt*   lvl_p   = s->lvl_p;
+  const OSQPInt*   rows    = s->lvl_rows;
+  const OSQPInt*   Lp      = s->L->p;
+  const OSQPInt*   Li      = s->L->i;
+  const OSQPFloat* Lx      = s->L->x;
+  const OSQPInt*   Ltp     = s->Lt->p;
+  const OSQPInt*   Lti     = s->Lt->i;
+  const OSQPFloat* Ltx     = s->Lt->x;
+  const OSQPFloat* Dinv    = s->Dinv;
+  OSQPFloat        xi;
+
+#pragma omp parallel private(i, k, l, t, xi)
+  {
+    // x = L \ x, from the leaves of the elimination tree
+    for (l = 0; l < nlevels; l++) {
+#pragma omp for schedule(static)
+      for (t = lvl_p[l]; t < lvl_p[l+1]; t++) {
+        i  = rows[t];
+        xi = x[i];
+        for (k = Ltp[i]; k < Ltp[i+1]; k++) xi -= Ltx[k] * x[Lti[k]];
+        x[i] = xi;
+      }
+    }
+
+    // x = L' \ (D \ x), from the roots of the elimination tree
+    for (l = nlevels - 1; l >= 0; l--) {
+#pragma omp for schedule(static)
+      for (t = lvl_p[l]; t < lvl_p[l+1]; t++) {
+        i  = rows[t];
+        xi = x[i] * Dinv[i];
+        for (k = Lp[i]; k < Lp[i+1]; k++) xi -= Lx[k] * x[Li[k]];
+        x[i] = xi;
+      }
+    }
+  }
+}
+#endif
+
+/* Store entry q of the solution of the KKT system in b, as x_tilde for the
+ * variable rows and as z_tilde = b + nu / rho for the constraint rows */
+static void LDL_store_kkt(OSQPFloat*          b,
+                          const qdldl_solver* s,
+                          OSQPInt             q,
+                          OSQPFloat           xq) {
+  if (q < s->n)
+    b[q] = xq;
+  else
+    b[q] += (s->rho_inv_vec ? s->rho_inv_vec[q - s->n] : s->rho_inv) * xq;
+}
+
+/*
+ * solve the KKT system of the ADMM iterations and store x_tilde and z_tilde in b
+ *
+ * b is gathered in the permuted ordering once. The diagonal scaling is folded
+ * into the backward solve, which stores every entry of the solution in b as
+ * soon as it is final, so the solution needs no further pass.
+ */
+static void LDLSolve_kkt(OSQPFloat*          b,
+                         const qdldl_solver* s) {
+
+  OSQPInt          j, k;
+  OSQPInt          n    = s->L->n;
+  const OSQPInt*   Lp   = s->L->p;
+  const OSQPInt*   Li   = s->L->i;
+  const OSQPFloat* Lx   = s->L->x;
+  const OSQPFloat* Dinv = s->Dinv;
+  const OSQPInt*   P    = s->P;
+  OSQPFloat*       x    = s->bp;
+  OSQPFloat        xj;
+
+  osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE, LDL_SOLVE_KKT_BYTES(n, Lp[n]));
+
+  for (j = 0; j < n; j++) x[j] = b[P[j]];
+
+#if !defined(OSQP_EMBEDDED_MODE) && defined(_OPENMP)
+  if (s->lvl_p) {
+    LDLSolve_levels(s, x);
+    for (j = 0; j < n; j++) LDL_store_kkt(b, s, P[j], x[j]);
+  }
+  else
+#endif
+  {
+    // x = L \ x
+    for (j = 0; j < n; j++) {
+      xj = x[j];
+      for (k = Lp[j]; k < Lp[j+1]; k++) x[Li[k]] -= Lx[k] * xj;
+    }
+
+    // x = L' \ (D \ x)
+    for (j = n - 1; j >= 0; j--) {
+      xj = x[j] * Dinv[j];
+      for (k = Lp[j]; k < Lp[j+1]; k++) xj -= Lx[k] * x[Li[k]];
+      x[j] = xj;
+      LDL_store_kkt(b, s, P[j], xj);
+    }
+  }
+
+  osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+}
+
+#ifndef OSQP_EMBEDDED_MODE
+
+/* solve LDL' x = b in place */
+static void LDLSolve_inplace(const qdldl_solver* s,
+                             OSQPFloat*          x) {
+
+#if !defined(OSQP_EMBEDDED_MODE) && defined(_OPENMP)
+  if (s->lvl_p) {
+    LDLSolve_levels(s, x);
+    return;
+  }
+#endif
+
+  QDLDL_solve(s->L->n, s->L->p, s->L->i, s->L->x, s->Dinv, x);
+}
+
 /* solve P'LDL'P x = b for x */
-static void LDLSolve(OSQPFloat*           x,
-                     const OSQPFloat*     b,
-                     const OSQPCscMatrix* L,
-                     const OSQPFloat*     Dinv,
-                     const OSQPInt*       P,
-                     OSQPFloat*           bp) {
+static void LDLSolve(OSQPFloat*          x,
+                     const OSQPFloat*    b,
+                     const qdldl_solver* s) {
 
-  OSQPInt j;
-  OSQPInt n = L->n;
+  OSQPInt        j;
+  OSQPInt        n  = s->L->n;
+  const OSQPInt* P  = s->P;
+  OSQPFloat*     bp = s->bp;
 
   osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE, LDL_SOLVE_BYTES(n, s->L->p[n], 1));
 
   // permute_x(L->n, bp, b, P);
   for (j = 0 ; j < n ; j++) bp[j] = b[P[j]];
 
-  QDLDL_solve(L->n, L->p, L->i, L->x, Dinv, bp);
+  LDLSolve_inplace(s, bp);
 
   // permutet_x(L->n, x, bp, P);
   for (j = 0 ; j < n ; j++) x[P[j]] = bp[j];
@@ -414,14 +985,150 @@ static void LDLSolve(OSQPFloat*           x,
   osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
 }
 
+/* Refinement stops once the residual is below this tolerance relative to b */
+#define DYN_REG_REFINE_TOL (1e-12)
+
+/*
+ * solve P'LDL'P x = b for x when the factorization replaced some pivots
+ *
+ * The factors are those of a perturbed KKT matrix, so the solution is refined
+ * against the stored (permuted) KKT matrix:
+ *   r = b - KKT x,  x = x + (LDL')^{-1} r
+ * All the work is done in the permuted ordering.
+ */
+static void LDLSolve_refine(OSQPFloat*       x,
+                            const OSQPFloat* b,
+                            qdldl_solver*    s) {
+
+  OSQPInt    i, j, k, iter;
+  OSQPInt    n   = s->L->n;
+  OSQPInt*   Kp  = s->KKT->p;
+  OSQPInt*   Ki  = s->KKT->i;
+  OSQPFloat* Kx  = s->KKT->x;
+  OSQPFloat* xp  = s->bp;
+  OSQPFloat* bp  = s->refine_work;
+  OSQPFloat* r   = s->refine_work + n;
+  OSQPFloat  norm_b = 0.0;
+  OSQPFloat  norm_r;
+
+  osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+
+  for (j = 0; j < n; j++) {
+    bp[j]  = b[s->P[j]];
+    xp[j]  = bp[j];
+    norm_b = c_max(norm_b, c_absval(bp[j]));
+  }
+
+  LDLSolve_inplace(s, xp);
+
+  for (iter = 0; iter < s->refine_iter; iter++) {
+    // r = b - KKT x, with only the upper triangular part of KKT stored
+    for (j = 0; j < n; j++) r[j] = bp[j];
+    for (j = 0; j < n; j++) {
+      for (k = Kp[j]; k < Kp[j+1]; k++) {
+        i = Ki[k];
+        r[i] -= Kx[k] * xp[j];
+        if (i != j) r[j] -= Kx[k] * xp[i];
+      }
+    }
+
+    norm_r = 0.0;
+    for (j = 0; j < n; j++) norm_r = c_max(norm_r, c_absval(r[j]));
+    if (norm_r <= DYN_REG_REFINE_TOL * (1.0 + norm_b)) break;
+
+    LDLSolve_inplace(s, r);
+    for (j = 0; j < n; j++) xp[j] += r[j];
+  }
+
+  for (j = 0; j < n; j++) x[s->P[j]] = xp[j];
+
+  osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+}
+
+/*
+ * Solve the KKT system of the ADMM iterations with the reduced system
+ *
+ *   (P + sigma I + A' diag(rho) A) x = b1 + A' diag(rho) b2
+ *
+ * Eliminating nu = diag(rho) (A x - b2) gives z_tilde = b2 + diag(rho)^{-1} nu = A x,
+ * so b = [b1; b2] is overwritten with [x; A x] as for the KKT matrix.
+ */
+static void LDLSolve_reduced(OSQPFloat*    b,
+                             qdldl_solver* s) {
+
+  OSQPInt              i, j, k;
+  OSQPInt              n = s->n;
+  OSQPInt              m = s->m;
+  const OSQPCscMatrix* A = s->Ared;
+  OSQPFloat*           x = s->sol;
+  OSQPFloat            xj;
+
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_SOLVE,
+                          2.0 * A->p[n] * (sizeof(OSQPFloat) + sizeof(OSQPInt)) +
+                          (3.0 * n + (s->rho_vec ? 4.0 : 3.0) * m) * sizeof(OSQPFloat));
+
+  // x = b1 + A' diag(rho) b2
+  for (j = 0; j < n; j++) {
+    xj = b[j];
+    for (k = A->p[j]; k < A->p[j+1]; k++) {
+      i   = A->i[k];
+      xj += A->x[k] * (s->rho_vec ? s->rho_vec[i] : s->rho) * b[n + i];
+    }
+    x[j] = xj;
+  }
+
+  if (s->nreg && s->refine_iter > 0)
+    LDLSolve_refine(x, x, s);
+  else
+    LDLSolve(x, x, s);
+
+  // b = [x; A x]
+  for (i = 0; i < m; i++) b[n + i] = 0.0;
+  for (j = 0; j < n; j++) {
+    b[j] = x[j];
+    for (k = A->p[j]; k < A->p[j+1]; k++) {
+      b[n + A->i[k]] += A->x[k] * x[j];
+    }
+  }
+}
+
+#endif  // OSQP_EMBEDDED_MODE
+#endif  // OSQP_ENABLE_LDL_UNROLL
+
+
+#if defined(OSQP_ENABLE_LDL_UNROLL) || !defined(OSQP_EMBEDDED_MODE)
+/* copy x_tilde from s->sol and compute z_tilde from b and s->sol */
+static void LDL_recover_kkt(OSQPFloat*          bv,
+                            const qdldl_solver* s) {
+
+  OSQPInt j;
+  OSQPInt n = s->n;
+  OSQPInt m = s->m;
+
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_SOLVE,
+                          (2.0 * n + (s->rho_inv_vec ? 4.0 : 3.0) * m) * sizeof(OSQPFloat));
+
+  for (j = 0 ; j < n ; j++) {
+    bv[j] = s->sol[j];
+  }
+
+  if (s->rho_inv_vec) {
+    for (j = 0 ; j < m ; j++) {
+      bv[j + n] += s->rho_inv_vec[j] * s->sol[j + n];
+    }
+  }
+  else {
+    for (j = 0 ; j < m ; j++) {
+      bv[j + n] += s->rho_inv * s->sol[j + n];
+    }
+  }
+}
+#endif
 
 OSQPInt solve_linsys_qdldl(qdldl_solver* s,
                            OSQPVectorf*  b,
                            OSQPInt       admm_iter) {
 
-  OSQPInt    j;
-  OSQPInt    n = s->n;
-  OSQPInt    m = s->m;
   OSQPFloat* bv = b->values;
 
   // Direct solver doesn't care about the ADMM iteration
@@ -432,31 +1139,29 @@ OSQPInt solve_linsys_qdldl(qdldl_solver* s,
 #ifndef OSQP_EMBEDDED_MODE
   if (s->polishing) {
     /* stores solution to the KKT system in b */
-    LDLSolve(bv, bv, s->L, s->Dinv, s->P, s->bp);
-  } else {
+    LDLSolve(bv, bv, s);
+  } else if (s->reduced) {
+    /* stores x_tilde and z_tilde in b */
+    LDLSolve_reduced(bv, s);
+  } else if (s->nreg && s->refine_iter > 0) {
+    /* stores solution to the KKT system in s->sol */
+    LDLSolve_refine(s->sol, bv, s);
+    LDL_recover_kkt(bv, s);
+  } else
 #endif
+  {
+#ifdef OSQP_ENABLE_LDL_UNROLL
     /* stores solution to the KKT system in s->sol */
-    LDLSolve(s->sol, bv, s->L, s->Dinv, s->P, s->bp);
-
-    /* copy x_tilde from s->sol */
-    for (j = 0 ; j < n ; j++) {
-      bv[j] = s->sol[j];
-    }
-
-    /* compute z_tilde from b and s->sol */
-    if (s->rho_inv_vec) {
-      for (j = 0 ; j < m ; j++) {
-        bv[j + n] += s->rho_inv_vec[j] * s->sol[j + n];
-      }
-    }
-    else {
-      for (j = 0 ; j < m ; j++) {
-        bv[j + n] += s->rho_inv * s->sol[j + n];
-      }
-    }
-#ifndef OSQP_EMBEDDED_MODE
-  }
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+    s->ldl_solve(s->sol, bv, s->L->x, s->Dinv, s->bp);
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+    LDL_recover_kkt(bv, s);
+#else
+    /* stores x_tilde and z_tilde in b */
+    LDLSolve_kkt(bv, s);
 #endif
+  }
+
   osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_SOLVE);
   return 0;
 }
@@ -475,17 +1180,30 @@ OSQPInt update_linsys_solver_matrices_qdldl(qdldl_solver*     s,
 
     OSQPInt pos_D_count;
 
-    // Update KKT matrix with new P
-    update_KKT_P(s->KKT, P->csc, Px_new_idx, P_new_n, s->PtoKKT, s->sigma, 0);
+#ifndef OSQP_EMBEDDED_MODE
+    OSQPInt j, Aidx;
 
-    // Update KKT matrix with new A
-    update_KKT_A(s->KKT, A->csc, Ax_new_idx, A_new_n, s->AtoKKT);
+    if (s->reduced) {
+        // Copy the new elements of A to its transpose, then recompute the reduced matrix
+        for (j = 0; j < A_new_n; j++) {
+            Aidx = Ax_new_idx ? Ax_new_idx[j] : j;
+            s->At->x[s->AtoAt[Aidx]] = A->csc->x[Aidx];
+        }
 
-    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
-    pos_D_count = QDLDL_factor(s->KKT->n, s->KKT->p, s->KKT->i, s->KKT->x,
-        s->L->p, s->L->i, s->L->x, s->D, s->Dinv, s->Lnz,
-        s->etree, s->bwork, s->iwork, s->fwork);
-    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+        update_reduced_KKT(s->KKT, s->RtoKKT, s->Rpat, P->csc, A->csc, s->At,
+                           s->sigma, s->rho_vec, s->rho, s->fwork);
+    }
+    else
+#endif
+    {
+        // Update KKT matrix with new P
+        update_KKT_P(s->KKT, P->csc, Px_new_idx, P_new_n, s->PtoKKT, s->sigma, 0);
+
+        // Update KKT matrix with new A
+        update_KKT_A(s->KKT, A->csc, Ax_new_idx, A_new_n, s->AtoKKT);
+    }
+
+    pos_D_count = LDL_numeric_factor(s->KKT, s);
 
     //number of positive elements in D should match the
     //dimension of P if P + \sigma I is PD.   Error otherwise.
@@ -502,6 +1220,26 @@ OSQPInt update_linsys_solver_rho_vec_qdldl(qdldl_solver*      s,
     OSQPInt m = s->m;
     OSQPFloat* rhov;
 
+#ifndef OSQP_EMBEDDED_MODE
+    if (s->reduced) {
+        // Recompute the reduced matrix with the new rho
+        if (s->rho_vec) {
+          rhov = rho_vec->values;
+          for (i = 0; i < m; i++){
+              s->rho_vec[i] = rhov[i];
+          }
+        }
+        else {
+          s->rho = rho_sc;
+        }
+
+        update_reduced_KKT(s->KKT, s->RtoKKT, s->Rpat, s->Pred, s->Ared, s->At,
+                           s->sigma, s->rho_vec, s->rho, s->fwork);
+
+        return (LDL_numeric_factor(s->KKT, s) < 0);
+    }
+#endif
+
     // Update internal rho_inv_vec
     if (s->rho_inv_vec) {
       rhov = rho_vec->values;
@@ -516,11 +1254,7 @@ OSQPInt update_linsys_solver_rho_vec_qdldl(qdldl_solver*      s,
     // Update KKT matrix with new rho_vec
     update_KKT_param2(s->KKT, s->rho_inv_vec, s->rho_inv, s->rhotoKKT, s->m);
 
-    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
-    retval = QDLDL_factor(s->KKT->n, s->KKT->p, s->KKT->i, s->KKT->x,
-        s->L->p, s->L->i, s->L->x, s->D, s->Dinv, s->Lnz,
-        s->etree, s->bwork, s->iwork, s->fwork);
-    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
+    retval = LDL_numeric_factor(s->KKT, s);
 
     return (retval < 0);
 }
@@ -531,40 +1265,6 @@ OSQPInt update_linsys_solver_rho_vec_qdldl(qdldl_solver*      s,
 
 // --------- Derivative functions -------- //
 
-//increment the D colptr by the number of nonzeros
-//in a square diagonal matrix.
-static void _colcount_diag(OSQPCscMatrix* D,
-                           OSQPInt        initcol,
-                           OSQPInt        blockcols) {
-
-    OSQPInt j;
-    for(j = initcol; j < (initcol + blockcols); j++){
-        D->p[j]++;
-    }
-}
-
-//increment D colptr by the number of nonzeros in M
-static void _colcount_block(OSQPCscMatrix* D,
-                            OSQPCscMatrix* M,
-                            OSQPInt        initcol,
-                            OSQPInt        istranspose) {
-
-    OSQPInt nnzM, j;
-
-    if(istranspose){
-        nnzM = M->p[M->n];
-        for (j = 0; j < nnzM; j++){
-            D->p[M->i[j] + initcol]++;
-        }
-    }
-    else {
-        //just add the column count
-        for (j = 0; j < M->n; j++){
-            D->p[j + initcol] += M->p[j+1] - M->p[j];
-        }
-    }
-}
-
 static void _colcount_to_colptr(OSQPCscMatrix* D) {
 
     OSQPInt j, count;
@@ -577,59 +1277,6 @@ static void _colcount_to_colptr(OSQPCscMatrix* D) {
     }
 }
 
-//populate values from M using the K colptr as indicator of
-//next fill location in each row
-static void _fill_block(OSQPCscMatrix* K,
-                        OSQPCscMatrix* M,
-                        OSQPInt*       index_mapping,
-                        OSQPInt        initrow,
-                        OSQPInt        initcol,
-                        OSQPInt        istranspose) {
-    OSQPInt ii, jj, row, col, dest;
-
-    for(ii=0; ii < M->n; ii++){
-        for(jj = M->p[ii]; jj < M->p[ii+1]; jj++){
-            if(istranspose){
-                col = M->i[jj] + initcol;
-                row = ii + initrow;
-            }
-            else {
-                col = ii + initcol;
-                row = M->i[jj] + initrow;
-            }
-
-            dest       = K->p[col]++;
-            K->i[dest] = row;
-            K->x[dest] = M->x[jj];
-            if (index_mapping != OSQP_NULL) { index_mapping[jj] = dest; }
-        }
-    }
-}
-
-static void _fill_diag_values(OSQPCscMatrix* K,
-                              OSQPInt*       index_mapping,
-                              OSQPInt        initrow,
-                              OSQPInt        initcol,
-                              OSQPFloat*     values,
-                              OSQPFloat      value_scalar,
-                              OSQPInt        n) {
-
-    OSQPInt j, dest, row, col;
-    for (j = 0; j < n; j++) {
-        row         = j + initrow;
-        col         = j + initcol;
-        dest        = K->p[col];
-        K->i[dest]  = row;
-        if (values != OSQP_NULL) {
-            K->x[dest] = values[j];
-        } else {
-            K->x[dest] = value_scalar;
-        }
-        K->p[col]++;
-        if (index_mapping != OSQP_NULL) { index_mapping[j] = dest; }
-    }
-}
-
 static void _backshift_colptrs(OSQPCscMatrix* K) {
 
     int j;
@@ -654,238 +1301,464 @@ static void _adj_perturb(OSQPCscMatrix* D,
     }
 }
 
-static void _adj_assemble_csc(OSQPCscMatrix*     D,
-                              const OSQPMatrix*  P_full,
-                              const OSQPMatrix*  G,
-                              const OSQPMatrix*  A_eq,
-                              const OSQPMatrix*  GDiagLambda,
-                              const OSQPVectorf* slacks) {
+//store a value at the next free location of column col
+static void _adj_push(OSQPCscMatrix* D,
+                      OSQPInt        row,
+                      OSQPInt        col,
+                      OSQPFloat      val) {
+
+    OSQPInt dest = D->p[col]++;
+    D->i[dest] = row;
+    D->x[dest] = val;
+}
+
+//row maps from the constraint index of A to the position of the row
+//in G = [-A_l; A_u] and A_eq (-1 if the row is not part of the block)
+static OSQPInt* _adj_row_maps(const OSQPDerivativeData* dd,
+                              OSQPInt                   m) {
 
-    OSQPInt n = OSQPMatrix_get_m(P_full);
-    OSQPInt x = OSQPMatrix_get_m(G);        // No. of inequality constraints
-    OSQPInt y = OSQPMatrix_get_m(A_eq);     // No. of equality constraints
+    OSQPInt  j;
+    OSQPInt* maps = (OSQPInt *)c_malloc(sizeof(OSQPInt) * 3 * m);
+
+    if (!maps) return OSQP_NULL;
+
+    for (j = 0; j < 3*m; j++) maps[j] = -1;
+    for (j = 0; j < dd->n_ineq_l; j++) maps[dd->l_noninf_indices[j]]     = j;
+    for (j = 0; j < dd->n_ineq_u; j++) maps[m + dd->u_noninf_indices[j]] = j;
+    for (j = 0; j < dd->n_eq; j++)     maps[2*m + dd->eq_indices[j]]     = j;
+
+    return maps;
+}
+
+//number of nonzeros in the upper triangular part of the adjoint matrix
+static OSQPInt _adj_count_nnz(const OSQPCscMatrix* P,
+                              const OSQPCscMatrix* A,
+                              const OSQPInt*       maps,
+                              OSQPInt              N,
+                              OSQPInt              n_ineq) {
+
+    OSQPInt j, r;
+    OSQPInt nnz = 2*N + n_ineq;     // I, zero diagonal, slacks
+
+    for (j = 0; j < P->n; j++) {
+        for (r = P->p[j]; r < P->p[j+1]; r++) {
+            nnz += (P->i[r] == j) ? 1 : 2;
+        }
+    }
+
+    for (j = 0; j < A->p[A->n]; j++) {
+        r = A->i[j];
+        nnz += 2 * ((maps[r] >= 0) + (maps[A->m + r] >= 0) + (maps[2*A->m + r] >= 0));
+    }
+
+    return nnz;
+}
+
+// Assemble the upper triangular part of the adjoint matrix [I K; K' 0] with
+// K = [P, G'*diag(lambda), A_eq'; G, diag(slacks), 0; A_eq, 0, 0], reading the
+// scaled problem data directly and undoing the scaling entry by entry.
+static void _adj_assemble_csc(OSQPCscMatrix*            D,
+                              const OSQPCscMatrix*      P,
+                              const OSQPCscMatrix*      A,
+                              const OSQPFloat*          Dinv,
+                              const OSQPFloat*          Einv,
+                              OSQPFloat                 cinv,
+                              const OSQPDerivativeData* dd,
+                              const OSQPInt*            maps,
+                              const OSQPFloat*          slacks) {
+
+    OSQPInt j, k, r, row;
+    OSQPFloat val;
+
+    OSQPInt n  = P->n;
+    OSQPInt m  = A->m;
+    OSQPInt nl = dd->n_ineq_l;
+    OSQPInt nu = dd->n_ineq_u;
+    OSQPInt N  = n + nl + nu + dd->n_eq;
+
+    const OSQPInt*   lmap = maps;
+    const OSQPInt*   umap = maps + m;
+    const OSQPInt*   emap = maps + 2*m;
+    const OSQPFloat* y_l  = OSQPVectorf_data(dd->y_l);
+    const OSQPFloat* y_u  = OSQPVectorf_data(dd->y_u);
 
-    OSQPInt j;
     //use D.p to hold nnz entries in each column of the D matrix
-    for (j=0; j <= 2*(n+x+y); j++){D->p[j] = 0;}
+    for (j = 0; j <= 2*N; j++) D->p[j] = 0;
 
-    _colcount_diag(D, 0, n+x+y);
-    _colcount_block(D, P_full->csc, n+x+y, 0);
-    _colcount_block(D, G->csc, n+x+y, 0);
-    _colcount_block(D, A_eq->csc, n+x+y, 0);
-    _colcount_block(D, GDiagLambda->csc, n+x+y+n, 1);
-    _colcount_diag(D, n+x+y+n, x);
-    _colcount_block(D, A_eq->csc, n+x+y+n+x, 1);
-    _colcount_diag(D, n+x+y, n+x+y);
+    for (j = 0; j < N; j++) D->p[j]++;
+    for (j = 0; j < n; j++) {
+        for (k = P->p[j]; k < P->p[j+1]; k++) {
+            D->p[N + j]++;
+            if (P->i[k] != j) D->p[N + P->i[k]]++;
+        }
+        for (k = A->p[j]; k < A->p[j+1]; k++) {
+            r = A->i[k];
+            if (lmap[r] >= 0) { D->p[N + j]++; D->p[N + n + lmap[r]]++; }
+            if (umap[r] >= 0) { D->p[N + j]++; D->p[N + n + nl + umap[r]]++; }
+            if (emap[r] >= 0) { D->p[N + j]++; D->p[N + n + nl + nu + emap[r]]++; }
+        }
+    }
+    for (j = 0; j < nl + nu; j++) D->p[N + n + j]++;
+    for (j = 0; j < N; j++)       D->p[N + j]++;
 
     //cumsum total entries to convert to D.p
     _colcount_to_colptr(D);
 
-    _fill_diag_values(D, OSQP_NULL, 0, 0, OSQP_NULL, 1, n+x+y);
-    _fill_block(D, P_full->csc, OSQP_NULL, 0, n+x+y, 0);
-    _fill_block(D, G->csc, OSQP_NULL, n, n+x+y, 0);
-    _fill_block(D, A_eq->csc, OSQP_NULL, n+x, n+x+y, 0);
-    _fill_block(D, GDiagLambda->csc, OSQP_NULL, 0, n+x+y+n, 1);
-    _fill_diag_values(D, OSQP_NULL, n, n+x+y+n, slacks->values, 0, x);
-    _fill_block(D, A_eq->csc, OSQP_NULL, 0, n+x+y+n+x, 1);
-    _fill_diag_values(D, OSQP_NULL, n+x+y, n+x+y, OSQP_NULL, 0, n+x+y);
+    //identity block
+    for (j = 0; j < N; j++) _adj_push(D, j, j, 1.0);
 
-    _backshift_colptrs(D);
+    //P in full symmetric form: upper triangle first, then the mirrored entries
+    for (j = 0; j < n; j++) {
+        for (k = P->p[j]; k < P->p[j+1]; k++) {
+            row = P->i[k];
+            val = cinv * P->x[k];
+            if (Dinv) val *= Dinv[row] * Dinv[j];
+            _adj_push(D, row, N + j, val);
+        }
+    }
+    for (j = 0; j < n; j++) {
+        for (k = P->p[j]; k < P->p[j+1]; k++) {
+            row = P->i[k];
+            if (row == j) continue;
+            val = cinv * P->x[k];
+            if (Dinv) val *= Dinv[row] * Dinv[j];
+            _adj_push(D, j, N + row, val);
+        }
+    }
 
+    //G = [-A_l; A_u] and A_eq below P, and their transposes to the right
+    for (j = 0; j < n; j++) {
+        for (k = A->p[j]; k < A->p[j+1]; k++) {
+            r = A->i[k];
+            if (lmap[r] < 0) continue;
+            val = A->x[k];
+            if (Einv) val *= Einv[r] * Dinv[j];
+            _adj_push(D, n + lmap[r], N + j, -val);
+            _adj_push(D, j, N + n + lmap[r], -y_l[r] * val);
+        }
+        for (k = A->p[j]; k < A->p[j+1]; k++) {
+            r = A->i[k];
+            if (umap[r] < 0) continue;
+            val = A->x[k];
+            if (Einv) val *= Einv[r] * Dinv[j];
+            _adj_push(D, n + nl + umap[r], N + j, val);
+            _adj_push(D, j, N + n + nl + umap[r], y_u[r] * val);
+        }
+        for (k = A->p[j]; k < A->p[j+1]; k++) {
+            r = A->i[k];
+            if (emap[r] < 0) continue;
+            val = A->x[k];
+            if (Einv) val *= Einv[r] * Dinv[j];
+            _adj_push(D, n + nl + nu + emap[r], N + j, val);
+            _adj_push(D, j, N + n + nl + nu + emap[r], val);
+        }
+    }
+
+    //slacks, then the zero diagonal of the lower right block (perturbed later)
+    for (j = 0; j < nl + nu; j++) _adj_push(D, n + j, N + n + j, slacks[j]);
+    for (j = 0; j < N; j++)       _adj_push(D, N + j, N + j, 0.0);
+
+    _backshift_colptrs(D);
 }
 
-OSQPInt adjoint_derivative_qdldl(qdldl_solver**     s,
-                                 const OSQPMatrix*  P_full,
-                                 const OSQPMatrix*  G,
-                                 const OSQPMatrix*  A_eq,
-                                 const OSQPMatrix*  GDiagLambda,
-                                 const OSQPVectorf* slacks,
-                                       OSQPVectorf* rhs) {
-    /* We don't currently reuse the solver for the adjoint computations */
-    OSQP_UnusedVar(s);
+// Solve the factored adjoint system for nrhs right-hand sides stored one after
+// the other in b. The right-hand sides are interleaved in bp so that each
+// column of L is traversed once for the whole block.
+static void _adj_ldl_solve(const qdldl_solver* s,
+                           OSQPFloat*          b,
+                           OSQPFloat*          bp,
+                           OSQPInt             nrhs) {
 
-    OSQPInt retval = 0;
+    OSQPInt i, j, k, row;
+    OSQPFloat val;
 
-    OSQPInt n = OSQPMatrix_get_m(P_full);
-    OSQPInt n_ineq = OSQPMatrix_get_m(G);
-    OSQPInt n_eq = OSQPMatrix_get_m(A_eq);
+    OSQPInt        dim  = s->n;
+    const OSQPInt* Lp   = s->L->p;
+    const OSQPInt* Li   = s->L->i;
+    const OSQPFloat* Lx = s->L->x;
 
-    // Get maximum number of nonzero elements (only upper triangular part)
-    OSQPInt P_full_nnz = OSQPMatrix_get_nz(P_full);
-    OSQPInt G_nnz = OSQPMatrix_get_nz(G);
-    OSQPInt A_eq_nnz = OSQPMatrix_get_nz(A_eq);
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+    osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE, LDL_SOLVE_BYTES(dim, Lp[dim], nrhs));
 
-    OSQPInt nnzKKT = n + n_ineq + n_eq +           // Number of diagonal elements in I (+eps)
-                   P_full_nnz +                  // Number of elements in P_full
-                   G_nnz +                       // Number of nonzeros in G
-                   A_eq_nnz +                    // Number of nonzeros in A_eq
-                   G_nnz +                       // Number of nonzeros in G'
-                   n_ineq +                      // Number of diagonal elements in slacks
-                   A_eq_nnz +                    // Number of nonzeros in A_eq'
-                   n + n_ineq + n_eq;            // Number of -eps entries on diagonal
+    for (i = 0; i < dim; i++) {
+        for (k = 0; k < nrhs; k++) {
+            bp[i*nrhs + k] = b[k*dim + s->P[i]];
+        }
+    }
 
-    OSQPInt dim = 2 * (n + n_ineq + n_eq);
-    OSQPCscMatrix* adj = csc_spalloc(dim, dim, nnzKKT, 1, 0);
-    if (!adj) return osqp_error(OSQP_MEM_ALLOC_ERROR);
+    // Solve L * y = b
+    for (i = 0; i < dim; i++) {
+        for (j = Lp[i]; j < Lp[i+1]; j++) {
+            row = Li[j];
+            val = Lx[j];
+            for (k = 0; k < nrhs; k++) {
+                bp[row*nrhs + k] -= val * bp[i*nrhs + k];
+            }
+        }
+    }
 
-    _adj_assemble_csc(adj, P_full, G, A_eq, GDiagLambda, slacks);
+    // Solve D * z = y
+    for (i = 0; i < dim; i++) {
+        for (k = 0; k < nrhs; k++) {
+            bp[i*nrhs + k] *= s->Dinv[i];
+        }
+    }
 
-    OSQPMatrix *adj_matrix = OSQPMatrix_new_from_csc(adj, 1);
+    // Solve L' * x = z
+    for (i = dim - 1; i >= 0; i--) {
+        for (j = Lp[i]; j < Lp[i+1]; j++) {
+            row = Li[j];
+            val = Lx[j];
+            for (k = 0; k < nrhs; k++) {
+                bp[i*nrhs + k] -= val * bp[row*nrhs + k];
+            }
+        }
+    }
 
-    if (!adj_matrix) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto adj_alloc_fail;
+    for (i = 0; i < dim; i++) {
+        for (k = 0; k < nrhs; k++) {
+            b[k*dim + s->P[i]] = bp[i*nrhs + k];
+        }
     }
 
-    _adj_perturb(adj, 1e-6);
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_BACKSOLVE);
+}
+
+// Check whether two assembled adjoint matrices have the same sparsity pattern
+static OSQPInt _adj_same_pattern(const OSQPCscMatrix* A,
+                                 const OSQPCscMatrix* B) {
+
+    OSQPInt j;
 
-    // ----------------------------
-    // QDLDL formulation + solve
-    // ----------------------------
-    const QDLDL_int   An   = dim;
-    QDLDL_int i; // Counter
+    if (A->n != B->n || A->p[A->n] != B->p[B->n]) return 0;
 
-    //data for L and D factors
-    QDLDL_int Ln = An;
+    for (j = 0; j <= A->n; j++) {
+        if (A->p[j] != B->p[j]) return 0;
+    }
+    for (j = 0; j < A->p[A->n]; j++) {
+        if (A->i[j] != B->i[j]) return 0;
+    }
 
-    QDLDL_float *Lx = OSQP_NULL;
-    QDLDL_int   *Li = OSQP_NULL;
+    return 1;
+}
 
-    QDLDL_int   *Lp   = (QDLDL_int*)malloc(sizeof(QDLDL_int)*(An+1));
-    QDLDL_float *D    = (QDLDL_float*)malloc(sizeof(QDLDL_float)*An);
-    QDLDL_float *Dinv = (QDLDL_float*)malloc(sizeof(QDLDL_float)*An);
+OSQPInt adjoint_derivative_qdldl(qdldl_solver**            sp,
+                                 const qdldl_solver*       sym,
+                                 const OSQPMatrix*         P,
+                                 const OSQPMatrix*         A,
+                                 const OSQPVectorf*        Dinv,
+                                 const OSQPVectorf*        Einv,
+                                 OSQPFloat                 cinv,
+                                 const OSQPDerivativeData* derivative_data,
+                                 const OSQPFloat*          slacks) {
 
-    //permutation
-    QDLDL_int   *P    = (QDLDL_int*)malloc(sizeof(QDLDL_int)*(An));
-    QDLDL_int   *Pinv = OSQP_NULL;
+    OSQPInt i;
+    OSQPInt sum_Lnz;
+    OSQPInt retval = 0;
+    OSQPInt* Pinv;
+    OSQPInt* maps;
+    OSQPCscMatrix* KKT_temp;
+    OSQPCscMatrix* KKT_perm;
 
-    //data for elim tree calculation
-    QDLDL_int *etree = (QDLDL_int*)malloc(sizeof(QDLDL_int)*An);
-    QDLDL_int *Lnz   = (QDLDL_int*)malloc(sizeof(QDLDL_int)*An);
-    QDLDL_int  sumLnz;
+    OSQPInt n      = P->csc->n;
+    OSQPInt m      = A->csc->m;
+    OSQPInt n_ineq = derivative_data->n_ineq_l + derivative_data->n_ineq_u;
+    OSQPInt N      = n + n_ineq + derivative_data->n_eq;
+    OSQPInt dim    = 2 * N;
 
-    //working data for factorisation
-    QDLDL_int   *iwork = (QDLDL_int*)malloc(sizeof(QDLDL_int)*(3*An));
-    QDLDL_bool  *bwork = (QDLDL_bool*)malloc(sizeof(QDLDL_bool)*An);
-    QDLDL_float *fwork = (QDLDL_float*)malloc(sizeof(QDLDL_float)*An);
+    *sp = OSQP_NULL;
 
-    //Data for results of A\b
-    QDLDL_float *x = OSQP_NULL;
-    QDLDL_float *x_work = OSQP_NULL;
+    maps = _adj_row_maps(derivative_data, m);
+    if (!maps) return osqp_error(OSQP_MEM_ALLOC_ERROR);
 
-    if (!Lp || !D || !Dinv || !P || !etree || !Lnz || !iwork || !bwork || !fwork) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto mat_comp_alloc_error;
+    // Allocate private structure to store the adjoint factorization
+    qdldl_solver* s = c_calloc(1, sizeof(qdldl_solver));
+    if (!s) {
+        c_free(maps);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
     }
 
-    OSQPInt amd_status;
-#ifdef OSQP_USE_LONG
-    amd_status = amd_l_order(An, adj->p, adj->i, P, (OSQPFloat *)OSQP_NULL, (OSQPFloat *)OSQP_NULL);
-#else
-    amd_status = amd_order(An, adj->p, adj->i, P, (OSQPFloat *)OSQP_NULL, (OSQPFloat *)OSQP_NULL);
-#endif
-    if (amd_status < 0) {
-        retval = amd_status;
-        goto mat_comp_alloc_error;
+    s->type     = OSQP_DIRECT_SOLVER;
+    s->name     = &name_qdldl;
+    s->free     = &free_linsys_solver_qdldl;
+    s->nthreads = 1;
+    s->n        = dim;
+    s->m        = 0;
+
+    // Unperturbed adjoint matrix, kept for iterative refinement
+    s->adj = csc_spalloc(dim, dim, _adj_count_nnz(P->csc, A->csc, maps, N, n_ineq), 1, 0);
+
+    s->L = c_calloc(1, sizeof(OSQPCscMatrix));
+    if (s->L) {
+        s->L->m  = dim;
+        s->L->n  = dim;
+        s->L->nz = -1;
+        s->L->p  = (OSQPInt *)c_malloc((dim+1) * sizeof(QDLDL_int));
     }
 
-    // Inverse of the permutation vector
-    Pinv = csc_pinv(P, An);
-    if (!Pinv) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto inv_perm_fail;
+    s->Dinv  = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * dim);
+    s->D     = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * dim);
+    s->P     = (QDLDL_int *)c_malloc(sizeof(QDLDL_int) * dim);
+    s->etree = (QDLDL_int *)c_malloc(sizeof(QDLDL_int) * dim);
+    s->Lnz   = (QDLDL_int *)c_malloc(sizeof(QDLDL_int) * dim);
+    s->iwork = (QDLDL_int *)c_malloc(sizeof(QDLDL_int) * (3*dim));
+    s->bwork = (QDLDL_bool *)c_malloc(sizeof(QDLDL_bool) * dim);
+    s->fwork = (QDLDL_float *)c_malloc(sizeof(QDLDL_float) * dim);
+
+    if (!s->adj || !s->L || !s->L->p || !s->Dinv || !s->D || !s->P ||
+        !s->etree || !s->Lnz || !s->iwork || !s->bwork || !s->fwork) {
+        c_free(maps);
+        free_linsys_solver_qdldl(s);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
     }
 
-    OSQPCscMatrix* adj_permuted = OSQP_NULL;
-    adj_permuted = csc_symperm(adj, Pinv, OSQP_NULL, 1);
-    if (!adj_permuted) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto sym_perm_fail;
+    _adj_assemble_csc(s->adj, P->csc, A->csc,
+                      Dinv ? Dinv->values : OSQP_NULL,
+                      Einv ? Einv->values : OSQP_NULL,
+                      cinv, derivative_data, maps, slacks);
+    c_free(maps);
+
+    // Perturb a copy of the matrix to make it quasidefinite, then permute it
+    KKT_temp = csc_copy(s->adj);
+    if (!KKT_temp) {
+        free_linsys_solver_qdldl(s);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
     }
 
-    sumLnz = QDLDL_etree(An, adj_permuted->p, adj_permuted->i, iwork, Lnz, etree);
+    _adj_perturb(KKT_temp, 1e-6);
 
-    Li    = (QDLDL_int*)malloc(sizeof(QDLDL_int)*sumLnz);
-    Lx    = (QDLDL_float*)malloc(sizeof(QDLDL_float)*sumLnz);
+    if (sym && _adj_same_pattern(s->adj, sym->adj)) {
+        // Same pattern as an already analysed system: reuse its ordering and elimination tree
+        osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_SYM_FAC);
+        for (i = 0; i < dim; i++) {
+            s->P[i]     = sym->P[i];
+            s->etree[i] = sym->etree[i];
+            s->Lnz[i]   = sym->Lnz[i];
+        }
+        sum_Lnz = sym->L->nzmax;
+
+        Pinv     = csc_pinv(s->P, dim);
+        KKT_perm = Pinv ? csc_symperm(KKT_temp, Pinv, OSQP_NULL, 1) : OSQP_NULL;
+        c_free(Pinv);
+        csc_spfree(KKT_temp);
+        KKT_temp = KKT_perm;
+        osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_SYM_FAC);
 
-    if (!Li || !Lx) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto csc_alloc_fail;
+        if (!KKT_temp) {
+            free_linsys_solver_qdldl(s);
+            return osqp_error(OSQP_MEM_ALLOC_ERROR);
+        }
     }
+    else {
+        retval = permute_KKT(&KKT_temp, s);
 
-    QDLDL_factor(An, adj_permuted->p, adj_permuted->i, adj_permuted->x, Lp, Li, Lx, D, Dinv, Lnz, etree, bwork, iwork, fwork);
+        if (retval || !KKT_temp) {
+            csc_spfree(KKT_temp);
+            free_linsys_solver_qdldl(s);
+            return osqp_error(OSQP_LINSYS_SOLVER_INIT_ERROR);
+        }
 
-    x = (QDLDL_float*)malloc(sizeof(QDLDL_float)*An);
-    x_work = (QDLDL_float*)malloc(sizeof(QDLDL_float)*An);
+        osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_SYM_FAC);
+        sum_Lnz = QDLDL_etree(KKT_temp->n, KKT_temp->p, KKT_temp->i, s->iwork, s->Lnz, s->etree);
+        osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_SYM_FAC);
 
-    if (!x || !x_work) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto x_alloc_fail;
+        if (sum_Lnz < 0) {
+            c_eprint("Error in adjoint matrix LDL factorization when computing the elimination tree.");
+            csc_spfree(KKT_temp);
+            free_linsys_solver_qdldl(s);
+            return osqp_error(OSQP_LINSYS_SOLVER_INIT_ERROR);
+        }
     }
 
-    //when solving A\b, start with x = b
-    for (i = 0 ; i < An ; i++) x_work[i] = rhs->values[P[i]];
-    QDLDL_solve(Ln, Lp, Li, Lx, Dinv, x_work);
-    for (i = 0 ; i < An ; i++) x[P[i]] = x_work[i];
+    s->KKT = KKT_temp;
 
-    OSQPVectorf *sol = OSQPVectorf_new(x, An);
-    OSQPVectorf *residual = OSQPVectorf_malloc(An);
+    // Allocate memory for Li and Lx
+    s->L->i = (OSQPInt *)c_malloc(sizeof(OSQPInt) * sum_Lnz);
+    s->L->x = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * sum_Lnz);
+    s->L->nzmax = sum_Lnz;
+    s->factor_nnz = sum_Lnz;
 
-    if (!sol || !residual) {
-        retval = OSQP_MEM_ALLOC_ERROR;
-        goto vec_alloc_fail;
+    if (sum_Lnz > 0 && (!s->L->i || !s->L->x)) {
+        free_linsys_solver_qdldl(s);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
     }
 
-    OSQPInt k;
-    for (k=0; k<200; k++) {
-        OSQPVectorf_copy(residual, rhs);
-        OSQPMatrix_Axpy(adj_matrix, sol, residual, 1, -1);
-        if (OSQPVectorf_norm_2(residual) < 1e-12) break;
+    *sp = s;
+
+    return 0;
+}
+
+OSQPInt adjoint_derivative_factor_qdldl(qdldl_solver* s) {
+
+    OSQPInt factor_status;
+
+    factor_status = QDLDL_factor(s->KKT->n, s->KKT->p, s->KKT->i, s->KKT->x,
+                                 s->L->p, s->L->i, s->L->x,
+                                 s->D, s->Dinv, s->Lnz,
+                                 s->etree, s->bwork, s->iwork, s->fwork);
 
-        for (i = 0 ; i < An ; i++) x_work[i] = residual->values[P[i]];
-        QDLDL_solve(Ln, Lp, Li, Lx, Dinv, x_work);
-        for (i = 0 ; i < An ; i++) residual->values[P[i]] = x_work[i];
+    return factor_status < 0;
+}
+
+OSQPInt adjoint_derivative_solve_qdldl(qdldl_solver* s,
+                                       OSQPVectorf*  rhs,
+                                       OSQPInt       nrhs) {
 
-        OSQPVectorf_minus(sol, sol, residual);
+    OSQPInt i, k, iter;
+    OSQPInt retval = 0;
+    OSQPInt dim = s->n;
+    OSQPInt n_active;
+    OSQPFloat res_norm;
+
+    OSQPFloat* b   = rhs->values;
+    OSQPFloat* sol = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim * nrhs);
+    OSQPFloat* res = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim * nrhs);
+    OSQPFloat* bp  = (OSQPFloat *)c_malloc(sizeof(OSQPFloat) * dim * nrhs);
+
+    if (!sol || !res || !bp) {
+        retval = osqp_error(OSQP_MEM_ALLOC_ERROR);
+        goto adj_solve_exit;
     }
 
-    // rhs is sized to be the largest possible size needed, so sol might be smaller
-    // Therefore, we have to subassign into rhs
-    OSQPVectorf_subvector_assign(rhs, OSQPVectorf_data(sol), 0, OSQPVectorf_length(sol), 1.0);
+    osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_SOLVE);
 
-/* Free data based on what failed */
-vec_alloc_fail:
-    OSQPVectorf_free(sol);
-    OSQPVectorf_free(residual);
+    for (i = 0; i < dim * nrhs; i++) sol[i] = b[i];
+    _adj_ldl_solve(s, sol, bp, nrhs);
 
-x_alloc_fail:
-    c_free(x);
-    c_free(x_work);
+    // Iterative refinement against the unperturbed matrix
+    for (iter = 0; iter < 200; iter++) {
+        n_active = 0;
 
-csc_alloc_fail:
-    c_free(Li);
-    c_free(Lx);
+        for (k = 0; k < nrhs; k++) {
+            for (i = 0; i < dim; i++) res[k*dim + i] = b[k*dim + i];
+            csc_Axpy_sym_triu(s->adj, sol + k*dim, res + k*dim, 1, -1);
 
-sym_perm_fail:
-    csc_spfree(adj_permuted);
+            res_norm = 0.0;
+            for (i = 0; i < dim; i++) res_norm += res[k*dim + i] * res[k*dim + i];
 
-inv_perm_fail:
-    c_free(Pinv);
+            if (c_sqrt(res_norm) < 1e-12) {
+                // Converged; a zero correction leaves this solution unchanged
+                for (i = 0; i < dim; i++) res[k*dim + i] = 0.0;
+            } else {
+                n_active++;
+            }
+        }
+
+        if (n_active == 0) break;
+
+        _adj_ldl_solve(s, res, bp, nrhs);
+
+        for (i = 0; i < dim * nrhs; i++) sol[i] -= res[i];
+    }
+
+    for (i = 0; i < dim * nrhs; i++) b[i] = sol[i];
+
+    osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_SOLVE);
 
-mat_comp_alloc_error:
-    c_free(Lp);
-    c_free(D);
-    c_free(Dinv);
-    c_free(P);
-    c_free(etree);
-    c_free(Lnz);
-    c_free(iwork);
-    c_free(bwork);
-    c_free(fwork);
-
-adj_alloc_fail:
-    OSQPMatrix_free(adj_matrix);
-    csc_spfree(adj);
+adj_solve_exit:
+    c_free(sol);
+    c_free(res);
+    c_free(bp);
 
     return retval;
 }
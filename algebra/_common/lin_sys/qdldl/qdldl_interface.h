@@ -35,13 +35,15 @@ struct qdldl {
                        const  OSQPVectorf* x);
 
 #ifndef OSQP_EMBEDDED_MODE
-    OSQPInt (*adjoint_derivative)(qdldl_solver**     s,
-                                  const OSQPMatrix*  P,
-                                  const OSQPMatrix*  G,
-                                  const OSQPMatrix*  A_eq,
-                                  const OSQPMatrix*  GDiagLambda,
-                                  const OSQPVectorf* slacks,
-                                        OSQPVectorf* rhs);
+    OSQPInt (*adjoint_derivative)(qdldl_solver**            s,
+                                  const qdldl_solver*       sym,
+                                  const OSQPMatrix*         P,
+                                  const OSQPMatrix*         A,
+                                  const OSQPVectorf*        Dinv,
+                                  const OSQPVectorf*        Einv,
+                                  OSQPFloat                 cinv,
+                                  const OSQPDerivativeData* derivative_data,
+                                  const OSQPFloat*          slacks);
 
     void (*free)(struct qdldl* self); ///< Free workspace (only if desktop)
 #endif
@@ -61,7 +63,16 @@ struct qdldl {
                                      OSQPFloat    rho_sc);    ///< Update rho_vec parameter
 #endif
 
+#ifdef OSQP_ENABLE_LDL_UNROLL
+    void (*ldl_solve)(OSQPFloat*       x,
+                      const OSQPFloat* b,
+                      const OSQPFloat* Lx,
+                      const OSQPFloat* Dinv,
+                      OSQPFloat*       work);             ///< Generated solve specialized to the pattern of L
+#endif
+
     OSQPInt nthreads;
+    OSQPInt factor_nnz;   ///< nonzeros in L predicted by the elimination tree
 
     /** @} */
 
@@ -79,6 +90,32 @@ struct qdldl {
     OSQPFloat      rho_inv;       ///< scalar parameter (used if rho_inv_vec == NULL)
 #ifndef OSQP_EMBEDDED_MODE
     OSQPInt        polishing;     ///< polishing flag
+
+    // Dynamic regularization
+    OSQPInt        dyn_reg;       ///< replace tiny pivots by pivots of the expected sign
+    OSQPFloat      dyn_reg_eps;   ///< pivots with magnitude at most dyn_reg_eps are replaced
+    OSQPFloat      dyn_reg_delta; ///< magnitude of the replacement pivots
+    OSQPInt        refine_iter;   ///< iterative refinement steps when pivots were replaced
+    OSQPInt        nreg;          ///< number of pivots replaced in the last factorization
+    OSQPFloat*     refine_work;   ///< refinement workspace (allocated once pivots are replaced)
+
+    // Reduced system P + sigma I + A' diag(rho) A (ADMM iterations only)
+    OSQPInt              reduced;   ///< the factored matrix is the reduced system, stored permuted in KKT
+    OSQPCscMatrix*       Ared;      ///< constraint matrix (owned by the solver workspace)
+    OSQPCscMatrix*       Pred;      ///< objective matrix (owned by the solver workspace)
+    OSQPCscMatrix*       At;        ///< transpose of A
+    OSQPInt*             AtoAt;     ///< index mapping from A to At
+    OSQPCscMatrix*       Rpat;      ///< pattern of the unpermuted reduced matrix
+    OSQPInt*             RtoKKT;    ///< index mapping from Rpat to KKT
+    OSQPFloat*           rho_vec;   ///< parameter vector
+    OSQPFloat            rho;       ///< scalar parameter (used if rho_vec == NULL)
+
+    // Level scheduled triangular solves (lvl_p == NULL for the serial solves)
+    OSQPInt              nlevels;   ///< number of levels (height of the elimination tree)
+    OSQPInt*             lvl_p;     ///< start of each level in lvl_rows
+    OSQPInt*             lvl_rows;  ///< rows of L ordered by level
+    OSQPCscMatrix*       Lt;        ///< transpose of L, refreshed after every factorization
+    OSQPInt*             LtoLt;     ///< index mapping from L to Lt
 #endif
     OSQPInt        n;             ///< number of QP variables
     OSQPInt        m;             ///< number of QP constraints
@@ -97,8 +134,10 @@ struct qdldl {
     QDLDL_int*   iwork;
     QDLDL_bool*  bwork;
     QDLDL_float* fwork;
+#endif
 
-    OSQPCscMatrix* adj;
+#ifndef OSQP_EMBEDDED_MODE
+    OSQPCscMatrix* adj;           ///< Adjoint derivative system (only used by the derivatives)
 #endif
 
     /** @} */
@@ -190,13 +229,55 @@ OSQPInt update_linsys_solver_rho_vec_qdldl(qdldl_solver*      s,
  */
 void free_linsys_solver_qdldl(qdldl_solver* s);
 
-OSQPInt adjoint_derivative_qdldl(qdldl_solver**     s,
-                                 const OSQPMatrix*  P,
-                                 const OSQPMatrix*  G,
-                                 const OSQPMatrix*  A_eq,
-                                 const OSQPMatrix*  GDiagLambda,
-                                 const OSQPVectorf* slacks,
-                                       OSQPVectorf* rhs);
+/**
+ * Assemble the adjoint derivative system and compute its symbolic factorization
+ *
+ * The system is assembled directly from the scaled problem matrices, with the
+ * scaling undone entry by entry. If sym has the same adjoint sparsity pattern,
+ * its ordering and elimination tree are reused instead of being recomputed.
+ *
+ * @param  s               Pointer to store the analysed system in
+ * @param  sym             Previously analysed system to share the symbolic factorization with (or OSQP_NULL)
+ * @param  P               Scaled objective function matrix (upper triangular)
+ * @param  A               Scaled constraint matrix
+ * @param  Dinv            Inverse variable scaling (OSQP_NULL if unscaled)
+ * @param  Einv            Inverse constraint scaling (OSQP_NULL if unscaled)
+ * @param  cinv            Inverse cost scaling
+ * @param  derivative_data Constraint classification and dual variables at the solution
+ * @param  slacks          Inequality slacks G*x - h
+ * @return                 Exitflag
+ */
+OSQPInt adjoint_derivative_qdldl(qdldl_solver**            s,
+                                 const qdldl_solver*       sym,
+                                 const OSQPMatrix*         P,
+                                 const OSQPMatrix*         A,
+                                 const OSQPVectorf*        Dinv,
+                                 const OSQPVectorf*        Einv,
+                                 OSQPFloat                 cinv,
+                                 const OSQPDerivativeData* derivative_data,
+                                 const OSQPFloat*          slacks);
+
+/**
+ * Numerically factor an analysed adjoint derivative system
+ *
+ * Does not allocate memory or print, so different systems can be factored concurrently.
+ *
+ * @param  s Adjoint system from adjoint_derivative_qdldl
+ * @return   0 on success, 1 if the factorization failed
+ */
+OSQPInt adjoint_derivative_factor_qdldl(qdldl_solver* s);
+
+/**
+ * Solve the factored adjoint derivative system for a block of right-hand sides
+ *
+ * @param  s    Adjoint factorization from adjoint_derivative_factor_qdldl
+ * @param  rhs  Right-hand sides stored one after the other, overwritten by the solutions
+ * @param  nrhs Number of right-hand sides
+ * @return      Exitflag
+ */
+OSQPInt adjoint_derivative_solve_qdldl(qdldl_solver* s,
+                                       OSQPVectorf*  rhs,
+                                       OSQPInt       nrhs);
 
 #endif
 
@@ -0,0 +1,546 @@
+#include "glob_opts.h"
+#include "printing.h"
+#include "timing.h"
+#include "csc_utils.h"
+#include "qdldl.h"
+#include "qdldl_ordering.h"
+#include "amd.h"
+
+/* Subgraphs up to this size are ordered with AMD instead of being dissected */
+#define ND_LEAF_SIZE  (64)
+
+/* Maximum depth of the dissection, the remaining subgraphs are ordered with AMD */
+#define ND_MAX_DEPTH  (48)
+
+/* Both parts must be this many times larger than the separator, which is
+ * eliminated last as a dense block */
+#define ND_SEPARATOR_RATIO  (4)
+
+
+/* Fill the AMD control parameters from the settings */
+static void amd_controls(OSQPFloat*          control,
+                         const OSQPSettings* settings) {
+#ifdef OSQP_USE_LONG
+    amd_l_defaults(control);
+#else
+    amd_defaults(control);
+#endif
+
+    if (settings) {
+        control[AMD_DENSE]      = settings->amd_dense;
+        control[AMD_AGGRESSIVE] = (OSQPFloat)settings->amd_aggressive;
+    }
+}
+
+static OSQPInt amd_call(OSQPInt        n,
+                        const OSQPInt* Ap,
+                        const OSQPInt* Ai,
+                        OSQPInt*       perm,
+                        OSQPFloat*     control) {
+    OSQPFloat info[AMD_INFO];
+
+#ifdef OSQP_USE_LONG
+    return amd_l_order(n, Ap, Ai, perm, control, info);
+#else
+    return amd_order(n, Ap, Ai, perm, control, info);
+#endif
+}
+
+
+/*
+ * Nested dissection workspace
+ *
+ * The vertices of the graph are kept in one array, and every subgraph is a
+ * contiguous segment of it. Each dissection reorders its segment into
+ * [part 1 | part 2 | separator] and recurses into the two parts, so once all
+ * the leaves are ordered the array is the elimination order.
+ */
+typedef struct {
+    OSQPInt    n;
+    OSQPInt*   adjp;     ///< column pointers of the adjacency (both triangles, no diagonal)
+    OSQPInt*   adji;     ///< neighbours
+    OSQPInt*   nodes;    ///< vertices, in elimination order once ordered
+    OSQPInt*   label;    ///< subgraph the vertex belongs to
+    OSQPInt*   level;    ///< BFS level of the vertex (-1 if unreached)
+    OSQPInt*   queue;    ///< BFS queue
+    OSQPInt*   tmp;      ///< segment reordering and leaf workspace
+    OSQPInt    last_id;  ///< last subgraph label handed out
+    OSQPFloat* control;  ///< AMD controls for the leaves
+} nd_work;
+
+
+/* BFS from root within the subgraph labelled id. Returns the number of levels. */
+static OSQPInt nd_bfs(nd_work* w,
+                      OSQPInt  root,
+                      OSQPInt  id,
+                      OSQPInt* nreached,
+                      OSQPInt* last) {
+    OSQPInt head = 0, tail = 0, v, u, k, nlev = 0;
+
+    w->level[root]  = 0;
+    w->queue[tail++] = root;
+
+    while (head < tail) {
+        v = w->queue[head++];
+
+        if (w->level[v] + 1 > nlev) nlev = w->level[v] + 1;
+
+        for (k = w->adjp[v]; k < w->adjp[v + 1]; k++) {
+            u = w->adji[k];
+            if (w->label[u] == id && w->level[u] < 0) {
+                w->level[u]      = w->level[v] + 1;
+                w->queue[tail++] = u;
+            }
+        }
+    }
+
+    *nreached = tail;
+    *last     = w->queue[tail - 1];
+    return nlev;
+}
+
+static void nd_reset_levels(nd_work* w, const OSQPInt* seg, OSQPInt nn) {
+    OSQPInt k;
+
+    for (k = 0; k < nn; k++) w->level[seg[k]] = -1;
+}
+
+/* Order a segment with AMD on the subgraph it induces */
+static OSQPInt nd_leaf(nd_work* w, OSQPInt* seg, OSQPInt nn) {
+    OSQPInt  id = ++w->last_id;
+    OSQPInt  j, k, u, nnz, status;
+    OSQPInt* loc;
+    OSQPInt* Sp;
+    OSQPInt* Si;
+    OSQPInt* lperm;
+
+    if (nn <= 1) return 0;
+
+    // Local indices of the vertices (stored in level, which is free here)
+    nnz = 0;
+    for (j = 0; j < nn; j++) {
+        w->label[seg[j]] = id;
+        w->level[seg[j]] = j;
+    }
+    loc = w->level;
+
+    for (j = 0; j < nn; j++) {
+        for (k = w->adjp[seg[j]]; k < w->adjp[seg[j] + 1]; k++) {
+            if (w->label[w->adji[k]] == id) nnz++;
+        }
+    }
+
+    Sp    = (OSQPInt*)c_malloc((nn + 1) * sizeof(OSQPInt));
+    Si    = (OSQPInt*)c_malloc((nnz ? nnz : 1) * sizeof(OSQPInt));
+    lperm = (OSQPInt*)c_malloc(nn * sizeof(OSQPInt));
+
+    if (!Sp || !Si || !lperm) {
+        c_free(Sp);
+        c_free(Si);
+        c_free(lperm);
+        return -1;
+    }
+
+    nnz = 0;
+    for (j = 0; j < nn; j++) {
+        Sp[j] = nnz;
+        for (k = w->adjp[seg[j]]; k < w->adjp[seg[j] + 1]; k++) {
+            u = w->adji[k];
+            if (w->label[u] == id) Si[nnz++] = loc[u];
+        }
+    }
+    Sp[nn] = nnz;
+
+    status = amd_call(nn, Sp, Si, lperm, w->control);
+
+    if (status >= 0) {
+        for (j = 0; j < nn; j++) w->tmp[j] = seg[lperm[j]];
+        for (j = 0; j < nn; j++) seg[j] = w->tmp[j];
+    }
+
+    nd_reset_levels(w, seg, nn);
+
+    c_free(Sp);
+    c_free(Si);
+    c_free(lperm);
+
+    return status < 0 ? -1 : 0;
+}
+
+static OSQPInt nd_dissect(nd_work* w, OSQPInt* seg, OSQPInt nn, OSQPInt depth) {
+    OSQPInt id, root, last, nreached, nlev, sep_lev, cum, k, v, u;
+    OSQPInt n1, n2, ns, i1, i2, is;
+    OSQPInt* counts;
+
+    if (nn <= ND_LEAF_SIZE || depth >= ND_MAX_DEPTH)
+        return nd_leaf(w, seg, nn);
+
+    id = ++w->last_id;
+    for (k = 0; k < nn; k++) w->label[seg[k]] = id;
+
+    // Root the level structure at a pseudo-peripheral vertex: the vertex
+    // reached last from an arbitrary start
+    nd_bfs(w, seg[0], id, &nreached, &last);
+    nd_reset_levels(w, seg, nn);
+    root = last;
+    nlev = nd_bfs(w, root, id, &nreached, &last);
+
+    if (nreached < nn) {
+        // The subgraph is disconnected: the reached component and the rest
+        // are independent, so no separator is needed
+        sep_lev = nlev;
+    }
+    else {
+        if (nlev < 3) {
+            nd_reset_levels(w, seg, nn);
+            return nd_leaf(w, seg, nn);
+        }
+
+        // Separate at the level splitting the vertices in half
+        counts = w->tmp;
+        for (k = 0; k < nlev; k++) counts[k] = 0;
+        for (k = 0; k < nn; k++) counts[w->level[seg[k]]]++;
+
+        cum = 0;
+        for (sep_lev = 0; sep_lev < nlev - 1; sep_lev++) {
+            cum += counts[sep_lev];
+            if (2 * cum >= nn) break;
+        }
+        if (sep_lev == 0) sep_lev = 1;
+        if (sep_lev >= nlev - 1) sep_lev = nlev - 2;
+    }
+
+    // Split the segment: vertices before the separating level go first,
+    // vertices after it (or unreached) second, and the separator last. Vertices
+    // of the separating level that have no neighbour after it join the first part.
+    n1 = n2 = ns = 0;
+    for (k = 0; k < nn; k++) {
+        v = seg[k];
+
+        if (w->level[v] >= 0 && w->level[v] < sep_lev) {
+            n1++;
+        }
+        else if (w->level[v] < 0 || w->level[v] > sep_lev) {
+            n2++;
+        }
+        else {
+            for (u = w->adjp[v]; u < w->adjp[v + 1]; u++) {
+                if (w->label[w->adji[u]] == id && w->level[w->adji[u]] == sep_lev + 1) break;
+            }
+            if (u < w->adjp[v + 1]) {
+                ns++;
+                w->level[v] = -2;   // mark as separator
+            }
+            else {
+                n1++;
+                w->level[v] = sep_lev - 1;
+            }
+        }
+    }
+
+    // A separator that is large compared to the parts costs more fill than it saves
+    if (n1 == 0 || n2 == 0 ||
+        ND_SEPARATOR_RATIO * ns > n1 || ND_SEPARATOR_RATIO * ns > n2) {
+        nd_reset_levels(w, seg, nn);
+        return nd_leaf(w, seg, nn);
+    }
+
+    i1 = 0;
+    i2 = n1;
+    is = n1 + n2;
+    for (k = 0; k < nn; k++) {
+        v = seg[k];
+
+        if (w->level[v] == -2)
+            w->tmp[is++] = v;
+        else if (w->level[v] >= 0 && w->level[v] < sep_lev)
+            w->tmp[i1++] = v;
+        else
+            w->tmp[i2++] = v;
+    }
+    for (k = 0; k < nn; k++) seg[k] = w->tmp[k];
+    nd_reset_levels(w, seg, nn);
+
+    // The separator is eliminated last, in its current order
+    if (nd_dissect(w, seg, n1, depth + 1)) return -1;
+    return nd_dissect(w, seg + n1, n2, depth + 1);
+}
+
+/* Nested dissection ordering of the upper triangular matrix A */
+static OSQPInt nesdis_order(OSQPInt*             perm,
+                            const OSQPCscMatrix* A,
+                            OSQPFloat*           control) {
+    nd_work   w;
+    OSQPInt   n = A->n;
+    OSQPInt   i, j, k, nsparse, ndense, status = -1;
+    OSQPFloat dense;
+
+    w.n       = n;
+    w.last_id = 0;
+    w.control = control;
+    w.adjp    = (OSQPInt*)c_calloc(n + 1, sizeof(OSQPInt));
+    w.adji    = (OSQPInt*)c_malloc((2 * A->p[n] + 1) * sizeof(OSQPInt));
+    w.nodes   = perm;
+    w.label   = (OSQPInt*)c_calloc(n, sizeof(OSQPInt));
+    w.level   = (OSQPInt*)c_malloc(n * sizeof(OSQPInt));
+    w.queue   = (OSQPInt*)c_malloc(n * sizeof(OSQPInt));
+    w.tmp     = (OSQPInt*)c_malloc((n + 1) * sizeof(OSQPInt));
+
+    if (w.adjp && w.adji && w.label && w.level && w.queue && w.tmp) {
+        // Symmetric adjacency without the diagonal
+        for (j = 0; j < n; j++) {
+            for (k = A->p[j]; k < A->p[j + 1]; k++) {
+                i = A->i[k];
+                if (i != j) {
+                    w.adjp[i + 1]++;
+                    w.adjp[j + 1]++;
+                }
+            }
+        }
+        for (j = 0; j < n; j++) w.adjp[j + 1] += w.adjp[j];
+
+        for (j = 0; j < n; j++) w.queue[j] = w.adjp[j];
+        for (j = 0; j < n; j++) {
+            for (k = A->p[j]; k < A->p[j + 1]; k++) {
+                i = A->i[k];
+                if (i != j) {
+                    w.adji[w.queue[i]++] = j;
+                    w.adji[w.queue[j]++] = i;
+                }
+            }
+        }
+
+        // Dense rows (as defined by AMD) would connect every part of the graph,
+        // so they are kept out of the dissection and eliminated last
+        dense = control[AMD_DENSE] < 0 ? (OSQPFloat)n :
+                c_max(16.0, control[AMD_DENSE] * c_sqrt((OSQPFloat)n));
+
+        nsparse = 0;
+        ndense  = 0;
+        for (j = 0; j < n; j++) {
+            w.level[j] = -1;
+
+            if (w.adjp[j + 1] - w.adjp[j] > dense) {
+                w.label[j] = -1;
+                w.nodes[n - 1 - ndense++] = j;
+            }
+            else {
+                w.nodes[nsparse++] = j;
+            }
+        }
+
+        status = nd_dissect(&w, w.nodes, nsparse, 0);
+    }
+
+    c_free(w.adjp);
+    c_free(w.adji);
+    c_free(w.label);
+    c_free(w.level);
+    c_free(w.queue);
+    c_free(w.tmp);
+
+    return status;
+}
+
+/* Copy the user permutation, checking it is a permutation of 0..n-1 */
+static OSQPInt user_order(OSQPInt*       perm,
+                          const OSQPInt* user,
+                          OSQPInt        n) {
+    OSQPInt  k;
+    OSQPInt* seen = (OSQPInt*)c_calloc(n, sizeof(OSQPInt));
+
+    if (!seen) return -1;
+
+    for (k = 0; k < n; k++) {
+        if (user[k] < 0 || user[k] >= n || seen[user[k]]) {
+            c_eprint("kkt_permutation is not a permutation of the %d KKT rows", (int)n);
+            c_free(seen);
+            return -1;
+        }
+        seen[user[k]] = 1;
+        perm[k]       = user[k];
+    }
+
+    c_free(seen);
+    return 0;
+}
+
+/* Ordering compared by OSQP_ORDERING_AUTO */
+typedef struct {
+    osqp_ordering_type ordering;
+    const char*        name;
+    OSQPInt*           perm;
+    OSQPInt            status;
+    OSQPInt            Lnz;     ///< predicted nonzeros of L
+    OSQPFloat          flops;   ///< predicted flops of the numeric factorization
+    OSQPFloat          time;    ///< ordering and symbolic analysis time
+} ordering_candidate;
+
+/*
+ * Predict the size of the LDL factor of A ordered by perm from the elimination
+ * tree, without factoring. The flops of the factorization are estimated as the
+ * sum of the squared column counts of L.
+ */
+OSQPInt kkt_ordering_fill(const OSQPInt*       perm,
+                          const OSQPCscMatrix* A,
+                          OSQPInt*             Lnz,
+                          OSQPFloat*           flops) {
+    OSQPInt        n    = A->n;
+    OSQPInt*       Pinv = csc_pinv(perm, n);
+    OSQPCscMatrix* C    = Pinv ? csc_symperm(A, Pinv, OSQP_NULL, 0) : OSQP_NULL;
+    OSQPInt*       work = (OSQPInt*)c_malloc(3 * n * sizeof(OSQPInt));
+    OSQPInt        j, sum_Lnz = -1;
+
+    if (C && work) {
+        // work holds the etree workspace, the column counts and the etree
+        sum_Lnz = QDLDL_etree(n, C->p, C->i, work, work + n, work + 2 * n);
+
+        *flops = 0.0;
+        for (j = 0; j < n && sum_Lnz >= 0; j++)
+            *flops += (OSQPFloat)work[n + j] * (OSQPFloat)work[n + j];
+    }
+    *Lnz = sum_Lnz;
+
+    c_free(Pinv);
+    csc_spfree(C);
+    c_free(work);
+
+    return sum_Lnz < 0 ? -1 : 0;
+}
+
+/*
+ * Compute the candidate orderings (in parallel when OpenMP is available) and
+ * keep the one with the fewest predicted nonzeros, which sets the cost of every
+ * solve; ties are broken by the factorization flops and then by the order of the
+ * candidates. Small matrices are ordered with AMD without comparing.
+ *
+ * The candidates allocate through c_malloc, also inside AMD, so they are only
+ * computed in parallel with the standard allocator: a custom memory manager is
+ * not required to be thread-safe. Nothing is printed inside the parallel region.
+ */
+static OSQPInt auto_order(OSQPInt*             perm,
+                          const OSQPCscMatrix* A,
+                          const OSQPSettings*  settings,
+                          OSQPInt              allow_user,
+                          OSQPFloat*           control) {
+    ordering_candidate cand[3] = {
+        {OSQP_ORDERING_AMD,    "amd",    OSQP_NULL, -1, 0, 0.0, 0.0},
+        {OSQP_ORDERING_NESDIS, "nesdis", OSQP_NULL, -1, 0, 0.0, 0.0},
+        {OSQP_ORDERING_USER,   "user",   OSQP_NULL, -1, 0, 0.0, 0.0}
+    };
+    OSQPInt n      = A->n;
+    OSQPInt ncand  = 2;
+    OSQPInt best   = -1;
+    OSQPInt status = 0;
+    OSQPInt k;
+
+    if (n < OSQP_AUTO_ORDERING_DIM)
+        return amd_call(n, A->p, A->i, perm, control) < 0 ? -1 : 0;
+
+    // The user permutation competes when one is given for this matrix
+    if (allow_user && settings->kkt_permutation)
+        ncand = 3;
+
+    for (k = 0; k < ncand; k++) {
+        cand[k].perm = (OSQPInt*)c_malloc(n * sizeof(OSQPInt));
+        if (!cand[k].perm) status = -1;
+    }
+
+    // The user permutation is only checked and copied, which may print an error
+    if (!status && ncand == 3)
+        cand[2].status = user_order(cand[2].perm, settings->kkt_permutation, n);
+
+    if (!status) {
+#if defined(_OPENMP) && !defined(OSQP_CUSTOM_MEMORY)
+#pragma omp parallel for
+#endif
+        for (k = 0; k < ncand; k++) {
+#ifdef OSQP_ENABLE_PROFILING
+            OSQPTimer* timer = OSQPTimer_new();
+            if (timer) osqp_tic(timer);
+#endif
+            switch (cand[k].ordering) {
+            case OSQP_ORDERING_NESDIS:
+                cand[k].status = nesdis_order(cand[k].perm, A, control);
+                break;
+            case OSQP_ORDERING_USER:
+                break;
+            default:
+                cand[k].status = amd_call(n, A->p, A->i, cand[k].perm, control) < 0 ? -1 : 0;
+                break;
+            }
+            if (!cand[k].status)
+                cand[k].status = kkt_ordering_fill(cand[k].perm, A, &cand[k].Lnz, &cand[k].flops);
+#ifdef OSQP_ENABLE_PROFILING
+            if (timer) {
+                cand[k].time = osqp_toc(timer);
+                OSQPTimer_free(timer);
+            }
+#endif
+        }
+
+        for (k = 0; k < ncand && !status; k++) {
+            if (cand[k].status) {
+                // An invalid user permutation is an error, not a losing candidate
+                if (cand[k].ordering == OSQP_ORDERING_USER) status = -1;
+                continue;
+            }
+            if (best < 0 || cand[k].Lnz < cand[best].Lnz ||
+                (cand[k].Lnz == cand[best].Lnz && cand[k].flops < cand[best].flops))
+                best = k;
+        }
+
+#ifdef OSQP_ENABLE_PRINTING
+        if (settings->verbose) {
+            c_print("kkt ordering (n = %i):\n", (int)n);
+            for (k = 0; k < ncand; k++) {
+                if (cand[k].status)
+                    c_print("  %-7s failed\n", cand[k].name);
+                else
+                    c_print("  %-7s nnz(L) = %i, flops = %.2e, time = %.2es%s\n",
+                            cand[k].name, (int)cand[k].Lnz, cand[k].flops, cand[k].time,
+                            !status && k == best ? " (selected)" : "");
+            }
+        }
+#endif
+
+        if (!status && best >= 0) {
+            for (k = 0; k < n; k++) perm[k] = cand[best].perm[k];
+        }
+        else {
+            status = -1;
+        }
+    }
+
+    for (k = 0; k < ncand; k++) c_free(cand[k].perm);
+
+    return status;
+}
+
+
+OSQPInt kkt_ordering(OSQPInt*             perm,
+                     const OSQPCscMatrix* A,
+                     const OSQPSettings*  settings,
+                     OSQPInt              allow_user) {
+    OSQPFloat control[AMD_CONTROL];
+    osqp_ordering_type ordering = settings ? settings->kkt_ordering : OSQP_ORDERING_AMD;
+
+    amd_controls(control, settings);
+
+    switch (ordering) {
+    case OSQP_ORDERING_AUTO:
+        return auto_order(perm, A, settings, allow_user, control);
+
+    case OSQP_ORDERING_USER:
+        if (allow_user)
+            return user_order(perm, settings->kkt_permutation, A->n);
+        return amd_call(A->n, A->p, A->i, perm, control) < 0 ? -1 : 0;
+
+    case OSQP_ORDERING_NESDIS:
+        return nesdis_order(perm, A, control);
+
+    case OSQP_ORDERING_AMD:
+    default:
+        return amd_call(A->n, A->p, A->i, perm, control) < 0 ? -1 : 0;
+    }
+}
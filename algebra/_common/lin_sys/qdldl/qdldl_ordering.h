@@ -0,0 +1,49 @@
+#ifndef QDLDL_ORDERING_H
+#define QDLDL_ORDERING_H
+
+
+#include "osqp.h"
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compute a fill-reducing ordering of a symmetric matrix
+ *
+ * The ordering is selected by settings->kkt_ordering. The user-supplied
+ * permutation is only used when allow_user is set, since it is defined for the
+ * KKT matrix of the ADMM iterations; other matrices (e.g. the polishing KKT)
+ * fall back to AMD, or leave it out of the comparison of OSQP_ORDERING_AUTO.
+ *
+ * @param  perm       Output permutation; perm[k] is the row/column of A pivoted k-th
+ * @param  A          Upper triangular part of the matrix (CSC form)
+ * @param  settings   Solver settings (OSQP_NULL for AMD with the default controls)
+ * @param  allow_user Use settings->kkt_permutation if it is selected
+ * @return            0 on success, negative on failure
+ */
+OSQPInt kkt_ordering(OSQPInt*             perm,
+                     const OSQPCscMatrix* A,
+                     const OSQPSettings*  settings,
+                     OSQPInt              allow_user);
+
+/**
+ * Predict the size of the LDL factor of a symmetrically permuted matrix
+ *
+ * @param  perm   Permutation; perm[k] is the row/column of A pivoted k-th
+ * @param  A      Upper triangular part of the matrix (CSC form, values unused)
+ * @param  Lnz    Output number of nonzeros in L
+ * @param  flops  Output factorization flops, as the sum of the squared column counts of L
+ * @return        0 on success, negative on failure
+ */
+OSQPInt kkt_ordering_fill(const OSQPInt*       perm,
+                          const OSQPCscMatrix* A,
+                          OSQPInt*             Lnz,
+                          OSQPFloat*           flops);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QDLDL_ORDERING_H */
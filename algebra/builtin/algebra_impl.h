@@ -38,6 +38,17 @@ typedef enum OSQPMatrix_symmetry_type {NONE,TRIU} OSQPMatrix_symmetry_type;
 struct OSQPMatrix_ {
   OSQPCscMatrix*           csc;
   OSQPMatrix_symmetry_type symmetry;
+#ifdef OSQP_ENABLE_SPMV_UNROLL
+  /* Generated products y = M*x and y = M'*x specialized to the pattern of csc */
+  void (*Axpy)(const OSQPFloat* Mx, const OSQPFloat* x, OSQPFloat* y);
+  void (*Atxpy)(const OSQPFloat* Mx, const OSQPFloat* x, OSQPFloat* y);
+#endif
+#ifndef OSQP_EMBEDDED_MODE
+  /* Both triangles of a TRIU matrix for the threaded symmetric product, kept
+   * in sync with csc (OSQP_NULL when the product uses csc directly) */
+  OSQPCscMatrix*           symm;
+  OSQPInt*                 symm_src;   ///< entry of csc holding the value of each entry of symm
+#endif
 };
 
 #ifdef __cplusplus
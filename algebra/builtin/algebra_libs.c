@@ -1,6 +1,10 @@
 #include "osqp_api_constants.h"
 #include "osqp_api_types.h"
 #include "qdldl_interface.h"
+#ifndef OSQP_EMBEDDED_MODE
+#include "dense_interface.h"
+#include "stage_interface.h"
+#endif
 #include "profilers.h"
 #include "util.h"
 
@@ -70,25 +74,47 @@ OSQPInt osqp_algebra_init_linsys_solver(LinSysSolver**      s,
   switch (settings->linsys_solver) {
   default:
   case OSQP_DIRECT_SOLVER:
-    retval = init_linsys_solver_qdldl((qdldl_solver **)s, P, A, rho_vec, settings, polishing);
+    // The KKT matrix is factored stage by stage when requested, and as a
+    // dense matrix for small dense problems
+    if (use_linsys_solver_stage(settings, polishing))
+      retval = init_linsys_solver_stage((stage_solver **)s, P, A, rho_vec, settings, polishing);
+    else if (use_linsys_solver_dense(P, A, settings))
+      retval = init_linsys_solver_dense((dense_solver **)s, P, A, rho_vec, settings, polishing);
+    else
+      retval = init_linsys_solver_qdldl((qdldl_solver **)s, P, A, rho_vec, settings, polishing);
   }
 
   osqp_profiler_sec_pop(OSQP_PROFILER_SEC_LINSYS_INIT);
   return retval;
 }
 
-OSQPInt adjoint_derivative_linsys_solver(LinSysSolver**      s,
-                                         const OSQPSettings* settings,
-                                         const OSQPMatrix*   P,
-                                         const OSQPMatrix*   G,
-                                         const OSQPMatrix*   A_eq,
-                                         OSQPMatrix*         GDiagLambda,
-                                         OSQPVectorf*        slacks,
-                                         OSQPVectorf*        rhs) {
+OSQPInt adjoint_derivative_linsys_solver(LinSysSolver**            s,
+                                         const OSQPSettings*       settings,
+                                         const LinSysSolver*       sym,
+                                         const OSQPMatrix*         P,
+                                         const OSQPMatrix*         A,
+                                         const OSQPVectorf*        Dinv,
+                                         const OSQPVectorf*        Einv,
+                                         OSQPFloat                 cinv,
+                                         const OSQPDerivativeData* derivative_data,
+                                         const OSQPFloat*          slacks) {
 
   OSQP_UnusedVar(settings);
 
-  return adjoint_derivative_qdldl((qdldl_solver **)s, P, G, A_eq, GDiagLambda, slacks, rhs);
+  return adjoint_derivative_qdldl((qdldl_solver **)s, (const qdldl_solver *)sym,
+                                  P, A, Dinv, Einv, cinv, derivative_data, slacks);
+}
+
+OSQPInt adjoint_derivative_linsys_factor(LinSysSolver* s) {
+
+  return adjoint_derivative_factor_qdldl((qdldl_solver *)s);
+}
+
+OSQPInt adjoint_derivative_linsys_solve(LinSysSolver* s,
+                                        OSQPVectorf*  rhs,
+                                        OSQPInt       nrhs) {
+
+  return adjoint_derivative_solve_qdldl((qdldl_solver *)s, rhs, nrhs);
 }
 
 #endif
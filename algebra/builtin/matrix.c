@@ -4,10 +4,88 @@
 #include "csc_math.h"
 #include "csc_utils.h"
 #include "printing.h"
+#include "util.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 #ifndef OSQP_EMBEDDED_MODE
 
+/* Minimum number of entries of an upper triangular matrix for the threaded
+ * symmetric product. Storing both triangles about doubles the entries read,
+ * which only pays off when they are split among several threads. */
+#define SYMM_SPMV_MIN_NNZ (10000)
+
+/*  symmetric storage -------------------------------------------------------*/
+
+// Decide whether the products with the upper triangular matrix A use both triangles
+static OSQPInt use_symm_spmv(const OSQPCscMatrix* A) {
+#ifdef _OPENMP
+  return omp_get_max_threads() > 1 && A->p[A->n] >= SYMM_SPMV_MIN_NNZ;
+#else
+  OSQP_UnusedVar(A);
+  return 0;
+#endif
+}
+
+// Copy the values of the upper triangle into both triangles
+static void symm_update(OSQPMatrix* M) {
+  OSQPInt k;
+
+  if (!M->symm) return;
+
+  for (k = 0; k < M->symm->p[M->symm->n]; k++) {
+    M->symm->x[k] = M->csc->x[M->symm_src[k]];
+  }
+}
+
+// Store both triangles of the upper triangular matrix M. Returns 1 on failure
+static OSQPInt symm_new(OSQPMatrix* M) {
+  const OSQPCscMatrix* A = M->csc;
+  OSQPInt              n = A->n;
+  OSQPInt              i, j, k;
+  OSQPInt*             next;
+
+  M->symm     = csc_spalloc(n, n, 2 * A->p[n], 1, 0);
+  M->symm_src = (OSQPInt *)c_malloc((2 * A->p[n] + 1) * sizeof(OSQPInt));
+  next        = (OSQPInt *)c_calloc(n + 1, sizeof(OSQPInt));
+
+  if (!M->symm || !M->symm_src || !next) {
+    c_free(next);
+    return 1;
+  }
+
+  /* Entry (i,j) of the upper triangle goes to column j and, above the
+   * diagonal, to column i. Filling the columns in order of j keeps the rows
+   * of every column sorted. */
+  for (j = 0; j < n; j++) {
+    for (k = A->p[j]; k < A->p[j+1]; k++) {
+      next[j+1]++;
+      if (A->i[k] != j) next[A->i[k]+1]++;
+    }
+  }
+  for (j = 0; j < n; j++) next[j+1] += next[j];
+  for (j = 0; j <= n; j++) M->symm->p[j] = next[j];
+
+  for (j = 0; j < n; j++) {
+    for (k = A->p[j]; k < A->p[j+1]; k++) {
+      i = A->i[k];
+      M->symm->i[next[j]]   = i;
+      M->symm_src[next[j]++] = k;
+      if (i != j) {
+        M->symm->i[next[i]]   = j;
+        M->symm_src[next[i]++] = k;
+      }
+    }
+  }
+  c_free(next);
+
+  symm_update(M);
+  return 0;
+}
+
 /*  logical test functions ----------------------------------------------------*/
 
 OSQPInt OSQPMatrix_is_eq(const OSQPMatrix* A,
@@ -25,7 +103,7 @@ OSQPInt OSQPMatrix_is_eq(const OSQPMatrix* A,
 OSQPMatrix* OSQPMatrix_new_from_csc(const OSQPCscMatrix* A,
                                           OSQPInt        is_triu) {
 
-  OSQPMatrix* out = c_malloc(sizeof(OSQPMatrix));
+  OSQPMatrix* out = c_calloc(1, sizeof(OSQPMatrix));
   if(!out) return OSQP_NULL;
 
   if(is_triu) out->symmetry = TRIU;
@@ -37,16 +115,20 @@ OSQPMatrix* OSQPMatrix_new_from_csc(const OSQPCscMatrix* A,
     c_free(out);
     return OSQP_NULL;
   }
-  else{
-    return out;
+
+  if (is_triu && use_symm_spmv(out->csc) && symm_new(out)) {
+    OSQPMatrix_free(out);
+    return OSQP_NULL;
   }
+
+  return out;
 }
 
 OSQPCscMatrix* OSQPMatrix_get_csc(const OSQPMatrix* M) {return csc_copy(M->csc);}
 
 // Make of a copy of a matrix
 OSQPMatrix* OSQPMatrix_copy_new(const OSQPMatrix* A) {
-    OSQPMatrix* out = c_malloc(sizeof(OSQPMatrix));
+    OSQPMatrix* out = c_calloc(1, sizeof(OSQPMatrix));
     if(!out) return OSQP_NULL;
 
     out->symmetry = A->symmetry;
@@ -56,16 +138,20 @@ OSQPMatrix* OSQPMatrix_copy_new(const OSQPMatrix* A) {
         c_free(out);
         return OSQP_NULL;
     }
-    else{
-        return out;
+
+    if (A->symm && symm_new(out)) {
+        OSQPMatrix_free(out);
+        return OSQP_NULL;
     }
+
+    return out;
 }
 
 // Convert an upper triangular matrix into a fully populated matrix
 OSQPMatrix* OSQPMatrix_triu_to_symm(const OSQPMatrix* A) {
 
     if (A->symmetry == TRIU) {
-        OSQPMatrix* out = c_malloc(sizeof(OSQPMatrix));
+        OSQPMatrix* out = c_calloc(1, sizeof(OSQPMatrix));
         if(!out) return OSQP_NULL;
 
         out->symmetry = NONE;
@@ -86,7 +172,7 @@ OSQPMatrix* OSQPMatrix_triu_to_symm(const OSQPMatrix* A) {
 OSQPMatrix* OSQPMatrix_vstack(const OSQPMatrix* A,
                               const OSQPMatrix* B) {
     if ((A->symmetry == NONE) && (B->symmetry == NONE)) {
-        OSQPMatrix* out = c_malloc(sizeof(OSQPMatrix));
+        OSQPMatrix* out = c_calloc(1, sizeof(OSQPMatrix));
         if(!out) return OSQP_NULL;
 
         out->symmetry = NONE;
@@ -113,6 +199,9 @@ void OSQPMatrix_update_values(OSQPMatrix*      M,
                               const OSQPInt*   Mx_new_idx,
                               OSQPInt          M_new_n) {
   csc_update_values(M->csc, Mx_new, Mx_new_idx, M_new_n);
+#ifndef OSQP_EMBEDDED_MODE
+  symm_update(M);
+#endif
 }
 
 /* Matrix dimensions and data access */
@@ -129,16 +218,25 @@ OSQPInt    OSQPMatrix_get_nz(const OSQPMatrix* M) {return M->csc->p[M->csc->n];}
 void OSQPMatrix_mult_scalar(OSQPMatrix *A,
                             OSQPFloat   sc){
   csc_scale(A->csc,sc);
+#ifndef OSQP_EMBEDDED_MODE
+  symm_update(A);
+#endif
 }
 
 void OSQPMatrix_lmult_diag(OSQPMatrix*        A,
                            const OSQPVectorf* L) {
   csc_lmult_diag(A->csc, OSQPVectorf_data(L));
+#ifndef OSQP_EMBEDDED_MODE
+  symm_update(A);
+#endif
 }
 
 void OSQPMatrix_rmult_diag(OSQPMatrix* A,
                            const OSQPVectorf* R) {
   csc_rmult_diag(A->csc, R->values);
+#ifndef OSQP_EMBEDDED_MODE
+  symm_update(A);
+#endif
 }
 
 void OSQPMatrix_AtDA_extract_diag(const OSQPMatrix*  A,
@@ -159,6 +257,20 @@ void OSQPMatrix_Axpy(const OSQPMatrix*  A,
                            OSQPFloat    alpha,
                            OSQPFloat    beta) {
 
+#ifdef OSQP_ENABLE_SPMV_UNROLL
+  if (alpha == 1.0 && beta == 0.0) {
+    A->Axpy(A->csc->x, x->values, y->values);
+    return;
+  }
+#endif
+
+#ifndef OSQP_EMBEDDED_MODE
+  if (A->symm) {
+    csc_Axpy_sym_full(A->symm, x->values, y->values, alpha, beta);
+    return;
+  }
+#endif
+
   if(A->symmetry == NONE){
     //full matrix
     csc_Axpy(A->csc, x->values, y->values, alpha, beta);
@@ -175,6 +287,20 @@ void OSQPMatrix_Atxpy(const OSQPMatrix*  A,
                             OSQPFloat    alpha,
                             OSQPFloat    beta) {
 
+#ifdef OSQP_ENABLE_SPMV_UNROLL
+  if (alpha == 1.0 && beta == 0.0) {
+    A->Atxpy(A->csc->x, x->values, y->values);
+    return;
+  }
+#endif
+
+#ifndef OSQP_EMBEDDED_MODE
+  if (A->symm) {
+    csc_Axpy_sym_full(A->symm, x->values, y->values, alpha, beta);
+    return;
+  }
+#endif
+
    if(A->symmetry == NONE) csc_Atxpy(A->csc, x->values, y->values, alpha, beta);
    else            csc_Axpy_sym_triu(A->csc, x->values, y->values, alpha, beta);
 }
@@ -207,7 +333,11 @@ void OSQPMatrix_row_norm_inf(const OSQPMatrix*  M,
 #ifndef OSQP_EMBEDDED_MODE
 
 void OSQPMatrix_free(OSQPMatrix* M){
-  if (M) csc_spfree(M->csc);
+  if (M) {
+    csc_spfree(M->csc);
+    csc_spfree(M->symm);
+    c_free(M->symm_src);
+  }
   c_free(M);
 }
 
@@ -228,7 +358,7 @@ OSQPMatrix* OSQPMatrix_submatrix_byrows(const OSQPMatrix*  A,
 
   if(!M) return OSQP_NULL;
 
-  out = c_malloc(sizeof(OSQPMatrix));
+  out = c_calloc(1, sizeof(OSQPMatrix));
 
   if(!out){
     csc_spfree(M);
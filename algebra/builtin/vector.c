@@ -248,6 +248,23 @@ OSQPFloat OSQPVectorf_norm_2(const OSQPVectorf* v) {
     return c_sqrt(normval);
 }
 
+OSQPInt OSQPVectorf_count_at_bounds(const OSQPVectorf* x,
+                                    const OSQPVectorf* l,
+                                    const OSQPVectorf* u) {
+    OSQPInt i;
+    OSQPInt length = x->length;
+    OSQPInt count  = 0;
+
+    OSQPFloat* xv = x->values;
+    OSQPFloat* lv = l->values;
+    OSQPFloat* uv = u->values;
+
+    for (i = 0; i < length; i++) {
+        count += (xv[i] == lv[i] || xv[i] == uv[i]);
+    }
+    return count;
+}
+
 #endif /* ifndef OSQP_EMBEDDED_MODE */
 
 OSQPInt OSQPVectorf_length(const OSQPVectorf* a) {return a->length;}
@@ -305,6 +305,15 @@ void cuda_vec_bounds_type(OSQPInt*         d_iseq,
                           OSQPInt          n,
                           OSQPInt*         h_has_changed);
 
+/**
+ * h_count = number of elements with d_x[i] == d_l[i] or d_x[i] == d_u[i]
+ */
+void cuda_vec_count_at_bounds(const OSQPFloat* d_x,
+                              const OSQPFloat* d_l,
+                              const OSQPFloat* d_u,
+                              OSQPInt          n,
+                              OSQPInt*         h_count);
+
 void cuda_vec_set_sc_if_lt(OSQPFloat*       d_x,
                            const OSQPFloat* d_z,
                            OSQPFloat        testval,
@@ -112,9 +112,10 @@ OSQPInt init_linsys_solver_cudapcg(cudapcg_solver**    sp,
   cudapcg_solver *s = (cudapcg_solver *)c_calloc(1, sizeof(cudapcg_solver));
   *sp = s;
 
-  /* Assign type and the number of threads */
-  s->type     = OSQP_INDIRECT_SOLVER;
-  s->nthreads = 1;
+  /* Assign type and the number of threads (the system isn't factored) */
+  s->type       = OSQP_INDIRECT_SOLVER;
+  s->nthreads   = 1;
+  s->factor_nnz = 0;
 
   /* Problem dimensions */
   n = OSQPMatrix_get_n(P);
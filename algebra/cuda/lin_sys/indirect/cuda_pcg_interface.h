@@ -67,6 +67,9 @@ typedef struct cudapcg_solver_ {
   /* threads count */
   OSQPInt nthreads;
 
+  /* Factorization size (always 0, the system isn't factored) */
+  OSQPInt factor_nnz;
+
   /* Dimensions */
   OSQPInt n;                  ///<  dimension of the linear system
   OSQPInt m;                  ///<  number of rows in A
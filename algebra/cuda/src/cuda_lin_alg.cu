@@ -316,6 +316,22 @@ __global__ void vec_bounds_type_kernel(OSQPInt*         iseq,
   }
 }
 
+__global__ void vec_count_at_bounds_kernel(const OSQPFloat* x,
+                                           const OSQPFloat* l,
+                                           const OSQPFloat* u,
+                                           OSQPInt*         count,
+                                           OSQPInt          n) {
+
+  OSQPInt idx = threadIdx.x + blockDim.x * blockIdx.x;
+  OSQPInt grid_size = blockDim.x * gridDim.x;
+
+  for(OSQPInt i = idx; i < n; i += grid_size) {
+    if (x[i] == l[i] || x[i] == u[i]) {
+      atomicAdd(count, 1);
+    }
+  }
+}
+
 __global__ void vec_set_sc_if_lt_kernel(OSQPFloat*       x,
                                         const OSQPFloat* z,
                                         OSQPFloat        testval,
@@ -936,6 +952,25 @@ void cuda_vec_bounds_type(OSQPInt*         d_iseq,
   cuda_free((void **) &d_has_changed);
 }
 
+void cuda_vec_count_at_bounds(const OSQPFloat* d_x,
+                              const OSQPFloat* d_l,
+                              const OSQPFloat* d_u,
+                              OSQPInt          n,
+                              OSQPInt*         h_count) {
+
+  OSQPInt *d_count;
+  OSQPInt number_of_blocks = (n / THREADS_PER_BLOCK) + 1;
+
+  /* Initialize d_count to zero */
+  cuda_calloc((void **) &d_count, sizeof(OSQPInt));
+
+  vec_count_at_bounds_kernel<<<number_of_blocks, THREADS_PER_BLOCK>>>(d_x, d_l, d_u, d_count, n);
+
+  checkCudaErrors(cudaMemcpy(h_count, d_count, sizeof(OSQPInt), cudaMemcpyDeviceToHost));
+
+  cuda_free((void **) &d_count);
+}
+
 void cuda_vec_set_sc_if_lt(OSQPFloat*       d_x,
                            const OSQPFloat* d_z,
                            OSQPFloat        testval,
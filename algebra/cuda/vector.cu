@@ -444,6 +444,17 @@ OSQPInt OSQPVectorf_ew_bounds_type(OSQPVectori*       iseq,
   return has_changed;
 }
 
+OSQPInt OSQPVectorf_count_at_bounds(const OSQPVectorf* x,
+                                    const OSQPVectorf* l,
+                                    const OSQPVectorf* u) {
+
+  OSQPInt count;
+
+  cuda_vec_count_at_bounds(x->d_val, l->d_val, u->d_val, x->length, &count);
+
+  return count;
+}
+
 void OSQPVectorf_set_scalar_if_lt(OSQPVectorf*       x,
                                   const OSQPVectorf* z,
                                   OSQPFloat          testval,
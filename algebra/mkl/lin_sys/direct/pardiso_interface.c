@@ -192,6 +192,7 @@ OSQPInt init_linsys_solver_pardiso(pardiso_solver**    sp,
   /* s->iparm[7] = 2;      // Max number of iterative refinement steps */
   s->iparm[7] = 0;      // Number of iterative refinement steps (auto, performs them only if perturbed pivots are obtained)
   s->iparm[9] = 13;     // Perturb the pivot elements with 1E-13
+  s->iparm[17] = -1;    // Report the number of nonzeros in the factors
   s->iparm[34] = 0;     // Use Fortran-style indexing for indices
   /* s->iparm[34] = 1;     // Use C-style indexing for indices */
 
@@ -219,6 +220,9 @@ OSQPInt init_linsys_solver_pardiso(pardiso_solver**    sp,
     return OSQP_LINSYS_SOLVER_INIT_ERROR;
   }
 
+  // Pardiso uses its own ordering and doesn't read the kkt_ordering setting
+  s->factor_nnz = s->iparm[17];
+
   // Numerical factorization
   s->phase = PARDISO_NUMERIC;
   osqp_profiler_sec_push(OSQP_PROFILER_SEC_LINSYS_NUM_FAC);
@@ -48,6 +48,7 @@ struct pardiso {
                               OSQPFloat          rho_sc);
 
     OSQPInt nthreads;
+    OSQPInt factor_nnz;   ///< nonzeros in the factors reported by the analysis phase
     /** @} */
 
 
@@ -144,6 +144,9 @@ OSQPInt init_linsys_mklcg(mklcg_solver**     sp,
   //the same thing as the pardiso solver
   s->nthreads = mkl_get_max_threads();
 
+  // The system isn't factored
+  s->factor_nnz = 0;
+
   //Initialise solver state to zero since it provides
   //cold start condition for the CG inner solver
   s->x = OSQPVectorf_calloc(n);
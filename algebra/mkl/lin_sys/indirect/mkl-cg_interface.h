@@ -34,6 +34,7 @@ typedef struct mklcg_solver_ {
 
   //threads count
   OSQPInt nthreads;
+  OSQPInt factor_nnz;   ///< always 0, the system isn't factored
 
   // Maximum number of iterations
   OSQPInt max_iter;
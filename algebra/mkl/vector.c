@@ -168,6 +168,23 @@ void OSQPVectorf_view_free(OSQPVectorf* a) {
   c_free(a);
 }
 
+OSQPInt OSQPVectorf_count_at_bounds(const OSQPVectorf* x,
+                                    const OSQPVectorf* l,
+                                    const OSQPVectorf* u) {
+  OSQPInt i;
+  OSQPInt length = x->length;
+  OSQPInt count  = 0;
+
+  OSQPFloat* xv = x->values;
+  OSQPFloat* lv = l->values;
+  OSQPFloat* uv = u->values;
+
+  for (i = 0; i < length; i++) {
+    count += (xv[i] == lv[i] || xv[i] == uv[i]);
+  }
+  return count;
+}
+
 
 OSQPInt OSQPVectorf_length(const OSQPVectorf* a) {return a->length;}
 OSQPInt OSQPVectori_length(const OSQPVectori *a) {return a->length;}
@@ -0,0 +1,775 @@
+/*
+ * Parametrized problem families of the benchmark suite.
+ *
+ * The families follow the formulations of the OSQP paper benchmarks (see also
+ * the examples in the documentation). All data is generated from a seeded
+ * pseudo random number generator, so the same size and seed always give the
+ * same problem on every platform.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_problems.h"
+
+
+/*******************
+ * Random numbers  *
+ *******************/
+
+typedef struct {
+  unsigned long long state;
+} bench_rng;
+
+static void rng_seed(bench_rng* rng, unsigned long seed) {
+  rng->state = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)seed;
+  if (!rng->state) rng->state = 1;
+}
+
+/* Uniform in [0, 1) (xorshift64*) */
+static OSQPFloat rng_uniform(bench_rng* rng) {
+  unsigned long long x = rng->state;
+
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  rng->state = x;
+
+  return (OSQPFloat)((x * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Standard normal (Box-Muller) */
+static OSQPFloat rng_normal(bench_rng* rng) {
+  OSQPFloat u1 = 1.0 - rng_uniform(rng);
+  OSQPFloat u2 = rng_uniform(rng);
+
+  return (OSQPFloat)(sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2));
+}
+
+static OSQPInt rng_int(bench_rng* rng, OSQPInt n) {
+  return (OSQPInt)(rng_uniform(rng) * n);
+}
+
+
+/*******************
+ * Sparse matrices *
+ *******************/
+
+/* Matrix in triplet form, converted to CSC once assembled */
+typedef struct {
+  OSQPInt    nrows;
+  OSQPInt    ncols;
+  OSQPInt    nnz;
+  OSQPInt    cap;
+  OSQPInt*   i;
+  OSQPInt*   j;
+  OSQPFloat* x;
+  OSQPInt    failed;   // an allocation failed, the matrix is incomplete
+} triplet;
+
+static void trip_init(triplet* t, OSQPInt nrows, OSQPInt ncols) {
+  memset(t, 0, sizeof(triplet));
+  t->nrows = nrows;
+  t->ncols = ncols;
+}
+
+static void trip_free(triplet* t) {
+  free(t->i);
+  free(t->j);
+  free(t->x);
+  memset(t, 0, sizeof(triplet));
+}
+
+static void trip_add(triplet* t, OSQPInt i, OSQPInt j, OSQPFloat x) {
+  if (t->failed) return;
+
+  if (t->nnz == t->cap) {
+    OSQPInt    cap = t->cap ? 2 * t->cap : 64;
+    OSQPInt*   ti  = realloc(t->i, cap * sizeof(OSQPInt));
+    OSQPInt*   tj  = ti ? realloc(t->j, cap * sizeof(OSQPInt)) : NULL;
+    OSQPFloat* tx  = tj ? realloc(t->x, cap * sizeof(OSQPFloat)) : NULL;
+
+    if (ti) t->i = ti;
+    if (tj) t->j = tj;
+    if (!tx) {
+      t->failed = 1;
+      return;
+    }
+    t->x   = tx;
+    t->cap = cap;
+  }
+
+  t->i[t->nnz] = i;
+  t->j[t->nnz] = j;
+  t->x[t->nnz] = x;
+  t->nnz++;
+}
+
+/* Add a block of the identity scaled by alpha with its top left corner at (row, col) */
+static void trip_add_eye(triplet* t, OSQPInt row, OSQPInt col, OSQPInt k, OSQPFloat alpha) {
+  OSQPInt i;
+
+  for (i = 0; i < k; i++)
+    trip_add(t, row + i, col + i, alpha);
+}
+
+/* Add a random rows x cols block with normal entries of the given density */
+static void trip_add_randn(triplet*   t,
+                           bench_rng* rng,
+                           OSQPInt    row,
+                           OSQPInt    col,
+                           OSQPInt    rows,
+                           OSQPInt    cols,
+                           OSQPFloat  density,
+                           OSQPFloat  mean,
+                           OSQPFloat  stddev) {
+  OSQPInt j, k, nz;
+
+  nz = (OSQPInt)(density * rows + 0.5);
+  if (nz < 1) nz = 1;
+
+  for (j = 0; j < cols; j++) {
+    for (k = 0; k < nz; k++)
+      trip_add(t, row + rng_int(rng, rows), col + j, mean + stddev * rng_normal(rng));
+  }
+}
+
+static OSQPCscMatrix* csc_alloc(OSQPInt m, OSQPInt n, OSQPInt nzmax) {
+  OSQPCscMatrix* M  = malloc(sizeof(OSQPCscMatrix));
+  OSQPInt*       Mp = calloc(n + 1, sizeof(OSQPInt));
+  OSQPInt*       Mi = malloc((nzmax ? nzmax : 1) * sizeof(OSQPInt));
+  OSQPFloat*     Mx = malloc((nzmax ? nzmax : 1) * sizeof(OSQPFloat));
+
+  if (!M || !Mp || !Mi || !Mx) {
+    free(M);
+    free(Mp);
+    free(Mi);
+    free(Mx);
+    return OSQP_NULL;
+  }
+
+  csc_set_data(M, m, n, nzmax, Mx, Mi, Mp);
+  return M;
+}
+
+static void csc_free(OSQPCscMatrix* M) {
+  if (!M) return;
+
+  free(M->p);
+  free(M->i);
+  free(M->x);
+  free(M);
+}
+
+/*
+ * Convert to CSC with sorted row indices, summing duplicate entries.
+ * If upper is set, entries below the diagonal are dropped.
+ */
+static OSQPCscMatrix* trip_to_csc(const triplet* t, OSQPInt upper) {
+  OSQPCscMatrix* M;
+  OSQPInt*       rp;
+  OSQPInt*       rj;
+  OSQPFloat*     rx;
+  OSQPInt        k, r, c, dst, start, nnz;
+
+  if (t->failed) return OSQP_NULL;
+
+  M  = csc_alloc(t->nrows, t->ncols, t->nnz);
+  rp = calloc(t->nrows + 1, sizeof(OSQPInt));
+  rj = malloc((t->nnz ? t->nnz : 1) * sizeof(OSQPInt));
+  rx = malloc((t->nnz ? t->nnz : 1) * sizeof(OSQPFloat));
+
+  if (!M || !rp || !rj || !rx) {
+    csc_free(M);
+    free(rp);
+    free(rj);
+    free(rx);
+    return OSQP_NULL;
+  }
+
+  // Bucket the entries by row, then by column, so rows end up sorted in each column
+  for (k = 0; k < t->nnz; k++) rp[t->i[k] + 1]++;
+  for (r = 0; r < t->nrows; r++) rp[r + 1] += rp[r];
+  for (k = 0; k < t->nnz; k++) {
+    dst     = rp[t->i[k]]++;
+    rj[dst] = t->j[k];
+    rx[dst] = t->x[k];
+  }
+  for (r = t->nrows; r > 0; r--) rp[r] = rp[r - 1];
+  rp[0] = 0;
+
+  for (k = 0; k < t->nnz; k++) M->p[t->j[k] + 1]++;
+  for (c = 0; c < t->ncols; c++) M->p[c + 1] += M->p[c];
+  for (r = 0; r < t->nrows; r++) {
+    for (k = rp[r]; k < rp[r + 1]; k++) {
+      dst       = M->p[rj[k]]++;
+      M->i[dst] = r;
+      M->x[dst] = rx[k];
+    }
+  }
+  for (c = t->ncols; c > 0; c--) M->p[c] = M->p[c - 1];
+  M->p[0] = 0;
+
+  // Compress, summing duplicates and dropping the lower triangle if requested
+  nnz = 0;
+  for (c = 0; c < t->ncols; c++) {
+    start   = M->p[c];
+    M->p[c] = nnz;
+
+    for (k = start; k < M->p[c + 1]; k++) {
+      if (upper && M->i[k] > c) continue;
+
+      if (nnz > M->p[c] && M->i[nnz - 1] == M->i[k]) {
+        M->x[nnz - 1] += M->x[k];
+      }
+      else {
+        M->i[nnz] = M->i[k];
+        M->x[nnz] = M->x[k];
+        nnz++;
+      }
+    }
+  }
+  M->p[t->ncols] = nnz;
+  M->nzmax       = nnz;
+
+  free(rp);
+  free(rj);
+  free(rx);
+  return M;
+}
+
+/*
+ * Add the upper triangular part of alpha * M'M at (off, off), for a matrix M
+ * in CSC form
+ */
+static void trip_add_gram(triplet* t, const OSQPCscMatrix* M, OSQPInt off, OSQPFloat alpha) {
+  OSQPInt    i, j, k, kk;
+  OSQPFloat  dot;
+
+  for (j = 0; j < M->n; j++) {
+    for (i = 0; i <= j; i++) {
+      // Both columns have sorted row indices, so merge them
+      dot = 0.0;
+      k   = M->p[i];
+      kk  = M->p[j];
+
+      while (k < M->p[i + 1] && kk < M->p[j + 1]) {
+        if (M->i[k] < M->i[kk]) {
+          k++;
+        }
+        else if (M->i[k] > M->i[kk]) {
+          kk++;
+        }
+        else {
+          dot += M->x[k++] * M->x[kk++];
+        }
+      }
+
+      if (dot != 0.0) trip_add(t, off + i, off + j, alpha * dot);
+    }
+  }
+}
+
+/* Random matrix of the given density in CSC form */
+static OSQPCscMatrix* sprandn(bench_rng* rng, OSQPInt rows, OSQPInt cols, OSQPFloat density,
+                              OSQPFloat mean, OSQPFloat stddev) {
+  triplet        t;
+  OSQPCscMatrix* M;
+
+  trip_init(&t, rows, cols);
+  trip_add_randn(&t, rng, 0, 0, rows, cols, density, mean, stddev);
+  M = trip_to_csc(&t, 0);
+  trip_free(&t);
+
+  return M;
+}
+
+/* Add a CSC block with its top left corner at (row, col), with rows scaled by d (if not NULL) */
+static void trip_add_csc(triplet* t, const OSQPCscMatrix* M, OSQPInt row, OSQPInt col,
+                         const OSQPFloat* d) {
+  OSQPInt j, k;
+
+  for (j = 0; j < M->n; j++) {
+    for (k = M->p[j]; k < M->p[j + 1]; k++)
+      trip_add(t, row + M->i[k], col + j, d ? d[M->i[k]] * M->x[k] : M->x[k]);
+  }
+}
+
+/* y = M*x */
+static void csc_matvec(const OSQPCscMatrix* M, const OSQPFloat* x, OSQPFloat* y) {
+  OSQPInt j, k;
+
+  memset(y, 0, M->m * sizeof(OSQPFloat));
+  for (j = 0; j < M->n; j++) {
+    for (k = M->p[j]; k < M->p[j + 1]; k++)
+      y[M->i[k]] += M->x[k] * x[j];
+  }
+}
+
+
+/*******************
+ * Problems        *
+ *******************/
+
+void bench_problem_free(bench_problem* prob) {
+  if (!prob) return;
+
+  csc_free(prob->P);
+  csc_free(prob->A);
+  free(prob->q);
+  free(prob->l);
+  free(prob->u);
+  free(prob);
+}
+
+/* Allocate the vectors of a problem and convert the assembled matrices */
+static bench_problem* problem_new(triplet* P, triplet* A) {
+  bench_problem* prob = calloc(1, sizeof(bench_problem));
+
+  if (!prob) return OSQP_NULL;
+
+  prob->n = P->ncols;
+  prob->m = A->nrows;
+  prob->P = trip_to_csc(P, 1);
+  prob->A = trip_to_csc(A, 0);
+  prob->q = calloc(prob->n, sizeof(OSQPFloat));
+  prob->l = calloc(prob->m ? prob->m : 1, sizeof(OSQPFloat));
+  prob->u = calloc(prob->m ? prob->m : 1, sizeof(OSQPFloat));
+
+  if (!prob->P || !prob->A || !prob->q || !prob->l || !prob->u) {
+    bench_problem_free(prob);
+    return OSQP_NULL;
+  }
+
+  return prob;
+}
+
+/*
+ * Random QP
+ *   minimize    1/2 x'Px + q'x
+ *   subject to  l <= Ax <= u
+ * with P = M'M + 1e-2 I, M and A of density 15%, and m = 10n.
+ */
+static bench_problem* gen_random_qp(OSQPInt n, unsigned long seed) {
+  bench_rng      rng;
+  triplet        P, A;
+  OSQPCscMatrix* M;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, m = 10 * n;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, n, n);
+  trip_init(&A, m, n);
+
+  M = sprandn(&rng, n, n, 0.15, 0.0, 1.0);
+  if (M) {
+    trip_add_gram(&P, M, 0, 1.0);
+    trip_add_eye(&P, 0, 0, n, 1e-2);
+    trip_add_randn(&A, &rng, 0, 0, m, n, 0.15, 0.0, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    for (i = 0; i < n; i++) prob->q[i] = rng_normal(&rng);
+    for (i = 0; i < m; i++) {
+      prob->l[i] = -rng_uniform(&rng);
+      prob->u[i] = rng_uniform(&rng);
+    }
+  }
+
+  csc_free(M);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+/*
+ * Equality constrained QP
+ *   minimize    1/2 x'Px + q'x
+ *   subject to  Ax = b
+ * with P = M'M + 1e-2 I, M and A of density 15%, and m = n/2.
+ */
+static bench_problem* gen_eq_qp(OSQPInt n, unsigned long seed) {
+  bench_rng      rng;
+  triplet        P, A;
+  OSQPCscMatrix* M;
+  OSQPFloat*     x0;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, m = n / 2 > 0 ? n / 2 : 1;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, n, n);
+  trip_init(&A, m, n);
+
+  M = sprandn(&rng, n, n, 0.15, 0.0, 1.0);
+  if (M) {
+    trip_add_gram(&P, M, 0, 1.0);
+    trip_add_eye(&P, 0, 0, n, 1e-2);
+    trip_add_randn(&A, &rng, 0, 0, m, n, 0.15, 0.0, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    // b = A*x0 for a random x0, so the constraints are consistent
+    for (i = 0; i < n; i++) prob->q[i] = rng_normal(&rng);
+    x0 = malloc(n * sizeof(OSQPFloat));
+    if (!x0) {
+      bench_problem_free(prob);
+      prob = OSQP_NULL;
+    }
+    else {
+      for (i = 0; i < n; i++) x0[i] = rng_normal(&rng);
+      csc_matvec(prob->A, x0, prob->l);
+      memcpy(prob->u, prob->l, m * sizeof(OSQPFloat));
+      free(x0);
+    }
+  }
+
+  csc_free(M);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+/*
+ * Portfolio optimization with a factor model of k = n/100 factors
+ *   minimize    x'Dx + y'y - mu'x
+ *   subject to  y = F'x, 1'x = 1, 0 <= x <= 1
+ */
+static bench_problem* gen_portfolio(OSQPInt n, unsigned long seed) {
+  bench_rng      rng;
+  triplet        P, A;
+  OSQPCscMatrix* F;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, j, k;
+
+  k = (n + 99) / 100;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, n + k, n + k);
+  trip_init(&A, k + 1 + n, n + k);
+
+  F = sprandn(&rng, n, k, 0.5, 0.0, 1.0);
+  if (F) {
+    for (i = 0; i < n; i++)
+      trip_add(&P, i, i, 2.0 * rng_uniform(&rng) * sqrt((double)k));
+    trip_add_eye(&P, n, n, k, 2.0);
+
+    // F'x - y = 0
+    for (j = 0; j < F->n; j++) {
+      for (i = F->p[j]; i < F->p[j + 1]; i++)
+        trip_add(&A, j, F->i[i], F->x[i]);
+    }
+    trip_add_eye(&A, 0, n, k, -1.0);
+
+    // 1'x = 1
+    for (i = 0; i < n; i++) trip_add(&A, k, i, 1.0);
+
+    // 0 <= x <= 1
+    trip_add_eye(&A, k + 1, 0, n, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    for (i = 0; i < n; i++) prob->q[i] = -rng_normal(&rng);
+
+    prob->l[k] = 1.0;
+    prob->u[k] = 1.0;
+    for (i = 0; i < n; i++) prob->u[k + 1 + i] = 1.0;
+  }
+
+  csc_free(F);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+/*
+ * Generate the data matrix Ad (m x n) and the noisy measurements b = Ad*v + e of
+ * a sparse vector v, with a fraction of outliers in the noise
+ */
+static OSQPCscMatrix* regression_data(bench_rng* rng, OSQPInt m, OSQPInt n,
+                                      OSQPFloat outliers, OSQPFloat** b) {
+  OSQPCscMatrix* Ad = sprandn(rng, m, n, 0.15, 0.0, 1.0);
+  OSQPFloat*     v  = calloc(n, sizeof(OSQPFloat));
+  OSQPInt        i;
+
+  *b = calloc(m, sizeof(OSQPFloat));
+
+  if (!Ad || !v || !*b) {
+    csc_free(Ad);
+    free(v);
+    free(*b);
+    *b = OSQP_NULL;
+    return OSQP_NULL;
+  }
+
+  for (i = 0; i < n; i++) {
+    if (rng_uniform(rng) < 0.5) v[i] = rng_normal(rng) / sqrt((double)n);
+  }
+
+  csc_matvec(Ad, v, *b);
+
+  for (i = 0; i < m; i++) {
+    if (rng_uniform(rng) < outliers)
+      (*b)[i] += 10.0 * rng_uniform(rng);
+    else
+      (*b)[i] += 0.5 * rng_normal(rng);
+  }
+
+  free(v);
+  return Ad;
+}
+
+/*
+ * Lasso with n features and m = 100n data points
+ *   minimize    y'y + lambda 1't
+ *   subject to  y = Ad*x - b, -t <= x <= t
+ */
+static bench_problem* gen_lasso(OSQPInt n, unsigned long seed) {
+  bench_rng      rng;
+  triplet        P, A;
+  OSQPCscMatrix* Ad;
+  OSQPFloat*     b;
+  OSQPFloat      lambda, atb;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, j, m = 100 * n;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, 2 * n + m, 2 * n + m);
+  trip_init(&A, m + 2 * n, 2 * n + m);
+
+  Ad = regression_data(&rng, m, n, 0.0, &b);
+  if (Ad) {
+    trip_add_eye(&P, n, n, m, 2.0);
+
+    // Ad*x - y = b
+    trip_add_csc(&A, Ad, 0, 0, OSQP_NULL);
+    trip_add_eye(&A, 0, n, m, -1.0);
+
+    // x - t <= 0, x + t >= 0
+    trip_add_eye(&A, m, 0, n, 1.0);
+    trip_add_eye(&A, m, n + m, n, -1.0);
+    trip_add_eye(&A, m + n, 0, n, 1.0);
+    trip_add_eye(&A, m + n, n + m, n, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    // lambda = ||Ad'b||_inf / 5
+    lambda = 0.0;
+    for (j = 0; j < n; j++) {
+      atb = 0.0;
+      for (i = Ad->p[j]; i < Ad->p[j + 1]; i++) atb += Ad->x[i] * b[Ad->i[i]];
+      if (fabs(atb) > lambda) lambda = fabs(atb);
+    }
+    lambda /= 5.0;
+
+    for (i = 0; i < n; i++) prob->q[n + m + i] = lambda;
+    for (i = 0; i < m; i++) {
+      prob->l[i] = b[i];
+      prob->u[i] = b[i];
+    }
+    for (i = 0; i < n; i++) {
+      prob->l[m + i]     = -OSQP_INFTY;
+      prob->u[m + i]     = 0.0;
+      prob->l[m + n + i] = 0.0;
+      prob->u[m + n + i] = OSQP_INFTY;
+    }
+  }
+
+  csc_free(Ad);
+  free(b);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+/*
+ * Huber fitting with n features and m = 100n data points (5% outliers)
+ *   minimize    u'u + 2 1'(r + s)
+ *   subject to  Ad*x - u - r + s = b, r >= 0, s >= 0
+ */
+static bench_problem* gen_huber(OSQPInt n, unsigned long seed) {
+  bench_rng      rng;
+  triplet        P, A;
+  OSQPCscMatrix* Ad;
+  OSQPFloat*     b;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, m = 100 * n;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, n + 3 * m, n + 3 * m);
+  trip_init(&A, 3 * m, n + 3 * m);
+
+  Ad = regression_data(&rng, m, n, 0.05, &b);
+  if (Ad) {
+    trip_add_eye(&P, n, n, m, 2.0);
+
+    trip_add_csc(&A, Ad, 0, 0, OSQP_NULL);
+    trip_add_eye(&A, 0, n, m, -1.0);
+    trip_add_eye(&A, 0, n + m, m, -1.0);
+    trip_add_eye(&A, 0, n + 2 * m, m, 1.0);
+    trip_add_eye(&A, m, n + m, 2 * m, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    for (i = 0; i < 2 * m; i++) prob->q[n + m + i] = 2.0;
+    for (i = 0; i < m; i++) {
+      prob->l[i] = b[i];
+      prob->u[i] = b[i];
+    }
+    for (i = m; i < 3 * m; i++) prob->u[i] = OSQP_INFTY;
+  }
+
+  csc_free(Ad);
+  free(b);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+/*
+ * Support vector machine with n features and m = 100n samples of two classes
+ *   minimize    x'x + 1't
+ *   subject to  t >= diag(b)*Ad*x + 1, t >= 0
+ */
+static bench_problem* gen_svm(OSQPInt n, unsigned long seed) {
+  bench_rng      rng;
+  triplet        P, A, D;
+  OSQPCscMatrix* Ad;
+  OSQPFloat*     b;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, m = 100 * n, half = m / 2;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, n + m, n + m);
+  trip_init(&A, 2 * m, n + m);
+  trip_init(&D, m, n);
+
+  b = malloc(m * sizeof(OSQPFloat));
+
+  // Samples of the two classes are centered at +-1/n
+  trip_add_randn(&D, &rng, 0, 0, half, n, 0.15, 1.0 / n, 1.0 / n);
+  trip_add_randn(&D, &rng, half, 0, m - half, n, 0.15, -1.0 / n, 1.0 / n);
+  Ad = trip_to_csc(&D, 0);
+
+  if (Ad && b) {
+    for (i = 0; i < m; i++) b[i] = i < half ? 1.0 : -1.0;
+
+    trip_add_eye(&P, 0, 0, n, 2.0);
+
+    trip_add_csc(&A, Ad, 0, 0, b);
+    trip_add_eye(&A, 0, n, m, -1.0);
+    trip_add_eye(&A, m, n, m, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    for (i = 0; i < m; i++) {
+      prob->q[n + i]     = 1.0;
+      prob->l[i]         = -OSQP_INFTY;
+      prob->u[i]         = -1.0;
+      prob->u[m + i]     = OSQP_INFTY;
+    }
+  }
+
+  csc_free(Ad);
+  free(b);
+  trip_free(&D);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+/*
+ * Model predictive control of a system with nx states, nu = nx/2 inputs and a
+ * horizon of T = 10 steps
+ *   minimize    sum_k x_k'Qx_k + u_k'Ru_k + x_T'Qx_T
+ *   subject to  x_{k+1} = Ad*x_k + Bd*u_k, x_0 = x_init,
+ *               -xbar <= x_k <= xbar, -ubar <= u_k <= ubar
+ */
+static bench_problem* gen_mpc(OSQPInt nx, unsigned long seed) {
+  const OSQPInt T = 10;
+
+  bench_rng      rng;
+  triplet        P, A, Dd;
+  OSQPCscMatrix* Ad = OSQP_NULL;
+  OSQPCscMatrix* Bd;
+  bench_problem* prob = OSQP_NULL;
+  OSQPInt        i, k, nu, n, nxt;
+
+  nu  = nx / 2 > 0 ? nx / 2 : 1;
+  nxt = (T + 1) * nx;
+  n   = nxt + T * nu;
+
+  rng_seed(&rng, seed);
+  trip_init(&P, n, n);
+  trip_init(&A, nxt + n, n);
+  trip_init(&Dd, nx, nx);
+
+  // Slightly perturbed identity dynamics
+  trip_add_eye(&Dd, 0, 0, nx, 1.0);
+  trip_add_randn(&Dd, &rng, 0, 0, nx, nx, 0.15, 0.0, 0.01);
+  Ad = trip_to_csc(&Dd, 0);
+  Bd = sprandn(&rng, nx, nu, 0.5, 0.0, 1.0);
+
+  if (Ad && Bd) {
+    for (i = 0; i < nx; i++) {
+      OSQPFloat qi = rng_uniform(&rng) < 0.7 ? 10.0 * rng_uniform(&rng) : 0.0;
+
+      for (k = 0; k <= T; k++) trip_add(&P, k * nx + i, k * nx + i, 2.0 * qi);
+    }
+    trip_add_eye(&P, nxt, nxt, T * nu, 0.2);
+
+    // -x_0 = -x_init, Ad*x_k + Bd*u_k - x_{k+1} = 0
+    trip_add_eye(&A, 0, 0, nx, -1.0);
+    for (k = 0; k < T; k++) {
+      trip_add_csc(&A, Ad, (k + 1) * nx, k * nx, OSQP_NULL);
+      trip_add_csc(&A, Bd, (k + 1) * nx, nxt + k * nu, OSQP_NULL);
+      trip_add_eye(&A, (k + 1) * nx, (k + 1) * nx, nx, -1.0);
+    }
+
+    // Bounds on the states and inputs
+    trip_add_eye(&A, nxt, 0, n, 1.0);
+
+    prob = problem_new(&P, &A);
+  }
+
+  if (prob) {
+    for (i = 0; i < nx; i++) {
+      prob->l[i] = -(0.5 * rng_uniform(&rng) - 0.25);
+      prob->u[i] = prob->l[i];
+    }
+    for (i = 0; i < n; i++) {
+      prob->u[nxt + i] = i < nxt ? 5.0 : 1.0;
+      prob->l[nxt + i] = -prob->u[nxt + i];
+    }
+  }
+
+  csc_free(Ad);
+  csc_free(Bd);
+  trip_free(&Dd);
+  trip_free(&P);
+  trip_free(&A);
+  return prob;
+}
+
+
+const bench_family bench_families[] = {
+  {"random_qp", gen_random_qp, {10,  50,  200,  0}},
+  {"eq_qp",     gen_eq_qp,     {10,  50,  200,  0}},
+  {"portfolio", gen_portfolio, {100, 500, 2000, 0}},
+  {"lasso",     gen_lasso,     {5,   20,  50,   0}},
+  {"huber",     gen_huber,     {5,   20,  50,   0}},
+  {"svm",       gen_svm,       {5,   20,  50,   0}},
+  {"mpc",       gen_mpc,       {4,   10,  40,   0}},
+  {NULL,        NULL,          {0}}
+};
@@ -0,0 +1,50 @@
+#ifndef BENCH_PROBLEMS_H
+#define BENCH_PROBLEMS_H
+
+#include "osqp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * QP generated by one of the benchmark problem families
+ *
+ * All arrays are owned by the problem and released with bench_problem_free.
+ */
+typedef struct {
+  OSQPInt        n;   ///< number of variables
+  OSQPInt        m;   ///< number of constraints
+  OSQPCscMatrix* P;   ///< quadratic cost (upper triangular part)
+  OSQPFloat*     q;   ///< linear cost
+  OSQPCscMatrix* A;   ///< constraint matrix
+  OSQPFloat*     l;   ///< constraint lower bound
+  OSQPFloat*     u;   ///< constraint upper bound
+} bench_problem;
+
+/**
+ * Generator of a problem family
+ *
+ * @param  size Size parameter of the family (number of variables, features, assets or states)
+ * @param  seed Seed of the random data
+ * @return      Generated problem, or OSQP_NULL if memory allocation failed
+ */
+typedef bench_problem* (*bench_generator)(OSQPInt size, unsigned long seed);
+
+typedef struct {
+  const char*     name;       ///< family name used on the command line and in the report
+  bench_generator generate;   ///< problem generator
+  OSQPInt         sizes[4];   ///< default sizes (0 terminated)
+} bench_family;
+
+/* Problem families, terminated by an entry with a NULL name */
+extern const bench_family bench_families[];
+
+/* Release a generated problem */
+void bench_problem_free(bench_problem* prob);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef BENCH_PROBLEMS_H */
@@ -0,0 +1,309 @@
+/*
+ * Benchmark driver: solves the problem families in bench_problems.c across
+ * sizes and solver settings and reports the timings as JSON.
+ *
+ * Usage: osqp_bench [-o file] [-r repeats] [-s size] [-v variant] [-q] [family ...]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+# include <sys/resource.h>
+#endif
+
+#include "osqp.h"
+#include "bench_problems.h"
+
+#define BENCH_SEED        1
+#define BENCH_REPEATS     5
+#define BENCH_MAX_REPEATS 100
+
+/* Settings variants every problem is solved with */
+typedef struct {
+  const char* name;
+  void (*apply)(OSQPSettings* settings);
+} bench_variant;
+
+static void variant_default(OSQPSettings* settings) {
+  (void)settings;
+}
+
+static void variant_polish(OSQPSettings* settings) {
+  settings->polishing = 1;
+}
+
+static void variant_high_accuracy(OSQPSettings* settings) {
+  settings->eps_abs = 1e-5;
+  settings->eps_rel = 1e-5;
+}
+
+static const bench_variant bench_variants[] = {
+  {"default",       variant_default},
+  {"polish",        variant_polish},
+  {"high_accuracy", variant_high_accuracy},
+  {NULL,            NULL}
+};
+
+/* Measurements of one problem and variant */
+typedef struct {
+  char      status[32];
+  OSQPInt   iter;
+  OSQPInt   factor_nnz;   // nonzeros of the KKT factor (0 for indirect solvers)
+  OSQPFloat setup_time;   // median over the repeats
+  OSQPFloat solve_time;   // median over the repeats
+  OSQPFloat solve_min;    // fastest solve
+} bench_result;
+
+
+static int cmp_float(const void* a, const void* b) {
+  OSQPFloat x = *(const OSQPFloat*)a;
+  OSQPFloat y = *(const OSQPFloat*)b;
+
+  return (x > y) - (x < y);
+}
+
+static OSQPFloat median(OSQPFloat* v, OSQPInt n) {
+  qsort(v, n, sizeof(OSQPFloat), cmp_float);
+  return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+/* Peak resident memory of the process so far in kB (-1 if unknown) */
+static long peak_memory_kb(void) {
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage))
+    return -1;
+# ifdef __APPLE__
+  return (long)(usage.ru_maxrss / 1024);
+# else
+  return (long)usage.ru_maxrss;
+# endif
+#else
+  return -1;
+#endif
+}
+
+static OSQPInt run_problem(const bench_problem* prob,
+                           const bench_variant* variant,
+                           OSQPInt              repeats,
+                           bench_result*        res) {
+  OSQPSettings settings;
+  OSQPSolver*  solver;
+  OSQPFloat    setup[BENCH_MAX_REPEATS];
+  OSQPFloat    solve[BENCH_MAX_REPEATS];
+  OSQPInt      r, exitflag;
+
+  osqp_set_default_settings(&settings);
+  settings.verbose = 0;
+  variant->apply(&settings);
+
+  for (r = 0; r < repeats; r++) {
+    solver   = OSQP_NULL;
+    exitflag = osqp_setup(&solver, prob->P, prob->q, prob->A, prob->l, prob->u,
+                          prob->m, prob->n, &settings);
+    if (!exitflag)
+      exitflag = osqp_solve(solver);
+
+    if (exitflag) {
+      fprintf(stderr, "osqp_bench: %s\n", osqp_error_message(exitflag));
+      osqp_cleanup(solver);
+      return exitflag;
+    }
+
+    setup[r] = solver->info->setup_time;
+    solve[r] = solver->info->solve_time + solver->info->polish_time;
+
+    strncpy(res->status, solver->info->status, sizeof(res->status) - 1);
+    res->status[sizeof(res->status) - 1] = '\0';
+    res->iter       = solver->info->iter;
+    res->factor_nnz = solver->info->factor_nnz;
+
+    osqp_cleanup(solver);
+  }
+
+  res->setup_time = median(setup, repeats);
+  res->solve_time = median(solve, repeats);
+  res->solve_min  = solve[0];   // median() sorted the times
+
+  return 0;
+}
+
+/*
+ * Nonzeros in the upper triangle of the full KKT matrix [P + sigma*I, A'; A, -1/rho*I],
+ * which has the whole diagonal of P whether the problem stores it or not
+ */
+static OSQPInt kkt_nnz(const bench_problem* prob) {
+  OSQPInt j, k;
+  OSQPInt nnz = prob->A->p[prob->n] + prob->m;
+
+  for (j = 0; j < prob->n; j++) {
+    nnz++;
+    for (k = prob->P->p[j]; k < prob->P->p[j+1]; k++) {
+      if (prob->P->i[k] < j) nnz++;
+    }
+  }
+
+  return nnz;
+}
+
+static void print_result(FILE*                out,
+                         OSQPInt              first,
+                         const char*          family,
+                         OSQPInt              size,
+                         const bench_variant* variant,
+                         const bench_problem* prob,
+                         OSQPInt              repeats,
+                         const bench_result*  res) {
+  OSQPInt nnz_P = prob->P->p[prob->n];
+  OSQPInt nnz_A = prob->A->p[prob->n];
+
+  fprintf(out, "%s    {\"family\": \"%s\", \"size\": %lld, \"variant\": \"%s\",\n",
+          first ? "" : ",\n", family, (long long)size, variant->name);
+  fprintf(out, "     \"n\": %lld, \"m\": %lld, \"nnz_P\": %lld, \"nnz_A\": %lld, \"nnz_KKT\": %lld, \"nnz_L\": %lld,\n",
+          (long long)prob->n, (long long)prob->m, (long long)nnz_P, (long long)nnz_A,
+          (long long)kkt_nnz(prob), (long long)res->factor_nnz);
+  fprintf(out, "     \"status\": \"%s\", \"iter\": %lld, \"repeats\": %lld,\n",
+          res->status, (long long)res->iter, (long long)repeats);
+  fprintf(out, "     \"setup_time\": %.6e, \"solve_time\": %.6e, \"solve_time_min\": %.6e,\n",
+          res->setup_time, res->solve_time, res->solve_min);
+  fprintf(out, "     \"iter_time\": %.6e, \"iter_per_sec\": %.6e, \"peak_memory_kb\": %ld}",
+          res->iter ? res->solve_time / res->iter : 0.0,
+          res->solve_time > 0.0 ? res->iter / res->solve_time : 0.0,
+          peak_memory_kb());
+}
+
+static void usage(void) {
+  OSQPInt i;
+
+  fprintf(stderr, "Usage: osqp_bench [-o file] [-r repeats] [-s size] [-v variant] [-q] [family ...]\n");
+  fprintf(stderr, "  -o file     write the JSON report to file (default: stdout)\n");
+  fprintf(stderr, "  -r repeats  number of setups and solves of every problem (default: %d)\n", BENCH_REPEATS);
+  fprintf(stderr, "  -s size     run only this size instead of the default sizes of each family\n");
+  fprintf(stderr, "  -v variant  run only this settings variant\n");
+  fprintf(stderr, "  -q          quick run: smallest size of every family, a single repeat\n");
+  fprintf(stderr, "Families:");
+  for (i = 0; bench_families[i].name; i++) fprintf(stderr, " %s", bench_families[i].name);
+  fprintf(stderr, "\nVariants:");
+  for (i = 0; bench_variants[i].name; i++) fprintf(stderr, " %s", bench_variants[i].name);
+  fprintf(stderr, "\n");
+}
+
+static OSQPInt selected(const char* name, char** list, OSQPInt n) {
+  OSQPInt i;
+
+  if (!n) return 1;
+
+  for (i = 0; i < n; i++) {
+    if (!strcmp(name, list[i])) return 1;
+  }
+
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  const char*    outname = NULL;
+  const char*    vname   = NULL;
+  OSQPInt        repeats = BENCH_REPEATS;
+  OSQPInt        size    = 0;
+  OSQPInt        quick   = 0;
+  OSQPInt        nfam    = 0;
+  OSQPInt        first   = 1;
+  OSQPInt        exitflag = 0;
+  OSQPInt        f, s, v, i;
+  char**         families;
+  FILE*          out = stdout;
+  bench_problem* prob;
+  bench_result   res;
+
+  families = malloc(argc * sizeof(char*));
+  if (!families) return 1;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      outname = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      repeats = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      size = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-v") && i + 1 < argc) {
+      vname = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-q")) {
+      quick = 1;
+    }
+    else if (argv[i][0] == '-') {
+      usage();
+      free(families);
+      return 1;
+    }
+    else {
+      families[nfam++] = argv[i];
+    }
+  }
+
+  if (quick) repeats = 1;
+  if (repeats < 1 || repeats > BENCH_MAX_REPEATS) {
+    fprintf(stderr, "osqp_bench: repeats must be between 1 and %d\n", BENCH_MAX_REPEATS);
+    free(families);
+    return 1;
+  }
+
+  if (outname) {
+    out = fopen(outname, "w");
+    if (!out) {
+      fprintf(stderr, "osqp_bench: cannot open %s\n", outname);
+      free(families);
+      return 1;
+    }
+  }
+
+  fprintf(out, "{\n  \"osqp_version\": \"%s\",\n  \"seed\": %d,\n  \"results\": [\n",
+          osqp_version(), BENCH_SEED);
+
+  for (f = 0; bench_families[f].name && !exitflag; f++) {
+    if (!selected(bench_families[f].name, families, nfam)) continue;
+
+    for (s = 0; s < 4 && bench_families[f].sizes[s] && !exitflag; s++) {
+      OSQPInt cur = size ? size : bench_families[f].sizes[s];
+
+      prob = bench_families[f].generate(cur, BENCH_SEED);
+      if (!prob) {
+        fprintf(stderr, "osqp_bench: failed to generate %s of size %lld\n",
+                bench_families[f].name, (long long)cur);
+        exitflag = 1;
+        break;
+      }
+
+      for (v = 0; bench_variants[v].name; v++) {
+        if (vname && strcmp(vname, bench_variants[v].name)) continue;
+
+        fprintf(stderr, "%s (size %lld, %s)\n", bench_families[f].name, (long long)cur,
+                bench_variants[v].name);
+
+        exitflag = run_problem(prob, &bench_variants[v], repeats, &res);
+        if (exitflag) break;
+
+        print_result(out, first, bench_families[f].name, cur, &bench_variants[v],
+                     prob, repeats, &res);
+        first = 0;
+      }
+
+      bench_problem_free(prob);
+
+      // A single size was requested
+      if (size || quick) break;
+    }
+  }
+
+  fprintf(out, "\n  ]\n}\n");
+
+  if (outname) fclose(out);
+  free(families);
+
+  return exitflag ? 1 : 0;
+}
@@ -90,6 +90,11 @@ void OSQPVectorf_view_update(OSQPVectorf* a, const OSQPVectorf* b, OSQPInt head,
 /* Free a view of a float vector */
 void OSQPVectorf_view_free(OSQPVectorf* a);
 
+/* Number of elements of x that are equal to their lower or upper bound */
+OSQPInt OSQPVectorf_count_at_bounds(const OSQPVectorf* x,
+                                    const OSQPVectorf* l,
+                                    const OSQPVectorf* u);
+
 # endif /* ifndef OSQP_EMBEDDED_MODE */
 
 
@@ -153,6 +153,15 @@ OSQPInt check_termination(OSQPSolver* solver,
 
 # ifndef OSQP_EMBEDDED_MODE
 
+/**
+ * Check if the polished solution satisfies the termination tolerances.
+ * Must be called after update_info at the polished solution.
+ *
+ * @param  solver Solver
+ * @return        Boolean (1 if the polished solution is accurate enough)
+ */
+OSQPInt check_polish_termination(const OSQPSolver* solver);
+
 /**
  * Validate problem data
  * @param  P  Problem data (quadratic cost term, csc format)
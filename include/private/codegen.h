@@ -2,24 +2,57 @@
 #define CODEGEN_H
 
 #include "osqp_api_types.h"
+#include "types.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-OSQPInt codegen_inc(const char* output_dir,
-                    const char* file_prefix);
-
-OSQPInt codegen_src(const char* output_dir,
-                    const char* file_prefix,
-                    OSQPSolver* solver,
-                    OSQPInt     embedded);
+/**
+ * Set up the linear system solver of the generated code
+ *
+ * The generated code solves with the QDLDL factors of the KKT matrix. If the
+ * workspace factors the reduced system or a dense KKT matrix instead, the
+ * QDLDL factorization is set up in its place until codegen_linsys_restore.
+ *
+ * @param  solver Solver
+ * @param  saved  Workspace solver that was replaced (OSQP_NULL if none)
+ * @return        Exitflag
+ */
+OSQPInt codegen_linsys_init(OSQPSolver*    solver,
+                            LinSysSolver** saved);
+
+/**
+ * Free the linear system solver set up by codegen_linsys_init and restore
+ * the workspace solver
+ *
+ * @param  solver Solver
+ * @param  saved  Workspace solver returned by codegen_linsys_init
+ */
+void codegen_linsys_restore(OSQPSolver*   solver,
+                            LinSysSolver* saved);
+
+OSQPInt codegen_inc(const char*         output_dir,
+                    const char*         file_prefix,
+                    OSQPSolver*         solver,
+                    OSQPCodegenDefines* defines);
+
+OSQPInt codegen_src(const char*         output_dir,
+                    const char*         file_prefix,
+                    OSQPSolver*         solver,
+                    OSQPCodegenDefines* defines);
 
 OSQPInt codegen_defines(const char*         output_dir,
                         OSQPCodegenDefines* defines);
 
-OSQPInt codegen_example(const char* output_dir,
-                        const char* file_prefix);
+OSQPInt codegen_fixed(const char*         output_dir,
+                      const char*         file_prefix,
+                      OSQPSolver*         solver,
+                      OSQPCodegenDefines* defines);
+
+OSQPInt codegen_example(const char*         output_dir,
+                        const char*         file_prefix,
+                        OSQPCodegenDefines* defines);
 
 #ifdef __cplusplus
 }
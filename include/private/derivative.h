@@ -19,9 +19,37 @@ OSQPInt adjoint_derivative_get_vec(OSQPSolver *solver,
                                    OSQPFloat*     du);
 
 OSQPInt adjoint_derivative_compute(OSQPSolver *solver,
-                                   OSQPFloat*     dx,
-                                   OSQPFloat*     dy_l,
-                                   OSQPFloat*     dy_u);
+                                   const OSQPFloat* dx,
+                                   const OSQPFloat* dy_l,
+                                   const OSQPFloat* dy_u);
+
+OSQPInt adjoint_derivative_compute_multi(OSQPSolver*      solver,
+                                         OSQPInt          nrhs,
+                                         const OSQPFloat* dx,
+                                         const OSQPFloat* dy,
+                                         OSQPFloat*       dq,
+                                         OSQPFloat*       dl,
+                                         OSQPFloat*       du,
+                                         OSQPCscMatrix*   dP,
+                                         OSQPCscMatrix*   dA);
+
+OSQPInt forward_derivative_compute_multi(OSQPSolver*          solver,
+                                         OSQPInt              ndir,
+                                         const OSQPCscMatrix* dP,
+                                         const OSQPFloat*     dq,
+                                         const OSQPCscMatrix* dA,
+                                         const OSQPFloat*     dl,
+                                         const OSQPFloat*     du,
+                                         OSQPFloat*           dx,
+                                         OSQPFloat*           dy);
+
+OSQPInt adjoint_derivative_compute_batch(OSQPSolver**     solvers,
+                                         OSQPInt          nsolvers,
+                                         const OSQPFloat* dx,
+                                         const OSQPFloat* dy);
+
+/* Free the cached adjoint factorization (called when the solution changes) */
+void adjoint_derivative_clear(OSQPSolver* solver);
 
 #ifdef __cplusplus
 }
@@ -55,14 +55,22 @@ OSQPInt osqp_algebra_init_linsys_solver(LinSysSolver**      s,
 
 #ifdef OSQP_ALGEBRA_BUILTIN
 #ifndef OSQP_EMBEDDED_MODE
-OSQPInt adjoint_derivative_linsys_solver(LinSysSolver**      s,
-                                         const OSQPSettings* settings,
-                                         const OSQPMatrix*   P,
-                                         const OSQPMatrix*   G,
-                                         const OSQPMatrix*   A_eq,
-                                         OSQPMatrix*         GDiagLambda,
-                                         OSQPVectorf*        slacks,
-                                         OSQPVectorf*        rhs);
+OSQPInt adjoint_derivative_linsys_solver(LinSysSolver**            s,
+                                         const OSQPSettings*       settings,
+                                         const LinSysSolver*       sym,
+                                         const OSQPMatrix*         P,
+                                         const OSQPMatrix*         A,
+                                         const OSQPVectorf*        Dinv,
+                                         const OSQPVectorf*        Einv,
+                                         OSQPFloat                 cinv,
+                                         const OSQPDerivativeData* derivative_data,
+                                         const OSQPFloat*          slacks);
+
+OSQPInt adjoint_derivative_linsys_factor(LinSysSolver* s);
+
+OSQPInt adjoint_derivative_linsys_solve(LinSysSolver* s,
+                                        OSQPVectorf*  rhs,
+                                        OSQPInt       nrhs);
 
 #endif
 #endif
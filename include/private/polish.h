@@ -18,6 +18,33 @@ extern "C" {
  */
 OSQPInt polish(OSQPSolver* solver);
 
+/**
+ * Allocate the workspace of polish_update_active_set, if early polishing is
+ * enabled and the workspace does not exist yet
+ * @param  solver OSQP solver
+ * @return        Exitflag
+ */
+OSQPInt polish_early_init(OSQPSolver* solver);
+
+/**
+ * Guess the active constraints from the current ADMM iterates and count
+ * for how many consecutive termination checks the guess has not changed
+ * (stored in work->pol->n_stable)
+ * @param  solver OSQP solver
+ */
+void polish_update_active_set(OSQPSolver* solver);
+
+/**
+ * Solution polish before the ADMM has converged: the polished solution
+ * replaces the ADMM iterates only if it meets the termination tolerances,
+ * in which case info->status_polish is set to OSQP_POLISH_SUCCESS. A polish
+ * that fails for any reason other than a memory allocation error is not
+ * reported, since it only means that the guessed active set was wrong
+ * @param  solver OSQP solver
+ * @return        Exitflag
+ */
+OSQPInt polish_early(OSQPSolver* solver);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,6 +4,10 @@
 // cmake generated compiler flags
 #include "osqp_configure.h"
 
+#ifdef OSQP_PROFILER_BUILTIN
+#include "osqp_api_types.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -85,6 +89,56 @@ void _osqp_profiler_sec_pop(OSQPProfilerSection section);
  */
 void _osqp_profiler_event_mark(OSQPProfilerEvent event);
 
+#ifdef OSQP_PROFILER_BUILTIN
+/**
+ * Counters accumulated by the builtin profiler for a single solver.
+ */
+typedef struct {
+    int                 level;                                 /* Level of the sections being counted */
+    struct OSQPTimer_*  timers[OSQP_PROFILER_SEC_ARRAY_LAST];  /* Timer started when entering each section */
+    OSQPFloat           time[OSQP_PROFILER_SEC_ARRAY_LAST];    /* Time spent inside each section */
+    OSQPInt             calls[OSQP_PROFILER_SEC_ARRAY_LAST];   /* Number of times each section was entered */
+    OSQPFloat           bytes[OSQP_PROFILER_SEC_ARRAY_LAST];   /* Estimated bytes read and written in each section */
+} OSQPProfilerData;
+
+/**
+ * Allocate zeroed profiler counters.
+ *
+ * @return the counters, or OSQP_NULL if the allocation failed
+ */
+OSQPProfilerData* _osqp_profiler_data_new(void);
+
+/**
+ * Free profiler counters.
+ */
+void _osqp_profiler_data_free(OSQPProfilerData* data);
+
+/**
+ * Direct the section annotations of the calling thread into @c data.
+ *
+ * The target is left set when an API call returns and may belong to a solver that
+ * was freed on another thread since, so every API call that reaches a profiled
+ * section must set it first.
+ *
+ * @param data are the counters to accumulate into (OSQP_NULL to stop counting)
+ */
+void _osqp_profiler_set_target(OSQPProfilerData* data);
+
+/**
+ * Add an estimate of the memory traffic to a section.
+ *
+ * @param section is the section the traffic belongs to
+ * @param bytes   is the number of bytes read and written
+ */
+void _osqp_profiler_sec_bytes(OSQPProfilerSection section, OSQPFloat bytes);
+
+#define osqp_profiler_set_target(data)     _osqp_profiler_set_target(data)
+#define osqp_profiler_sec_bytes(sec, bytes) _osqp_profiler_sec_bytes(sec, bytes)
+#else
+#define osqp_profiler_set_target(data)
+#define osqp_profiler_sec_bytes(sec, bytes)
+#endif
+
 /*
  * Allow disabling the profiler annotations completely with no overhead by just ignoring the call.
  */
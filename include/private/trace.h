@@ -0,0 +1,62 @@
+/* Convergence trace of the termination checks */
+#ifndef TRACE_H
+#define TRACE_H
+
+
+#include "osqp.h"
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocate the convergence trace with room for settings->trace_size records
+ * (work->trace is left OSQP_NULL if the trace is disabled)
+ * @param  solver OSQP solver
+ * @return        Exitflag
+ */
+OSQPInt trace_init(OSQPSolver* solver);
+
+/**
+ * Free the convergence trace
+ * @param trace Convergence trace (can be OSQP_NULL)
+ */
+void trace_free(OSQPTrace* trace);
+
+/**
+ * Clear the records at the start of a solve
+ * @param solver OSQP solver
+ */
+void trace_reset(OSQPSolver* solver);
+
+/**
+ * Store the state at a termination check in the trace, overwriting the
+ * oldest record once the trace is full. Does not allocate memory.
+ *
+ * NB: Must be called after update_info so the residuals are current
+ * @param solver OSQP solver
+ * @param iter   Current iteration
+ */
+void trace_record(OSQPSolver* solver,
+                  OSQPInt     iter);
+
+/**
+ * Export the records of the last solve, oldest first
+ * (the CSV export is a null-terminated string)
+ * @param  solver OSQP solver
+ * @param  format Format of the export (osqp_trace_format_type)
+ * @param  buffer Buffer to write the export to (OSQP_NULL to only query the size)
+ * @param  size   On input the size of buffer, on output the size of the export (bytes)
+ * @return        Exitflag
+ */
+OSQPInt trace_export(const OSQPSolver* solver,
+                     OSQPInt           format,
+                     void*             buffer,
+                     OSQPInt*          size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef TRACE_H */
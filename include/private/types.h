@@ -6,6 +6,7 @@
 #include "algebra_matrix.h"
 #include "algebra_vector.h"
 #include "glob_opts.h"
+#include "profilers.h"
 
 /******************
 * Internal types *
@@ -57,7 +58,28 @@ typedef struct {
   OSQPFloat    obj_val;       ///< objective value at polished solution
   OSQPFloat    prim_res;      ///< primal residual at polished solution
   OSQPFloat    dual_res;      ///< dual residual at polished solution
+  OSQPInt      n_stable;      ///< consecutive termination checks with unchanged active_flags
+  OSQPInt*     early_flags;   ///< active-set guess and its previous value (2m entries, early polishing only)
+  OSQPFloat*   early_zylu;    ///< raw copies of z, y, l and u (4m entries, early polishing only)
 } OSQPPolish;
+
+
+/**
+ * Convergence trace (ring buffer of termination check records)
+ */
+
+typedef struct {
+  OSQPTraceRecord* records;     ///< ring buffer of records
+  OSQPInt          size;        ///< number of records the ring buffer holds
+  OSQPInt          count;       ///< number of records written in the current solve
+  OSQPInt          last_iter;   ///< iteration of the last record
+# ifdef OSQP_ENABLE_PROFILING
+  OSQPTimer*       timer;       ///< timer for the linear system solve before each record
+  OSQPFloat        linsys_time; ///< time of the linear system solve before the next record
+  OSQPInt          use_profile; ///< take the solve times from the builtin profiler instead
+  OSQPFloat        kkt_time;    ///< KKT solve time counted by the builtin profiler at the last record
+# endif // ifdef OSQP_ENABLE_PROFILING
+} OSQPTrace;
 # endif // ifndef OSQP_EMBEDDED_MODE
 
 
@@ -88,6 +110,11 @@ typedef struct {
     OSQPVectorf *ryu;  ///< for internal use, size m
     OSQPVectorf *rhs;  ///< rhs of linear system to solve for derivatives; length 2*(n + n_ineq_l + n_ineq_u + n_eq)
                        ///< conservatively allocated with length 2(n + 2m) in `osqp_setup`
+    LinSysSolver *adj_solver;  ///< factorization of the adjoint system, kept until the solution changes
+    OSQPInt *eq_indices;       ///< constraint index of each equality, size n_eq
+    OSQPInt *l_noninf_indices; ///< constraint index of each finite lower bound inequality, size n_ineq_l
+    OSQPInt *u_noninf_indices; ///< constraint index of each finite upper bound inequality, size n_ineq_u
+    OSQPInt *nu_sign;          ///< sign of the dual variable of each equality, size n_eq
 } OSQPDerivativeData;
 
 /**
@@ -104,6 +131,9 @@ struct OSQPWorkspace_ {
 # ifndef OSQP_EMBEDDED_MODE
   /// Polish structure
   OSQPPolish* pol;
+
+  /// Convergence trace (OSQP_NULL if disabled)
+  OSQPTrace* trace;
 # endif // ifndef OSQP_EMBEDDED_MODE
 
   /**
@@ -203,6 +233,10 @@ struct OSQPWorkspace_ {
   OSQPInt rho_update_from_solve;
 # endif // ifdef OSQP_ENABLE_PROFILING
 
+# ifdef OSQP_PROFILER_BUILTIN
+  OSQPProfilerData* profile; ///< counters of the builtin profiler
+# endif // ifdef OSQP_PROFILER_BUILTIN
+
 # ifdef OSQP_ENABLE_PRINTING
   OSQPInt summary_printed; ///< Has last summary been printed? (true/false)
 # endif // ifdef OSQP_ENABLE_PRINTING
@@ -257,7 +291,8 @@ struct linsys_solver {
                             OSQPFloat          rho_sc);  ///< Update rho_vec
 # endif // if OSQP_EMBEDDED_MODE != 1
 
-  OSQPInt nthreads; ///< number of threads active
+  OSQPInt nthreads;   ///< number of threads active
+  OSQPInt factor_nnz; ///< number of nonzeros in the factor of the KKT matrix (0 if not factored)
 };
 
 #ifdef __cplusplus
@@ -68,6 +68,35 @@ typedef enum {
     OSQP_DIAGONAL_PRECONDITIONER,    /* Diagonal (Jacobi) preconditioner */
 } osqp_precond_type;
 
+/**************************************
+* Fill-reducing orderings of the KKT *
+**************************************/
+typedef enum {
+    OSQP_ORDERING_AMD = 0,      /* Approximate minimum degree */
+    OSQP_ORDERING_NESDIS,       /* Nested dissection, with AMD on the small subgraphs */
+    OSQP_ORDERING_USER,         /* Permutation supplied in OSQPSettings::kkt_permutation */
+    OSQP_ORDERING_AUTO          /* Ordering with the smallest predicted factor */
+} osqp_ordering_type;
+
+/*****************************************
+* Linear systems of the direct solver  *
+*****************************************/
+typedef enum {
+    OSQP_KKT_SYSTEM_FULL = 0,   /* Quasidefinite KKT matrix of dimension n + m */
+    OSQP_KKT_SYSTEM_REDUCED,    /* Reduced matrix P + sigma I + A' diag(rho) A of dimension n */
+    OSQP_KKT_SYSTEM_AUTO,       /* System with the smallest predicted cost */
+    OSQP_KKT_SYSTEM_DENSE,      /* KKT matrix stored and factored as a dense matrix */
+    OSQP_KKT_SYSTEM_STAGED      /* KKT matrix factored stage by stage, with the stages in OSQPSettings::kkt_stages */
+} osqp_kkt_system_type;
+
+/*****************************
+* Convergence trace formats *
+*****************************/
+enum osqp_trace_format_type {
+    OSQP_TRACE_BINARY = 0,      /* Array of OSQPTraceRecord, oldest first */
+    OSQP_TRACE_CSV              /* Text with a header line and one line per record, oldest first */
+};
+
 /******************
 * Solver Errors  *
 ******************/
@@ -151,6 +180,24 @@ extern const char * OSQP_ERROR_MESSAGE[];
 
 #  define OSQP_DELTA                (1E-6)
 #  define OSQP_POLISH_REFINE_ITER   (3)
+#  define OSQP_POLISH_EARLY_CHECKS  (0)        ///< Disable early polishing by default
+
+#  define OSQP_TRACE_SIZE           (0)        ///< Disable the convergence trace by default
+
+#  define OSQP_KKT_ORDERING         (OSQP_ORDERING_AUTO)
+#  define OSQP_AUTO_ORDERING_DIM    (1000)     ///< Smallest KKT dimension for which OSQP_ORDERING_AUTO compares orderings
+#  define OSQP_AMD_DENSE            (10.0)     ///< AMD default dense row threshold
+#  define OSQP_AMD_AGGRESSIVE       (1)        ///< Use aggressive absorption in AMD by default
+
+#  define OSQP_DYN_REG              (1)        ///< Replace tiny pivots of the KKT factorization by default
+#  define OSQP_DYN_REG_EPS          (1e-13)
+#  define OSQP_DYN_REG_DELTA        (1e-07)
+#  define OSQP_DYN_REG_REFINE_ITER  (3)
+
+#  define OSQP_KKT_SYSTEM           (OSQP_KKT_SYSTEM_AUTO)
+#  define OSQP_AUTO_KKT_SYSTEM_DIM  (1000)     ///< Smallest KKT dimension for which OSQP_KKT_SYSTEM_AUTO compares systems
+#  define OSQP_AUTO_DENSE_KKT_DIM   (300)      ///< KKT dimension below which OSQP_KKT_SYSTEM_AUTO considers the dense factorization
+#  define OSQP_AUTO_DENSE_KKT_DENSITY (0.4)    ///< Fraction of the KKT lower triangle that must be nonzero for the dense factorization
 
 
 /*********************************
@@ -181,6 +228,9 @@ extern const char * OSQP_ERROR_MESSAGE[];
 
 # define OSQP_PRINT_INTERVAL 200
 
+# define OSQP_CLOCK_CHECK_TOL      (0.01) ///< fraction of a deadline the solver may overrun it by between clock reads
+# define OSQP_CLOCK_CHECK_MAX_ITER (1000) ///< maximum number of iterations between clock reads
+
 # define OSQP_MIN_SCALING   (1e-04) ///< minimum scaling value
 # define OSQP_MAX_SCALING   (1e+04) ///< maximum scaling value
 
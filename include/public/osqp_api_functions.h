@@ -132,6 +132,41 @@ OSQPInt osqp_get_solution(OSQPSolver* solver, OSQPSolution* solution);
  */
 OSQP_API OSQPInt osqp_cleanup(OSQPSolver* solver);
 
+/**
+ * Export the convergence trace of the last solve
+ *
+ * The trace holds the state at the last \a settings->trace_size termination
+ * checks of the last call to osqp_solve, oldest first. Call with \a buffer
+ * set to OSQP_NULL to get the size of the export, then again with a buffer
+ * of at least that size.
+ *
+ * @param  solver Solver
+ * @param  format Export format, see osqp_trace_format_type (the CSV export is null-terminated)
+ * @param  buffer Buffer to store the export in (OSQP_NULL to only get its size)
+ * @param  size   On input the size of \a buffer, on output the size of the export (bytes)
+ * @return        Exitflag for errors (0 if no errors)
+ */
+OSQP_API OSQPInt osqp_get_trace(const OSQPSolver* solver,
+                                OSQPInt           format,
+                                void*             buffer,
+                                OSQPInt*          size);
+
+/**
+ * Get the counters the builtin profiler has accumulated for a solver
+ *
+ * The counters cover every setup, solve and update of the solver so far and
+ * only include the sections enabled by the \a profiler_level setting.
+ * Requires building with OSQP_PROFILER_ANNOTATIONS=builtin.
+ *
+ * @param  solver   Solver
+ * @param  sections Array to store one entry per profiler section in
+ * @param  n        On input the length of \a sections, on output the number of profiler sections
+ * @return          Exitflag for errors (0 if no errors)
+ */
+OSQP_API OSQPInt osqp_get_profile(const OSQPSolver*   solver,
+                                  OSQPProfileSection* sections,
+                                  OSQPInt*            n);
+
 # endif /* ifndef OSQP_EMBEDDED_MODE */
 
 
@@ -325,6 +360,116 @@ OSQP_API OSQPInt osqp_adjoint_derivative_get_vec(OSQPSolver*    solver,
                                                  OSQPFloat* dl,
                                                  OSQPFloat* du);
 
+/**
+ * Compute the adjoint derivatives of P/q/A/l/u for several (dx, dy) seeds at once.
+ *
+ * The factorization of the adjoint system is computed on the first derivative call
+ * after a solve and reused by all later calls until the solution or the problem data
+ * change, so additional seeds only cost a backsolve.
+ *
+ * @note An optimal solution must be obtained before calling this function.
+ *
+ * @param[in]  solver Solver
+ * @param[in]  nrhs   Number of seeds
+ * @param[in]  dx     Seeds dx stored one after the other (length n * nrhs)
+ * @param[in]  dy     Seeds dy stored one after the other (length m * nrhs)
+ * @param[out] dq     Derivatives w.r.t. q (length n * nrhs), or OSQP_NULL
+ * @param[out] dl     Derivatives w.r.t. l (length m * nrhs), or OSQP_NULL
+ * @param[out] du     Derivatives w.r.t. u (length m * nrhs), or OSQP_NULL
+ * @param[out] dP     Sparsity pattern of dP whose x array holds nrhs blocks of nnz values, or OSQP_NULL
+ * @param[out] dA     Sparsity pattern of dA whose x array holds nrhs blocks of nnz values, or OSQP_NULL
+ * @return            Exitflag for errors (0 if no errors)
+ */
+OSQP_API OSQPInt osqp_adjoint_derivative_compute_multi(OSQPSolver*      solver,
+                                                       OSQPInt          nrhs,
+                                                       const OSQPFloat* dx,
+                                                       const OSQPFloat* dy,
+                                                       OSQPFloat*       dq,
+                                                       OSQPFloat*       dl,
+                                                       OSQPFloat*       du,
+                                                       OSQPCscMatrix*   dP,
+                                                       OSQPCscMatrix*   dA);
+
+/**
+ * Compute internal data structures needed for the adjoint derivatives of a batch of solved problems.
+ *
+ * Problems whose adjoint systems share a sparsity pattern (same P/A patterns and the same
+ * equality/inequality classification of the constraints) reuse the ordering and symbolic
+ * factorization of the first problem. The numeric factorizations run in parallel when
+ * OSQP is built with OpenMP. The derivatives of each problem are then read with
+ * @c osqp_adjoint_derivative_get_mat and @c osqp_adjoint_derivative_get_vec on its solver.
+ *
+ * @note An optimal solution must be obtained for every problem before calling this function.
+ *
+ * @param[in] solvers  Array of solvers
+ * @param[in] nsolvers Number of solvers
+ * @param[in] dx       Seeds dx of every problem stored one after the other
+ * @param[in] dy       Seeds dy of every problem stored one after the other
+ * @return             Exitflag for errors (0 if no errors)
+ */
+OSQP_API OSQPInt osqp_adjoint_derivative_compute_batch(OSQPSolver**     solvers,
+                                                       OSQPInt          nsolvers,
+                                                       const OSQPFloat* dx,
+                                                       const OSQPFloat* dy);
+
+/**
+ * Compute the forward derivatives (Jacobian-vector product) of the solution x/y
+ * along a perturbation dP/dq/dA/dl/du of the problem data.
+ *
+ * The perturbation is given in the original (unscaled) problem coordinates.
+ * Any of dP, dq, dA, dl, du may be OSQP_NULL to leave that part unperturbed.
+ * This reuses the cached factorization of the adjoint derivative system.
+ *
+ * @note An optimal solution must be obtained before calling this function.
+ *
+ * @param[in]  solver Solver
+ * @param[in]  dP     Perturbation of P (upper triangular part, n x n)
+ * @param[in]  dq     Perturbation of q of length n
+ * @param[in]  dA     Perturbation of A (m x n)
+ * @param[in]  dl     Perturbation of l of length m
+ * @param[in]  du     Perturbation of u of length m
+ * @param[out] dx     Derivative of x of length n
+ * @param[out] dy     Derivative of y of length m
+ * @return            Exitflag for errors (0 if no errors)
+ */
+OSQP_API OSQPInt osqp_forward_derivative_compute(OSQPSolver*          solver,
+                                                 const OSQPCscMatrix* dP,
+                                                 const OSQPFloat*     dq,
+                                                 const OSQPCscMatrix* dA,
+                                                 const OSQPFloat*     dl,
+                                                 const OSQPFloat*     du,
+                                                 OSQPFloat*           dx,
+                                                 OSQPFloat*           dy);
+
+/**
+ * Compute the forward derivatives of the solution x/y for several perturbation directions at once.
+ *
+ * The directions are stored one after the other. dP and dA give a sparsity pattern
+ * whose x array holds ndir blocks of nnz values.
+ *
+ * @note An optimal solution must be obtained before calling this function.
+ *
+ * @param[in]  solver Solver
+ * @param[in]  ndir   Number of directions
+ * @param[in]  dP     Perturbations of P, or OSQP_NULL
+ * @param[in]  dq     Perturbations of q (length n * ndir), or OSQP_NULL
+ * @param[in]  dA     Perturbations of A, or OSQP_NULL
+ * @param[in]  dl     Perturbations of l (length m * ndir), or OSQP_NULL
+ * @param[in]  du     Perturbations of u (length m * ndir), or OSQP_NULL
+ * @param[out] dx     Derivatives of x (length n * ndir), or OSQP_NULL
+ * @param[out] dy     Derivatives of y (length m * ndir), or OSQP_NULL
+ * @return            Exitflag for errors (0 if no errors)
+ */
+OSQP_API OSQPInt osqp_forward_derivative_compute_multi(OSQPSolver*          solver,
+                                                       OSQPInt              ndir,
+                                                       const OSQPCscMatrix* dP,
+                                                       const OSQPFloat*     dq,
+                                                       const OSQPCscMatrix* dA,
+                                                       const OSQPFloat*     dl,
+                                                       const OSQPFloat*     du,
+                                                       OSQPFloat*           dx,
+                                                       OSQPFloat*           dy);
+
 /** @} */
 
 /* ------------------ Code generation functions ----------------- */
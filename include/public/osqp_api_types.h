@@ -88,6 +88,26 @@ typedef struct {
   // polishing parameters
   OSQPFloat delta;                  ///< regularization parameter for polishing
   OSQPInt   polish_refine_iter;     ///< number of iterative refinement steps in polishing
+  OSQPInt   polish_early_checks;    ///< number of consecutive termination checks with an unchanged active set before polishing is tried early; if 0, then disabled
+
+  // diagnostics
+  OSQPInt   trace_size;             ///< number of termination checks kept in the convergence trace; if 0, then disabled
+
+  // KKT ordering (direct solver)
+  osqp_ordering_type kkt_ordering;  ///< fill-reducing ordering of the KKT matrix
+  OSQPFloat      amd_dense;         ///< AMD dense row threshold; rows with more than max(16, amd_dense * sqrt(n+m)) entries are ordered last; if negative, no rows are dense
+  OSQPInt        amd_aggressive;    ///< boolean; use aggressive absorption in AMD
+  const OSQPInt* kkt_permutation;   ///< KKT permutation of length n+m used by OSQP_ORDERING_USER (owned by the caller, read during setup)
+
+  // dynamic regularization (direct solver)
+  OSQPInt   dyn_reg;                ///< boolean; replace tiny pivots of the KKT factorization by pivots of the expected sign
+  OSQPFloat dyn_reg_eps;            ///< pivots with magnitude at most dyn_reg_eps are replaced
+  OSQPFloat dyn_reg_delta;          ///< magnitude of the replacement pivots
+  OSQPInt   dyn_reg_refine_iter;    ///< number of iterative refinement steps of the solves when pivots were replaced
+
+  // linear system (direct solver)
+  osqp_kkt_system_type kkt_system;  ///< linear system factored for the ADMM iterations
+  const OSQPInt* kkt_stages;        ///< stage of each of the n+m KKT rows (variables, then constraints) used by OSQP_KKT_SYSTEM_STAGED (owned by the caller, read during setup)
 } OSQPSettings;
 
 
@@ -109,6 +129,7 @@ typedef struct {
   OSQPInt   iter;         ///< Number of iterations taken
   OSQPInt   rho_updates;  ///< Number of rho updates performned
   OSQPFloat rho_estimate; ///< Best rho estimate so far from residuals
+  OSQPInt   factor_nnz;   ///< Number of nonzeros in the KKT factor predicted from its ordering (0 if not factored)
 
   // timing information
   OSQPFloat setup_time;  ///< Setup phase time (seconds)
@@ -119,6 +140,30 @@ typedef struct {
 } OSQPInfo;
 
 
+/**
+ * State of the solver at one termination check, as stored in the convergence trace.
+ */
+typedef struct {
+  OSQPInt   iter;        ///< Iteration of the termination check
+  OSQPFloat prim_res;    ///< Norm of primal residual
+  OSQPFloat dual_res;    ///< Norm of dual residual
+  OSQPFloat rho;         ///< ADMM penalty parameter
+  OSQPFloat linsys_time; ///< Time spent solving linear systems since the previous check (seconds), estimated from the last solve unless the builtin profiler counts the KKT solves
+  OSQPInt   n_active;    ///< Number of constraints at their lower or upper bound
+} OSQPTraceRecord;
+
+
+/**
+ * Counters accumulated by the builtin profiler for one profiler section.
+ */
+typedef struct {
+  const char* name;  ///< Short name of the section, e.g. 'admm_iter'
+  OSQPFloat   time;  ///< Total time spent inside the section (seconds)
+  OSQPInt     calls; ///< Number of times the section was entered
+  OSQPFloat   bytes; ///< Estimated bytes read and written by the section itself (not its subsections)
+} OSQPProfileSection;
+
+
 /**
  * Structure to hold the computed solution (if any), and any certificates of
  * infeasibility (if any) found by the solver.
@@ -158,6 +203,11 @@ typedef struct {
   OSQPInt profiling_enable;   ///< Enable timing of code sections if 1
   OSQPInt interrupt_enable;   ///< Enable interrupt checking if 1
   OSQPInt derivatives_enable; ///< Enable deriatives if 1
+  OSQPInt ldl_unroll_enable;  ///< Generate a solve unrolled over the sparsity pattern of the KKT factor if 1
+  OSQPInt spmv_unroll_enable; ///< Generate matrix-vector products unrolled over the sparsity patterns of P and A if 1
+  OSQPInt fixed_point_bits;   ///< Also generate a fixed-point ADMM solver with this word length (0 = none, 16 or 32)
+  OSQPInt multi_instance_enable; ///< Share the constant data between caller-allocated solver instances if 1 (embedded mode 1 only)
+  OSQPInt compact_index_enable;  ///< Generate the solves and products not unrolled with the narrowest index type per array if 1
 } OSQPCodegenDefines;
 
 #endif /* ifndef OSQP_API_TYPES_H */
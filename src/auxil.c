@@ -161,11 +161,27 @@ void update_xz_tilde(OSQPSolver* solver,
 
   OSQPWorkspace* work = solver->work;
 
+#if !defined(OSQP_EMBEDDED_MODE) && defined(OSQP_ENABLE_PROFILING)
+  // The convergence trace only times the solve before each termination check,
+  // unless the builtin profiler already times all of them (see trace_record)
+  OSQPInt timed = work->trace && !work->trace->use_profile &&
+                  solver->settings->check_termination &&
+                  (admm_iter % solver->settings->check_termination == 0);
+#endif /* if !defined(OSQP_EMBEDDED_MODE) && defined(OSQP_ENABLE_PROFILING) */
+
   // Compute right-hand side
   compute_rhs(solver);
 
   // Solve linear system
+#if !defined(OSQP_EMBEDDED_MODE) && defined(OSQP_ENABLE_PROFILING)
+  if (timed) osqp_tic(work->trace->timer);
+#endif /* if !defined(OSQP_EMBEDDED_MODE) && defined(OSQP_ENABLE_PROFILING) */
+
   work->linsys_solver->solve(work->linsys_solver, work->xz_tilde, admm_iter);
+
+#if !defined(OSQP_EMBEDDED_MODE) && defined(OSQP_ENABLE_PROFILING)
+  if (timed) work->trace->linsys_time = osqp_toc(work->trace->timer);
+#endif /* if !defined(OSQP_EMBEDDED_MODE) && defined(OSQP_ENABLE_PROFILING) */
 }
 
 void update_x(OSQPSolver* solver) {
@@ -270,9 +286,10 @@ static OSQPFloat compute_prim_res(OSQPSolver*        solver,
   return prim_res;
 }
 
-static OSQPFloat compute_prim_tol(const OSQPSolver* solver,
-                                  OSQPFloat         eps_abs,
-                                  OSQPFloat         eps_rel) {
+static OSQPFloat compute_prim_tol(const OSQPSolver*  solver,
+                                  const OSQPVectorf* z,
+                                  OSQPFloat          eps_abs,
+                                  OSQPFloat          eps_rel) {
 
   OSQPFloat max_rel_eps, temp_rel_eps;
   OSQPSettings*  settings = solver->settings;
@@ -282,7 +299,7 @@ static OSQPFloat compute_prim_tol(const OSQPSolver* solver,
   if (settings->scaling && !settings->scaled_termination) {
     // ||Einv * z||
     max_rel_eps =
-    OSQPVectorf_scaled_norm_inf(work->scaling->Einv, work->z);
+    OSQPVectorf_scaled_norm_inf(work->scaling->Einv, z);
 
     // ||Einv * A * x||
     temp_rel_eps =
@@ -294,7 +311,7 @@ static OSQPFloat compute_prim_tol(const OSQPSolver* solver,
 
   else { // No unscaling required
     // ||z||
-    max_rel_eps = OSQPVectorf_norm_inf(work->z);
+    max_rel_eps = OSQPVectorf_norm_inf(z);
 
     // ||A * x||
     temp_rel_eps = OSQPVectorf_norm_inf(work->Ax);
@@ -780,7 +797,7 @@ OSQPInt check_termination(OSQPSolver* solver,
   }
   else {
     // Compute primal tolerance
-    eps_prim = compute_prim_tol(solver, eps_abs, eps_rel);
+    eps_prim = compute_prim_tol(solver, work->z, eps_abs, eps_rel);
 
     // Primal feasibility check
     if (info->prim_res < eps_prim) {
@@ -853,6 +870,28 @@ OSQPInt check_termination(OSQPSolver* solver,
 
 #ifndef OSQP_EMBEDDED_MODE
 
+OSQPInt check_polish_termination(const OSQPSolver* solver) {
+
+  OSQPFloat eps_prim, eps_dual;
+
+  OSQPSettings*  settings = solver->settings;
+  OSQPWorkspace* work     = solver->work;
+
+  // NB: update_info at the polished solution left A*x, P*x and A'*y
+  //     in work->Ax, work->Px and work->Aty
+  eps_dual = compute_dual_tol(solver, settings->eps_abs, settings->eps_rel);
+
+  if (work->pol->dual_res >= eps_dual) return 0;
+
+  // No constraints -> Primal feasibility always satisfied
+  if (work->data->m == 0) return 1;
+
+  eps_prim = compute_prim_tol(solver, work->pol->z,
+                              settings->eps_abs, settings->eps_rel);
+
+  return (work->pol->prim_res < eps_prim);
+}
+
 OSQPInt validate_data(const OSQPCscMatrix* P,
                       const OSQPFloat*     q,
                       const OSQPCscMatrix* A,
@@ -1112,5 +1151,70 @@ OSQPInt validate_settings(const OSQPSettings* settings,
     return 1;
   }
 
+  if (settings->polish_early_checks < 0) {
+    c_eprint("polish_early_checks must be nonnegative");
+    return 1;
+  }
+
+  if (settings->trace_size < 0) {
+    c_eprint("trace_size must be nonnegative");
+    return 1;
+  }
+
+  if (settings->kkt_ordering != OSQP_ORDERING_AMD &&
+      settings->kkt_ordering != OSQP_ORDERING_NESDIS &&
+      settings->kkt_ordering != OSQP_ORDERING_USER &&
+      settings->kkt_ordering != OSQP_ORDERING_AUTO) {
+    c_eprint("kkt_ordering not recognized");
+    return 1;
+  }
+
+  if (settings->kkt_ordering == OSQP_ORDERING_USER && !settings->kkt_permutation) {
+    c_eprint("kkt_permutation must be provided when kkt_ordering is OSQP_ORDERING_USER");
+    return 1;
+  }
+
+  if (settings->amd_aggressive != 0 &&
+      settings->amd_aggressive != 1) {
+    c_eprint("amd_aggressive must be either 0 or 1");
+    return 1;
+  }
+
+  if (settings->dyn_reg != 0 &&
+      settings->dyn_reg != 1) {
+    c_eprint("dyn_reg must be either 0 or 1");
+    return 1;
+  }
+
+  if (settings->dyn_reg_eps < 0.0) {
+    c_eprint("dyn_reg_eps must be nonnegative");
+    return 1;
+  }
+
+  if (settings->dyn_reg_delta <= settings->dyn_reg_eps) {
+    c_eprint("dyn_reg_delta must be greater than dyn_reg_eps");
+    return 1;
+  }
+
+  if (settings->dyn_reg_refine_iter < 0) {
+    c_eprint("dyn_reg_refine_iter must be nonnegative");
+    return 1;
+  }
+
+  if (settings->kkt_system != OSQP_KKT_SYSTEM_FULL &&
+      settings->kkt_system != OSQP_KKT_SYSTEM_REDUCED &&
+      settings->kkt_system != OSQP_KKT_SYSTEM_AUTO &&
+      settings->kkt_system != OSQP_KKT_SYSTEM_DENSE &&
+      settings->kkt_system != OSQP_KKT_SYSTEM_STAGED) {
+    c_eprint("kkt_system not recognized");
+    return 1;
+  }
+
+  if (from_setup &&
+      settings->kkt_system == OSQP_KKT_SYSTEM_STAGED && !settings->kkt_stages) {
+    c_eprint("kkt_stages must be provided when kkt_system is OSQP_KKT_SYSTEM_STAGED");
+    return 1;
+  }
+
   return 0;
 }
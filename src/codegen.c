@@ -26,19 +26,79 @@
   exitflag = f; \
   if (exitflag) { return _osqp_error_line(exitflag, __FUNCTION__, __FILE__, __LINE__); }
 
+/* Qualifiers of the data the generated solver never modifies. OSQP_CODEGEN_FLASH
+ * can be defined when compiling the generated code to place it in a given section */
+#define CONST_QUAL        "OSQP_CODEGEN_FLASH const "
+#define STATIC_CONST_QUAL "static OSQP_CODEGEN_FLASH const "
+
+/* Cast needed to store the address of data declared with the qualifier qual in a structure */
+#define QUAL_CAST(qual, type) ((qual)[0] ? "(" type " *)" : "")
+
+/*********
+* Footprint
+**********/
+
+/*
+ * Footprint report listing the size of every array written to the workspace.
+ * codegen_src owns it for a single generation and passes it to the writers.
+ */
+typedef struct {
+  FILE*   file;
+  OSQPInt count;
+  OSQPInt float_bytes;
+  OSQPInt flash;
+  OSQPInt ram;
+  OSQPInt instance;
+} footprint;
+
+/* Size of the integers in the generated code, which does not use OSQP_USE_LONG */
+#define FOOTPRINT_INT_BYTES ((OSQPInt)sizeof(int))
+
+/* Record an array of the given section ("flash", "ram" or "instance") */
+static void footprint_add(footprint*  fp,
+                          const char* name,
+                          OSQPInt     bytes,
+                          const char* section) {
+
+  if (bytes <= 0) return;
+
+  if (fp->count++) fprintf(fp->file, ",\n");
+  fprintf(fp->file, "    { \"name\": \"%s\", \"section\": \"%s\", \"bytes\": %" OSQP_INT_FMT " }",
+          name, section, bytes);
+
+  if      (section[0] == 'f') fp->flash    += bytes;
+  else if (section[0] == 'r') fp->ram      += bytes;
+  else                        fp->instance += bytes;
+}
+
+/* Write an uninitialized array the solver works in */
+static void write_array(FILE*       f,
+                        footprint*  fp,
+                        const char* type,
+                        OSQPInt     elem_bytes,
+                        const char* name,
+                        OSQPInt     n) {
+
+  fprintf(f, "%s %s[%" OSQP_INT_FMT "];\n", type, name, n);
+  footprint_add(fp, name, n*elem_bytes, "ram");
+}
+
 /*********
 * Vectors
 **********/
 
 static OSQPInt write_vecf(FILE*            f,
+                          footprint*       fp,
                           const OSQPFloat* vecf,
                           OSQPInt          n,
-                          const char*      name) {
+                          const char*      name,
+                          const char*      qual) {
 
   OSQPInt i;
 
   if (n && vecf) {
-    fprintf(f, "OSQPFloat %s[%" OSQP_INT_FMT "] = {\n", name, n);
+    footprint_add(fp, name, n*fp->float_bytes, qual[0] ? "flash" : "ram");
+    fprintf(f, "%sOSQPFloat %s[%" OSQP_INT_FMT "] = {\n", qual, name, n);
     for (i = 0; i < n; i++) {
       fprintf(f, "  (OSQPFloat)%.20f,\n", vecf[i]);
     }
@@ -52,14 +112,17 @@ static OSQPInt write_vecf(FILE*            f,
 }
 
 static OSQPInt write_veci(FILE*          f,
+                          footprint*     fp,
                           const OSQPInt* veci,
                           OSQPInt        n,
-                          const char*    name) {
+                          const char*    name,
+                          const char*    qual) {
 
   OSQPInt i;
 
   if (n && veci) {
-    fprintf(f, "OSQPInt %s[%" OSQP_INT_FMT "] = {\n", name, n);
+    footprint_add(fp, name, n*FOOTPRINT_INT_BYTES, qual[0] ? "flash" : "ram");
+    fprintf(f, "%sOSQPInt %s[%" OSQP_INT_FMT "] = {\n", qual, name, n);
     for (i = 0; i < n; i++) {
       fprintf(f, "  %" OSQP_INT_FMT ",\n", veci[i]);
     }
@@ -73,24 +136,32 @@ static OSQPInt write_veci(FILE*          f,
 }
 
 static OSQPInt write_OSQPVectorf(FILE*              f,
+                                 footprint*         fp,
                                  const OSQPVectorf* vec,
-                                 const char*        name) {
+                                 const char*        name,
+                                 const char*        qual) {
   
   OSQPInt exitflag = OSQP_NO_ERROR;
   char vecf_name[MAX_VAR_LENGTH];
 
   if (!vec) return OSQP_DATA_NOT_INITIALIZED;
 
-  sprintf(vecf_name, "%s_val", name);
-  PROPAGATE_ERROR(write_vecf(f, vec->values, vec->length, vecf_name))
-  fprintf(f, "OSQPVectorf %s = {\n  %s,\n  %" OSQP_INT_FMT "\n};\n", name, vecf_name, vec->length);
+  if (snprintf(vecf_name, sizeof(vecf_name), "%s_val", name) >= (int)sizeof(vecf_name)) {
+    c_eprint("Variable name %s is too long", name);
+    return OSQP_CODEGEN_DEFINES_ERROR;
+  }
+  PROPAGATE_ERROR(write_vecf(f, fp, vec->values, vec->length, vecf_name, qual))
+  fprintf(f, "%sOSQPVectorf %s = {\n  %s%s,\n  %" OSQP_INT_FMT "\n};\n",
+          qual, name, QUAL_CAST(qual, "OSQPFloat"), vecf_name, vec->length);
 
   return exitflag;
 }
 
 static OSQPInt write_OSQPVectori(FILE*              f,
+                                 footprint*         fp,
                                  const OSQPVectori* vec,
-                                 const char*        name) {
+                                 const char*        name,
+                                 const char*        qual) {
   
   OSQPInt exitflag = OSQP_NO_ERROR;
   char veci_name[MAX_VAR_LENGTH+4];
@@ -98,8 +169,9 @@ static OSQPInt write_OSQPVectori(FILE*              f,
   if (!vec) return OSQP_DATA_NOT_INITIALIZED;
 
   sprintf(veci_name, "%s_val", name);
-  PROPAGATE_ERROR(write_veci(f, vec->values, vec->length, veci_name))
-  fprintf(f, "OSQPVectori %s = {\n  %s,\n  %" OSQP_INT_FMT "\n};\n", name, veci_name, vec->length);
+  PROPAGATE_ERROR(write_veci(f, fp, vec->values, vec->length, veci_name, qual))
+  fprintf(f, "%sOSQPVectori %s = {\n  %s%s,\n  %" OSQP_INT_FMT "\n};\n",
+          qual, name, QUAL_CAST(qual, "OSQPInt"), veci_name, vec->length);
 
   return exitflag;
 }
@@ -110,8 +182,11 @@ static OSQPInt write_OSQPVectori(FILE*              f,
 **********/
 
 static OSQPInt write_csc(FILE*                f,
+                         footprint*           fp,
                          const OSQPCscMatrix* M,
-                         const char*          name) {
+                         const char*          name,
+                         const char*          qual,
+                         const char*          iqual) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
   char vec_name[MAX_VAR_LENGTH];
@@ -119,17 +194,17 @@ static OSQPInt write_csc(FILE*                f,
   if (!M) return OSQP_DATA_NOT_INITIALIZED;
 
   sprintf(vec_name, "%s_p", name);
-  PROPAGATE_ERROR(write_veci(f, M->p, M->n+1, vec_name))
+  PROPAGATE_ERROR(write_veci(f, fp, M->p, M->n+1, vec_name, iqual))
   sprintf(vec_name, "%s_i", name);
-  PROPAGATE_ERROR(write_veci(f, M->i, M->nzmax, vec_name))
+  PROPAGATE_ERROR(write_veci(f, fp, M->i, M->nzmax, vec_name, iqual))
   sprintf(vec_name, "%s_x", name);
-  PROPAGATE_ERROR(write_vecf(f, M->x, M->nzmax, vec_name))
-  fprintf(f, "OSQPCscMatrix %s = {\n", name);
+  PROPAGATE_ERROR(write_vecf(f, fp, M->x, M->nzmax, vec_name, qual))
+  fprintf(f, "%sOSQPCscMatrix %s = {\n", qual, name);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", M->m);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", M->n);
-  fprintf(f, "  %s_p,\n", name);
-  fprintf(f, "  %s_i,\n", name);
-  fprintf(f, "  %s_x,\n", name);
+  fprintf(f, "  %s%s_p,\n", QUAL_CAST(iqual, "OSQPInt"),  name);
+  fprintf(f, "  %s%s_i,\n", QUAL_CAST(iqual, "OSQPInt"),  name);
+  fprintf(f, "  %s%s_x,\n", QUAL_CAST(qual, "OSQPFloat"), name);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", M->nzmax);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", M->nz);
   fprintf(f, "};\n");
@@ -137,20 +212,272 @@ static OSQPInt write_csc(FILE*                f,
   return exitflag;
 }
 
-static OSQPInt write_OSQPMatrix(FILE*             f,
-                                const OSQPMatrix* mat,
-                                const char*       name) {
+/*
+ * Build a row-wise view of the pattern of a CSC matrix. Entry k of row i in the
+ * view is stored at Rk[Rp[i]+k] (index into M->x) and Rj[Rp[i]+k] (its column).
+ * The arrays are allocated here and must be freed by the caller.
+ */
+static OSQPInt csc_row_view(const OSQPCscMatrix* M,
+                            OSQPInt**            Rp,
+                            OSQPInt**            Rk,
+                            OSQPInt**            Rj) {
+
+  OSQPInt i, j, k;
+  OSQPInt *next;
+  OSQPInt nnz = M->p[M->n];
+
+  *Rp  = (OSQPInt *)c_calloc(M->m + 1, sizeof(OSQPInt));
+  *Rk  = (OSQPInt *)c_malloc((nnz + 1) * sizeof(OSQPInt));
+  *Rj  = (OSQPInt *)c_malloc((nnz + 1) * sizeof(OSQPInt));
+  next = (OSQPInt *)c_malloc((M->m + 1) * sizeof(OSQPInt));
+
+  if (!*Rp || !*Rk || !*Rj || !next) {
+    c_free(*Rp);
+    c_free(*Rk);
+    c_free(*Rj);
+    c_free(next);
+    return osqp_error(OSQP_MEM_ALLOC_ERROR);
+  }
+
+  for (k = 0; k < nnz; k++) (*Rp)[M->i[k] + 1]++;
+  for (i = 0; i < M->m; i++) {
+    (*Rp)[i + 1] += (*Rp)[i];
+    next[i]       = (*Rp)[i];
+  }
+  for (j = 0; j < M->n; j++) {
+    for (k = M->p[j]; k < M->p[j + 1]; k++) {
+      i = M->i[k];
+      (*Rk)[next[i]] = k;
+      (*Rj)[next[i]] = j;
+      next[i]++;
+    }
+  }
+
+  c_free(next);
+
+  return OSQP_NO_ERROR;
+}
+
+/* Write one term of an unrolled dot product, starting the assignment on the first one */
+static void write_spmv_term(FILE*    f,
+                            OSQPInt  row,
+                            OSQPInt  k,
+                            OSQPInt  col,
+                            OSQPInt* first) {
+
+  if (*first) {
+    fprintf(f, "  y[%" OSQP_INT_FMT "] = Mx[%" OSQP_INT_FMT "] * x[%" OSQP_INT_FMT "]", row, k, col);
+    *first = 0;
+  }
+  else {
+    fprintf(f, "\n         + Mx[%" OSQP_INT_FMT "] * x[%" OSQP_INT_FMT "]", k, col);
+  }
+}
+
+static void write_spmv_end(FILE*   f,
+                           OSQPInt row,
+                           OSQPInt first) {
+
+  if (first) fprintf(f, "  y[%" OSQP_INT_FMT "] = (OSQPFloat)0.0;\n", row);
+  else       fprintf(f, ";\n");
+}
+
+/*
+ * Write y = M*x (and y = M'*x for nonsymmetric matrices) specialized to the
+ * sparsity pattern of M. Every entry of y is a single sum, so y is never read
+ * and needs no initialization. The values of M are still read from M->x so
+ * they can change with matrix updates.
+ */
+static OSQPInt write_spmv_unrolled(FILE*             f,
+                                   const OSQPMatrix* mat,
+                                   const char*       name) {
+
+  OSQPInt exitflag = OSQP_NO_ERROR;
+  OSQPInt i, j, k, first;
+  OSQPInt *Rp, *Rk, *Rj;
+
+  const OSQPCscMatrix* M = mat->csc;
+
+  PROPAGATE_ERROR(csc_row_view(M, &Rp, &Rk, &Rj))
+
+  fprintf(f, "/* Compute y = M*x with the sparsity pattern of %s unrolled */\n", name);
+  fprintf(f, "static void %s_Axpy(const OSQPFloat* Mx, const OSQPFloat* x, OSQPFloat* y) {\n", name);
+  if (M->p[M->n] == 0) {
+    fprintf(f, "  (void)Mx;\n");
+    fprintf(f, "  (void)x;\n");
+  }
+  for (i = 0; i < M->m; i++) {
+    first = 1;
+    if (mat->symmetry == TRIU) {
+      /* Upper triangle from column i, mirrored lower triangle from row i */
+      for (k = M->p[i]; k < M->p[i + 1]; k++) {
+        write_spmv_term(f, i, k, M->i[k], &first);
+      }
+      for (k = Rp[i]; k < Rp[i + 1]; k++) {
+        if (Rj[k] != i) write_spmv_term(f, i, Rk[k], Rj[k], &first);
+      }
+    }
+    else {
+      for (k = Rp[i]; k < Rp[i + 1]; k++) {
+        write_spmv_term(f, i, Rk[k], Rj[k], &first);
+      }
+    }
+    write_spmv_end(f, i, first);
+  }
+  fprintf(f, "}\n\n");
+
+  if (mat->symmetry == NONE) {
+    fprintf(f, "/* Compute y = M'*x with the sparsity pattern of %s unrolled */\n", name);
+    fprintf(f, "static void %s_Atxpy(const OSQPFloat* Mx, const OSQPFloat* x, OSQPFloat* y) {\n", name);
+    if (M->p[M->n] == 0) {
+      fprintf(f, "  (void)Mx;\n");
+      fprintf(f, "  (void)x;\n");
+    }
+    for (j = 0; j < M->n; j++) {
+      first = 1;
+      for (k = M->p[j]; k < M->p[j + 1]; k++) {
+        write_spmv_term(f, j, k, M->i[k], &first);
+      }
+      write_spmv_end(f, j, first);
+    }
+    fprintf(f, "}\n\n");
+  }
+
+  c_free(Rp);
+  c_free(Rk);
+  c_free(Rj);
+
+  return exitflag;
+}
+
+/*
+ * Write an index array with the narrowest unsigned type holding all its entries.
+ * The array always has at least one element so that the kernels reading it compile.
+ */
+static void write_veci_compact(FILE*          f,
+                               footprint*     fp,
+                               const OSQPInt* veci,
+                               OSQPInt        n,
+                               const char*    name) {
+
+  OSQPInt i;
+  OSQPInt vmax = 0;
+  OSQPInt bytes;
+  const char* type;
+
+  for (i = 0; i < n; i++) vmax = c_max(vmax, veci[i]);
+
+  if (vmax <= 0xFF) {
+    type  = "unsigned char";
+    bytes = 1;
+  }
+  else if (vmax <= 0xFFFF) {
+    type  = "unsigned short";
+    bytes = 2;
+  }
+  else {
+    type  = "OSQPInt";
+    bytes = FOOTPRINT_INT_BYTES;
+  }
+
+  footprint_add(fp, name, n*bytes, "flash");
+  fprintf(f, "%s%s %s[%" OSQP_INT_FMT "] = {\n", STATIC_CONST_QUAL, type, name, c_max(n, 1));
+  for (i = 0; i < n; i++) {
+    fprintf(f, "  %" OSQP_INT_FMT ",\n", veci[i]);
+  }
+  if (n == 0) fprintf(f, "  0\n");
+  fprintf(f, "};\n");
+}
+
+/*
+ * Write y = M*x and y = M'*x as loops over compact copies of the pattern of M.
+ * They follow the order of csc_Axpy, csc_Axpy_sym_triu and csc_Atxpy.
+ */
+static void write_spmv_compact(FILE*             f,
+                               footprint*        fp,
+                               const OSQPMatrix* mat,
+                               const char*       name) {
+
+  const OSQPCscMatrix* M = mat->csc;
+  char vec_name[MAX_VAR_LENGTH+4];
+
+  sprintf(vec_name, "%s_p_c", name);
+  write_veci_compact(f, fp, M->p, M->n+1, vec_name);
+  sprintf(vec_name, "%s_i_c", name);
+  write_veci_compact(f, fp, M->i, M->p[M->n], vec_name);
+
+  fprintf(f, "/* Compute y = M*x with the compact pattern of %s */\n", name);
+  fprintf(f, "static void %s_Axpy(const OSQPFloat* Mx, const OSQPFloat* x, OSQPFloat* y) {\n", name);
+  fprintf(f, "  OSQPInt i, j, k;\n\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) y[i] = 0.0;\n", M->m);
+  fprintf(f, "  for (j = 0; j < %" OSQP_INT_FMT "; j++) {\n", M->n);
+  fprintf(f, "    for (k = %s_p_c[j]; k < %s_p_c[j + 1]; k++) {\n", name, name);
+  fprintf(f, "      i = %s_i_c[k];\n", name);
+  fprintf(f, "      y[i] += Mx[k] * x[j];\n");
+  if (mat->symmetry == TRIU) {
+    fprintf(f, "      if (i != j) y[j] += Mx[k] * x[i];\n");
+  }
+  fprintf(f, "    }\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "}\n\n");
+
+  if (mat->symmetry == NONE) {
+    fprintf(f, "/* Compute y = M'*x with the compact pattern of %s */\n", name);
+    fprintf(f, "static void %s_Atxpy(const OSQPFloat* Mx, const OSQPFloat* x, OSQPFloat* y) {\n", name);
+    fprintf(f, "  OSQPInt j, k;\n\n");
+    fprintf(f, "  for (j = 0; j < %" OSQP_INT_FMT "; j++) {\n", M->n);
+    fprintf(f, "    y[j] = 0.0;\n");
+    fprintf(f, "    for (k = %s_p_c[j]; k < %s_p_c[j + 1]; k++) {\n", name, name);
+    fprintf(f, "      y[j] += Mx[k] * x[%s_i_c[k]];\n", name);
+    fprintf(f, "    }\n");
+    fprintf(f, "  }\n");
+    fprintf(f, "}\n\n");
+  }
+}
+
+static OSQPInt write_OSQPMatrix(FILE*                     f,
+                                footprint*                fp,
+                                const OSQPMatrix*         mat,
+                                const char*               name,
+                                const OSQPCodegenDefines* defines,
+                                const char*               qual,
+                                const char*               iqual) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
   char csc_name[MAX_VAR_LENGTH+4];
+  OSQPCscMatrix csc;
+  OSQPInt spmv_gen = defines->spmv_unroll_enable || defines->compact_index_enable;
 
   if (!mat) return OSQP_DATA_NOT_INITIALIZED;
 
+  if (defines->spmv_unroll_enable) {
+    PROPAGATE_ERROR(write_spmv_unrolled(f, mat, name))
+  }
+  else if (defines->compact_index_enable) {
+    write_spmv_compact(f, fp, mat, name);
+  }
+
+  /* The generated products are the only users of the pattern unless the
+   * matrix gets rescaled after an update */
+  csc = *mat->csc;
+  if (spmv_gen && defines->embedded_mode == 1) {
+    csc.p = OSQP_NULL;
+    csc.i = OSQP_NULL;
+  }
+
   sprintf(csc_name, "%s_csc", name);
-  PROPAGATE_ERROR(write_csc(f, mat->csc, csc_name))
-  fprintf(f, "OSQPMatrix %s = {\n", name);
-  fprintf(f, "  &%s,\n", csc_name);
-  fprintf(f, "  %d\n", mat->symmetry);
+  PROPAGATE_ERROR(write_csc(f, fp, &csc, csc_name, qual, iqual))
+  fprintf(f, "%sOSQPMatrix %s = {\n", qual, name);
+  fprintf(f, "  %s&%s,\n", QUAL_CAST(qual, "OSQPCscMatrix"), csc_name);
+  if (spmv_gen) {
+    fprintf(f, "  %d,\n", mat->symmetry);
+    fprintf(f, "  &%s_Axpy,\n", name);
+    if (mat->symmetry == NONE) fprintf(f, "  &%s_Atxpy\n", name);
+    else                       fprintf(f, "  &%s_Axpy\n", name);
+  }
+  else {
+    fprintf(f, "  %d\n", mat->symmetry);
+  }
   fprintf(f, "};\n");
   
   return exitflag;
@@ -163,12 +490,13 @@ static OSQPInt write_OSQPMatrix(FILE*             f,
 
 static OSQPInt write_settings(FILE*               f,
                               const OSQPSettings* settings,
-                              const char*         prefix) {
+                              const char*         prefix,
+                              const char*         qual) {
   
   if (!settings) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
 
   fprintf(f, "/* Define the settings structure */\n");
-  fprintf(f, "OSQPSettings %ssettings = {\n", prefix);
+  fprintf(f, "%sOSQPSettings %ssettings = {\n", qual, prefix);
   fprintf(f, "  0,\n"); // device
   fprintf(f, "  OSQP_DIRECT_SOLVER,\n");
   fprintf(f, "  1,\n"); // allocate_solution
@@ -199,6 +527,18 @@ static OSQPInt write_settings(FILE*               f,
   fprintf(f, "  (OSQPFloat)%.20f,\n", settings->time_limit);
   fprintf(f, "  (OSQPFloat)%.20f,\n", settings->delta);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", settings->polish_refine_iter);
+  fprintf(f, "  0,\n"); // polish_early_checks
+  fprintf(f, "  0,\n"); // trace_size
+  fprintf(f, "  %u,\n", settings->kkt_ordering);
+  fprintf(f, "  (OSQPFloat)%.20f,\n", settings->amd_dense);
+  fprintf(f, "  %" OSQP_INT_FMT ",\n", settings->amd_aggressive);
+  fprintf(f, "  OSQP_NULL,\n"); // kkt_permutation
+  fprintf(f, "  %" OSQP_INT_FMT ",\n", settings->dyn_reg);
+  fprintf(f, "  (OSQPFloat)%.20f,\n", settings->dyn_reg_eps);
+  fprintf(f, "  (OSQPFloat)%.20f,\n", settings->dyn_reg_delta);
+  fprintf(f, "  %" OSQP_INT_FMT ",\n", settings->dyn_reg_refine_iter);
+  fprintf(f, "  %u,\n", settings->kkt_system);
+  fprintf(f, "  OSQP_NULL,\n"); // kkt_stages
   fprintf(f, "};\n\n");
 
   return OSQP_NO_ERROR;
@@ -211,12 +551,13 @@ static OSQPInt write_settings(FILE*               f,
 
 static OSQPInt write_info(FILE*           f,
                           const OSQPInfo* info,
-                          const char*     prefix) {
+                          const char*     prefix,
+                          const char*     qual) {
   
   if (!info) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
 
   fprintf(f, "/* Define the info structure */\n");
-  fprintf(f, "OSQPInfo %sinfo = {\n", prefix);
+  fprintf(f, "%sOSQPInfo %sinfo = {\n", qual, prefix);
   fprintf(f, "  \"%s\",\n", OSQP_STATUS_MESSAGE[OSQP_UNSOLVED]);
   fprintf(f, "  %d,\n", OSQP_UNSOLVED);
   fprintf(f, "  0,\n"); // status_polish
@@ -226,6 +567,7 @@ static OSQPInt write_info(FILE*           f,
   fprintf(f, "  0,\n"); // iter (iteration count)
   fprintf(f, "  0,\n"); // rho_updates
   fprintf(f, "  (OSQPFloat)%.20f,\n", info->rho_estimate);
+  fprintf(f, "  %" OSQP_INT_FMT ",\n", info->factor_nnz);
   fprintf(f, "  (OSQPFloat)0.0,\n"); // setup_time
   fprintf(f, "  (OSQPFloat)0.0,\n"); // solve_time
   fprintf(f, "  (OSQPFloat)0.0,\n"); // update_time
@@ -242,19 +584,26 @@ static OSQPInt write_info(FILE*           f,
 ***********/
 
 static OSQPInt write_solution(FILE*       f,
+                              footprint*  fp,
                               OSQPInt     n,
                               OSQPInt     m,
                               const char* prefix) {
 
+  char name[MAX_VAR_LENGTH];
+
   /* No need to actually test anything here */
 
   fprintf(f, "/* Define the solution structure */\n");
-  fprintf(f, "OSQPFloat %ssol_x[%" OSQP_INT_FMT "];\n", prefix, n);
-  if (m > 0) fprintf(f, "OSQPFloat %ssol_y[%" OSQP_INT_FMT "];\n", prefix, m);
-  else       fprintf(f, "#define %ssol_y (OSQP_NULL)\n", prefix);
-  if (m > 0) fprintf(f, "OSQPFloat %ssol_prim_inf_cert[%" OSQP_INT_FMT "];\n", prefix, m);
-  else       fprintf(f, "#define %ssol_prim_inf_cert (OSQP_NULL)\n", prefix);
-  fprintf(f, "OSQPFloat %ssol_dual_inf_cert[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%ssol_x", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
+  sprintf(name, "%ssol_y", prefix);
+  if (m > 0) write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
+  else       fprintf(f, "#define %s (OSQP_NULL)\n", name);
+  sprintf(name, "%ssol_prim_inf_cert", prefix);
+  if (m > 0) write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
+  else       fprintf(f, "#define %s (OSQP_NULL)\n", name);
+  sprintf(name, "%ssol_dual_inf_cert", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPSolution %ssol = {\n", prefix);
   fprintf(f, "  %ssol_x,\n", prefix);
   fprintf(f, "  %ssol_y,\n", prefix);
@@ -271,8 +620,10 @@ static OSQPInt write_solution(FILE*       f,
 **********/
 
 static OSQPInt write_scaling(FILE*              f,
+                             footprint*         fp,
                              const OSQPScaling* scaling,
-                             const char*        prefix) {
+                             const char*        prefix,
+                             const char*        qual) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
   char name[MAX_VAR_LENGTH];
@@ -281,20 +632,20 @@ static OSQPInt write_scaling(FILE*              f,
 
   fprintf(f, "\n/* Define the scaling structure */\n");
   sprintf(name, "%sscaling_D", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, scaling->D,    name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, scaling->D,    name, qual))
   sprintf(name, "%sscaling_E", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, scaling->E,    name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, scaling->E,    name, qual))
   sprintf(name, "%sscaling_Dinv", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, scaling->Dinv, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, scaling->Dinv, name, qual))
   sprintf(name, "%sscaling_Einv", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, scaling->Einv, name))
-  fprintf(f, "OSQPScaling %sscaling = {\n", prefix);
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, scaling->Einv, name, qual))
+  fprintf(f, "%sOSQPScaling %sscaling = {\n", qual, prefix);
   fprintf(f, "  (OSQPFloat)%.20f,\n", scaling->c);
-  fprintf(f, "  &%sscaling_D,\n", prefix);
-  fprintf(f, "  &%sscaling_E,\n", prefix);
+  fprintf(f, "  %s&%sscaling_D,\n", QUAL_CAST(qual, "OSQPVectorf"), prefix);
+  fprintf(f, "  %s&%sscaling_E,\n", QUAL_CAST(qual, "OSQPVectorf"), prefix);
   fprintf(f, "  (OSQPFloat)%.20f,\n", scaling->cinv);
-  fprintf(f, "  &%sscaling_Dinv,\n", prefix);
-  fprintf(f, "  &%sscaling_Einv\n", prefix);
+  fprintf(f, "  %s&%sscaling_Dinv,\n", QUAL_CAST(qual, "OSQPVectorf"), prefix);
+  fprintf(f, "  %s&%sscaling_Einv\n", QUAL_CAST(qual, "OSQPVectorf"), prefix);
   fprintf(f, "};\n\n");
 
   return exitflag;
@@ -305,31 +656,37 @@ static OSQPInt write_scaling(FILE*              f,
 * Data
 *******/
 
-static OSQPInt write_data(FILE*           f,
-                          const OSQPData* data,
-                          const char*     prefix) {
+static OSQPInt write_data(FILE*                     f,
+                          footprint*                fp,
+                          const OSQPData*           data,
+                          const char*               prefix,
+                          const OSQPCodegenDefines* defines) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
   char name[MAX_VAR_LENGTH];
 
+  /* Matrix updates only change the values, never the sparsity pattern */
+  const char* qual  = defines->embedded_mode == 1 ? CONST_QUAL : "";
+  const char* iqual = CONST_QUAL;
+
   if (!data) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
 
   fprintf(f, "/* Define the data structure */\n");
   sprintf(name, "%sdata_P", prefix);
-  GENERATE_ERROR(write_OSQPMatrix(f,  data->P, name))
+  GENERATE_ERROR(write_OSQPMatrix(f, fp,  data->P, name, defines, qual, iqual))
   sprintf(name, "%sdata_A", prefix);
-  GENERATE_ERROR(write_OSQPMatrix(f,  data->A, name))
+  GENERATE_ERROR(write_OSQPMatrix(f, fp,  data->A, name, defines, qual, iqual))
   sprintf(name, "%sdata_q", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, data->q, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, data->q, name, ""))
   sprintf(name, "%sdata_l", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, data->l, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, data->l, name, ""))
   sprintf(name, "%sdata_u", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, data->u, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, data->u, name, ""))
   fprintf(f, "OSQPData %sdata = {\n", prefix);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", data->n);
   fprintf(f, "  %" OSQP_INT_FMT ",\n", data->m);
-  fprintf(f, "  &%sdata_P,\n", prefix);
-  fprintf(f, "  &%sdata_A,\n", prefix);
+  fprintf(f, "  %s&%sdata_P,\n", QUAL_CAST(qual, "OSQPMatrix"), prefix);
+  fprintf(f, "  %s&%sdata_A,\n", QUAL_CAST(qual, "OSQPMatrix"), prefix);
   fprintf(f, "  &%sdata_q,\n", prefix);
   fprintf(f, "  &%sdata_l,\n", prefix);
   fprintf(f, "  &%sdata_u\n", prefix);
@@ -343,56 +700,189 @@ static OSQPInt write_data(FILE*           f,
 * Linear System Solver
 ***********************/
 
-static OSQPInt write_linsys(FILE*               f,
-                            const qdldl_solver* linsys,
-                            const OSQPData*     data,
-                            const char*         prefix,
-                            OSQPInt             embedded) {
+/*
+ * Write a solve of P'LDL'P x = b specialized to the sparsity pattern of L.
+ *
+ * The forward substitution is written row by row so each entry of the permuted
+ * right-hand side is gathered once, and the inverse permutation is applied as
+ * soon as an entry of the backward substitution is final. Only the values of
+ * L and Dinv are read at run time, so the factor can still be refreshed by
+ * matrix updates.
+ */
+static OSQPInt write_ldl_unrolled(FILE*               f,
+                                  const qdldl_solver* linsys,
+                                  const char*         prefix) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
+  OSQPInt i, j, k;
+  OSQPInt *Rp, *Rk, *Rj;
+
+  const OSQPCscMatrix* L = linsys->L;
+
+  OSQPInt nm = linsys->n + linsys->m;
+
+  PROPAGATE_ERROR(csc_row_view(L, &Rp, &Rk, &Rj))
+
+  fprintf(f, "/* Solve P'LDL'P x = b with the sparsity pattern of L and P unrolled */\n");
+  fprintf(f, "static void %slinsys_ldl_solve(OSQPFloat* x, const OSQPFloat* b, const OSQPFloat* Lx,\n", prefix);
+  fprintf(f, "                               const OSQPFloat* Dinv, OSQPFloat* t) {\n");
+
+  fprintf(f, "  /* Forward substitution L t = P b */\n");
+  for (i = 0; i < nm; i++) {
+    fprintf(f, "  t[%" OSQP_INT_FMT "] = b[%" OSQP_INT_FMT "];\n", i, linsys->P[i]);
+    for (k = Rp[i]; k < Rp[i + 1]; k++) {
+      fprintf(f, "  t[%" OSQP_INT_FMT "] -= Lx[%" OSQP_INT_FMT "] * t[%" OSQP_INT_FMT "];\n",
+              i, Rk[k], Rj[k]);
+    }
+  }
+
+  fprintf(f, "  /* Diagonal solve and backward substitution L' P x = D^{-1} t */\n");
+  for (j = nm - 1; j >= 0; j--) {
+    fprintf(f, "  t[%" OSQP_INT_FMT "] *= Dinv[%" OSQP_INT_FMT "];\n", j, j);
+    for (k = L->p[j]; k < L->p[j + 1]; k++) {
+      fprintf(f, "  t[%" OSQP_INT_FMT "] -= Lx[%" OSQP_INT_FMT "] * t[%" OSQP_INT_FMT "];\n",
+              j, k, L->i[k]);
+    }
+    fprintf(f, "  x[%" OSQP_INT_FMT "] = t[%" OSQP_INT_FMT "];\n", linsys->P[j], j);
+  }
+  fprintf(f, "}\n\n");
+
+  c_free(Rp);
+  c_free(Rk);
+  c_free(Rj);
+
+  return exitflag;
+}
+
+/*
+ * Write a solve of P'LDL'P x = b looping over compact copies of the pattern of
+ * L and of the permutation, in the same order as LDLSolve.
+ */
+static void write_ldl_compact(FILE*               f,
+                              footprint*          fp,
+                              const qdldl_solver* linsys,
+                              const char*         prefix) {
+
   char name[MAX_VAR_LENGTH];
+  const OSQPCscMatrix* L = linsys->L;
+  OSQPInt nm = linsys->n + linsys->m;
+
+  sprintf(name, "%slinsys_L_p_c", prefix);
+  write_veci_compact(f, fp, L->p, nm+1, name);
+  sprintf(name, "%slinsys_L_i_c", prefix);
+  write_veci_compact(f, fp, L->i, L->p[nm], name);
+  sprintf(name, "%slinsys_P_c", prefix);
+  write_veci_compact(f, fp, linsys->P, nm, name);
+
+  fprintf(f, "/* Solve P'LDL'P x = b with the compact pattern of L and P */\n");
+  fprintf(f, "static void %slinsys_ldl_solve(OSQPFloat* x, const OSQPFloat* b, const OSQPFloat* Lx,\n", prefix);
+  fprintf(f, "                               const OSQPFloat* Dinv, OSQPFloat* t) {\n");
+  fprintf(f, "  OSQPInt   i, k;\n");
+  fprintf(f, "  OSQPFloat val;\n\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) t[i] = b[%slinsys_P_c[i]];\n", nm, prefix);
+  fprintf(f, "  /* Forward substitution L t = P b */\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", nm);
+  fprintf(f, "    val = t[i];\n");
+  fprintf(f, "    for (k = %slinsys_L_p_c[i]; k < %slinsys_L_p_c[i + 1]; k++) {\n", prefix, prefix);
+  fprintf(f, "      t[%slinsys_L_i_c[k]] -= Lx[k] * val;\n", prefix);
+  fprintf(f, "    }\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) t[i] *= Dinv[i];\n", nm);
+  fprintf(f, "  /* Backward substitution L' P x = D^{-1} t */\n");
+  fprintf(f, "  for (i = %" OSQP_INT_FMT "; i >= 0; i--) {\n", nm - 1);
+  fprintf(f, "    val = t[i];\n");
+  fprintf(f, "    for (k = %slinsys_L_p_c[i]; k < %slinsys_L_p_c[i + 1]; k++) {\n", prefix, prefix);
+  fprintf(f, "      val -= Lx[k] * t[%slinsys_L_i_c[k]];\n", prefix);
+  fprintf(f, "    }\n");
+  fprintf(f, "    t[i] = val;\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) x[%slinsys_P_c[i]] = t[i];\n", nm, prefix);
+  fprintf(f, "}\n\n");
+}
+
+static OSQPInt write_linsys(FILE*                     f,
+                            footprint*                fp,
+                            const qdldl_solver*       linsys,
+                            const OSQPData*           data,
+                            const char*               prefix,
+                            const OSQPCodegenDefines* defines) {
+
+  OSQPInt exitflag = OSQP_NO_ERROR;
+  char name[MAX_VAR_LENGTH];
+  OSQPCscMatrix L;
 
   if (!linsys) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
 
   OSQPInt n = linsys->n;
   OSQPInt m = linsys->m;
+  OSQPInt embedded = defines->embedded_mode;
+  OSQPInt unroll   = defines->ldl_unroll_enable;
+  OSQPInt compact  = defines->compact_index_enable;
+  OSQPInt multi    = defines->multi_instance_enable;
+
+  /* The factorization only changes when it is refactored after a matrix update,
+   * and is shared between instances, which supply their own solve workspace */
+  const char* qual  = multi ? STATIC_CONST_QUAL : (embedded == 1 ? CONST_QUAL : "");
+  const char* iqual = multi ? STATIC_CONST_QUAL : CONST_QUAL;
+
+  /* The generated solves carry their own permutation, and the pattern of L is
+   * only needed when it gets refactored after a matrix update */
+  L = *linsys->L;
+  if ((unroll || compact) && embedded == 1) {
+    L.p = OSQP_NULL;
+    L.i = OSQP_NULL;
+  }
+
+  if (unroll) {
+    PROPAGATE_ERROR(write_ldl_unrolled(f, linsys, prefix))
+  }
+  else if (compact) {
+    write_ldl_compact(f, fp, linsys, prefix);
+  }
 
   fprintf(f, "/* Define the linear system solver structure */\n");
   sprintf(name, "%slinsys_L", prefix);
-  GENERATE_ERROR(write_csc(f, linsys->L, name))
+  GENERATE_ERROR(write_csc(f, fp, &L, name, qual, qual))
   sprintf(name, "%slinsys_Dinv", prefix);
-  GENERATE_ERROR(write_vecf(f, linsys->Dinv, n+m, name))
+  GENERATE_ERROR(write_vecf(f, fp, linsys->Dinv, n+m, name, qual))
   sprintf(name, "%slinsys_P", prefix);
-  GENERATE_ERROR(write_veci(f, linsys->P, n+m, name))
-  fprintf(f, "OSQPFloat %slinsys_bp[%" OSQP_INT_FMT "];\n",  prefix, n+m);
-  fprintf(f, "OSQPFloat %slinsys_sol[%" OSQP_INT_FMT "];\n", prefix, n+m);
+  GENERATE_ERROR(write_veci(f, fp, (unroll || compact) ? OSQP_NULL : linsys->P, n+m, name, iqual))
+  if (!multi) {
+    sprintf(name, "%slinsys_bp", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n+m);
+    sprintf(name, "%slinsys_sol", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n+m);
+  }
 
   if (linsys->rho_inv_vec) {
     sprintf(name, "%slinsys_rho_inv_vec", prefix);
-    GENERATE_ERROR(write_vecf(f, linsys->rho_inv_vec, m, name))
+    GENERATE_ERROR(write_vecf(f, fp, linsys->rho_inv_vec, m, name, qual))
   }
 
   if (embedded > 1) {
     sprintf(name, "%slinsys_KKT", prefix);
-    GENERATE_ERROR(write_csc(f, linsys->KKT, name))
+    GENERATE_ERROR(write_csc(f, fp, linsys->KKT, name, "", iqual))
     sprintf(name, "%slinsys_PtoKKT", prefix);
-    GENERATE_ERROR(write_veci(f, linsys->PtoKKT, data->P->csc->p[n], name))
+    GENERATE_ERROR(write_veci(f, fp, linsys->PtoKKT, data->P->csc->p[n], name, iqual))
     sprintf(name, "%slinsys_AtoKKT", prefix);
-    GENERATE_ERROR(write_veci(f, linsys->AtoKKT, data->A->csc->p[n], name))
+    GENERATE_ERROR(write_veci(f, fp, linsys->AtoKKT, data->A->csc->p[n], name, iqual))
     sprintf(name, "%slinsys_rhotoKKT", prefix);
-    GENERATE_ERROR(write_veci(f, linsys->rhotoKKT, m, name))
+    GENERATE_ERROR(write_veci(f, fp, linsys->rhotoKKT, m, name, iqual))
     sprintf(name, "%slinsys_D", prefix);
-    GENERATE_ERROR(write_vecf(f, linsys->D, n+m, name))
+    GENERATE_ERROR(write_vecf(f, fp, linsys->D, n+m, name, ""))
     sprintf(name, "%slinsys_etree", prefix);
-    GENERATE_ERROR(write_veci(f, linsys->etree, n+m, name))
+    GENERATE_ERROR(write_veci(f, fp, linsys->etree, n+m, name, iqual))
     sprintf(name, "%slinsys_Lnz", prefix);
-    GENERATE_ERROR(write_veci(f, linsys->Lnz, n+m, name))
-    fprintf(f, "QDLDL_int   %slinsys_iwork[%" OSQP_INT_FMT "];\n", prefix, 3*(n+m));
-    fprintf(f, "QDLDL_bool  %slinsys_bwork[%" OSQP_INT_FMT "];\n", prefix, n+m);
-    fprintf(f, "QDLDL_float %slinsys_fwork[%" OSQP_INT_FMT "];\n", prefix, n+m);
+    GENERATE_ERROR(write_veci(f, fp, linsys->Lnz, n+m, name, iqual))
+    sprintf(name, "%slinsys_iwork", prefix);
+    write_array(f, fp, "QDLDL_int", FOOTPRINT_INT_BYTES, name, 3*(n+m));
+    sprintf(name, "%slinsys_bwork", prefix);
+    write_array(f, fp, "QDLDL_bool", FOOTPRINT_INT_BYTES, name, n+m);
+    sprintf(name, "%slinsys_fwork", prefix);
+    write_array(f, fp, "QDLDL_float", fp->float_bytes, name, n+m);
   }
 
-  fprintf(f, "qdldl_solver %slinsys = {\n", prefix);
+  fprintf(f, "%sqdldl_solver %slinsys = {\n", qual, prefix);
   fprintf(f, "  %d,\n", linsys->type);
   fprintf(f, "  &name_qdldl,\n");
   fprintf(f, "  &solve_linsys_qdldl,\n");
@@ -402,15 +892,25 @@ static OSQPInt write_linsys(FILE*               f,
     fprintf(f, "  &update_linsys_solver_matrices_qdldl,\n");
     fprintf(f, "  &update_linsys_solver_rho_vec_qdldl,\n");
   }
+  if (unroll || compact) {
+    fprintf(f, "  &%slinsys_ldl_solve,\n", prefix);
+  }
   fprintf(f, "  %" OSQP_INT_FMT ",\n", linsys->nthreads);
-  fprintf(f, "  &%slinsys_L,\n", prefix);
-  fprintf(f, "  %slinsys_Dinv,\n", prefix);
-  fprintf(f, "  %slinsys_P,\n", prefix);
-  fprintf(f, "  %slinsys_bp,\n", prefix);
-  fprintf(f, "  %slinsys_sol,\n", prefix);
+  fprintf(f, "  %" OSQP_INT_FMT ",\n", linsys->factor_nnz);
+  fprintf(f, "  %s&%slinsys_L,\n", QUAL_CAST(qual, "OSQPCscMatrix"), prefix);
+  fprintf(f, "  %s%slinsys_Dinv,\n", QUAL_CAST(qual, "OSQPFloat"), prefix);
+  fprintf(f, "  %s%slinsys_P,\n", QUAL_CAST(iqual, "OSQPInt"), prefix);
+  if (multi) {
+    fprintf(f, "  OSQP_NULL,\n");  /* bp, provided by each instance */
+    fprintf(f, "  OSQP_NULL,\n");  /* sol, provided by each instance */
+  }
+  else {
+    fprintf(f, "  %slinsys_bp,\n", prefix);
+    fprintf(f, "  %slinsys_sol,\n", prefix);
+  }
 
   if (linsys->rho_inv_vec) {
-    fprintf(f, "  %slinsys_rho_inv_vec,\n", prefix);
+    fprintf(f, "  %s%slinsys_rho_inv_vec,\n", QUAL_CAST(qual, "OSQPFloat"), prefix);
   }
   else {
     fprintf(f, "  OSQP_NULL,\n");
@@ -422,12 +922,12 @@ static OSQPInt write_linsys(FILE*               f,
   fprintf(f, "  %" OSQP_INT_FMT ",\n", m);
   if (embedded > 1) {
     fprintf(f, "  &%slinsys_KKT,\n", prefix);
-    fprintf(f, "  %slinsys_PtoKKT,\n", prefix);
-    fprintf(f, "  %slinsys_AtoKKT,\n", prefix);
-    fprintf(f, "  %slinsys_rhotoKKT,\n", prefix);
+    fprintf(f, "  %s%slinsys_PtoKKT,\n", QUAL_CAST(iqual, "OSQPInt"), prefix);
+    fprintf(f, "  %s%slinsys_AtoKKT,\n", QUAL_CAST(iqual, "OSQPInt"), prefix);
+    fprintf(f, "  %s%slinsys_rhotoKKT,\n", QUAL_CAST(iqual, "OSQPInt"), prefix);
     fprintf(f, "  %slinsys_D,\n", prefix);
-    fprintf(f, "  %slinsys_etree,\n", prefix);
-    fprintf(f, "  %slinsys_Lnz,\n", prefix);
+    fprintf(f, "  %s%slinsys_etree,\n", QUAL_CAST(iqual, "OSQPInt"), prefix);
+    fprintf(f, "  %s%slinsys_Lnz,\n", QUAL_CAST(iqual, "OSQPInt"), prefix);
     fprintf(f, "  %slinsys_iwork,\n", prefix);
     fprintf(f, "  %slinsys_bwork,\n", prefix);
     fprintf(f, "  %slinsys_fwork,\n", prefix);
@@ -442,89 +942,109 @@ static OSQPInt write_linsys(FILE*               f,
 * Workspace
 ************/
 
-static OSQPInt write_workspace(FILE*             f,
-                               const OSQPSolver* solver,
-                               OSQPInt           n,
-                               OSQPInt           m,
-                               const char*       prefix,
-                               OSQPInt           embedded) {
+static OSQPInt write_workspace(FILE*                     f,
+                               footprint*                fp,
+                               const OSQPSolver*         solver,
+                               OSQPInt                   n,
+                               OSQPInt                   m,
+                               const char*               prefix,
+                               const OSQPCodegenDefines* defines) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
   char name[MAX_VAR_LENGTH];
   const OSQPWorkspace *work = solver->work;
+  OSQPInt embedded = defines->embedded_mode;
+
+  /* rho and the scaling are only changed by updates in embedded mode 2 */
+  const char* qual = embedded == 1 ? CONST_QUAL : "";
 
   if (!work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
 
-  PROPAGATE_ERROR(write_data(f, work->data, prefix))
-  PROPAGATE_ERROR(write_linsys(f, (qdldl_solver *)work->linsys_solver, work->data, prefix, embedded))
+  PROPAGATE_ERROR(write_data(f, fp, work->data, prefix, defines))
+  PROPAGATE_ERROR(write_linsys(f, fp, (qdldl_solver *)work->linsys_solver, work->data, prefix, defines))
 
   if (solver->settings->rho_is_vec) {
     sprintf(name, "%swork_rho_vec", prefix);
-    GENERATE_ERROR(write_OSQPVectorf(f, work->rho_vec, name))
+    GENERATE_ERROR(write_OSQPVectorf(f, fp, work->rho_vec, name, qual))
     sprintf(name, "%swork_rho_inv_vec", prefix);
-    GENERATE_ERROR(write_OSQPVectorf(f, work->rho_inv_vec, name))
+    GENERATE_ERROR(write_OSQPVectorf(f, fp, work->rho_inv_vec, name, qual))
 
     if (embedded > 1) {
       sprintf(name, "%swork_constr_type", prefix);
-      GENERATE_ERROR(write_OSQPVectori(f, work->constr_type, name))
+      GENERATE_ERROR(write_OSQPVectori(f, fp, work->constr_type, name, ""))
     }
   }
 
   /* Initialize x,y,z as we usually want to warm start the iterates */
   sprintf(name, "%swork_x", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, work->x, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, work->x, name, ""))
   sprintf(name, "%swork_y", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, work->y, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, work->y, name, ""))
   sprintf(name, "%swork_z", prefix);
-  GENERATE_ERROR(write_OSQPVectorf(f, work->z, name))
+  GENERATE_ERROR(write_OSQPVectorf(f, fp, work->z, name, ""))
+
+  sprintf(name, "%swork_xz_tilde_val", prefix);
 
-  fprintf(f, "OSQPFloat   %swork_xz_tilde_val[%" OSQP_INT_FMT "];\n", prefix, n+m);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n+m);
   fprintf(f, "OSQPVectorf %swork_xz_tilde = {\n  %swork_xz_tilde_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n+m);
   fprintf(f, "OSQPVectorf %swork_xtilde_view = {\n  %swork_xz_tilde_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
   fprintf(f, "OSQPVectorf %swork_ztilde_view = {\n  %swork_xz_tilde_val+%" OSQP_INT_FMT ",\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n, m);
-  fprintf(f, "OSQPFloat   %swork_x_prev_val[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%swork_x_prev_val", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPVectorf %swork_x_prev = {\n  %swork_x_prev_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
   if (m > 0) {
-    fprintf(f, "OSQPFloat   %swork_z_prev_val[%" OSQP_INT_FMT "];\n", prefix, m);
+    sprintf(name, "%swork_z_prev_val", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
     fprintf(f, "OSQPVectorf %swork_z_prev = {\n  %swork_z_prev_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, m);
-    fprintf(f, "OSQPFloat   %swork_Ax_val[%" OSQP_INT_FMT "];\n", prefix, m);
+    sprintf(name, "%swork_Ax_val", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
     fprintf(f, "OSQPVectorf %swork_Ax = {\n  %swork_Ax_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, m);
   }
   else {
     fprintf(f, "OSQPVectorf %swork_z_prev = { OSQP_NULL, 0 };\n", prefix);
     fprintf(f, "OSQPVectorf %swork_Ax = { OSQP_NULL, 0 };\n", prefix);
   }
-  fprintf(f, "OSQPFloat   %swork_Px_val[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%swork_Px_val", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPVectorf %swork_Px = {\n  %swork_Px_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
-  fprintf(f, "OSQPFloat   %swork_Aty_val[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%swork_Aty_val", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPVectorf %swork_Aty = {\n  %swork_Aty_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
   if (m > 0) {
-    fprintf(f, "OSQPFloat   %swork_delta_y_val[%" OSQP_INT_FMT "];\n", prefix, m);
+    sprintf(name, "%swork_delta_y_val", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
     fprintf(f, "OSQPVectorf %swork_delta_y = {\n  %swork_delta_y_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, m);
   }
   else {
     fprintf(f, "OSQPVectorf %swork_delta_y = { OSQP_NULL, 0 };\n", prefix);
   }
-  fprintf(f, "OSQPFloat   %swork_Atdelta_y_val[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%swork_Atdelta_y_val", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPVectorf %swork_Atdelta_y = {\n  %swork_Atdelta_y_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
-  fprintf(f, "OSQPFloat   %swork_delta_x_val[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%swork_delta_x_val", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPVectorf %swork_delta_x = {\n  %swork_delta_x_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
-  fprintf(f, "OSQPFloat   %swork_Pdelta_x_val[%" OSQP_INT_FMT "];\n", prefix, n);
+  sprintf(name, "%swork_Pdelta_x_val", prefix);
+  write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
   fprintf(f, "OSQPVectorf %swork_Pdelta_x = {\n  %swork_Pdelta_x_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
   if (m > 0) {
-    fprintf(f, "OSQPFloat   %swork_Adelta_x_val[%" OSQP_INT_FMT "];\n", prefix, m);
+    sprintf(name, "%swork_Adelta_x_val", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
     fprintf(f, "OSQPVectorf %swork_Adelta_x = {\n  %swork_Adelta_x_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, m);
   }
   else {
     fprintf(f, "OSQPVectorf %swork_Adelta_x = { OSQP_NULL, 0 };\n", prefix);
   }
   if (embedded > 1) {
-    fprintf(f, "OSQPFloat   %swork_D_temp_val[%" OSQP_INT_FMT "];\n", prefix, n);
+    sprintf(name, "%swork_D_temp_val", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
     fprintf(f, "OSQPVectorf %swork_D_temp = {\n  %swork_D_temp_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
-    fprintf(f, "OSQPFloat   %swork_D_temp_A_val[%" OSQP_INT_FMT "];\n", prefix, n);
+    sprintf(name, "%swork_D_temp_A_val", prefix);
+    write_array(f, fp, "OSQPFloat", fp->float_bytes, name, n);
     fprintf(f, "OSQPVectorf %swork_D_temp_A = {\n  %swork_D_temp_A_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, n);
     if (m > 0) {
-      fprintf(f, "OSQPFloat   %swork_E_temp_val[%" OSQP_INT_FMT "];\n", prefix, m);
+      sprintf(name, "%swork_E_temp_val", prefix);
+      write_array(f, fp, "OSQPFloat", fp->float_bytes, name, m);
       fprintf(f, "OSQPVectorf %swork_E_temp = {\n  %swork_E_temp_val,\n  %" OSQP_INT_FMT "\n};\n", prefix, prefix, m);
     }
     else {
@@ -533,7 +1053,7 @@ static OSQPInt write_workspace(FILE*             f,
   }
 
   if (solver->settings->scaling) {
-    PROPAGATE_ERROR(write_scaling(f, work->scaling, prefix))
+    PROPAGATE_ERROR(write_scaling(f, fp, work->scaling, prefix, qual))
   }
   
   fprintf(f, "/* Define the workspace structure */\n");
@@ -542,8 +1062,8 @@ static OSQPInt write_workspace(FILE*             f,
   fprintf(f, "  (LinSysSolver *)&%slinsys,\n", prefix);
 
   if (solver->settings->rho_is_vec) {
-    fprintf(f, "  &%swork_rho_vec,\n", prefix);
-    fprintf(f, "  &%swork_rho_inv_vec,\n", prefix);
+    fprintf(f, "  %s&%swork_rho_vec,\n", QUAL_CAST(qual, "OSQPVectorf"), prefix);
+    fprintf(f, "  %s&%swork_rho_inv_vec,\n", QUAL_CAST(qual, "OSQPVectorf"), prefix);
     if (embedded > 1) {
       fprintf(f, "  &%swork_constr_type,\n", prefix);
     }
@@ -584,7 +1104,7 @@ static OSQPInt write_workspace(FILE*             f,
     }
   }
   if (solver->settings->scaling) {
-    fprintf(f, "  &%sscaling,\n", prefix);
+    fprintf(f, "  %s&%sscaling,\n", QUAL_CAST(qual, "OSQPScaling"), prefix);
   }
   else {
     fprintf(f, "  OSQP_NULL,\n");
@@ -598,14 +1118,227 @@ static OSQPInt write_workspace(FILE*             f,
 }
 
 
+/*******************
+* Multiple instances
+********************/
+
+/* Iterate vector that each instance keeps in its own memory */
+typedef struct {
+  const char*      owner;  /* structure holding the vector, "data" or "work" */
+  const char*      field;  /* name of the vector in its owner */
+  OSQPInt          len;    /* number of elements */
+  const OSQPFloat* init;   /* initial values (OSQP_NULL if left uninitialized) */
+} instance_vec;
+
+#define INSTANCE_NVEC 17
+
+/* Fill the table of per-instance vectors, shared by the header and the initializer */
+static void instance_vectors(const OSQPSolver* solver,
+                             instance_vec*     vecs) {
+
+  const OSQPWorkspace* work = solver->work;
+  OSQPInt n = work->data->n;
+  OSQPInt m = work->data->m;
+  OSQPInt k = 0;
+
+#define INSTANCE_VEC(o, fl, l, v) \
+  vecs[k].owner = o; vecs[k].field = fl; vecs[k].len = l; vecs[k].init = v; k++;
+
+  INSTANCE_VEC("data", "q",         n,   work->data->q->values)
+  INSTANCE_VEC("data", "l",         m,   work->data->l->values)
+  INSTANCE_VEC("data", "u",         m,   work->data->u->values)
+  INSTANCE_VEC("work", "x",         n,   work->x->values)
+  INSTANCE_VEC("work", "y",         m,   work->y->values)
+  INSTANCE_VEC("work", "z",         m,   work->z->values)
+  INSTANCE_VEC("work", "xz_tilde",  n+m, OSQP_NULL)
+  INSTANCE_VEC("work", "x_prev",    n,   OSQP_NULL)
+  INSTANCE_VEC("work", "z_prev",    m,   OSQP_NULL)
+  INSTANCE_VEC("work", "Ax",        m,   OSQP_NULL)
+  INSTANCE_VEC("work", "Px",        n,   OSQP_NULL)
+  INSTANCE_VEC("work", "Aty",       n,   OSQP_NULL)
+  INSTANCE_VEC("work", "delta_y",   m,   OSQP_NULL)
+  INSTANCE_VEC("work", "Atdelta_y", n,   OSQP_NULL)
+  INSTANCE_VEC("work", "delta_x",   n,   OSQP_NULL)
+  INSTANCE_VEC("work", "Pdelta_x",  n,   OSQP_NULL)
+  INSTANCE_VEC("work", "Adelta_x",  m,   OSQP_NULL)
+
+#undef INSTANCE_VEC
+}
+
+/* Write the instance structure holding everything a solve modifies */
+static void write_instance_struct(FILE*             f,
+                                  const OSQPSolver* solver,
+                                  const char*       prefix) {
+
+  instance_vec vecs[INSTANCE_NVEC];
+  OSQPInt i;
+  OSQPInt n = solver->work->data->n;
+  OSQPInt m = solver->work->data->m;
+
+  instance_vectors(solver, vecs);
+
+  fprintf(f, "/* Mutable state of one solver instance, allocated by the caller */\n");
+  fprintf(f, "typedef struct {\n");
+  fprintf(f, "  OSQPSolver    solver;\n");
+  fprintf(f, "  OSQPSettings  settings;\n");
+  fprintf(f, "  OSQPInfo      info;\n");
+  fprintf(f, "  OSQPSolution  sol;\n");
+  fprintf(f, "  OSQPFloat     sol_x[%" OSQP_INT_FMT "];\n", n);
+  fprintf(f, "  OSQPFloat     sol_y[%" OSQP_INT_FMT "];\n", c_max(m, 1));
+  fprintf(f, "  OSQPFloat     sol_prim_inf_cert[%" OSQP_INT_FMT "];\n", c_max(m, 1));
+  fprintf(f, "  OSQPFloat     sol_dual_inf_cert[%" OSQP_INT_FMT "];\n", n);
+  fprintf(f, "  OSQPWorkspace work;\n");
+  fprintf(f, "  OSQPData      data;\n");
+  fprintf(f, "  qdldl_solver  linsys;\n");
+  fprintf(f, "  OSQPFloat     linsys_bp[%" OSQP_INT_FMT "];\n", n+m);
+  fprintf(f, "  OSQPFloat     linsys_sol[%" OSQP_INT_FMT "];\n", n+m);
+  for (i = 0; i < INSTANCE_NVEC; i++) {
+    fprintf(f, "  OSQPVectorf   %s_%s;\n", vecs[i].owner, vecs[i].field);
+    fprintf(f, "  OSQPFloat     %s_%s_val[%" OSQP_INT_FMT "];\n",
+            vecs[i].owner, vecs[i].field, c_max(vecs[i].len, 1));
+  }
+  fprintf(f, "  OSQPVectorf   work_xtilde_view;\n");
+  fprintf(f, "  OSQPVectorf   work_ztilde_view;\n");
+  fprintf(f, "} %sinstance;\n\n", prefix);
+}
+
+/*
+ * Write the data shared by all instances as constants, followed by the function
+ * initializing an instance to point at them. Only valid in embedded mode 1, where
+ * the matrices, the factorization and the scaling never change.
+ */
+static OSQPInt write_instance(FILE*                     f,
+                              footprint*                fp,
+                              const OSQPSolver*         solver,
+                              const char*               prefix,
+                              const OSQPCodegenDefines* defines) {
+
+  OSQPInt exitflag = OSQP_NO_ERROR;
+  char name[MAX_VAR_LENGTH];
+  instance_vec vecs[INSTANCE_NVEC];
+  OSQPInt i;
+  const char* qual = STATIC_CONST_QUAL;
+  const OSQPWorkspace* work = solver->work;
+  OSQPInt n = work->data->n;
+  OSQPInt m = work->data->m;
+
+  instance_vectors(solver, vecs);
+
+  /* Arrays in the instance structure, allocated by the caller for each instance */
+  footprint_add(fp, "instance.sol_x", n*fp->float_bytes, "instance");
+  footprint_add(fp, "instance.sol_y", c_max(m, 1)*fp->float_bytes, "instance");
+  footprint_add(fp, "instance.sol_prim_inf_cert", c_max(m, 1)*fp->float_bytes, "instance");
+  footprint_add(fp, "instance.sol_dual_inf_cert", n*fp->float_bytes, "instance");
+  footprint_add(fp, "instance.linsys_bp", (n+m)*fp->float_bytes, "instance");
+  footprint_add(fp, "instance.linsys_sol", (n+m)*fp->float_bytes, "instance");
+  for (i = 0; i < INSTANCE_NVEC; i++) {
+    sprintf(name, "instance.%s_%s_val", vecs[i].owner, vecs[i].field);
+    footprint_add(fp, name, c_max(vecs[i].len, 1)*fp->float_bytes, "instance");
+  }
+
+  PROPAGATE_ERROR(write_settings(f, solver->settings, prefix, qual))
+  PROPAGATE_ERROR(write_info(f, solver->info, prefix, qual))
+
+  fprintf(f, "/* Define the shared problem matrices */\n");
+  sprintf(name, "%sdata_P", prefix);
+  GENERATE_ERROR(write_OSQPMatrix(f, fp, work->data->P, name, defines, qual, qual))
+  sprintf(name, "%sdata_A", prefix);
+  GENERATE_ERROR(write_OSQPMatrix(f, fp, work->data->A, name, defines, qual, qual))
+
+  PROPAGATE_ERROR(write_linsys(f, fp, (qdldl_solver *)work->linsys_solver, work->data, prefix, defines))
+
+  if (solver->settings->rho_is_vec) {
+    sprintf(name, "%swork_rho_vec", prefix);
+    GENERATE_ERROR(write_OSQPVectorf(f, fp, work->rho_vec, name, qual))
+    sprintf(name, "%swork_rho_inv_vec", prefix);
+    GENERATE_ERROR(write_OSQPVectorf(f, fp, work->rho_inv_vec, name, qual))
+  }
+
+  if (solver->settings->scaling) {
+    PROPAGATE_ERROR(write_scaling(f, fp, work->scaling, prefix, qual))
+  }
+
+  fprintf(f, "/* Define the initial values of the instance vectors */\n");
+  for (i = 0; i < INSTANCE_NVEC; i++) {
+    if (vecs[i].init && vecs[i].len) {
+      sprintf(name, "%s%s_%s_init", prefix, vecs[i].owner, vecs[i].field);
+      GENERATE_ERROR(write_vecf(f, fp, vecs[i].init, vecs[i].len, name, qual))
+    }
+  }
+
+  fprintf(f, "\n/* Initialize an instance to solve the problem from the generated initial iterates */\n");
+  fprintf(f, "void %sinstance_init(%sinstance* inst) {\n", prefix, prefix);
+  fprintf(f, "  unsigned char* bytes = (unsigned char*)inst;\n");
+  fprintf(f, "  OSQPInt i;\n\n");
+
+  fprintf(f, "  /* Clear the members not set below */\n");
+  fprintf(f, "  for (i = 0; i < (OSQPInt)sizeof(*inst); i++) bytes[i] = 0;\n\n");
+
+  fprintf(f, "  inst->settings = %ssettings;\n", prefix);
+  fprintf(f, "  inst->info     = %sinfo;\n", prefix);
+  fprintf(f, "  inst->linsys   = %slinsys;\n", prefix);
+  fprintf(f, "  inst->linsys.bp  = inst->linsys_bp;\n");
+  fprintf(f, "  inst->linsys.sol = inst->linsys_sol;\n\n");
+
+  fprintf(f, "  inst->sol.x = inst->sol_x;\n");
+  fprintf(f, "  inst->sol.y = %s;\n", m > 0 ? "inst->sol_y" : "OSQP_NULL");
+  fprintf(f, "  inst->sol.prim_inf_cert = %s;\n", m > 0 ? "inst->sol_prim_inf_cert" : "OSQP_NULL");
+  fprintf(f, "  inst->sol.dual_inf_cert = inst->sol_dual_inf_cert;\n\n");
+
+  for (i = 0; i < INSTANCE_NVEC; i++) {
+    const char* o  = vecs[i].owner;
+    const char* fl = vecs[i].field;
+
+    if (vecs[i].len) fprintf(f, "  inst->%s_%s.values = inst->%s_%s_val;\n", o, fl, o, fl);
+    fprintf(f, "  inst->%s_%s.length = %" OSQP_INT_FMT ";\n", o, fl, vecs[i].len);
+    fprintf(f, "  inst->%s.%s = &inst->%s_%s;\n", o, fl, o, fl);
+    if (vecs[i].init && vecs[i].len) {
+      fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) inst->%s_%s_val[i] = %s%s_%s_init[i];\n",
+              vecs[i].len, o, fl, prefix, o, fl);
+    }
+  }
+  fprintf(f, "  inst->work_xtilde_view.values = inst->work_xz_tilde_val;\n");
+  fprintf(f, "  inst->work_xtilde_view.length = %" OSQP_INT_FMT ";\n", n);
+  fprintf(f, "  inst->work.xtilde_view = &inst->work_xtilde_view;\n");
+  fprintf(f, "  inst->work_ztilde_view.values = inst->work_xz_tilde_val + %" OSQP_INT_FMT ";\n", n);
+  fprintf(f, "  inst->work_ztilde_view.length = %" OSQP_INT_FMT ";\n", m);
+  fprintf(f, "  inst->work.ztilde_view = &inst->work_ztilde_view;\n\n");
+
+  fprintf(f, "  inst->data.n = %" OSQP_INT_FMT ";\n", n);
+  fprintf(f, "  inst->data.m = %" OSQP_INT_FMT ";\n", m);
+  fprintf(f, "  inst->data.P = (OSQPMatrix *)&%sdata_P;\n", prefix);
+  fprintf(f, "  inst->data.A = (OSQPMatrix *)&%sdata_A;\n\n", prefix);
+
+  fprintf(f, "  inst->work.data = &inst->data;\n");
+  fprintf(f, "  inst->work.linsys_solver = (LinSysSolver *)&inst->linsys;\n");
+  if (solver->settings->rho_is_vec) {
+    fprintf(f, "  inst->work.rho_vec = (OSQPVectorf *)&%swork_rho_vec;\n", prefix);
+    fprintf(f, "  inst->work.rho_inv_vec = (OSQPVectorf *)&%swork_rho_inv_vec;\n", prefix);
+  }
+  if (solver->settings->scaling) {
+    fprintf(f, "  inst->work.scaling = (OSQPScaling *)&%sscaling;\n", prefix);
+  }
+  fprintf(f, "  inst->work.rho_inv = (OSQPFloat)%.20f;\n\n", work->rho_inv);
+
+  fprintf(f, "  inst->solver.settings = &inst->settings;\n");
+  fprintf(f, "  inst->solver.solution = &inst->sol;\n");
+  fprintf(f, "  inst->solver.info     = &inst->info;\n");
+  fprintf(f, "  inst->solver.work     = &inst->work;\n");
+  fprintf(f, "}\n");
+
+  return exitflag;
+}
+
+
 /*********
 * Solver
 **********/
 
-static OSQPInt write_solver(FILE*             f,
-                            const OSQPSolver* solver,
-                            const char*       prefix,
-                            OSQPInt           embedded) {
+static OSQPInt write_solver(FILE*                     f,
+                            footprint*                fp,
+                            const OSQPSolver*         solver,
+                            const char*               prefix,
+                            const OSQPCodegenDefines* defines) {
 
   if (!solver) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
 
@@ -614,10 +1347,14 @@ static OSQPInt write_solver(FILE*             f,
   OSQPInt n = solver->work->data->n;
   OSQPInt m = solver->work->data->m;
 
-  PROPAGATE_ERROR(write_settings(f, solver->settings, prefix))
-  PROPAGATE_ERROR(write_solution(f, n, m, prefix))
-  PROPAGATE_ERROR(write_info(f, solver->info, prefix))
-  PROPAGATE_ERROR(write_workspace(f, solver, n, m, prefix, embedded))
+  if (defines->multi_instance_enable) {
+    return write_instance(f, fp, solver, prefix, defines);
+  }
+
+  PROPAGATE_ERROR(write_settings(f, solver->settings, prefix, ""))
+  PROPAGATE_ERROR(write_solution(f, fp, n, m, prefix))
+  PROPAGATE_ERROR(write_info(f, solver->info, prefix, ""))
+  PROPAGATE_ERROR(write_workspace(f, fp, solver, n, m, prefix, defines))
 
   fprintf(f, "/* Define the solver structure */\n");
   fprintf(f, "OSQPSolver %ssolver = {\n", prefix);
@@ -631,12 +1368,618 @@ static OSQPInt write_solver(FILE*             f,
 }
 
 
+/*********************
+* Fixed-point solver
+**********************/
+
+/* Iterates get this much headroom over the ranges seen at generation time */
+#define FIXED_HEADROOM 4.0
+
+/* Number of fractional bits of the fixed-point formats */
+typedef struct {
+  OSQPInt x;        /* primal iterate */
+  OSQPInt z;        /* slack iterate and bounds */
+  OSQPInt y;        /* dual iterate */
+  OSQPInt t;        /* KKT right-hand side, factor solve and solution */
+  OSQPInt q;        /* linear cost */
+  OSQPInt L;        /* factor entries */
+  OSQPInt Dinv;     /* inverse factor diagonal */
+  OSQPInt sigma;
+  OSQPInt alpha;    /* alpha and 1 - alpha */
+  OSQPInt rho;
+  OSQPInt rho_inv;
+  OSQPInt D;        /* variable scaling */
+  OSQPInt Ec;       /* constraint and cost scaling E / c */
+  OSQPInt x_out;    /* unscaled primal solution */
+  OSQPInt y_out;    /* unscaled dual solution */
+} fixed_formats;
+
+/* Fractional bits so that values up to range fit in a signed word */
+static OSQPInt fixed_frac_bits(double  range,
+                               OSQPInt word) {
+
+  OSQPInt e = 0;
+
+  if (range <= 0.0) return word - 1;
+
+  while (range >= 1.0) { range /= 2.0; e++; }
+  while (range < 0.5)  { range *= 2.0; e--; }
+
+  /* Keep every product of two words inside the double-width accumulator */
+  return c_min(c_max(word - 1 - e, 0), word - 1);
+}
+
+/* Value in the given format, rounded and clipped to the symmetric range of the word */
+static long long fixed_raw(double  v,
+                           OSQPInt frac,
+                           OSQPInt word) {
+
+  OSQPInt i;
+  double lim = 1.0;
+
+  for (i = 0; i < word - 1; i++) lim *= 2.0;
+  lim -= 1.0;
+  for (i = 0; i < frac; i++) v *= 2.0;
+
+  v = (v >= 0.0) ? v + 0.5 : v - 0.5;
+  if (v >  lim) v =  lim;
+  if (v < -lim) v = -lim;
+
+  return (long long)v;
+}
+
+/* Largest finite magnitude in v (infinite bounds are left out) */
+static double fixed_range(const double* v,
+                          OSQPInt       n) {
+
+  OSQPInt i;
+  double r = 0.0;
+
+  for (i = 0; i < n; i++) {
+    if (c_absval(v[i]) < OSQP_INFTY * OSQP_MIN_SCALING) r = c_max(r, c_absval(v[i]));
+  }
+
+  return r;
+}
+
+static void write_fixed_vec(FILE*         f,
+                            const char*   prefix,
+                            const char*   name,
+                            const double* v,
+                            OSQPInt       n,
+                            OSQPInt       frac,
+                            OSQPInt       word) {
+
+  OSQPInt i;
+
+  fprintf(f, "static const %sfx %s[%" OSQP_INT_FMT "] = {\n", prefix, name, c_max(n, 1));
+  for (i = 0; i < n; i++) {
+    fprintf(f, "  %lld,\n", fixed_raw(v[i], frac, word));
+  }
+  if (n == 0) fprintf(f, "  0\n");
+  fprintf(f, "};\n");
+}
+
+/* Problem data and sample iterates in double precision, used to choose the formats */
+typedef struct {
+  OSQPInt n;
+  OSQPInt m;
+  double* q;
+  double* l;
+  double* u;
+  double* x;
+  double* z;
+  double* y;
+  double* rho;
+  double* rho_inv;
+  double* D;
+  double* Ec;
+  double* b;        /* KKT right-hand side at the sample iterates, then its solution */
+  double* t;
+} fixed_sample;
+
+static void fixed_sample_free(fixed_sample* s) {
+  c_free(s->q);
+  c_free(s->l);
+  c_free(s->u);
+  c_free(s->x);
+  c_free(s->z);
+  c_free(s->y);
+  c_free(s->rho);
+  c_free(s->rho_inv);
+  c_free(s->D);
+  c_free(s->Ec);
+  c_free(s->b);
+  c_free(s->t);
+}
+
+/*
+ * Copy the scaled problem data and current iterates, then run one KKT solve on
+ * the right-hand side they produce to find the ranges seen inside an iteration.
+ */
+static OSQPInt fixed_analyse(const OSQPSolver* solver,
+                             OSQPInt           word,
+                             fixed_sample*     s,
+                             fixed_formats*    fmt) {
+
+  OSQPInt i, j, k;
+  double rx, rz, ry, rt, r;
+
+  const OSQPWorkspace* work   = solver->work;
+  const qdldl_solver*  linsys = (qdldl_solver *)work->linsys_solver;
+  const OSQPCscMatrix* L      = linsys->L;
+
+  OSQPInt n = work->data->n;
+  OSQPInt m = work->data->m;
+
+  s->n       = n;
+  s->m       = m;
+  s->q       = (double *)c_malloc((n + 1) * sizeof(double));
+  s->l       = (double *)c_malloc((m + 1) * sizeof(double));
+  s->u       = (double *)c_malloc((m + 1) * sizeof(double));
+  s->x       = (double *)c_malloc((n + 1) * sizeof(double));
+  s->z       = (double *)c_malloc((m + 1) * sizeof(double));
+  s->y       = (double *)c_malloc((m + 1) * sizeof(double));
+  s->rho     = (double *)c_malloc((m + 1) * sizeof(double));
+  s->rho_inv = (double *)c_malloc((m + 1) * sizeof(double));
+  s->D       = (double *)c_malloc((n + 1) * sizeof(double));
+  s->Ec      = (double *)c_malloc((m + 1) * sizeof(double));
+  s->b       = (double *)c_malloc((n + m + 1) * sizeof(double));
+  s->t       = (double *)c_malloc((n + m + 1) * sizeof(double));
+
+  if (!s->q || !s->l || !s->u || !s->x || !s->z || !s->y || !s->rho ||
+      !s->rho_inv || !s->D || !s->Ec || !s->b || !s->t) {
+    return osqp_error(OSQP_MEM_ALLOC_ERROR);
+  }
+
+  for (i = 0; i < n; i++) {
+    s->q[i] = work->data->q->values[i];
+    s->x[i] = work->x->values[i];
+    s->D[i] = work->scaling ? work->scaling->D->values[i] : 1.0;
+  }
+  for (i = 0; i < m; i++) {
+    s->l[i]       = work->data->l->values[i];
+    s->u[i]       = work->data->u->values[i];
+    s->z[i]       = work->z->values[i];
+    s->y[i]       = work->y->values[i];
+    s->rho[i]     = work->rho_vec     ? work->rho_vec->values[i]     : solver->settings->rho;
+    s->rho_inv[i] = work->rho_inv_vec ? work->rho_inv_vec->values[i] : work->rho_inv;
+    s->Ec[i]      = work->scaling ? work->scaling->E->values[i] * work->scaling->cinv : 1.0;
+  }
+
+  /* KKT solve for the right-hand side of the next iteration */
+  for (i = 0; i < n; i++) s->b[i]     = solver->settings->sigma * s->x[i] - s->q[i];
+  for (i = 0; i < m; i++) s->b[n + i] = s->z[i] - s->rho_inv[i] * s->y[i];
+
+  rt = fixed_range(s->b, n + m);
+
+  for (i = 0; i < n + m; i++) s->t[i] = s->b[linsys->P[i]];
+  for (j = 0; j < n + m; j++) {
+    for (k = L->p[j]; k < L->p[j + 1]; k++) s->t[L->i[k]] -= L->x[k] * s->t[j];
+  }
+  rt = c_max(rt, fixed_range(s->t, n + m));
+  for (i = 0; i < n + m; i++) s->t[i] *= linsys->Dinv[i];
+  rt = c_max(rt, fixed_range(s->t, n + m));
+  for (j = n + m - 1; j >= 0; j--) {
+    for (k = L->p[j]; k < L->p[j + 1]; k++) s->t[j] -= L->x[k] * s->t[L->i[k]];
+    s->b[linsys->P[j]] = s->t[j];
+  }
+  rt = c_max(rt, fixed_range(s->t, n + m));
+
+  /* Iterate ranges include the intermediate x_tilde, nu and z_tilde */
+  rx = c_max(fixed_range(s->x, n), fixed_range(s->b, n));
+  ry = c_max(fixed_range(s->y, m), fixed_range(s->b + n, m));
+  rz = c_max(fixed_range(s->z, m), c_max(fixed_range(s->l, m), fixed_range(s->u, m)));
+  for (i = 0; i < m; i++) {
+    r  = s->z[i] + s->rho_inv[i] * (s->b[n + i] - s->y[i]);
+    rz = c_max(rz, c_absval(r));
+  }
+
+  fmt->x       = fixed_frac_bits(FIXED_HEADROOM * rx, word);
+  fmt->z       = fixed_frac_bits(FIXED_HEADROOM * rz, word);
+  fmt->y       = fixed_frac_bits(FIXED_HEADROOM * ry, word);
+  fmt->t       = fixed_frac_bits(FIXED_HEADROOM * rt, word);
+  fmt->q       = fixed_frac_bits(fixed_range(s->q, n), word);
+  fmt->sigma   = fixed_frac_bits(solver->settings->sigma, word);
+  fmt->alpha   = fixed_frac_bits(c_max(solver->settings->alpha,
+                                       c_absval(1.0 - solver->settings->alpha)), word);
+  fmt->rho     = fixed_frac_bits(fixed_range(s->rho, m), word);
+  fmt->rho_inv = fixed_frac_bits(fixed_range(s->rho_inv, m), word);
+  fmt->D       = fixed_frac_bits(fixed_range(s->D, n), word);
+  fmt->Ec      = fixed_frac_bits(fixed_range(s->Ec, m), word);
+  fmt->x_out   = fixed_frac_bits(FIXED_HEADROOM * rx * fixed_range(s->D, n), word);
+  fmt->y_out   = fixed_frac_bits(FIXED_HEADROOM * ry * fixed_range(s->Ec, m), word);
+
+  r = 0.0;
+  for (k = 0; k < L->p[n + m]; k++) r = c_max(r, c_absval(L->x[k]));
+  fmt->L = fixed_frac_bits(r, word);
+  r = 0.0;
+  for (i = 0; i < n + m; i++) r = c_max(r, c_absval(linsys->Dinv[i]));
+  fmt->Dinv = fixed_frac_bits(r, word);
+
+  return OSQP_NO_ERROR;
+}
+
+static OSQPInt write_fixed_header(const char*          output_dir,
+                                  const char*          file_prefix,
+                                  OSQPInt              word,
+                                  const fixed_sample*  s,
+                                  const fixed_formats* fmt) {
+
+  char fname[FILE_LENGTH], hfname[PATH_LENGTH], incGuard[FILE_LENGTH+2], mp[FILE_LENGTH];
+  FILE *f;
+  time_t now;
+  OSQPInt i = 0;
+
+  const char* p = file_prefix;
+
+  sprintf(fname,  "%sfixed", file_prefix);
+  sprintf(hfname, "%s%s.h", output_dir, fname);
+
+  f = fopen(hfname, "w");
+  if (f == NULL)
+    return osqp_error(OSQP_FOPEN_ERROR);
+
+  /* Upper-case prefix for the macros */
+  while (file_prefix[i]) {
+    mp[i] = toupper(file_prefix[i]);
+    i++;
+  }
+  mp[i] = 0;
+
+  time(&now);
+  fprintf(f, "/*\n");
+  fprintf(f, " * This file was autogenerated by OSQP on %s", ctime(&now));
+  fprintf(f, " * \n");
+  fprintf(f, " * This file contains the prototypes of a fixed-point ADMM solver for the\n");
+  fprintf(f, " * problem in %sworkspace.c. Every vector is stored in a %" OSQP_INT_FMT "-bit signed\n", file_prefix, word);
+  fprintf(f, " * Q format, value = raw * 2^-FRAC, with the fractional bits given below.\n");
+  fprintf(f, " * The solver works on the scaled problem with the KKT factorization and\n");
+  fprintf(f, " * step sizes of the workspace, and runs a fixed number of iterations.\n");
+  fprintf(f, " * The formats come from the ranges of the workspace iterates, so solving\n");
+  fprintf(f, " * the problem before generating the code gives tighter formats.\n");
+  fprintf(f, " */\n\n");
+
+  i = 0;
+  sprintf(incGuard, "%s_H", fname);
+  while(incGuard[i]){
+    incGuard[i] = toupper(incGuard[i]);
+    i++;
+  }
+  fprintf(f, "#ifndef %s\n",   incGuard);
+  fprintf(f, "#define %s\n\n", incGuard);
+
+  fprintf(f, "#include <stdint.h>\n\n");
+
+  fprintf(f, "#ifdef __cplusplus\n");
+  fprintf(f, "extern \"C\" {\n");
+  fprintf(f, "#endif\n\n");
+
+  fprintf(f, "typedef int%" OSQP_INT_FMT "_t %sfx;\n",      word,     p);
+  fprintf(f, "typedef int%" OSQP_INT_FMT "_t %sfx_wide;\n\n", 2 * word, p);
+
+  fprintf(f, "#define %sFIXED_N %" OSQP_INT_FMT "\n",   mp, s->n);
+  fprintf(f, "#define %sFIXED_M %" OSQP_INT_FMT "\n\n", mp, s->m);
+
+  fprintf(f, "/* Fractional bits of the solver vectors */\n");
+  fprintf(f, "#define %sFIXED_FRAC_X     %" OSQP_INT_FMT "\n", mp, fmt->x);
+  fprintf(f, "#define %sFIXED_FRAC_Z     %" OSQP_INT_FMT "\n", mp, fmt->z);
+  fprintf(f, "#define %sFIXED_FRAC_Y     %" OSQP_INT_FMT "\n", mp, fmt->y);
+  fprintf(f, "#define %sFIXED_FRAC_Q     %" OSQP_INT_FMT "\n", mp, fmt->q);
+  fprintf(f, "#define %sFIXED_FRAC_X_OUT %" OSQP_INT_FMT "\n", mp, fmt->x_out);
+  fprintf(f, "#define %sFIXED_FRAC_Y_OUT %" OSQP_INT_FMT "\n\n", mp, fmt->y_out);
+
+  fprintf(f, "typedef struct {\n");
+  fprintf(f, "  %sfx x[%" OSQP_INT_FMT "];      /* scaled primal iterate (FRAC_X) */\n",    p, c_max(s->n, 1));
+  fprintf(f, "  %sfx z[%" OSQP_INT_FMT "];      /* scaled slack iterate (FRAC_Z) */\n",     p, c_max(s->m, 1));
+  fprintf(f, "  %sfx y[%" OSQP_INT_FMT "];      /* scaled dual iterate (FRAC_Y) */\n",      p, c_max(s->m, 1));
+  fprintf(f, "  %sfx q[%" OSQP_INT_FMT "];      /* scaled linear cost (FRAC_Q) */\n",       p, c_max(s->n, 1));
+  fprintf(f, "  %sfx l[%" OSQP_INT_FMT "];      /* scaled lower bound (FRAC_Z) */\n",       p, c_max(s->m, 1));
+  fprintf(f, "  %sfx u[%" OSQP_INT_FMT "];      /* scaled upper bound (FRAC_Z) */\n",       p, c_max(s->m, 1));
+  fprintf(f, "  %sfx b[%" OSQP_INT_FMT "];      /* KKT right-hand side and solution */\n",  p, s->n + s->m);
+  fprintf(f, "  %sfx t[%" OSQP_INT_FMT "];      /* KKT factor solve workspace */\n",        p, s->n + s->m);
+  fprintf(f, "  uint32_t saturations;  /* results clipped to the range of their format */\n");
+  fprintf(f, "  uint32_t overflows;    /* accumulations in the factor solve that would wrap */\n");
+  fprintf(f, "} %sfixed_workspace;\n\n", p);
+
+  fprintf(f, "/* Load the data and warm start of the workspace, and reset the counters */\n");
+  fprintf(f, "void %sfixed_init(%sfixed_workspace* w);\n\n", p, p);
+  fprintf(f, "/* Run iter ADMM iterations from the current iterates */\n");
+  fprintf(f, "void %sfixed_solve(%sfixed_workspace* w, int iter);\n\n", p, p);
+  fprintf(f, "/* Unscaled primal (FRAC_X_OUT) and dual (FRAC_Y_OUT) solution */\n");
+  fprintf(f, "void %sfixed_solution(%sfixed_workspace* w, %sfx* x, %sfx* y);\n\n", p, p, p, p);
+
+  fprintf(f, "#ifdef __cplusplus\n");
+  fprintf(f, "}\n");
+  fprintf(f, "#endif\n\n");
+
+  fprintf(f, "#endif /* ifndef %s */\n", incGuard);
+
+  fclose(f);
+
+  return OSQP_NO_ERROR;
+}
+
+/* Shift that brings a product of formats fa and fb to format fr */
+#define FIXED_SHIFT(fa, fb, fr) ((fa) + (fb) - (fr))
+
+static void write_fixed_kkt_solve(FILE*                f,
+                                  const qdldl_solver*  linsys,
+                                  const char*          p,
+                                  OSQPInt              word,
+                                  const fixed_formats* fmt,
+                                  const OSQPInt*       Rp,
+                                  const OSQPInt*       Rk,
+                                  const OSQPInt*       Rj) {
+
+  OSQPInt i, j, k;
+  const OSQPCscMatrix* L = linsys->L;
+
+  OSQPInt nm = linsys->n + linsys->m;
+
+  fprintf(f, "/* Solve P'LDL'P b = b with the factor unrolled into the code */\n");
+  fprintf(f, "static void kkt_solve(%sfixed_workspace* w) {\n", p);
+  fprintf(f, "  %sfx* b = w->b;\n", p);
+  fprintf(f, "  %sfx* t = w->t;\n", p);
+  fprintf(f, "  %sfx_wide acc;\n\n", p);
+
+  fprintf(f, "  /* Forward substitution L t = P b */\n");
+  for (i = 0; i < nm; i++) {
+    if (Rp[i] == Rp[i + 1]) {
+      fprintf(f, "  t[%" OSQP_INT_FMT "] = b[%" OSQP_INT_FMT "];\n", i, linsys->P[i]);
+      continue;
+    }
+    fprintf(f, "  acc = (%sfx_wide)b[%" OSQP_INT_FMT "] * ((%sfx_wide)1 << %" OSQP_INT_FMT ");\n",
+            p, linsys->P[i], p, fmt->L);
+    for (k = Rp[i]; k < Rp[i + 1]; k++) {
+      fprintf(f, "  acc = fx_msub(w, acc, %lld, t[%" OSQP_INT_FMT "]);\n",
+              fixed_raw(L->x[Rk[k]], fmt->L, word), Rj[k]);
+    }
+    fprintf(f, "  t[%" OSQP_INT_FMT "] = fx_narrow(w, acc, %" OSQP_INT_FMT ");\n", i, fmt->L);
+  }
+
+  fprintf(f, "\n  /* Diagonal solve and backward substitution L' P b = D^{-1} t */\n");
+  for (j = nm - 1; j >= 0; j--) {
+    fprintf(f, "  t[%" OSQP_INT_FMT "] = fx_mul(w, t[%" OSQP_INT_FMT "], %lld, %" OSQP_INT_FMT ");\n",
+            j, j, fixed_raw(linsys->Dinv[j], fmt->Dinv, word), fmt->Dinv);
+    if (L->p[j] < L->p[j + 1]) {
+      fprintf(f, "  acc = (%sfx_wide)t[%" OSQP_INT_FMT "] * ((%sfx_wide)1 << %" OSQP_INT_FMT ");\n",
+              p, j, p, fmt->L);
+      for (k = L->p[j]; k < L->p[j + 1]; k++) {
+        fprintf(f, "  acc = fx_msub(w, acc, %lld, t[%" OSQP_INT_FMT "]);\n",
+                fixed_raw(L->x[k], fmt->L, word), L->i[k]);
+      }
+      fprintf(f, "  t[%" OSQP_INT_FMT "] = fx_narrow(w, acc, %" OSQP_INT_FMT ");\n", j, fmt->L);
+    }
+    fprintf(f, "  b[%" OSQP_INT_FMT "] = t[%" OSQP_INT_FMT "];\n", linsys->P[j], j);
+  }
+  fprintf(f, "}\n\n");
+}
+
+static OSQPInt write_fixed_source(const char*          output_dir,
+                                  const char*          file_prefix,
+                                  const OSQPSolver*    solver,
+                                  OSQPInt              word,
+                                  const fixed_sample*  s,
+                                  const fixed_formats* fmt) {
+
+  OSQPInt exitflag = OSQP_NO_ERROR;
+  char cfname[PATH_LENGTH];
+  FILE *f;
+  time_t now;
+  OSQPInt *Rp, *Rk, *Rj;
+
+  const char*         p      = file_prefix;
+  const qdldl_solver* linsys = (qdldl_solver *)solver->work->linsys_solver;
+
+  OSQPInt n = s->n;
+  OSQPInt m = s->m;
+
+  PROPAGATE_ERROR(csc_row_view(linsys->L, &Rp, &Rk, &Rj))
+
+  sprintf(cfname, "%s%sfixed.c", output_dir, file_prefix);
+
+  f = fopen(cfname, "w");
+  if (f == NULL) {
+    c_free(Rp);
+    c_free(Rk);
+    c_free(Rj);
+    return osqp_error(OSQP_FOPEN_ERROR);
+  }
+
+  time(&now);
+  fprintf(f, "/*\n");
+  fprintf(f, " * This file was autogenerated by OSQP on %s", ctime(&now));
+  fprintf(f, " * \n");
+  fprintf(f, " * This file contains a fixed-point ADMM solver for the problem in %sworkspace.c.\n", file_prefix);
+  fprintf(f, " */\n\n");
+
+  fprintf(f, "#include \"%sfixed.h\"\n\n", file_prefix);
+
+  fprintf(f, "#define FX_MAX  ((%sfx)INT%" OSQP_INT_FMT "_MAX)\n", p, word);
+  fprintf(f, "#define FXW_MAX ((%sfx_wide)INT%" OSQP_INT_FMT "_MAX)\n", p, 2 * word);
+  fprintf(f, "#define FXW_MIN (-FXW_MAX)\n\n");
+
+  fprintf(f, "/* Narrow v by a right shift of s bits (left if negative), rounding and saturating */\n");
+  fprintf(f, "static %sfx fx_narrow(%sfixed_workspace* w, %sfx_wide v, int s) {\n", p, p, p);
+  fprintf(f, "  if (s >= %" OSQP_INT_FMT ") return 0;\n", 2 * word - 1);
+  fprintf(f, "  if (s > 0) {\n");
+  fprintf(f, "    v = v >> (s - 1);\n");
+  fprintf(f, "    v = (v >> 1) + (v & 1);\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "  else if (s < 0) {\n");
+  fprintf(f, "    if (v > (FXW_MAX >> -s) || v < (FXW_MIN >> -s)) v = (v > 0) ? FXW_MAX : FXW_MIN;\n");
+  fprintf(f, "    else v = v * ((%sfx_wide)1 << -s);\n", p);
+  fprintf(f, "  }\n");
+  fprintf(f, "  if (v >  FX_MAX) { w->saturations++; return  FX_MAX; }\n");
+  fprintf(f, "  if (v < -FX_MAX) { w->saturations++; return -FX_MAX; }\n");
+  fprintf(f, "  return (%sfx)v;\n", p);
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "static %sfx fx_mul(%sfixed_workspace* w, %sfx a, %sfx b, int s) {\n", p, p, p, p);
+  fprintf(f, "  return fx_narrow(w, (%sfx_wide)a * b, s);\n", p);
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "static %sfx fx_add(%sfixed_workspace* w, %sfx a, %sfx b) {\n", p, p, p, p);
+  fprintf(f, "  return fx_narrow(w, (%sfx_wide)a + b, 0);\n", p);
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "static %sfx fx_sub(%sfixed_workspace* w, %sfx a, %sfx b) {\n", p, p, p, p);
+  fprintf(f, "  return fx_narrow(w, (%sfx_wide)a - b, 0);\n", p);
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "/* acc - a*b in the double-width accumulator, saturating on overflow */\n");
+  fprintf(f, "static %sfx_wide fx_msub(%sfixed_workspace* w, %sfx_wide acc, %sfx a, %sfx b) {\n", p, p, p, p, p);
+  fprintf(f, "  %sfx_wide ab = (%sfx_wide)a * b;\n", p, p);
+  fprintf(f, "  if (ab > 0 && acc < FXW_MIN + ab) { w->overflows++; return FXW_MIN; }\n");
+  fprintf(f, "  if (ab < 0 && acc > FXW_MAX + ab) { w->overflows++; return FXW_MAX; }\n");
+  fprintf(f, "  return acc - ab;\n");
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "/* Initial iterates and problem data */\n");
+  write_fixed_vec(f, p, "x0",      s->x,       n, fmt->x,       word);
+  write_fixed_vec(f, p, "z0",      s->z,       m, fmt->z,       word);
+  write_fixed_vec(f, p, "y0",      s->y,       m, fmt->y,       word);
+  write_fixed_vec(f, p, "q0",      s->q,       n, fmt->q,       word);
+  write_fixed_vec(f, p, "l0",      s->l,       m, fmt->z,       word);
+  write_fixed_vec(f, p, "u0",      s->u,       m, fmt->z,       word);
+  write_fixed_vec(f, p, "rho",     s->rho,     m, fmt->rho,     word);
+  write_fixed_vec(f, p, "rho_inv", s->rho_inv, m, fmt->rho_inv, word);
+  write_fixed_vec(f, p, "D",       s->D,       n, fmt->D,       word);
+  write_fixed_vec(f, p, "Ec",      s->Ec,      m, fmt->Ec,      word);
+  fprintf(f, "\n");
+
+  write_fixed_kkt_solve(f, linsys, p, word, fmt, Rp, Rk, Rj);
+
+  fprintf(f, "void %sfixed_init(%sfixed_workspace* w) {\n", p, p);
+  fprintf(f, "  int i;\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", n);
+  fprintf(f, "    w->x[i] = x0[i];\n");
+  fprintf(f, "    w->q[i] = q0[i];\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", m);
+  fprintf(f, "    w->z[i] = z0[i];\n");
+  fprintf(f, "    w->y[i] = y0[i];\n");
+  fprintf(f, "    w->l[i] = l0[i];\n");
+  fprintf(f, "    w->u[i] = u0[i];\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "  w->saturations = 0;\n");
+  fprintf(f, "  w->overflows   = 0;\n");
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "void %sfixed_solve(%sfixed_workspace* w, int iter) {\n", p, p);
+  fprintf(f, "  int k, i;\n");
+  fprintf(f, "  %sfx d, zt, zr, zn;\n\n", p);
+  fprintf(f, "  for (k = 0; k < iter; k++) {\n");
+  fprintf(f, "    /* KKT right-hand side [sigma*x - q; z - rho_inv*y] */\n");
+  fprintf(f, "    for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", n);
+  fprintf(f, "      w->b[i] = fx_sub(w, fx_mul(w, %lld, w->x[i], %" OSQP_INT_FMT "),\n",
+          fixed_raw(solver->settings->sigma, fmt->sigma, word), FIXED_SHIFT(fmt->sigma, fmt->x, fmt->t));
+  fprintf(f, "                          fx_narrow(w, w->q[i], %" OSQP_INT_FMT "));\n", fmt->q - fmt->t);
+  fprintf(f, "    }\n");
+  fprintf(f, "    for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", m);
+  fprintf(f, "      w->b[%" OSQP_INT_FMT " + i] = fx_sub(w, fx_narrow(w, w->z[i], %" OSQP_INT_FMT "),\n", n, fmt->z - fmt->t);
+  fprintf(f, "                          fx_mul(w, rho_inv[i], w->y[i], %" OSQP_INT_FMT "));\n",
+          FIXED_SHIFT(fmt->rho_inv, fmt->y, fmt->t));
+  fprintf(f, "    }\n\n");
+  fprintf(f, "    /* b = [x_tilde; nu] */\n");
+  fprintf(f, "    kkt_solve(w);\n\n");
+  fprintf(f, "    /* Relaxed primal update */\n");
+  fprintf(f, "    for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", n);
+  fprintf(f, "      w->x[i] = fx_add(w, fx_mul(w, %lld, fx_narrow(w, w->b[i], %" OSQP_INT_FMT "), %" OSQP_INT_FMT "),\n",
+          fixed_raw(solver->settings->alpha, fmt->alpha, word), fmt->t - fmt->x, fmt->alpha);
+  fprintf(f, "                          fx_mul(w, %lld, w->x[i], %" OSQP_INT_FMT "));\n",
+          fixed_raw(1.0 - solver->settings->alpha, fmt->alpha, word), fmt->alpha);
+  fprintf(f, "    }\n\n");
+  fprintf(f, "    /* Relaxed slack update, projection onto [l, u] and dual update */\n");
+  fprintf(f, "    for (i = 0; i < %" OSQP_INT_FMT "; i++) {\n", m);
+  fprintf(f, "      d  = fx_sub(w, fx_narrow(w, w->b[%" OSQP_INT_FMT " + i], %" OSQP_INT_FMT "), w->y[i]);\n",
+          n, fmt->t - fmt->y);
+  fprintf(f, "      zt = fx_add(w, w->z[i], fx_mul(w, rho_inv[i], d, %" OSQP_INT_FMT "));\n",
+          FIXED_SHIFT(fmt->rho_inv, fmt->y, fmt->z));
+  fprintf(f, "      zr = fx_add(w, fx_mul(w, %lld, zt, %" OSQP_INT_FMT "),\n",
+          fixed_raw(solver->settings->alpha, fmt->alpha, word), fmt->alpha);
+  fprintf(f, "                     fx_mul(w, %lld, w->z[i], %" OSQP_INT_FMT "));\n",
+          fixed_raw(1.0 - solver->settings->alpha, fmt->alpha, word), fmt->alpha);
+  fprintf(f, "      zn = fx_add(w, zr, fx_mul(w, rho_inv[i], w->y[i], %" OSQP_INT_FMT "));\n",
+          FIXED_SHIFT(fmt->rho_inv, fmt->y, fmt->z));
+  fprintf(f, "      if (zn < w->l[i]) zn = w->l[i];\n");
+  fprintf(f, "      if (zn > w->u[i]) zn = w->u[i];\n");
+  fprintf(f, "      w->y[i] = fx_add(w, w->y[i], fx_mul(w, rho[i], fx_sub(w, zr, zn), %" OSQP_INT_FMT "));\n",
+          FIXED_SHIFT(fmt->rho, fmt->z, fmt->y));
+  fprintf(f, "      w->z[i] = zn;\n");
+  fprintf(f, "    }\n");
+  fprintf(f, "  }\n");
+  fprintf(f, "}\n\n");
+
+  fprintf(f, "void %sfixed_solution(%sfixed_workspace* w, %sfx* x, %sfx* y) {\n", p, p, p, p);
+  fprintf(f, "  int i;\n");
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) x[i] = fx_mul(w, D[i], w->x[i], %" OSQP_INT_FMT ");\n",
+          n, FIXED_SHIFT(fmt->D, fmt->x, fmt->x_out));
+  fprintf(f, "  for (i = 0; i < %" OSQP_INT_FMT "; i++) y[i] = fx_mul(w, Ec[i], w->y[i], %" OSQP_INT_FMT ");\n",
+          m, FIXED_SHIFT(fmt->Ec, fmt->y, fmt->y_out));
+  fprintf(f, "}\n");
+
+  fclose(f);
+
+  c_free(Rp);
+  c_free(Rk);
+  c_free(Rj);
+
+  return exitflag;
+}
+
+
 /*************
 * Codegen API
 **************/
 
-OSQPInt codegen_inc(const char* output_dir,
-                    const char* file_prefix) {
+OSQPInt codegen_linsys_init(OSQPSolver*    solver,
+                            LinSysSolver** saved) {
+
+  OSQPInt        exitflag;
+  OSQPSettings   settings;
+  LinSysSolver*  linsys = OSQP_NULL;
+  OSQPWorkspace* work   = solver->work;
+
+  *saved = OSQP_NULL;
+
+  /* The QDLDL factorization of the KKT matrix is written as it is */
+  if (work->linsys_solver->solve == (OSQPInt (*)(LinSysSolver*, OSQPVectorf*, OSQPInt))&solve_linsys_qdldl &&
+      !((qdldl_solver *)work->linsys_solver)->reduced)
+    return OSQP_NO_ERROR;
+
+  /* The user permutation is owned by the caller and only needs to be valid
+   * during setup, so the temporary factorization falls back to AMD */
+  settings = *solver->settings;
+  settings.kkt_system      = OSQP_KKT_SYSTEM_FULL;
+  settings.kkt_permutation = OSQP_NULL;
+  if (settings.kkt_ordering == OSQP_ORDERING_USER)
+    settings.kkt_ordering = OSQP_ORDERING_AMD;
+
+  exitflag = init_linsys_solver_qdldl((qdldl_solver **)&linsys, work->data->P, work->data->A,
+                                      work->rho_vec, &settings, 0);
+  if (exitflag) return osqp_error(exitflag);
+
+  *saved = work->linsys_solver;
+  work->linsys_solver = linsys;
+
+  return OSQP_NO_ERROR;
+}
+
+void codegen_linsys_restore(OSQPSolver*   solver,
+                            LinSysSolver* saved) {
+
+  if (!saved) return;
+
+  solver->work->linsys_solver->free(solver->work->linsys_solver);
+  solver->work->linsys_solver = saved;
+}
+
+OSQPInt codegen_inc(const char*         output_dir,
+                    const char*         file_prefix,
+                    OSQPSolver*         solver,
+                    OSQPCodegenDefines* defines) {
 
   char fname[FILE_LENGTH], hfname[PATH_LENGTH], incGuard[FILE_LENGTH+2];
   FILE *incFile;
@@ -670,13 +2013,25 @@ OSQPInt codegen_inc(const char* output_dir,
   fprintf(incFile, "#define %s\n\n", incGuard);
 
   /* Include required headers */
-  fprintf(incFile, "#include \"osqp_api_types.h\"\n\n");
+  fprintf(incFile, "#include \"osqp_api_types.h\"\n");
+  if (defines->multi_instance_enable) {
+    fprintf(incFile, "#include \"types.h\"\n");
+    fprintf(incFile, "#include \"algebra_impl.h\"\n");
+    fprintf(incFile, "#include \"qdldl_interface.h\"\n");
+  }
+  fprintf(incFile, "\n");
 
   fprintf(incFile, "#ifdef __cplusplus\n");
   fprintf(incFile, "extern \"C\" {\n");
   fprintf(incFile, "#endif\n\n");
 
-  fprintf(incFile, "  extern OSQPSolver %ssolver;\n\n", file_prefix);
+  if (defines->multi_instance_enable) {
+    write_instance_struct(incFile, solver, file_prefix);
+    fprintf(incFile, "  void %sinstance_init(%sinstance* inst);\n\n", file_prefix, file_prefix);
+  }
+  else {
+    fprintf(incFile, "  extern OSQPSolver %ssolver;\n\n", file_prefix);
+  }
 
   fprintf(incFile, "#ifdef __cplusplus\n");
   fprintf(incFile, "}\n");
@@ -692,24 +2047,39 @@ OSQPInt codegen_inc(const char* output_dir,
 }
 
 
-OSQPInt codegen_src(const char* output_dir,
-                    const char* file_prefix,
-                    OSQPSolver* solver,
-                    OSQPInt     embedded) {
+OSQPInt codegen_src(const char*         output_dir,
+                    const char*         file_prefix,
+                    OSQPSolver*         solver,
+                    OSQPCodegenDefines* defines) {
 
   OSQPInt exitflag = OSQP_NO_ERROR;
-  char fname[PATH_LENGTH], cfname[PATH_LENGTH+2];
+  char fname[PATH_LENGTH], cfname[PATH_LENGTH+2], rfname[PATH_LENGTH+2];
   FILE *srcFile;
   time_t now;
+  footprint fp = {0};
 
   sprintf(fname,  "%s%sworkspace", output_dir, file_prefix);
   sprintf(cfname, "%s.c",        fname);
+  sprintf(rfname, "%s%sfootprint.json", output_dir, file_prefix);
 
   /* Open source file */
   srcFile = fopen(cfname, "w");
   if (srcFile == NULL)
     return osqp_error(OSQP_FOPEN_ERROR);
 
+  /* Open the footprint report, filled while writing the workspace */
+  fp.file = fopen(rfname, "w");
+  if (fp.file == NULL) {
+    fclose(srcFile);
+    return osqp_error(OSQP_FOPEN_ERROR);
+  }
+  fp.float_bytes = defines->float_type ? (OSQPInt)sizeof(float) : (OSQPInt)sizeof(double);
+
+  fprintf(fp.file, "{\n");
+  fprintf(fp.file, "  \"float_bytes\": %" OSQP_INT_FMT ",\n", fp.float_bytes);
+  fprintf(fp.file, "  \"int_bytes\": %" OSQP_INT_FMT ",\n", FOOTPRINT_INT_BYTES);
+  fprintf(fp.file, "  \"arrays\": [\n");
+
   /* Print comment headers containing the generation time into the files */
   time(&now);
   fprintf(srcFile, "/*\n");
@@ -721,13 +2091,31 @@ OSQPInt codegen_src(const char* output_dir,
   /* Include required headers */
   fprintf(srcFile, "#include \"types.h\"\n");
   fprintf(srcFile, "#include \"algebra_impl.h\"\n");
-  fprintf(srcFile, "#include \"qdldl_interface.h\"\n\n");
+  fprintf(srcFile, "#include \"qdldl_interface.h\"\n");
+  if (defines->multi_instance_enable) {
+    fprintf(srcFile, "#include \"%sworkspace.h\"\n", file_prefix);
+  }
+  fprintf(srcFile, "\n");
+
+  fprintf(srcFile, "/* Define OSQP_CODEGEN_FLASH to place the constant data in a section,\n");
+  fprintf(srcFile, " * e.g. as __attribute__((section(\".rodata.osqp\"))) */\n");
+  fprintf(srcFile, "#ifndef OSQP_CODEGEN_FLASH\n");
+  fprintf(srcFile, "#define OSQP_CODEGEN_FLASH\n");
+  fprintf(srcFile, "#endif\n\n");
 
   /* Write the workspace variables to file */
-  exitflag = write_solver(srcFile, solver, file_prefix, embedded);
+  exitflag = write_solver(srcFile, &fp, solver, file_prefix, defines);
+
+  /* Totals of the arrays (the small structures pointing to them are not included) */
+  fprintf(fp.file, "\n  ],\n");
+  fprintf(fp.file, "  \"flash_bytes\": %" OSQP_INT_FMT ",\n", fp.flash);
+  fprintf(fp.file, "  \"ram_bytes\": %" OSQP_INT_FMT ",\n", fp.ram);
+  fprintf(fp.file, "  \"instance_bytes\": %" OSQP_INT_FMT "\n", fp.instance);
+  fprintf(fp.file, "}\n");
 
   /* Close header file */
   fclose(srcFile);
+  fclose(fp.file);
 
   return exitflag;
 }
@@ -769,6 +2157,16 @@ OSQPInt codegen_defines(const char*         output_dir,
     fprintf(incFile, "#define OSQP_ENABLE_DERIVATIVES\n\n");
   }
 
+  /* Write out if a generated LDL solve is used (unrolled or with compact indices) */
+  if (defines->ldl_unroll_enable == 1 || defines->compact_index_enable == 1) {
+    fprintf(incFile, "#define OSQP_ENABLE_LDL_UNROLL\n\n");
+  }
+
+  /* Write out if generated matrix-vector products are used (unrolled or with compact indices) */
+  if (defines->spmv_unroll_enable == 1 || defines->compact_index_enable == 1) {
+    fprintf(incFile, "#define OSQP_ENABLE_SPMV_UNROLL\n\n");
+  }
+
   /* Write out if printing is enabled */
   if (defines->printing_enable == 1) {
     fprintf(incFile, "#define OSQP_ENABLE_PRINTING\n\n");
@@ -799,12 +2197,39 @@ OSQPInt codegen_defines(const char*         output_dir,
 }
 
 
-OSQPInt codegen_example(const char* output_dir,
-                        const char* file_prefix){
+OSQPInt codegen_fixed(const char*         output_dir,
+                      const char*         file_prefix,
+                      OSQPSolver*         solver,
+                      OSQPCodegenDefines* defines) {
 
-  char cfname[PATH_LENGTH];
+  OSQPInt exitflag;
+  fixed_sample  s = {0};
+  fixed_formats fmt = {0};
+
+  exitflag = fixed_analyse(solver, defines->fixed_point_bits, &s, &fmt);
+  if (!exitflag) exitflag = write_fixed_header(output_dir, file_prefix, defines->fixed_point_bits, &s, &fmt);
+  if (!exitflag) exitflag = write_fixed_source(output_dir, file_prefix, solver, defines->fixed_point_bits, &s, &fmt);
+
+  fixed_sample_free(&s);
+
+  return exitflag;
+}
+
+
+OSQPInt codegen_example(const char*         output_dir,
+                        const char*         file_prefix,
+                        OSQPCodegenDefines* defines){
+
+  char cfname[PATH_LENGTH], macro_prefix[FILE_LENGTH];
   FILE *srcFile;
   time_t now;
+  OSQPInt i = 0;
+
+  while (file_prefix[i]) {
+    macro_prefix[i] = toupper(file_prefix[i]);
+    i++;
+  }
+  macro_prefix[i] = 0;
 
   sprintf(cfname, "%semosqp.c", output_dir);
 
@@ -824,13 +2249,34 @@ OSQPInt codegen_example(const char* output_dir,
   /* Include required headers */
   fprintf(srcFile, "#include <stdio.h>\n");
   fprintf(srcFile, "#include \"osqp.h\"\n");
-  fprintf(srcFile, "#include \"%sworkspace.h\"\n\n", file_prefix);
+  fprintf(srcFile, "#include \"%sworkspace.h\"\n", file_prefix);
+  if (defines->fixed_point_bits) {
+    fprintf(srcFile, "#include \"%sfixed.h\"\n", file_prefix);
+  }
+  fprintf(srcFile, "\n");
+
+  if (defines->fixed_point_bits) {
+    fprintf(srcFile, "static %sfixed_workspace fixed_work;\n", file_prefix);
+    fprintf(srcFile, "static %sfx fixed_x[%sFIXED_N + 1];\n", file_prefix, macro_prefix);
+    fprintf(srcFile, "static %sfx fixed_y[%sFIXED_M + 1];\n\n", file_prefix, macro_prefix);
+  }
+
+  if (defines->multi_instance_enable) {
+    fprintf(srcFile, "static %sinstance inst;\n\n", file_prefix);
+  }
 
   fprintf(srcFile, "int main() {\n");
-  fprintf(srcFile, "  OSQPInt exitflag;\n\n");
+  fprintf(srcFile, "  OSQPInt exitflag;\n");
+  if (defines->multi_instance_enable) {
+    fprintf(srcFile, "  OSQPSolver* solver = &inst.solver;\n\n");
+    fprintf(srcFile, "  %sinstance_init( &inst );\n", file_prefix);
+  }
+  else {
+    fprintf(srcFile, "  OSQPSolver* solver = &%ssolver;\n\n", file_prefix);
+  }
   fprintf(srcFile, "  printf( \"Embedded test program for vector updates.\\n\");\n\n");
 
-  fprintf(srcFile, "  exitflag = osqp_solve( &%ssolver );\n\n", file_prefix);
+  fprintf(srcFile, "  exitflag = osqp_solve( solver );\n\n");
 
   fprintf(srcFile, "  if( exitflag > 0 ) {\n");
   fprintf(srcFile, "    printf( \"  OSQP errored: %%s\\n\", osqp_error_message(exitflag));\n" );
@@ -838,6 +2284,27 @@ OSQPInt codegen_example(const char* output_dir,
   fprintf(srcFile, "  } else {\n");
   fprintf(srcFile, "    printf( \"  Solved workspace with no error.\\n\" );\n");
   fprintf(srcFile, "  }\n");
+
+  if (defines->fixed_point_bits) {
+    fprintf(srcFile, "\n  /* Run the fixed-point solver for as many iterations and compare */\n");
+    fprintf(srcFile, "  {\n");
+    fprintf(srcFile, "    int i;\n");
+    fprintf(srcFile, "    double err = 0.0;\n\n");
+    fprintf(srcFile, "    %sfixed_init( &fixed_work );\n", file_prefix);
+    fprintf(srcFile, "    %sfixed_solve( &fixed_work, (int)solver->info->iter );\n", file_prefix);
+    fprintf(srcFile, "    %sfixed_solution( &fixed_work, fixed_x, fixed_y );\n\n", file_prefix);
+    fprintf(srcFile, "    for( i = 0; i < %sFIXED_N; i++ ) {\n", macro_prefix);
+    fprintf(srcFile, "      double xi = fixed_x[i] / (double)((%sfx_wide)1 << %sFIXED_FRAC_X_OUT);\n",
+            file_prefix, macro_prefix);
+    fprintf(srcFile, "      double ei = xi - solver->solution->x[i];\n");
+    fprintf(srcFile, "      if( ei < 0 ) ei = -ei;\n");
+    fprintf(srcFile, "      if( ei > err ) err = ei;\n");
+    fprintf(srcFile, "    }\n\n");
+    fprintf(srcFile, "    printf( \"  Fixed-point solve: %%lu saturations, %%lu overflows, max primal error %%e\\n\",\n");
+    fprintf(srcFile, "            (unsigned long)fixed_work.saturations, (unsigned long)fixed_work.overflows, err );\n");
+    fprintf(srcFile, "  }\n");
+  }
+
   fprintf(srcFile, "}\n");
 
   /* Close header file */
@@ -1,31 +1,41 @@
 #include "derivative.h"
 #include "lin_alg.h"
 #include "error.h"
+#include "printing.h"
 #include "csc_utils.h"
 #include "csc_math.h"
+#include "profilers.h"
+
+static void adjoint_derivative_fill_mat(const OSQPCscMatrix* dP,
+                                              OSQPFloat*     dPx,
+                                        const OSQPCscMatrix* dA,
+                                              OSQPFloat*     dAx,
+                                        const OSQPFloat*     x,
+                                        const OSQPFloat*     y_l,
+                                        const OSQPFloat*     y_u,
+                                        const OSQPFloat*     rx,
+                                        const OSQPFloat*     ryl,
+                                        const OSQPFloat*     ryu) {
+
+    OSQPInt col, p, i;
+
+    if (dP) {
+        for (col=0; col<dP->n; col++) {
+            for (p=dP->p[col]; p<dP->p[col+1]; p++) {
+                i = dP->i[p];
+                dPx[p] = 0.5 * ((rx[i] * x[col]) + (rx[col] * x[i]));
+            }
+        }
+    }
 
-OSQPInt unscale_PA(OSQPSolver*  solver,
-                     OSQPMatrix*  P,
-                     OSQPMatrix*  A) {
-
-  OSQPMatrix_mult_scalar(P, solver->work->scaling->cinv);
-  OSQPMatrix_lmult_diag(P, solver->work->scaling->Dinv);
-  OSQPMatrix_rmult_diag(P, solver->work->scaling->Dinv);
-
-  OSQPMatrix_lmult_diag(A, solver->work->scaling->Einv);
-  OSQPMatrix_rmult_diag(A, solver->work->scaling->Dinv);
-
-  return 0;
-}
-
-OSQPInt unscale_lu(OSQPSolver*  solver,
-                     OSQPVectorf* l,
-                     OSQPVectorf* u) {
-
-    OSQPVectorf_ew_prod(l, l, solver->work->scaling->Einv);
-    OSQPVectorf_ew_prod(u, u, solver->work->scaling->Einv);
-
-    return 0;
+    if (dA) {
+        for (col=0; col<dA->n; col++) {
+            for (p=dA->p[col]; p<dA->p[col+1]; p++) {
+                i = dA->i[p];
+                dAx[p] = ((y_u[i] - y_l[i]) * rx[col]) + ((ryu[i] - ryl[i]) * x[col]);
+            }
+        }
+    }
 }
 
 OSQPInt adjoint_derivative_get_mat(OSQPSolver *solver,
@@ -38,33 +48,17 @@ OSQPInt adjoint_derivative_get_mat(OSQPSolver *solver,
 
     OSQPInt n = solver->work->data->n;
     OSQPDerivativeData *derivative_data = solver->work->derivative_data;
-    OSQPVectorf* x = OSQPVectorf_new(solver->solution->x, n);  // unscaled solution
-    OSQPFloat* x_data = OSQPVectorf_data(x);
-
-    OSQPFloat* y_u_data = OSQPVectorf_data(derivative_data->y_u);
-    OSQPFloat* y_l_data = OSQPVectorf_data(derivative_data->y_l);
-    OSQPFloat* ryu_data = OSQPVectorf_data(derivative_data->ryu);
-    OSQPFloat* ryl_data = OSQPVectorf_data(derivative_data->ryl);
 
     OSQPInt pos = n + derivative_data->n_ineq_l + derivative_data->n_ineq_u + derivative_data->n_eq;
-    OSQPVectorf* rx = OSQPVectorf_view(derivative_data->rhs, pos, n);
-    OSQPFloat* rx_data  = OSQPVectorf_data(rx);
-
-    OSQPInt col;
-    for (col=0; col<n; col++) {
-        OSQPInt p, i;
-        for (p=dP->p[col]; p<dP->p[col+1]; p++) {
-            i = dP->i[p];
-            dP->x[p] = 0.5 * ((rx_data[i] * x_data[col]) + (rx_data[col] * x_data[i]));
-        }
-        for (p=dA->p[col]; p<dA->p[col+1]; p++) {
-            i = dA->i[p];
-            dA->x[p] = ((y_u_data[i] - y_l_data[i]) * rx_data[col]) + ((ryu_data[i] - ryl_data[i]) * x_data[col]);
-        }
-    }
+    OSQPFloat* rx_data = OSQPVectorf_data(derivative_data->rhs) + pos;
 
-    OSQPVectorf_view_free(rx);
-    OSQPVectorf_free(x);
+    adjoint_derivative_fill_mat(dP, dP->x, dA, dA->x,
+                                solver->solution->x,  // unscaled solution
+                                OSQPVectorf_data(derivative_data->y_l),
+                                OSQPVectorf_data(derivative_data->y_u),
+                                rx_data,
+                                OSQPVectorf_data(derivative_data->ryl),
+                                OSQPVectorf_data(derivative_data->ryu));
 
     return 0;
 }
@@ -98,45 +92,60 @@ OSQPInt adjoint_derivative_get_vec(OSQPSolver *solver,
     return 0;
 }
 
-OSQPInt adjoint_derivative_compute(OSQPSolver *solver,
-                                   OSQPFloat*     dx,
-                                   OSQPFloat*     dy_l,
-                                   OSQPFloat*     dy_u) {
-
-    // Check if solver has been initialized
-    if (!solver || !solver->work || !solver->work->derivative_data)
-      return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+void adjoint_derivative_clear(OSQPSolver* solver) {
 
-    OSQPInt m = solver->work->data->m;
-    OSQPInt n = solver->work->data->n;
     OSQPDerivativeData *derivative_data = solver->work->derivative_data;
 
-    OSQPMatrix*  P = OSQPMatrix_copy_new(solver->work->data->P);
-    OSQPMatrix*  A = OSQPMatrix_copy_new(solver->work->data->A);
-    OSQPVectorf* l = OSQPVectorf_copy_new(solver->work->data->l);
-    OSQPVectorf* u = OSQPVectorf_copy_new(solver->work->data->u);
-    OSQPVectorf* x = OSQPVectorf_new(solver->solution->x, n);  // Note: x/y are unscaled solutions
-    OSQPVectorf* y = OSQPVectorf_new(solver->solution->y, m);
+    if (!derivative_data) return;
+
+    if (derivative_data->adj_solver) derivative_data->adj_solver->free(derivative_data->adj_solver);
+    derivative_data->adj_solver = OSQP_NULL;
 
-    // TODO: If we didn't have to unscale P/A/l/u we would not have to copy these
-    if (solver->settings->scaling) unscale_PA(solver, P, A);
-    if (solver->settings->scaling) unscale_lu(solver, l, u);
+    c_free(derivative_data->eq_indices);
+    c_free(derivative_data->l_noninf_indices);
+    c_free(derivative_data->u_noninf_indices);
+    c_free(derivative_data->nu_sign);
+    derivative_data->eq_indices       = OSQP_NULL;
+    derivative_data->l_noninf_indices = OSQP_NULL;
+    derivative_data->u_noninf_indices = OSQP_NULL;
+    derivative_data->nu_sign          = OSQP_NULL;
+}
+
+/* Form the adjoint system at the current solution and compute its symbolic factorization.
+ * The symbolic factorization of sym is reused if the two systems share a sparsity pattern.
+ * The system is assembled from the scaled problem data, so P/A/l/u are never copied. */
+static OSQPInt adjoint_derivative_analyse(OSQPSolver*         solver,
+                                          const LinSysSolver* sym) {
+
+    OSQPInt j, row;
+    OSQPInt m = solver->work->data->m;
+    OSQPInt n = solver->work->data->n;
+    OSQPWorkspace*      work            = solver->work;
+    OSQPDerivativeData* derivative_data = work->derivative_data;
 
-    OSQPFloat* l_data = OSQPVectorf_data(l);
-    OSQPFloat* u_data = OSQPVectorf_data(u);
-    OSQPFloat* y_data = OSQPVectorf_data(y);
+    const OSQPVectorf* Dinv = solver->settings->scaling ? work->scaling->Dinv : OSQP_NULL;
+    const OSQPVectorf* Einv = solver->settings->scaling ? work->scaling->Einv : OSQP_NULL;
+    OSQPFloat          cinv = solver->settings->scaling ? work->scaling->cinv : 1.0;
 
-    OSQPInt* A_ineq_l_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
-    OSQPInt* A_ineq_u_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
-    OSQPInt* A_eq_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
+    const OSQPFloat* l_data    = OSQPVectorf_data(work->data->l);
+    const OSQPFloat* u_data    = OSQPVectorf_data(work->data->u);
+    const OSQPFloat* Einv_data = Einv ? OSQPVectorf_data(Einv) : OSQP_NULL;
+    const OSQPFloat* y_data    = solver->solution->y;  // Note: x/y are unscaled solutions
 
     OSQPInt* eq_indices_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
     OSQPInt* l_noninf_indices_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
     OSQPInt* u_noninf_indices_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
     OSQPInt* nu_sign_vec = (OSQPInt *) c_malloc(m * sizeof(OSQPInt));
 
-    OSQPVectorf* dy_l_vec = OSQPVectorf_new(dy_l, m);
-    OSQPVectorf* dy_u_vec = OSQPVectorf_new(dy_u, m);
+    derivative_data->eq_indices = eq_indices_vec;
+    derivative_data->l_noninf_indices = l_noninf_indices_vec;
+    derivative_data->u_noninf_indices = u_noninf_indices_vec;
+    derivative_data->nu_sign = nu_sign_vec;
+
+    if (m && (!eq_indices_vec || !l_noninf_indices_vec || !u_noninf_indices_vec || !nu_sign_vec)) {
+        adjoint_derivative_clear(solver);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
+    }
 
     // TODO: We could use constr_type in OSQPWorkspace but it only tells us whether a constraint is 'loose'
     // not 'upper loose' or 'lower loose', which we seem to need here.
@@ -146,31 +155,21 @@ OSQPInt adjoint_derivative_compute(OSQPSolver *solver,
     OSQPInt n_ineq_u = 0;
     OSQPInt n_eq = 0;
 
-    OSQPInt j;
     for (j = 0; j < m; j++) {
-        OSQPFloat _l = l_data[j];
-        OSQPFloat _u = u_data[j];
+        // Bounds of the unscaled problem
+        OSQPFloat _l = Einv_data ? Einv_data[j] * l_data[j] : l_data[j];
+        OSQPFloat _u = Einv_data ? Einv_data[j] * u_data[j] : u_data[j];
         if (_l < _u) {
-            A_eq_vec[j] = 0;
             if (_l > -infval) {
                 l_noninf_indices_vec[n_ineq_l] = j;
-                A_ineq_l_vec[j] = 1;
                 n_ineq_l++;
-            } else {
-                A_ineq_l_vec[j] = 0;
             }
             if (_u < infval) {
                 u_noninf_indices_vec[n_ineq_u] = j;
-                A_ineq_u_vec[j] = 1;
                 n_ineq_u++;
-            } else {
-                A_ineq_u_vec[j] = 0;
             }
         } else {
             eq_indices_vec[n_eq] = j;
-            A_eq_vec[j] = 1;
-            A_ineq_l_vec[j] = 0;
-            A_ineq_u_vec[j] = 0;
             if (y_data[j] >= 0) {
                 nu_sign_vec[n_eq] = 1;
             } else {
@@ -184,148 +183,450 @@ OSQPInt adjoint_derivative_compute(OSQPSolver *solver,
     derivative_data->n_ineq_u = n_ineq_u;
     derivative_data->n_eq = n_eq;
 
-    OSQPVectori* A_ineq_l_i = OSQPVectori_new(A_ineq_l_vec, m);
-    c_free(A_ineq_l_vec);
-    OSQPMatrix*  A_ineq_l = OSQPMatrix_submatrix_byrows(A, A_ineq_l_i);
-    OSQPMatrix_mult_scalar(A_ineq_l, -1);
+    // --------- lambda
+    OSQPFloat* y_l = OSQPVectorf_data(derivative_data->y_l);
+    OSQPFloat* y_u = OSQPVectorf_data(derivative_data->y_u);
+    for (j = 0; j < m; j++) {
+        y_u[j] = c_max(y_data[j], 0);
+        y_l[j] = -c_min(y_data[j], 0);
+    }
 
-    OSQPVectori* A_ineq_u_i = OSQPVectori_new(A_ineq_u_vec, m);
-    c_free(A_ineq_u_vec);
-    OSQPMatrix*  A_ineq_u = OSQPMatrix_submatrix_byrows(A, A_ineq_u_i);
+    // --------- slacks G*x - h, with the unscaled A*x = Einv * A_s * Dinv * x
+    OSQPVectorf* x  = OSQPVectorf_new(solver->solution->x, n);
+    OSQPVectorf* Ax = OSQPVectorf_malloc(m);
+    OSQPFloat* slacks = (OSQPFloat *) c_malloc((n_ineq_l + n_ineq_u) * sizeof(OSQPFloat));
+
+    if (!x || !Ax || ((n_ineq_l + n_ineq_u) && !slacks)) {
+        OSQPVectorf_free(x);
+        OSQPVectorf_free(Ax);
+        c_free(slacks);
+        adjoint_derivative_clear(solver);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
+    }
 
-    OSQPMatrix* G = OSQPMatrix_vstack(A_ineq_l, A_ineq_u);
+    if (Dinv) OSQPVectorf_ew_prod(x, x, Dinv);
+    OSQPMatrix_Axpy(work->data->A, x, Ax, 1, 0);
+    if (Einv) OSQPVectorf_ew_prod(Ax, Ax, Einv);
+    OSQPVectorf_free(x);
 
-    OSQPMatrix_free(A_ineq_l);
-    OSQPMatrix_free(A_ineq_u);
+    OSQPFloat* Ax_data = OSQPVectorf_data(Ax);
+    for (j = 0; j < n_ineq_l; j++) {
+        row = l_noninf_indices_vec[j];
+        slacks[j] = (Einv_data ? Einv_data[row] * l_data[row] : l_data[row]) - Ax_data[row];
+    }
+    for (j = 0; j < n_ineq_u; j++) {
+        row = u_noninf_indices_vec[j];
+        slacks[n_ineq_l + j] = Ax_data[row] - (Einv_data ? Einv_data[row] * u_data[row] : u_data[row]);
+    }
+    OSQPVectorf_free(Ax);
 
-    OSQPVectori* A_eq_i = OSQPVectori_new(A_eq_vec, m);
-    c_free(A_eq_vec);
-    OSQPMatrix*  A_eq = OSQPMatrix_submatrix_byrows(A, A_eq_i);
-    OSQPVectori_free(A_eq_i);
-    OSQPMatrix_free(A);
+    // The factorization is kept until the next solve
+    OSQPInt retval = adjoint_derivative_linsys_solver(&derivative_data->adj_solver,
+                                                      solver->settings, sym,
+                                                      work->data->P, work->data->A,
+                                                      Dinv, Einv, cinv,
+                                                      derivative_data, slacks);
+    c_free(slacks);
 
-    // --------- lambda
-    OSQPVectorf* m_zeros = OSQPVectorf_malloc(m);
-    OSQPVectorf_set_scalar(m_zeros, 0);
-    OSQPVectorf_ew_max_vec(derivative_data->y_u, y, m_zeros);
-    OSQPVectorf_ew_min_vec(derivative_data->y_l, y, m_zeros);
-    OSQPVectorf_mult_scalar(derivative_data->y_l, -1);
-    OSQPVectorf_free(m_zeros);
-
-    OSQPVectorf* y_l_ineq = OSQPVectorf_subvector_byrows(derivative_data->y_l, A_ineq_l_i);
-    OSQPVectorf* y_u_ineq = OSQPVectorf_subvector_byrows(derivative_data->y_u, A_ineq_u_i);
-    OSQPVectorf* lambda = OSQPVectorf_concat(y_l_ineq, y_u_ineq);
-
-    OSQPVectorf_free(y_l_ineq);
-    OSQPVectorf_free(y_u_ineq);
-    // ---------- lambda
-
-    // --------- slacks
-    OSQPVectorf* l_ineq = OSQPVectorf_subvector_byrows(l, A_ineq_l_i);
-    OSQPVectorf_free(l);
-    OSQPVectorf_mult_scalar(l_ineq, -1);
-    OSQPVectorf* u_ineq = OSQPVectorf_subvector_byrows(u, A_ineq_u_i);
-    OSQPVectorf_free(u);
-    OSQPVectorf* h = OSQPVectorf_concat(l_ineq, u_ineq);
-
-    OSQPVectorf_free(l_ineq);
-    OSQPVectorf_free(u_ineq);
-
-    OSQPVectorf* slacks = OSQPVectorf_copy_new(h);
-    OSQPVectorf_free(h);
-    OSQPMatrix_Axpy(G, x, slacks, 1, -1);
-    OSQPVectorf_free(x);
+    if (retval) adjoint_derivative_clear(solver);
+
+    return retval;
+}
+
+/* Form and factor the adjoint system at the current solution, unless it is cached */
+static OSQPInt adjoint_derivative_factor(OSQPSolver* solver) {
+
+    OSQPDerivativeData *derivative_data = solver->work->derivative_data;
+
+    if (derivative_data->adj_solver) return 0;
+
+    OSQPInt retval = adjoint_derivative_analyse(solver, OSQP_NULL);
+    if (retval) return retval;
 
-    // ---------- GDiagLambda
-    OSQPMatrix* GDiagLambda = OSQPMatrix_copy_new(G);
-    OSQPMatrix_lmult_diag(GDiagLambda, lambda);
-    OSQPVectorf_free(lambda);
+    if (adjoint_derivative_linsys_factor(derivative_data->adj_solver)) {
+        c_eprint("Error in adjoint matrix LDL factorization when computing the nonzero elements.");
+        adjoint_derivative_clear(solver);
+        return osqp_error(OSQP_LINSYS_SOLVER_INIT_ERROR);
+    }
 
-    // ---------- Assemble RHS of the linear system
-    OSQPVectorf* dy_l_ineq = OSQPVectorf_subvector_byrows(dy_l_vec, A_ineq_l_i);
-    OSQPVectorf_free(dy_l_vec);
-    OSQPVectori_free(A_ineq_l_i);
-    OSQPVectorf* dy_u_ineq = OSQPVectorf_subvector_byrows(dy_u_vec, A_ineq_u_i);
-    OSQPVectorf_free(dy_u_vec);
-    OSQPVectori_free(A_ineq_u_i);
+    return 0;
+}
 
-    OSQPVectorf *rhs = derivative_data->rhs;
+/* Assemble the right-hand side of the adjoint system for one seed (dx, dy) */
+static void adjoint_derivative_form_rhs(const OSQPDerivativeData* derivative_data,
+                                        OSQPInt                   n,
+                                        const OSQPFloat*          dx,
+                                        const OSQPFloat*          dy_l,
+                                        const OSQPFloat*          dy_u,
+                                        OSQPFloat*                rhs) {
+
+    OSQPInt j;
     OSQPInt pos = 0;
-    OSQPVectorf_subvector_assign(rhs, dx, pos, n, -1);
+
+    for (j=0; j<n; j++) rhs[pos+j] = -dx[j];
     pos += n;
-    OSQPVectorf_subvector_assign(rhs, OSQPVectorf_data(dy_l_ineq), pos, n_ineq_l, -1);
-    OSQPVectorf_free(dy_l_ineq);
-    pos += n_ineq_l;
-    OSQPVectorf_subvector_assign(rhs, OSQPVectorf_data(dy_u_ineq), pos, n_ineq_u, -1);
-    OSQPVectorf_free(dy_u_ineq);
-    pos += n_ineq_u;
-
-    OSQPFloat* d_nu_vec = (OSQPFloat *) c_malloc(n_eq * sizeof(OSQPFloat));
-    for (j=0; j<n_eq; j++) {
-      if (nu_sign_vec[j]==1) {
-        d_nu_vec[j] = dy_u[eq_indices_vec[j]];
-      } else if (nu_sign_vec[j]==-1) {
-        d_nu_vec[j] = -dy_l[eq_indices_vec[j]];
-      } else {}  // should never happen
+    for (j=0; j<derivative_data->n_ineq_l; j++) {
+        rhs[pos+j] = -dy_l[derivative_data->l_noninf_indices[j]];
     }
-    OSQPVectorf_subvector_assign(rhs, d_nu_vec, pos, n_eq, -1);
-    c_free(d_nu_vec);
-    pos += n_eq;
-
-    OSQPVectorf_subvector_assign_scalar(rhs, 0, pos, n + n_ineq_l + n_ineq_u + n_eq);
-    // ---------- Assemble RHS of the linear system
-
-    OSQPMatrix* P_full = OSQPMatrix_triu_to_symm(P);
-    OSQPMatrix_free(P);
-    adjoint_derivative_linsys_solver(NULL /* No solver object is allocated for this solver yet */,
-                                     solver->settings, P_full, G, A_eq, GDiagLambda, slacks, rhs);
-    OSQPMatrix_free(P_full);
-    OSQPMatrix_free(G);
-    OSQPMatrix_free(A_eq);
-    OSQPMatrix_free(GDiagLambda);
-    OSQPVectorf_free(slacks);
+    pos += derivative_data->n_ineq_l;
+    for (j=0; j<derivative_data->n_ineq_u; j++) {
+        rhs[pos+j] = -dy_u[derivative_data->u_noninf_indices[j]];
+    }
+    pos += derivative_data->n_ineq_u;
+    for (j=0; j<derivative_data->n_eq; j++) {
+      if (derivative_data->nu_sign[j]==1) {
+        rhs[pos+j] = -dy_u[derivative_data->eq_indices[j]];
+      } else {
+        rhs[pos+j] = dy_l[derivative_data->eq_indices[j]];
+      }
+    }
+    pos += derivative_data->n_eq;
 
-    OSQPFloat* rhs_data = OSQPVectorf_data(rhs);
+    for (j=0; j<pos; j++) rhs[pos+j] = 0;
+}
+
+/* Recover the derivatives w.r.t. the lower/upper bounds from the adjoint solution */
+static void adjoint_derivative_get_duals(const OSQPDerivativeData* derivative_data,
+                                         OSQPInt                   n,
+                                         OSQPInt                   m,
+                                         const OSQPFloat*          y,
+                                         const OSQPFloat*          sol,
+                                         OSQPFloat*                ryl,
+                                         OSQPFloat*                ryu) {
+
+    OSQPInt j, row;
+    OSQPInt pos = 2*n + derivative_data->n_ineq_l + derivative_data->n_ineq_u + derivative_data->n_eq;
+
+    const OSQPFloat* y_l = OSQPVectorf_data(derivative_data->y_l);
+    const OSQPFloat* y_u = OSQPVectorf_data(derivative_data->y_u);
 
-    OSQPFloat* r_yl = (OSQPFloat *) c_malloc(m * sizeof(OSQPFloat));
-    OSQPFloat* r_yu = (OSQPFloat *) c_malloc(m * sizeof(OSQPFloat));
     // TODO: We shouldn't have to do this if we assemble r_yl/r_yu judiciously
-    for (j=0; j<m; j++) r_yl[j] = 0;
-    for (j=0; j<m; j++) r_yu[j] = 0;
+    for (j=0; j<m; j++) ryl[j] = 0;
+    for (j=0; j<m; j++) ryu[j] = 0;
 
-    pos += n;
     for (j=0; j<derivative_data->n_ineq_l; j++) {
-        r_yl[l_noninf_indices_vec[j]] = -rhs_data[pos+j];
+        ryl[derivative_data->l_noninf_indices[j]] = -sol[pos+j];
     }
-    c_free(l_noninf_indices_vec);
     pos += derivative_data->n_ineq_l;
     for (j=0; j<derivative_data->n_ineq_u; j++) {
-        r_yu[u_noninf_indices_vec[j]] = rhs_data[pos+j];
+        ryu[derivative_data->u_noninf_indices[j]] = sol[pos+j];
     }
-    c_free(u_noninf_indices_vec);
     pos += derivative_data->n_ineq_u;
     for (j=0; j<derivative_data->n_eq; j++) {
-        if (nu_sign_vec[j]==1) {
-            r_yl[eq_indices_vec[j]] = 0;
-            r_yu[eq_indices_vec[j]] = rhs_data[pos+j] / y_data[eq_indices_vec[j]];
+        row = derivative_data->eq_indices[j];
+        if (derivative_data->nu_sign[j]==1) {
+            ryl[row] = 0;
+            ryu[row] = sol[pos+j] / y[row];
         } else {
-            r_yl[eq_indices_vec[j]] = -rhs_data[pos+j] / y_data[eq_indices_vec[j]];
-            r_yu[eq_indices_vec[j]] = 0;
+            ryl[row] = -sol[pos+j] / y[row];
+            ryu[row] = 0;
         }
     }
-    c_free(nu_sign_vec);
-    c_free(eq_indices_vec);
 
-    OSQPVectorf_from_raw(derivative_data->ryl, r_yl);
-    c_free(r_yl);
-    OSQPVectorf_ew_prod(derivative_data->ryl, derivative_data->ryl, derivative_data->y_l);
-    OSQPVectorf_mult_scalar(derivative_data->ryl, -1);
-    OSQPVectorf_from_raw(derivative_data->ryu, r_yu);
-    c_free(r_yu);
-    OSQPVectorf_ew_prod(derivative_data->ryu, derivative_data->ryu, derivative_data->y_u);
+    for (j=0; j<m; j++) {
+        ryl[j] *= -y_l[j];
+        ryu[j] *= y_u[j];
+    }
+}
+
+OSQPInt adjoint_derivative_compute(OSQPSolver *solver,
+                                   const OSQPFloat* dx,
+                                   const OSQPFloat* dy_l,
+                                   const OSQPFloat* dy_u) {
+
+    // Check if solver has been initialized
+    if (!solver || !solver->work || !solver->work->derivative_data)
+      return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+
+    OSQPInt m = solver->work->data->m;
+    OSQPInt n = solver->work->data->n;
+    OSQPDerivativeData *derivative_data = solver->work->derivative_data;
 
-    //cleanup
-    OSQPVectorf_free(y);
+    OSQPInt retval = adjoint_derivative_factor(solver);
+    if (retval) return retval;
+
+    adjoint_derivative_form_rhs(derivative_data, n, dx, dy_l, dy_u,
+                                OSQPVectorf_data(derivative_data->rhs));
+
+    retval = adjoint_derivative_linsys_solve(derivative_data->adj_solver, derivative_data->rhs, 1);
+    if (retval) return retval;
+
+    adjoint_derivative_get_duals(derivative_data, n, m, solver->solution->y,
+                                 OSQPVectorf_data(derivative_data->rhs),
+                                 OSQPVectorf_data(derivative_data->ryl),
+                                 OSQPVectorf_data(derivative_data->ryu));
 
     return 0;
 }
+
+OSQPInt adjoint_derivative_compute_multi(OSQPSolver*      solver,
+                                         OSQPInt          nrhs,
+                                         const OSQPFloat* dx,
+                                         const OSQPFloat* dy,
+                                         OSQPFloat*       dq,
+                                         OSQPFloat*       dl,
+                                         OSQPFloat*       du,
+                                         OSQPCscMatrix*   dP,
+                                         OSQPCscMatrix*   dA) {
+
+    OSQPInt j, k, dim, pos;
+
+    // Check if solver has been initialized
+    if (!solver || !solver->work || !solver->work->derivative_data)
+      return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+
+    OSQPInt m = solver->work->data->m;
+    OSQPInt n = solver->work->data->n;
+    OSQPDerivativeData *derivative_data = solver->work->derivative_data;
+
+    OSQPInt retval = adjoint_derivative_factor(solver);
+    if (retval) return retval;
+
+    dim = 2 * (n + derivative_data->n_ineq_l + derivative_data->n_ineq_u + derivative_data->n_eq);
+    pos = dim / 2;
+
+    OSQPVectorf* rhs = OSQPVectorf_malloc(dim * nrhs);
+    OSQPFloat*   ryl = (OSQPFloat *) c_malloc(m * sizeof(OSQPFloat));
+    OSQPFloat*   ryu = (OSQPFloat *) c_malloc(m * sizeof(OSQPFloat));
+
+    if (!rhs || (m && (!ryl || !ryu))) {
+        OSQPVectorf_free(rhs);
+        c_free(ryl);
+        c_free(ryu);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
+    }
+
+    OSQPFloat* rhs_data = OSQPVectorf_data(rhs);
+
+    for (k=0; k<nrhs; k++) {
+        adjoint_derivative_form_rhs(derivative_data, n, dx + k*n, dy + k*m, dy + k*m,
+                                    rhs_data + k*dim);
+    }
+
+    // Backsolve all seeds with the same factorization at once
+    retval = adjoint_derivative_linsys_solve(derivative_data->adj_solver, rhs, nrhs);
+
+    for (k=0; !retval && k<nrhs; k++) {
+        const OSQPFloat* sol = rhs_data + k*dim;
+
+        adjoint_derivative_get_duals(derivative_data, n, m, solver->solution->y, sol, ryl, ryu);
+
+        if (dq) for (j=0; j<n; j++) dq[k*n + j] = sol[pos + j];
+        if (dl) for (j=0; j<m; j++) dl[k*m + j] = ryl[j];
+        if (du) for (j=0; j<m; j++) du[k*m + j] = -ryu[j];
+
+        adjoint_derivative_fill_mat(dP, dP ? dP->x + k*dP->p[dP->n] : OSQP_NULL,
+                                    dA, dA ? dA->x + k*dA->p[dA->n] : OSQP_NULL,
+                                    solver->solution->x,
+                                    OSQPVectorf_data(derivative_data->y_l),
+                                    OSQPVectorf_data(derivative_data->y_u),
+                                    sol + pos, ryl, ryu);
+    }
+
+    OSQPVectorf_free(rhs);
+    c_free(ryl);
+    c_free(ryu);
+
+    return retval;
+}
+
+OSQPInt forward_derivative_compute_multi(OSQPSolver*          solver,
+                                         OSQPInt              ndir,
+                                         const OSQPCscMatrix* dP,
+                                         const OSQPFloat*     dq,
+                                         const OSQPCscMatrix* dA,
+                                         const OSQPFloat*     dl,
+                                         const OSQPFloat*     du,
+                                         OSQPFloat*           dx,
+                                         OSQPFloat*           dy) {
+
+    OSQPInt j, k, row, dim, pos;
+    OSQPCscMatrix dP_k, dA_k;
+
+    // Check if solver has been initialized
+    if (!solver || !solver->work || !solver->work->derivative_data)
+      return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+
+    OSQPInt m = solver->work->data->m;
+    OSQPInt n = solver->work->data->n;
+    OSQPDerivativeData *derivative_data = solver->work->derivative_data;
+
+    OSQPInt retval = adjoint_derivative_factor(solver);
+    if (retval) return retval;
+
+    OSQPInt n_ineq_l = derivative_data->n_ineq_l;
+    OSQPInt n_ineq_u = derivative_data->n_ineq_u;
+    OSQPInt n_eq     = derivative_data->n_eq;
+
+    const OSQPFloat* x   = solver->solution->x;
+    const OSQPFloat* y   = solver->solution->y;
+    const OSQPFloat* y_l = OSQPVectorf_data(derivative_data->y_l);
+    const OSQPFloat* y_u = OSQPVectorf_data(derivative_data->y_u);
+
+    dim = 2 * (n + n_ineq_l + n_ineq_u + n_eq);
+    pos = dim / 2;
+
+    OSQPVectorf* rhs = OSQPVectorf_malloc(dim * ndir);
+    OSQPFloat*   w   = (OSQPFloat *) c_calloc(m, sizeof(OSQPFloat));
+    OSQPFloat*   v   = (OSQPFloat *) c_malloc(m * sizeof(OSQPFloat));
+
+    if (!rhs || (m && (!w || !v))) {
+        OSQPVectorf_free(rhs);
+        c_free(w);
+        c_free(v);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
+    }
+
+    OSQPFloat* rhs_data = OSQPVectorf_data(rhs);
+
+    // Multipliers of the rows of A in the stationarity condition
+    for (j=0; j<n_ineq_l; j++) w[derivative_data->l_noninf_indices[j]] -= y_l[derivative_data->l_noninf_indices[j]];
+    for (j=0; j<n_ineq_u; j++) w[derivative_data->u_noninf_indices[j]] += y_u[derivative_data->u_noninf_indices[j]];
+    for (j=0; j<n_eq; j++)     w[derivative_data->eq_indices[j]] = y[derivative_data->eq_indices[j]];
+
+    // The adjoint matrix is [I K; K' 0], so a right-hand side [0; c] gives K'^{-1} c
+    // in the top half, which is the forward sensitivity of the KKT conditions.
+    for (k=0; k<ndir; k++) {
+        OSQPFloat* c = rhs_data + k*dim;
+
+        for (j=0; j<pos; j++) c[j] = 0;
+        c += pos;
+
+        // Stationarity: -(dP x + dq + dA' w)
+        for (j=0; j<n; j++) c[j] = dq ? -dq[k*n + j] : 0;
+        if (dP) {
+            dP_k   = *dP;
+            dP_k.x = dP->x + k*dP->p[dP->n];
+            csc_Axpy_sym_triu(&dP_k, x, c, -1, 1);
+        }
+
+        for (j=0; j<m; j++) v[j] = 0;
+        if (dA) {
+            dA_k   = *dA;
+            dA_k.x = dA->x + k*dA->p[dA->n];
+            csc_Atxpy(&dA_k, w, c, -1, 1);
+            csc_Axpy(&dA_k, x, v, 1, 0);
+        }
+        c += n;
+
+        // Complementarity of the lower/upper inequalities, then equality feasibility
+        for (j=0; j<n_ineq_l; j++) {
+            row  = derivative_data->l_noninf_indices[j];
+            c[j] = -y_l[row] * ((dl ? dl[k*m + row] : 0) - v[row]);
+        }
+        c += n_ineq_l;
+        for (j=0; j<n_ineq_u; j++) {
+            row  = derivative_data->u_noninf_indices[j];
+            c[j] = -y_u[row] * (v[row] - (du ? du[k*m + row] : 0));
+        }
+        c += n_ineq_u;
+        for (j=0; j<n_eq; j++) {
+            row  = derivative_data->eq_indices[j];
+            if (derivative_data->nu_sign[j]==1) {
+                c[j] = (du ? du[k*m + row] : 0) - v[row];
+            } else {
+                c[j] = (dl ? dl[k*m + row] : 0) - v[row];
+            }
+        }
+    }
+
+    retval = adjoint_derivative_linsys_solve(derivative_data->adj_solver, rhs, ndir);
+
+    for (k=0; !retval && k<ndir; k++) {
+        const OSQPFloat* sol = rhs_data + k*dim;
+
+        if (dx) for (j=0; j<n; j++) dx[k*n + j] = sol[j];
+
+        if (dy) {
+            OSQPFloat* dy_k = dy + k*m;
+
+            for (j=0; j<m; j++) dy_k[j] = 0;
+            for (j=0; j<n_ineq_l; j++) dy_k[derivative_data->l_noninf_indices[j]] -= sol[n + j];
+            for (j=0; j<n_ineq_u; j++) dy_k[derivative_data->u_noninf_indices[j]] += sol[n + n_ineq_l + j];
+            for (j=0; j<n_eq; j++)     dy_k[derivative_data->eq_indices[j]] = sol[n + n_ineq_l + n_ineq_u + j];
+        }
+    }
+
+    OSQPVectorf_free(rhs);
+    c_free(w);
+    c_free(v);
+
+    return retval;
+}
+
+OSQPInt adjoint_derivative_compute_batch(OSQPSolver**     solvers,
+                                         OSQPInt          nsolvers,
+                                         const OSQPFloat* dx,
+                                         const OSQPFloat* dy) {
+
+    OSQPInt k;
+    OSQPInt retval = 0;
+    OSQPInt n_pending = 0;
+    const LinSysSolver* sym = OSQP_NULL;
+
+    if (nsolvers <= 0) return 0;
+
+    for (k=0; k<nsolvers; k++) {
+        // Check if solver has been initialized
+        if (!solvers[k] || !solvers[k]->work || !solvers[k]->work->derivative_data)
+          return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+    }
+
+    OSQPSolver** pending = (OSQPSolver **) c_malloc(nsolvers * sizeof(OSQPSolver*));
+    OSQPInt*     failed  = (OSQPInt *) c_calloc(nsolvers, sizeof(OSQPInt));
+    if (!pending || !failed) {
+        c_free(pending);
+        c_free(failed);
+        return osqp_error(OSQP_MEM_ALLOC_ERROR);
+    }
+
+    // Assemble every system, sharing the ordering and elimination tree of the first one.
+    // Each solver is profiled into its own counters.
+    for (k=0; k<nsolvers; k++) {
+        OSQPDerivativeData *derivative_data = solvers[k]->work->derivative_data;
+
+        if (!derivative_data->adj_solver) {
+            osqp_profiler_set_target(solvers[k]->work->profile);
+            retval = adjoint_derivative_analyse(solvers[k], sym);
+            if (retval) break;
+            pending[n_pending++] = solvers[k];
+        }
+        if (!sym) sym = derivative_data->adj_solver;
+    }
+
+    // The numeric factorizations are independent of each other
+    if (!retval) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (k=0; k<n_pending; k++) {
+            failed[k] = adjoint_derivative_linsys_factor(pending[k]->work->derivative_data->adj_solver);
+        }
+
+        for (k=0; k<n_pending; k++) {
+            if (failed[k]) {
+                c_eprint("Error in adjoint matrix LDL factorization when computing the nonzero elements.");
+                retval = osqp_error(OSQP_LINSYS_SOLVER_INIT_ERROR);
+                break;
+            }
+        }
+    }
+
+    // Do not keep systems that were not factored
+    if (retval) {
+        for (k=0; k<n_pending; k++) adjoint_derivative_clear(pending[k]);
+    }
+
+    c_free(pending);
+    c_free(failed);
+
+    // Backsolve each problem with its own seed
+    for (k=0; !retval && k<nsolvers; k++) {
+        osqp_profiler_set_target(solvers[k]->work->profile);
+        retval = adjoint_derivative_compute(solvers[k], dx, dy, dy);
+        dx += solvers[k]->work->data->n;
+        dy += solvers[k]->work->data->m;
+    }
+
+    return retval;
+}
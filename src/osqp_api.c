@@ -18,6 +18,7 @@
 
 #ifndef OSQP_EMBEDDED_MODE
 # include "polish.h"
+# include "trace.h"
 #endif
 
 #ifdef OSQP_ENABLE_DERIVATIVES
@@ -95,6 +96,11 @@ void osqp_set_default_codegen_defines(OSQPCodegenDefines* defines) {
   defines->profiling_enable   = 0;  /* Default to no timing */
   defines->interrupt_enable   = 0;  /* Default to no interrupts */
   defines->derivatives_enable = 0;  /* Default to no derivatives */
+  defines->ldl_unroll_enable  = 0;  /* Default to the generic LDL solve */
+  defines->spmv_unroll_enable = 0;  /* Default to the generic matrix-vector products */
+  defines->fixed_point_bits   = 0;  /* Default to no fixed-point solver */
+  defines->multi_instance_enable = 0;  /* Default to a single global solver */
+  defines->compact_index_enable  = 0;  /* Default to the library kernels with OSQPInt indices */
 }
 
 
@@ -141,6 +147,22 @@ void osqp_set_default_settings(OSQPSettings* settings) {
 
   settings->delta              = OSQP_DELTA;                    /* regularization parameter for polishing */
   settings->polish_refine_iter = OSQP_POLISH_REFINE_ITER;       /* iterative refinement steps in polish */
+  settings->polish_early_checks = OSQP_POLISH_EARLY_CHECKS;     /* stable active-set checks before early polish */
+
+  settings->trace_size         = OSQP_TRACE_SIZE;               /* termination checks kept in the convergence trace */
+
+  settings->kkt_ordering    = OSQP_KKT_ORDERING;              /* fill-reducing ordering of the KKT matrix */
+  settings->amd_dense       = (OSQPFloat)OSQP_AMD_DENSE;      /* AMD dense row threshold */
+  settings->amd_aggressive  = OSQP_AMD_AGGRESSIVE;            /* AMD aggressive absorption */
+  settings->kkt_permutation = OSQP_NULL;                      /* user-supplied KKT permutation */
+
+  settings->dyn_reg             = OSQP_DYN_REG;                       /* dynamic regularization of the KKT pivots */
+  settings->dyn_reg_eps         = (OSQPFloat)OSQP_DYN_REG_EPS;        /* threshold of the replaced pivots */
+  settings->dyn_reg_delta       = (OSQPFloat)OSQP_DYN_REG_DELTA;      /* magnitude of the replacement pivots */
+  settings->dyn_reg_refine_iter = OSQP_DYN_REG_REFINE_ITER;           /* iterative refinement steps of the solves */
+
+  settings->kkt_system = OSQP_KKT_SYSTEM;                             /* linear system of the direct solver */
+  settings->kkt_stages = OSQP_NULL;                                   /* user-supplied stages of the KKT rows */
 }
 
 #ifndef OSQP_EMBEDDED_MODE
@@ -167,9 +189,6 @@ OSQPInt osqp_setup(OSQPSolver**         solverp,
   // Validate settings
   if (validate_settings(settings, 1)) return osqp_error(OSQP_SETTINGS_VALIDATION_ERROR);
 
-  osqp_profiler_init(settings->profiler_level);
-  osqp_profiler_sec_push(OSQP_PROFILER_SEC_SETUP);
-
   // Allocate empty solver
   solver = c_calloc(1, sizeof(OSQPSolver));
   if (!(solver)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
@@ -180,6 +199,16 @@ OSQPInt osqp_setup(OSQPSolver**         solverp,
   if (!(work)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
   solver->work = work;
 
+#ifdef OSQP_PROFILER_BUILTIN
+  // Allocate the profiler counters so the setup is counted as well
+  work->profile = _osqp_profiler_data_new();
+  if (!(work->profile)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
+#endif /* ifdef OSQP_PROFILER_BUILTIN */
+
+  osqp_profiler_set_target(work->profile);
+  osqp_profiler_init(settings->profiler_level);
+  osqp_profiler_sec_push(OSQP_PROFILER_SEC_SETUP);
+
   // Allocate empty info struct
   solver->info = c_calloc(1, sizeof(OSQPInfo));
   if (!(solver->info)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
@@ -330,7 +359,7 @@ OSQPInt osqp_setup(OSQPSolver**         solverp,
   osqp_cold_start(solver);
 
   // Initialize active constraints structure
-  work->pol = c_malloc(sizeof(OSQPPolish));
+  work->pol = c_calloc(1, sizeof(OSQPPolish));
   if (!(work->pol)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
   work->pol->active_flags = OSQPVectori_malloc(m);
   work->pol->x            = OSQPVectorf_malloc(n);
@@ -340,6 +369,10 @@ OSQPInt osqp_setup(OSQPSolver**         solverp,
   if (!(work->pol->active_flags) ||
       !(work->pol->z) || !(work->pol->y))
     return osqp_error(OSQP_MEM_ALLOC_ERROR);
+  if (polish_early_init(solver)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
+
+  // Allocate convergence trace (if enabled)
+  if (trace_init(solver)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
 
   // Allocate solution
   if (settings->allocate_solution) {
@@ -378,6 +411,7 @@ OSQPInt osqp_setup(OSQPSolver**         solverp,
 # endif /* ifdef OSQP_ENABLE_PROFILING */
   solver->info->rho_updates  = 0;                      // Rho updates set to 0
   solver->info->rho_estimate = solver->settings->rho;  // Best rho estimate
+  solver->info->factor_nnz   = work->linsys_solver->factor_nnz;
   solver->info->obj_val      = OSQP_INFTY;
   solver->info->prim_res     = OSQP_INFTY;
   solver->info->dual_res     = OSQP_INFTY;
@@ -427,6 +461,58 @@ OSQPInt osqp_setup(OSQPSolver**         solverp,
 #endif /* ifndef OSQP_EMBEDDED_MODE */
 
 
+#ifdef OSQP_PROFILER_BUILTIN
+/* Estimated memory traffic of the vector operations in one ADMM iteration,
+ * counting every vector element read or written by the right-hand side
+ * computation and the x, z and y updates */
+static void profile_admm_bytes(const OSQPSolver* solver) {
+
+  OSQPFloat n   = (OSQPFloat)solver->work->data->n;
+  OSQPFloat m   = (OSQPFloat)solver->work->data->m;
+  OSQPFloat vec = (OSQPFloat)solver->settings->rho_is_vec;
+  OSQPFloat f   = (OSQPFloat)sizeof(OSQPFloat);
+
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_ADMM_KKT_SOLVE, f * (3*n + 3*m + 3*m*vec));
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_ADMM_UPDATE,    f * (6*n + 9*m + m*vec));
+  osqp_profiler_sec_bytes(OSQP_PROFILER_SEC_ADMM_PROJ,      f * (8*m + 3*m*vec));
+}
+#endif /* ifdef OSQP_PROFILER_BUILTIN */
+
+#ifdef OSQP_ENABLE_PROFILING
+/*
+ * Number of iterations until the clock has to be read again. The interval is
+ * sized from the average iteration time so that the deadlines of the time limit
+ * and of the automatic rho interval are overrun by at most half of the time
+ * left to them, and never by more than OSQP_CLOCK_CHECK_TOL of the deadline.
+ */
+static OSQPInt clock_check_interval(const OSQPSolver* solver,
+                                    OSQPInt           iter,
+                                    OSQPFloat         solve_time,
+                                    OSQPFloat         run_time) {
+
+  OSQPFloat iter_time = solve_time / iter;
+  OSQPFloat budget    = OSQP_INFTY;
+  OSQPFloat deadline;
+
+  if (solver->settings->time_limit) {
+    deadline = solver->settings->time_limit;
+    budget   = c_min(budget, c_max(0.5 * (deadline - run_time), OSQP_CLOCK_CHECK_TOL * deadline));
+  }
+
+# if OSQP_EMBEDDED_MODE != 1
+  if (solver->settings->adaptive_rho && !solver->settings->adaptive_rho_interval) {
+    deadline = solver->settings->adaptive_rho_fraction * solver->info->setup_time;
+    budget   = c_min(budget, c_max(0.5 * (deadline - solve_time), OSQP_CLOCK_CHECK_TOL * deadline));
+  }
+# endif /* if OSQP_EMBEDDED_MODE != 1 */
+
+  if (budget >= OSQP_CLOCK_CHECK_MAX_ITER * iter_time)
+    return OSQP_CLOCK_CHECK_MAX_ITER;
+
+  return c_max((OSQPInt)(budget / iter_time), 1);
+}
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+
 OSQPInt osqp_solve(OSQPSolver *solver) {
 
   OSQPInt exitflag;
@@ -435,8 +521,15 @@ OSQPInt osqp_solve(OSQPSolver *solver) {
   OSQPInt can_check_termination; // boolean: check termination or not
   OSQPWorkspace* work;
 
+#ifndef OSQP_EMBEDDED_MODE
+  OSQPInt polished_early;        // boolean: polished solution accepted inside the loop
+#endif /* ifndef OSQP_EMBEDDED_MODE */
+
 #ifdef OSQP_ENABLE_PROFILING
   OSQPFloat temp_run_time;       // Temporary variable to store current run time
+  OSQPFloat solve_time;          // Solve time at the last clock read
+  OSQPInt   clock_read;          // boolean: clock was read in this iteration
+  OSQPInt   next_clock_iter;     // Iteration at which to read the clock next
 #endif /* ifdef OSQP_ENABLE_PROFILING */
 
 #ifdef OSQP_ENABLE_PRINTING
@@ -447,15 +540,30 @@ OSQPInt osqp_solve(OSQPSolver *solver) {
   if (!solver || !solver->work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
   work = solver->work;
 
+  osqp_profiler_set_target(work->profile);
+
 #ifdef OSQP_ENABLE_PROFILING
   if (work->clear_update_time == 1)
     solver->info->update_time = 0.0;
   work->rho_update_from_solve = 1;
+
+  solve_time      = 0.0;
+  next_clock_iter = 1;
 #endif /* ifdef OSQP_ENABLE_PROFILING */
 
   // Initialize variables
   exitflag              = 0;
   can_check_termination = 0;
+#ifndef OSQP_EMBEDDED_MODE
+  polished_early        = 0;
+  work->pol->n_stable   = 0;
+  if (work->trace) trace_reset(solver);
+#endif /* ifndef OSQP_EMBEDDED_MODE */
+
+#ifdef OSQP_ENABLE_DERIVATIVES
+  // The cached adjoint factorization belongs to the previous solution
+  adjoint_derivative_clear(solver);
+#endif /* ifdef OSQP_ENABLE_DERIVATIVES */
 #ifdef OSQP_ENABLE_PRINTING
   can_print = solver->settings->verbose;
   // Compute objective function only if verbose is on
@@ -521,6 +629,10 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
     osqp_profiler_sec_pop(OSQP_PROFILER_SEC_ADMM_UPDATE);
     osqp_profiler_sec_pop(OSQP_PROFILER_SEC_ADMM_ITER);
 
+#ifdef OSQP_PROFILER_BUILTIN
+    profile_admm_bytes(solver);
+#endif /* ifdef OSQP_PROFILER_BUILTIN */
+
 #ifdef OSQP_ENABLE_INTERRUPT
 
     // Check the interrupt signal
@@ -534,24 +646,35 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
 
 #ifdef OSQP_ENABLE_PROFILING
 
-    // Check if solver time_limit is enabled. In case, check if the current
-    // run time is more than the time_limit option.
-    if (work->first_run) {
-      temp_run_time = solver->info->setup_time + osqp_toc(work->timer);
-    }
-    else {
-      temp_run_time = solver->info->update_time + osqp_toc(work->timer);
-    }
+    // Reading the clock costs about as much as an iteration of a tiny problem,
+    // so it is only read once enough iterations have passed to approach one
+    // of the deadlines (see clock_check_interval)
+    clock_read = (iter >= next_clock_iter);
 
-    if (solver->settings->time_limit &&
-        (temp_run_time >= solver->settings->time_limit)) {
-      update_status(solver->info, OSQP_TIME_LIMIT_REACHED);
+    if (clock_read) {
+      solve_time = osqp_toc(work->timer);
+
+      // Check if solver time_limit is enabled. In case, check if the current
+      // run time is more than the time_limit option.
+      if (work->first_run) {
+        temp_run_time = solver->info->setup_time + solve_time;
+      }
+      else {
+        temp_run_time = solver->info->update_time + solve_time;
+      }
+
+      if (solver->settings->time_limit &&
+          (temp_run_time >= solver->settings->time_limit)) {
+        update_status(solver->info, OSQP_TIME_LIMIT_REACHED);
 # ifdef OSQP_ENABLE_PRINTING
 
-      if (solver->settings->verbose) c_print("run time limit reached\n");
-      can_print = 0;  // Not printing at this iteration
+        if (solver->settings->verbose) c_print("run time limit reached\n");
+        can_print = 0;  // Not printing at this iteration
 # endif /* ifdef OSQP_ENABLE_PRINTING */
-      break;
+        break;
+      }
+
+      next_clock_iter = iter + clock_check_interval(solver, iter, solve_time, temp_run_time);
     }
 #endif /* ifdef OSQP_ENABLE_PROFILING */
 
@@ -579,6 +702,10 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
       }
 
       if (can_check_termination) {
+# ifndef OSQP_EMBEDDED_MODE
+        if (work->trace) trace_record(solver, iter);
+# endif /* ifndef OSQP_EMBEDDED_MODE */
+
         // Check algorithm termination
         if (check_termination(solver, 0)) {
           // Terminate algorithm
@@ -592,6 +719,10 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
       // Update information and compute also objective value
       update_info(solver, iter, compute_obj, 0);
 
+# ifndef OSQP_EMBEDDED_MODE
+      if (work->trace) trace_record(solver, iter);
+# endif /* ifndef OSQP_EMBEDDED_MODE */
+
       // Check algorithm termination
       if (check_termination(solver, 0)) {
         // Terminate algorithm
@@ -601,6 +732,43 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
 #endif /* ifdef OSQP_ENABLE_PRINTING */
 
 
+#ifndef OSQP_EMBEDDED_MODE
+
+    // Try polishing before convergence once the active set guess has settled
+    if (can_check_termination && solver->settings->polishing &&
+        solver->settings->polish_early_checks) {
+      polish_update_active_set(solver);
+
+      if (work->pol->n_stable > solver->settings->polish_early_checks) {
+        osqp_profiler_sec_push(OSQP_PROFILER_SEC_POLISH);
+        exitflag = polish_early(solver);
+        osqp_profiler_sec_pop(OSQP_PROFILER_SEC_POLISH);
+
+        // Only an allocation failure is returned, see polish_early
+        if (exitflag > 0) {
+          c_eprint("Failed polishing");
+          goto exit;
+        }
+
+        if (solver->info->status_polish == OSQP_POLISH_SUCCESS) {
+          // Polished solution is accurate enough -> terminate
+          polished_early = 1;
+# ifdef OSQP_ENABLE_PRINTING
+          work->summary_printed = 1; // Polished iterate already printed
+# endif /* ifdef OSQP_ENABLE_PRINTING */
+          update_status(solver->info, OSQP_SOLVED);
+          break;
+        }
+
+        // The polish failed or was not accurate enough: wait for K more checks
+        // and recompute the products at the ADMM iterates, which it overwrote
+        work->pol->n_stable = 0;
+        update_info(solver, iter, compute_obj, 0);
+      }
+    }
+#endif /* ifndef OSQP_EMBEDDED_MODE */
+
+
 #if OSQP_EMBEDDED_MODE != 1
 # ifdef OSQP_ENABLE_PROFILING
 
@@ -608,9 +776,9 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
     // certain fraction
     // of the setup time.
     if (solver->settings->adaptive_rho && !solver->settings->adaptive_rho_interval) {
-      // Check time
-      if (osqp_toc(work->timer) >
-          solver->settings->adaptive_rho_fraction * solver->info->setup_time) {
+      // Check time (only when the clock was read in this iteration)
+      if (clock_read &&
+          solve_time > solver->settings->adaptive_rho_fraction * solver->info->setup_time) {
         // Enough time has passed. We now get the number of iterations between
         // the updates.
         if (solver->settings->check_termination) {
@@ -749,12 +917,16 @@ osqp_profiler_sec_push(OSQP_PROFILER_SEC_OPT_SOLVE);
   /* Update solve time */
 #ifdef OSQP_ENABLE_PROFILING
   solver->info->solve_time = osqp_toc(work->timer);
+# ifndef OSQP_EMBEDDED_MODE
+  if (polished_early) solver->info->solve_time -= solver->info->polish_time;
+# endif /* ifndef OSQP_EMBEDDED_MODE */
 #endif /* ifdef OSQP_ENABLE_PROFILING */
 
 
 #ifndef OSQP_EMBEDDED_MODE
   // Polish the obtained solution
-  if (solver->settings->polishing && (solver->info->status_val == OSQP_SOLVED)) {
+  if (solver->settings->polishing && !polished_early &&
+      (solver->info->status_val == OSQP_SOLVED)) {
     osqp_profiler_sec_push(OSQP_PROFILER_SEC_POLISH);
     exitflag = polish(solver);
     osqp_profiler_sec_pop(OSQP_PROFILER_SEC_POLISH);
@@ -881,6 +1053,8 @@ OSQPInt osqp_cleanup(OSQPSolver* solver) {
       OSQPVectorf_free(work->pol->x);
       OSQPVectorf_free(work->pol->z);
       OSQPVectorf_free(work->pol->y);
+      c_free(work->pol->early_flags);
+      c_free(work->pol->early_zylu);
       c_free(work->pol);
     }
 #endif /* ifndef OSQP_EMBEDDED_MODE */
@@ -928,6 +1102,14 @@ OSQPInt osqp_cleanup(OSQPSolver* solver) {
     if (work->timer) OSQPTimer_free(work->timer);
 # endif /* ifdef OSQP_ENABLE_PROFILING */
 
+    // Free convergence trace
+    trace_free(work->trace);
+
+# ifdef OSQP_PROFILER_BUILTIN
+    // Free profiler counters, which also stops this thread from counting into them
+    _osqp_profiler_data_free(work->profile);
+# endif /* ifdef OSQP_PROFILER_BUILTIN */
+
 # ifdef OSQP_ENABLE_DERIVATIVES
       if (work->derivative_data){
           if (work->derivative_data->y_l) OSQPVectorf_free(work->derivative_data->y_l);
@@ -935,6 +1117,7 @@ OSQPInt osqp_cleanup(OSQPSolver* solver) {
           if (work->derivative_data->ryl) OSQPVectorf_free(work->derivative_data->ryl);
           if (work->derivative_data->ryu) OSQPVectorf_free(work->derivative_data->ryu);
           if (work->derivative_data->rhs) OSQPVectorf_free(work->derivative_data->rhs);
+          adjoint_derivative_clear(solver);
           c_free(work->derivative_data);
       }
 #endif /* ifdef OSQP_ENABLE_SCALING */
@@ -949,6 +1132,52 @@ OSQPInt osqp_cleanup(OSQPSolver* solver) {
   return exitflag;
 }
 
+
+OSQPInt osqp_get_trace(const OSQPSolver* solver,
+                       OSQPInt           format,
+                       void*             buffer,
+                       OSQPInt*          size) {
+
+  // Check if workspace has been initialized
+  if (!solver || !solver->work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+
+  if (!size) return osqp_error(OSQP_DATA_VALIDATION_ERROR);
+
+  return trace_export(solver, format, buffer, size);
+}
+
+
+OSQPInt osqp_get_profile(const OSQPSolver*   solver,
+                         OSQPProfileSection* sections,
+                         OSQPInt*            n) {
+
+#ifdef OSQP_PROFILER_BUILTIN
+  OSQPInt i;
+  OSQPProfilerData* data;
+
+  // Check if workspace has been initialized
+  if (!solver || !solver->work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
+  data = solver->work->profile;
+
+  if (!n || (*n > 0 && !sections)) return osqp_error(OSQP_DATA_VALIDATION_ERROR);
+
+  for (i = 0; i < OSQP_PROFILER_SEC_ARRAY_LAST && i < *n; i++) {
+    sections[i].name  = osqp_profiler_sections[i].name;
+    sections[i].time  = data->time[i];
+    sections[i].calls = data->calls[i];
+    sections[i].bytes = data->bytes[i];
+  }
+
+  *n = OSQP_PROFILER_SEC_ARRAY_LAST;
+  return OSQP_NO_ERROR;
+#else
+  OSQP_UnusedVar(solver);
+  OSQP_UnusedVar(sections);
+  OSQP_UnusedVar(n);
+  return OSQP_FUNC_NOT_IMPLEMENTED;
+#endif /* ifdef OSQP_PROFILER_BUILTIN */
+}
+
 #endif /* ifndef OSQP_EMBEDDED_MODE */
 
 
@@ -972,6 +1201,9 @@ OSQPInt osqp_update_data_vec(OSQPSolver*      solver,
   if (!solver || !solver->work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
   work = solver->work;
 
+  /* A change of the constraint types refactors the KKT matrix */
+  osqp_profiler_set_target(work->profile);
+
 #ifdef OSQP_ENABLE_PROFILING
   if (work->clear_update_time == 1) {
     work->clear_update_time = 0;
@@ -1025,6 +1257,10 @@ OSQPInt osqp_update_data_vec(OSQPSolver*      solver,
   /* Reset solver information */
   reset_info(solver->info);
 
+#ifdef OSQP_ENABLE_DERIVATIVES
+  adjoint_derivative_clear(solver);
+#endif /* ifdef OSQP_ENABLE_DERIVATIVES */
+
 #ifdef OSQP_ENABLE_PROFILING
   solver->info->update_time += osqp_toc(work->timer);
 #endif /* ifdef OSQP_ENABLE_PROFILING */
@@ -1098,6 +1334,8 @@ OSQPInt osqp_update_data_mat(OSQPSolver*      solver,
   if (!solver || !solver->work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
   work = solver->work;
 
+  osqp_profiler_set_target(work->profile);
+
 #ifdef OSQP_ENABLE_PROFILING
   if (work->clear_update_time == 1) {
     work->clear_update_time = 0;
@@ -1165,6 +1403,10 @@ OSQPInt osqp_update_data_mat(OSQPSolver*      solver,
   // Reset solver information
   reset_info(solver->info);
 
+#ifdef OSQP_ENABLE_DERIVATIVES
+  adjoint_derivative_clear(solver);
+#endif /* ifdef OSQP_ENABLE_DERIVATIVES */
+
   if (exitflag != 0){c_eprint("new KKT matrix is not quasidefinite");}
 
 #ifdef OSQP_ENABLE_PROFILING
@@ -1185,6 +1427,8 @@ OSQPInt osqp_update_rho(OSQPSolver* solver,
     if (!solver || !solver->work) return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
     work = solver->work;
 
+  osqp_profiler_set_target(work->profile);
+
   // Check value of rho
   if (rho_new <= 0) {
     c_eprint("rho must be positive");
@@ -1254,6 +1498,7 @@ OSQPInt osqp_update_settings(OSQPSolver*         solver,
 
   /* Must call into profiler to update level in addition to storing the value */
   settings->profiler_level = new_settings->profiler_level;
+  osqp_profiler_set_target(solver->work->profile);
   osqp_profiler_update_level(settings->profiler_level);
 
   settings->verbose       = new_settings->verbose;
@@ -1287,6 +1532,26 @@ OSQPInt osqp_update_settings(OSQPSolver*         solver,
 
   settings->delta              = new_settings->delta;
   settings->polish_refine_iter = new_settings->polish_refine_iter;
+  settings->polish_early_checks = new_settings->polish_early_checks;
+
+#ifndef OSQP_EMBEDDED_MODE
+  if (polish_early_init(solver)) return osqp_error(OSQP_MEM_ALLOC_ERROR);
+#endif
+
+  // trace_size ignored
+
+  // kkt_ordering    ignored
+  // amd_dense       ignored
+  // amd_aggressive  ignored
+  // kkt_permutation ignored
+
+  // dyn_reg             ignored
+  // dyn_reg_eps         ignored
+  // dyn_reg_delta       ignored
+  // dyn_reg_refine_iter ignored
+
+  // kkt_system ignored
+  // kkt_stages ignored
 
   /* Update settings in the linear system solver */
   solver->work->linsys_solver->update_settings(solver->work->linsys_solver, settings);
@@ -1307,6 +1572,8 @@ OSQPInt osqp_codegen(OSQPSolver*         solver,
   OSQPInt exitflag = 0;
 
 #ifdef OSQP_CODEGEN
+  LinSysSolver* linsys;
+
   if (!solver || !solver->work || !solver->settings || !solver->info) {
     return osqp_error(OSQP_WORKSPACE_NOT_INIT_ERROR);
   }
@@ -1323,14 +1590,27 @@ OSQPInt osqp_codegen(OSQPSolver*         solver,
                     || (defines->printing_enable != 0  && defines->printing_enable != 1)
                     || (defines->profiling_enable != 0 && defines->profiling_enable != 1)
                     || (defines->interrupt_enable != 0 && defines->interrupt_enable != 1)
-                    || (defines->derivatives_enable != 0 && defines->derivatives_enable != 1)) {
+                    || (defines->derivatives_enable != 0 && defines->derivatives_enable != 1)
+                    || (defines->ldl_unroll_enable != 0  && defines->ldl_unroll_enable != 1)
+                    || (defines->spmv_unroll_enable != 0 && defines->spmv_unroll_enable != 1)
+                    || (defines->fixed_point_bits != 0   && defines->fixed_point_bits != 16
+                                                         && defines->fixed_point_bits != 32)
+                    || (defines->multi_instance_enable != 0 && defines->multi_instance_enable != 1)
+                    || (defines->multi_instance_enable == 1 && defines->embedded_mode != 1)
+                    || (defines->compact_index_enable != 0 && defines->compact_index_enable != 1)) {
     return osqp_error(OSQP_CODEGEN_DEFINES_ERROR);
   }
 
-  exitflag = codegen_inc(output_dir, file_prefix);
-  if (!exitflag) exitflag = codegen_src(output_dir, file_prefix, solver, defines->embedded_mode);
-  if (!exitflag) exitflag = codegen_example(output_dir, file_prefix);
+  /* The KKT matrix written out may be factored again here */
+  osqp_profiler_set_target(solver->work->profile);
+
+  exitflag = codegen_linsys_init(solver, &linsys);
+  if (!exitflag) exitflag = codegen_inc(output_dir, file_prefix, solver, defines);
+  if (!exitflag) exitflag = codegen_src(output_dir, file_prefix, solver, defines);
+  if (!exitflag && defines->fixed_point_bits) exitflag = codegen_fixed(output_dir, file_prefix, solver, defines);
+  if (!exitflag) exitflag = codegen_example(output_dir, file_prefix, defines);
   if (!exitflag) exitflag = codegen_defines(output_dir, defines);
+  codegen_linsys_restore(solver, linsys);
 #else
   OSQP_UnusedVar(solver);
   OSQP_UnusedVar(output_dir);
@@ -1373,6 +1653,9 @@ OSQPInt osqp_adjoint_derivative_compute(OSQPSolver* solver,
   OSQPInt status = 0;
 
 #ifdef OSQP_ENABLE_DERIVATIVES
+  if (solver && solver->work) {
+    osqp_profiler_set_target(solver->work->profile);
+  }
   status = adjoint_derivative_compute(solver, dx, dy, dy);
 #else
   OSQP_UnusedVar(solver);
@@ -1384,6 +1667,101 @@ OSQPInt osqp_adjoint_derivative_compute(OSQPSolver* solver,
   return status;
 }
 
+OSQPInt osqp_adjoint_derivative_compute_multi(OSQPSolver*      solver,
+                                              OSQPInt          nrhs,
+                                              const OSQPFloat* dx,
+                                              const OSQPFloat* dy,
+                                              OSQPFloat*       dq,
+                                              OSQPFloat*       dl,
+                                              OSQPFloat*       du,
+                                              OSQPCscMatrix*   dP,
+                                              OSQPCscMatrix*   dA) {
+  OSQPInt status = 0;
+
+#ifdef OSQP_ENABLE_DERIVATIVES
+  if (solver && solver->work) {
+    osqp_profiler_set_target(solver->work->profile);
+  }
+  status = adjoint_derivative_compute_multi(solver, nrhs, dx, dy, dq, dl, du, dP, dA);
+#else
+  OSQP_UnusedVar(solver);
+  OSQP_UnusedVar(nrhs);
+  OSQP_UnusedVar(dx);
+  OSQP_UnusedVar(dy);
+  OSQP_UnusedVar(dq);
+  OSQP_UnusedVar(dl);
+  OSQP_UnusedVar(du);
+  OSQP_UnusedVar(dP);
+  OSQP_UnusedVar(dA);
+  status = OSQP_FUNC_NOT_IMPLEMENTED;
+#endif
+
+  return status;
+}
+
+OSQPInt osqp_adjoint_derivative_compute_batch(OSQPSolver**     solvers,
+                                              OSQPInt          nsolvers,
+                                              const OSQPFloat* dx,
+                                              const OSQPFloat* dy) {
+  OSQPInt status = 0;
+
+#ifdef OSQP_ENABLE_DERIVATIVES
+  status = adjoint_derivative_compute_batch(solvers, nsolvers, dx, dy);
+#else
+  OSQP_UnusedVar(solvers);
+  OSQP_UnusedVar(nsolvers);
+  OSQP_UnusedVar(dx);
+  OSQP_UnusedVar(dy);
+  status = OSQP_FUNC_NOT_IMPLEMENTED;
+#endif
+
+  return status;
+}
+
+OSQPInt osqp_forward_derivative_compute(OSQPSolver*          solver,
+                                        const OSQPCscMatrix* dP,
+                                        const OSQPFloat*     dq,
+                                        const OSQPCscMatrix* dA,
+                                        const OSQPFloat*     dl,
+                                        const OSQPFloat*     du,
+                                        OSQPFloat*           dx,
+                                        OSQPFloat*           dy) {
+
+  return osqp_forward_derivative_compute_multi(solver, 1, dP, dq, dA, dl, du, dx, dy);
+}
+
+OSQPInt osqp_forward_derivative_compute_multi(OSQPSolver*          solver,
+                                              OSQPInt              ndir,
+                                              const OSQPCscMatrix* dP,
+                                              const OSQPFloat*     dq,
+                                              const OSQPCscMatrix* dA,
+                                              const OSQPFloat*     dl,
+                                              const OSQPFloat*     du,
+                                              OSQPFloat*           dx,
+                                              OSQPFloat*           dy) {
+  OSQPInt status = 0;
+
+#ifdef OSQP_ENABLE_DERIVATIVES
+  if (solver && solver->work) {
+    osqp_profiler_set_target(solver->work->profile);
+  }
+  status = forward_derivative_compute_multi(solver, ndir, dP, dq, dA, dl, du, dx, dy);
+#else
+  OSQP_UnusedVar(solver);
+  OSQP_UnusedVar(ndir);
+  OSQP_UnusedVar(dP);
+  OSQP_UnusedVar(dq);
+  OSQP_UnusedVar(dA);
+  OSQP_UnusedVar(dl);
+  OSQP_UnusedVar(du);
+  OSQP_UnusedVar(dx);
+  OSQP_UnusedVar(dy);
+  status = OSQP_FUNC_NOT_IMPLEMENTED;
+#endif
+
+  return status;
+}
+
 OSQPInt osqp_adjoint_derivative_get_mat(OSQPSolver*    solver,
                                         OSQPCscMatrix* dP,
                                         OSQPCscMatrix* dA) {
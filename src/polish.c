@@ -7,6 +7,49 @@
 #include "error.h"
 #include "timing.h"
 
+/**
+ * Guess which linear constraints are lower-active, upper-active and free
+ * from the primal and dual iterates returned by the ADMM.
+ *
+ *    active_flags is -1/0/1 to indicate  lower/ inactive / upper.
+ *    equality constraints are treated as lower active
+ *
+ * @param  active_flags Output flags (length m)
+ * @param  z            Primal iterate z
+ * @param  y            Dual iterate y
+ * @param  l            Lower bound
+ * @param  u            Upper bound
+ * @param  m            Number of constraints
+ * @return              Number of active constraints
+ */
+static OSQPInt guess_active_set(OSQPInt*         active_flags,
+                                const OSQPFloat* z,
+                                const OSQPFloat* y,
+                                const OSQPFloat* l,
+                                const OSQPFloat* u,
+                                OSQPInt          m) {
+
+  OSQPInt j;
+  OSQPInt n_active = 0;
+
+  for (j = 0; j < m; j++) {
+
+    if ((z[j] - l[j] < -y[j]) || (l[j] == u[j]) ) { // lower-active or equality
+      active_flags[j] = -1;
+      n_active++;
+    }
+    else if (u[j] - z[j] < y[j]) { // upper-active
+      active_flags[j] = +1;
+      n_active++;
+    }
+    else{
+      active_flags[j] = 0;
+    }
+  }
+
+  return n_active;
+}
+
 /**
  * Form reduced matrix A that contains only rows that are active at the
  * solution.
@@ -18,7 +61,7 @@
  */
 static OSQPInt form_Ared(OSQPWorkspace* work){
 
-  OSQPInt j, n_active;
+  OSQPInt n_active;
   OSQPInt m = work->data->m;
 
   OSQPInt* active_flags = OSQP_NULL;
@@ -52,31 +95,8 @@ static OSQPInt form_Ared(OSQPWorkspace* work){
   OSQPVectorf_to_raw(l, work->data->l);
   OSQPVectorf_to_raw(u, work->data->u);
 
-  // Initialize counters for active constraints
-  n_active = 0;
-
-  /* Guess which linear constraints are lower-active, upper-active and free
-   *
-   *    active_flags is -1/0/1 to indicate  lower/ inactive / upper.
-   *    equality constraints are treated as lower active
-   *
-   *    Ared is formed by selecting all of the active rows.
-   */
-
-  for (j = 0; j < work->data->m; j++) {
-
-    if ((z[j] - l[j] < -y[j]) || (l[j] == u[j]) ) { // lower-active or equality
-      active_flags[j] = -1;
-      n_active++;
-    }
-    else if (u[j] - z[j] < y[j]) { // upper-active
-      active_flags[j] = +1;
-      n_active++;
-    }
-    else{
-      active_flags[j] = 0;
-    }
-  }
+  // Guess the active constraints; Ared is formed by selecting all active rows
+  n_active = guess_active_set(active_flags, z, y, l, u, m);
 
   // Copy raw vector into OSQPVectori structure
   OSQPVectori_from_raw(work->pol->active_flags, active_flags);
@@ -314,9 +334,16 @@ static OSQPInt get_ypol_from_yred(OSQPWorkspace* work, OSQPVectorf* yred_vf) {
   return OSQP_NO_ERROR;
 }
 
-OSQPInt polish(OSQPSolver* solver) {
+/**
+ * Form and solve the reduced KKT system for the guessed active set.
+ * The polished solution and its residuals are stored in work->pol.
+ * @param  solver OSQP solver
+ * @param  early  Boolean (if called before the ADMM has converged)
+ * @return        Exitflag
+ */
+static OSQPInt polish_solve(OSQPSolver* solver,
+                            OSQPInt     early) {
 
-  OSQPInt polish_successful = 0;
   OSQPInt exitflag = 0;
 
   LinSysSolver* plsh = OSQP_NULL;
@@ -330,7 +357,11 @@ OSQPInt polish(OSQPSolver* solver) {
   OSQPWorkspace* work     = solver->work;
 
 #ifdef OSQP_ENABLE_PROFILING
-  osqp_tic(work->timer); // Start timer
+  OSQPFloat polish_start = 0.0;
+
+  // The solve timer is still running when polishing early
+  if (early) polish_start = osqp_toc(work->timer);
+  else       osqp_tic(work->timer); // Start timer
 #endif /* ifdef OSQP_ENABLE_PROFILING */
 
   // Form Ared by assuming the active constraints and store in work->pol->Ared
@@ -342,7 +373,8 @@ OSQPInt polish(OSQPSolver* solver) {
     return exitflag;
   } else if (work->pol->n_active == 0) {
     /* No active constraints, so skip polishing */
-    c_print("Polishing not needed - no active set detected at optimal point\n");
+    if (!early)
+      c_print("Polishing not needed - no active set detected at optimal point\n");
     info->status_polish = OSQP_POLISH_NO_ACTIVE_SET_FOUND;
 
     /* Memory clean-up */
@@ -458,6 +490,63 @@ OSQPInt polish(OSQPSolver* solver) {
   // Compute primal and dual residuals at the polished solution
   update_info(solver, 0, 1, 1);
 
+#ifdef OSQP_ENABLE_PROFILING
+  if (early) info->polish_time -= polish_start;
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+
+  // Memory clean-up
+  plsh->free(plsh);
+
+  // Checks that they are not NULL are already performed earlier
+  OSQPMatrix_free(work->pol->Ared);
+  OSQPVectorf_free(rhs_red);
+  OSQPVectorf_free(pol_sol);
+  OSQPVectorf_view_free(pol_sol_xview);
+  OSQPVectorf_view_free(pol_sol_yview);
+
+  return OSQP_NO_ERROR;
+}
+
+/**
+ * Replace the ADMM iterates with the polished solution
+ * @param solver OSQP solver
+ */
+static void polish_accept(OSQPSolver* solver) {
+
+  OSQPInfo*      info = solver->info;
+  OSQPWorkspace* work = solver->work;
+
+  // Update solver information
+  info->obj_val       = work->pol->obj_val;
+  info->prim_res      = work->pol->prim_res;
+  info->dual_res      = work->pol->dual_res;
+  info->status_polish = OSQP_POLISH_SUCCESS;
+
+  // Update (x, z, y) in ADMM iterations
+  // NB: z needed for warm starting
+  OSQPVectorf_copy(work->x, work->pol->x);
+  OSQPVectorf_copy(work->z, work->pol->z);
+  OSQPVectorf_copy(work->y, work->pol->y);
+
+  // Print summary
+#ifdef OSQP_ENABLE_PRINTING
+
+  if (solver->settings->verbose) print_polish(solver);
+#endif /* ifdef OSQP_ENABLE_PRINTING */
+}
+
+OSQPInt polish(OSQPSolver* solver) {
+
+  OSQPInt polish_successful = 0;
+  OSQPInt exitflag = 0;
+
+  OSQPInfo*      info = solver->info;
+  OSQPWorkspace* work = solver->work;
+
+  exitflag = polish_solve(solver, 0);
+
+  if (exitflag || work->pol->n_active == 0) return exitflag;
+
   // Check if polish was successful
   polish_successful = (work->pol->prim_res < info->prim_res &&
                        work->pol->dual_res < info->dual_res) || // Residuals
@@ -475,23 +564,7 @@ OSQPInt polish(OSQPSolver* solver) {
                                                                     // tiny
 
   if (polish_successful) {
-    // Update solver information
-    info->obj_val       = work->pol->obj_val;
-    info->prim_res      = work->pol->prim_res;
-    info->dual_res      = work->pol->dual_res;
-    info->status_polish = OSQP_POLISH_SUCCESS;
-
-    // Update (x, z, y) in ADMM iterations
-    // NB: z needed for warm starting
-    OSQPVectorf_copy(work->x, work->pol->x);
-    OSQPVectorf_copy(work->z, work->pol->z);
-    OSQPVectorf_copy(work->y, work->pol->y);
-
-    // Print summary
-#ifdef OSQP_ENABLE_PRINTING
-
-    if (settings->verbose) print_polish(solver);
-#endif /* ifdef OSQP_ENABLE_PRINTING */
+    polish_accept(solver);
   } else { // Polishing failed
     info->status_polish = OSQP_POLISH_FAILED;
 
@@ -499,15 +572,94 @@ OSQPInt polish(OSQPSolver* solver) {
     //       and polished solution
   }
 
-  // Memory clean-up
-  plsh->free(plsh);
+  return OSQP_NO_ERROR;
+}
 
-  // Checks that they are not NULL are already performed earlier
-  OSQPMatrix_free(work->pol->Ared);
-  OSQPVectorf_free(rhs_red);
-  OSQPVectorf_free(pol_sol);
-  OSQPVectorf_view_free(pol_sol_xview);
-  OSQPVectorf_view_free(pol_sol_yview);
+OSQPInt polish_early_init(OSQPSolver* solver) {
+
+  OSQPInt        m   = solver->work->data->m;
+  OSQPPolish*    pol = solver->work->pol;
+
+  if (solver->settings->polish_early_checks <= 0 || pol->early_flags) return OSQP_NO_ERROR;
+
+  pol->early_flags = (OSQPInt *) c_malloc(2 * m * sizeof(OSQPInt));
+  pol->early_zylu  = (OSQPFloat *) c_malloc(4 * m * sizeof(OSQPFloat));
+
+  /* Handle memory allocation errors */
+  if (m && (!pol->early_flags || !pol->early_zylu)) {
+    c_free(pol->early_flags);
+    c_free(pol->early_zylu);
+    pol->early_flags = OSQP_NULL;
+    pol->early_zylu  = OSQP_NULL;
+
+    return osqp_error(OSQP_MEM_ALLOC_ERROR);
+  }
+
+  return OSQP_NO_ERROR;
+}
+
+void polish_update_active_set(OSQPSolver* solver) {
+
+  OSQPInt j, changed;
+  OSQPInt m = solver->work->data->m;
+
+  OSQPWorkspace* work = solver->work;
+
+  // Workspace allocated by polish_early_init
+  OSQPInt*   active_flags      = work->pol->early_flags;
+  OSQPInt*   active_flags_prev = work->pol->early_flags + m;
+  OSQPFloat* z = work->pol->early_zylu;
+  OSQPFloat* y = work->pol->early_zylu + m;
+  OSQPFloat* l = work->pol->early_zylu + 2 * m;
+  OSQPFloat* u = work->pol->early_zylu + 3 * m;
+
+  // Copy data to raw arrays
+  OSQPVectori_to_raw(active_flags_prev, work->pol->active_flags);
+  OSQPVectorf_to_raw(z, work->z);
+  OSQPVectorf_to_raw(y, work->y);
+  OSQPVectorf_to_raw(l, work->data->l);
+  OSQPVectorf_to_raw(u, work->data->u);
+
+  work->pol->n_active = guess_active_set(active_flags, z, y, l, u, m);
+
+  // Compare against the guess from the previous termination check
+  // NB: n_stable is zero at the first check, so the stale flags are ignored
+  changed = (work->pol->n_stable == 0);
+  for (j = 0; j < m && !changed; j++) {
+    changed = (active_flags[j] != active_flags_prev[j]);
+  }
+
+  if (changed) {
+    OSQPVectori_from_raw(work->pol->active_flags, active_flags);
+    work->pol->n_stable = 1;
+  } else {
+    work->pol->n_stable++;
+  }
+}
+
+OSQPInt polish_early(OSQPSolver* solver) {
+
+  OSQPInt exitflag = 0;
+
+  OSQPInfo*      info = solver->info;
+  OSQPWorkspace* work = solver->work;
+
+  exitflag = polish_solve(solver, 1);
+
+  // Only running out of memory stops the solve. Any other failure means the
+  // guessed active set was wrong, which is handled like an inaccurate polish.
+  if (exitflag == OSQP_MEM_ALLOC_ERROR) return exitflag;
+
+  // Accept only if the polished point meets the termination tolerances
+  if (!exitflag && work->pol->n_active > 0 && check_polish_termination(solver)) {
+    polish_accept(solver);
+  } else {
+    // Keep iterating; the ADMM iterates are left untouched
+    info->status_polish = OSQP_POLISH_NOT_PERFORMED;
+#ifdef OSQP_ENABLE_PROFILING
+    info->polish_time = 0.0;
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+  }
 
   return OSQP_NO_ERROR;
 }
@@ -0,0 +1,113 @@
+/*
+ * Builtin profiler that accumulates the time, call count and memory traffic
+ * of every section into counters owned by the solver.
+ */
+#include "types.h"
+#include "timing.h"
+#include "profilers.h"
+#include "util.h"
+
+/* The counters are selected per thread so solvers on different threads don't mix */
+#if defined(_MSC_VER)
+#  define OSQP_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#  define OSQP_THREAD_LOCAL __thread
+#else
+#  define OSQP_THREAD_LOCAL _Thread_local
+#endif
+
+static OSQP_THREAD_LOCAL OSQPProfilerData* s_osqp_profiler_target = OSQP_NULL;
+
+
+OSQPProfilerData* _osqp_profiler_data_new(void) {
+    OSQPInt i;
+    OSQPProfilerData* data = c_calloc(1, sizeof(OSQPProfilerData));
+
+    if (!data)
+        return OSQP_NULL;
+
+    for(i=0; i < OSQP_PROFILER_SEC_ARRAY_LAST; i++) {
+        data->timers[i] = OSQPTimer_new();
+
+        if (!data->timers[i]) {
+            _osqp_profiler_data_free(data);
+            return OSQP_NULL;
+        }
+    }
+
+    return data;
+}
+
+
+void _osqp_profiler_data_free(OSQPProfilerData* data) {
+    OSQPInt i;
+
+    if (!data)
+        return;
+
+    // Only the calling thread can be stopped, see _osqp_profiler_set_target
+    if (s_osqp_profiler_target == data)
+        s_osqp_profiler_target = OSQP_NULL;
+
+    for(i=0; i < OSQP_PROFILER_SEC_ARRAY_LAST; i++) {
+        OSQPTimer_free(data->timers[i]);
+    }
+
+    c_free(data);
+}
+
+
+void _osqp_profiler_set_target(OSQPProfilerData* data) {
+    s_osqp_profiler_target = data;
+}
+
+
+void _osqp_profiler_init(int level) {
+    if (s_osqp_profiler_target)
+        s_osqp_profiler_target->level = level;
+}
+
+
+void _osqp_profiler_update_level(int level) {
+    if (s_osqp_profiler_target)
+        s_osqp_profiler_target->level = level;
+}
+
+
+void _osqp_profiler_sec_push(OSQPProfilerSection section) {
+    OSQPProfilerData* data = s_osqp_profiler_target;
+
+    // Don't count a section that isn't enabled
+    if (!data || osqp_profiler_sections[section].level > data->level)
+        return;
+
+    osqp_tic(data->timers[section]);
+}
+
+
+void _osqp_profiler_sec_pop(OSQPProfilerSection section) {
+    OSQPProfilerData* data = s_osqp_profiler_target;
+
+    // Don't count a section that isn't enabled
+    if (!data || osqp_profiler_sections[section].level > data->level)
+        return;
+
+    data->time[section] += osqp_toc(data->timers[section]);
+    data->calls[section]++;
+}
+
+
+void _osqp_profiler_sec_bytes(OSQPProfilerSection section, OSQPFloat bytes) {
+    OSQPProfilerData* data = s_osqp_profiler_target;
+
+    if (!data || osqp_profiler_sections[section].level > data->level)
+        return;
+
+    data->bytes[section] += bytes;
+}
+
+
+void _osqp_profiler_event_mark(OSQPProfilerEvent event) {
+    // Events are not counted by the builtin profiler
+    OSQP_UnusedVar(event);
+}
@@ -0,0 +1,180 @@
+#include <stdio.h>
+
+#include "trace.h"
+#include "osqp_api_constants.h"
+#include "printing.h"
+#include "timing.h"
+#include "profilers.h"
+
+/* Header line of the CSV export */
+static const char trace_csv_header[] = "iter,prim_res,dual_res,rho,linsys_time,n_active\n";
+
+
+OSQPInt trace_init(OSQPSolver* solver) {
+
+  OSQPTrace*     trace;
+  OSQPWorkspace* work = solver->work;
+
+  if (solver->settings->trace_size == 0) return 0;
+
+  trace = c_calloc(1, sizeof(OSQPTrace));
+  if (!trace) return 1;
+  work->trace = trace;
+
+  trace->size    = solver->settings->trace_size;
+  trace->records = c_calloc(trace->size, sizeof(OSQPTraceRecord));
+  if (!trace->records) return 1;
+
+#ifdef OSQP_ENABLE_PROFILING
+  trace->timer = OSQPTimer_new();
+  if (!trace->timer) return 1;
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+
+  return 0;
+}
+
+
+void trace_free(OSQPTrace* trace) {
+
+  if (!trace) return;
+
+#ifdef OSQP_ENABLE_PROFILING
+  if (trace->timer) OSQPTimer_free(trace->timer);
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+
+  c_free(trace->records);
+  c_free(trace);
+}
+
+
+void trace_reset(OSQPSolver* solver) {
+
+  OSQPTrace* trace = solver->work->trace;
+
+  trace->count     = 0;
+  trace->last_iter = 0;
+
+#ifdef OSQP_ENABLE_PROFILING
+  trace->linsys_time = 0.0;
+  trace->use_profile = 0;
+# ifdef OSQP_PROFILER_BUILTIN
+  // The profiler already times every KKT solve when it counts that section
+  if (solver->work->profile &&
+      osqp_profiler_sections[OSQP_PROFILER_SEC_ADMM_KKT_SOLVE].level <= solver->work->profile->level) {
+    trace->use_profile = 1;
+    trace->kkt_time    = solver->work->profile->time[OSQP_PROFILER_SEC_ADMM_KKT_SOLVE];
+  }
+# endif /* ifdef OSQP_PROFILER_BUILTIN */
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+}
+
+
+void trace_record(OSQPSolver* solver,
+                  OSQPInt     iter) {
+
+  OSQPWorkspace*   work  = solver->work;
+  OSQPTrace*       trace = work->trace;
+  OSQPTraceRecord* rec   = &trace->records[trace->count % trace->size];
+
+  rec->iter        = iter;
+  rec->prim_res    = solver->info->prim_res;
+  rec->dual_res    = solver->info->dual_res;
+  rec->rho         = solver->settings->rho;
+  rec->linsys_time = 0.0;
+  rec->n_active    = OSQPVectorf_count_at_bounds(work->z, work->data->l, work->data->u);
+
+#ifdef OSQP_ENABLE_PROFILING
+  if (!trace->use_profile) {
+    // Only the solve before the record is timed, the others are assumed to take as long
+    rec->linsys_time = trace->linsys_time * (iter - trace->last_iter);
+  }
+# ifdef OSQP_PROFILER_BUILTIN
+  else {
+    rec->linsys_time = work->profile->time[OSQP_PROFILER_SEC_ADMM_KKT_SOLVE] - trace->kkt_time;
+    trace->kkt_time  = work->profile->time[OSQP_PROFILER_SEC_ADMM_KKT_SOLVE];
+  }
+# endif /* ifdef OSQP_PROFILER_BUILTIN */
+#endif /* ifdef OSQP_ENABLE_PROFILING */
+
+  trace->count++;
+  trace->last_iter = iter;
+}
+
+
+/* Write a record as a CSV line (only compute its length if buf is OSQP_NULL) */
+static OSQPInt trace_csv_line(char*                  buf,
+                              size_t                 len,
+                              const OSQPTraceRecord* rec) {
+
+  return (OSQPInt)snprintf(buf, len, "%" OSQP_INT_FMT ",%.9e,%.9e,%.9e,%.9e,%" OSQP_INT_FMT "\n",
+                           rec->iter, rec->prim_res, rec->dual_res, rec->rho,
+                           rec->linsys_time, rec->n_active);
+}
+
+
+OSQPInt trace_export(const OSQPSolver* solver,
+                     OSQPInt           format,
+                     void*             buffer,
+                     OSQPInt*          size) {
+
+  OSQPInt i, first, n_rec, needed;
+  char*   out;
+
+  const OSQPTrace*       trace = solver->work->trace;
+  const OSQPTraceRecord* rec;
+
+  // Only the last trace->size records of the solve are kept
+  n_rec = 0;
+  first = 0;
+  if (trace) {
+    n_rec = c_min(trace->count, trace->size);
+    first = trace->count - n_rec;
+  }
+
+  // Size of the export
+  if (format == OSQP_TRACE_BINARY) {
+    needed = n_rec * (OSQPInt)sizeof(OSQPTraceRecord);
+  }
+  else if (format == OSQP_TRACE_CSV) {
+    // Header, lines and the terminating null
+    needed = (OSQPInt)sizeof(trace_csv_header);
+    for (i = 0; i < n_rec; i++) {
+      needed += trace_csv_line(OSQP_NULL, 0, &trace->records[(first + i) % trace->size]);
+    }
+  }
+  else {
+    c_eprint("unknown trace format");
+    return 1;
+  }
+
+  if (!buffer) {
+    *size = needed;
+    return 0;
+  }
+
+  if (*size < needed) {
+    c_eprint("buffer too small for the trace (%i bytes needed)", (int)needed);
+    *size = needed;
+    return 1;
+  }
+
+  out = (char*)buffer;
+  if (format == OSQP_TRACE_BINARY) {
+    for (i = 0; i < n_rec; i++) {
+      ((OSQPTraceRecord*)buffer)[i] = trace->records[(first + i) % trace->size];
+    }
+  }
+  else {
+    // Each line is written with a terminating null, which the next line overwrites
+    for (i = 0; i < (OSQPInt)sizeof(trace_csv_header); i++) out[i] = trace_csv_header[i];
+    out += sizeof(trace_csv_header) - 1;
+
+    for (i = 0; i < n_rec; i++) {
+      rec  = &trace->records[(first + i) % trace->size];
+      out += trace_csv_line(out, (size_t)(needed - (out - (char*)buffer)), rec);
+    }
+  }
+
+  *size = needed;
+  return 0;
+}
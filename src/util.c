@@ -308,6 +308,22 @@ OSQPSettings* copy_settings(const OSQPSettings *settings) {
 
   new->delta              = settings->delta;
   new->polish_refine_iter = settings->polish_refine_iter;
+  new->polish_early_checks = settings->polish_early_checks;
+
+  new->trace_size         = settings->trace_size;
+
+  new->kkt_ordering    = settings->kkt_ordering;
+  new->amd_dense       = settings->amd_dense;
+  new->amd_aggressive  = settings->amd_aggressive;
+  new->kkt_permutation = settings->kkt_permutation;
+
+  new->dyn_reg             = settings->dyn_reg;
+  new->dyn_reg_eps         = settings->dyn_reg_eps;
+  new->dyn_reg_delta       = settings->dyn_reg_delta;
+  new->dyn_reg_refine_iter = settings->dyn_reg_refine_iter;
+
+  new->kkt_system = settings->kkt_system;
+  new->kkt_stages = settings->kkt_stages;
 
   return new;
 }
@@ -67,3 +67,126 @@ TEST_CASE_METHOD(basic_lp_test_fixture, "Basic LP", "[solve][lp]")
   mu_assert("Basic LP test solve: Error in polish status!",
             solver->info->status_polish == expectedPolishStatus);
 }
+
+TEST_CASE_METHOD(basic_lp_test_fixture, "Basic LP: Early polishing", "[solve][lp][polish]")
+{
+  OSQPInt exitflag;
+  OSQPInt iter_no_early;
+
+  settings->polishing = 1;
+  settings->polish_refine_iter = 4;
+  settings->warm_starting = 0;
+
+  // Check often enough for the active set to settle before convergence
+  settings->check_termination = 5;
+
+  // Setup solver
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  // Setup correct
+  mu_assert("Basic LP test early polish: Setup error!", exitflag == 0);
+
+  // Reference solve without early polishing
+  osqp_solve(solver.get());
+  iter_no_early = solver->info->iter;
+
+  // Try polishing once the active set is unchanged for two checks
+  settings->polish_early_checks = 2;
+  exitflag = osqp_update_settings(solver.get(), settings.get());
+  mu_assert("Basic LP test early polish: Error updating settings!", exitflag == 0);
+
+  osqp_solve(solver.get());
+
+  // Compare solver statuses
+  mu_assert("Basic LP test early polish: Error in solver status!",
+      solver->info->status_val == sols_data->status_test);
+
+  // Check polishing status
+  mu_assert("Basic LP test early polish: Error in polish status!",
+            solver->info->status_polish == OSQP_POLISH_SUCCESS);
+
+  // Early polishing stops the iterations before ADMM converges on its own
+  mu_assert("Basic LP test early polish: Error in number of iterations!",
+            solver->info->iter < iter_no_early);
+
+  // Compare objective values
+  mu_assert("Basic LP test early polish: Error in objective value!",
+      c_absval(solver->info->obj_val - sols_data->obj_value_test) <
+      TESTS_TOL);
+
+  // Compare primal solutions
+  mu_assert("Basic LP test early polish: Error in primal solution!",
+      vec_norm_inf_diff(solver->solution->x, sols_data->x_test,
+            data->n) < TESTS_TOL);
+
+  // Compare dual solutions
+  mu_assert("Basic LP test early polish: Error in dual solution!",
+      vec_norm_inf_diff(solver->solution->y, sols_data->y_test,
+            data->m) < TESTS_TOL);
+
+  // Negative number of checks is not allowed
+  settings->polish_early_checks = -1;
+  exitflag = osqp_update_settings(solver.get(), settings.get());
+  mu_assert("Basic LP test early polish: Wrong value of polish_early_checks not caught!",
+            exitflag == OSQP_SETTINGS_VALIDATION_ERROR);
+}
+
+TEST_CASE_METHOD(basic_lp_test_fixture, "Basic LP: Failed early polishing", "[solve][lp][polish]")
+{
+  OSQPInt exitflag;
+  OSQPInt exitflag_no_early;
+  OSQPInt iter_no_early;
+
+  settings->polishing = 1;
+  settings->polish_refine_iter = 4;
+  settings->warm_starting = 0;
+  settings->check_termination = 5;
+
+  // Setup solver
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  // Setup correct
+  mu_assert("Basic LP test failed early polish: Setup error!", exitflag == 0);
+
+  // Make every polishing factorization fail. The ADMM factorization keeps the
+  // values it was set up with, but the polish replaces every pivot by zero and
+  // reports a nonconvex KKT matrix.
+  solver->settings->dyn_reg       = 1;
+  solver->settings->dyn_reg_eps   = OSQP_INFTY;
+  solver->settings->dyn_reg_delta = 0.0;
+
+  // Reference solve without early polishing, where the final polish fails
+  exitflag_no_early = osqp_solve(solver.get());
+  iter_no_early     = solver->info->iter;
+
+  mu_assert("Basic LP test failed early polish: Error in reference solver status!",
+      solver->info->status_val == sols_data->status_test);
+
+  // Try polishing once the active set is unchanged for two checks
+  settings->polish_early_checks = 2;
+  exitflag = osqp_update_settings(solver.get(), settings.get());
+  mu_assert("Basic LP test failed early polish: Error updating settings!", exitflag == 0);
+
+  solver->settings->dyn_reg       = 1;
+  solver->settings->dyn_reg_eps   = OSQP_INFTY;
+  solver->settings->dyn_reg_delta = 0.0;
+
+  exitflag = osqp_solve(solver.get());
+
+  // The failed early polishes do not stop or change the ADMM iterations, and
+  // only the final polish is reported
+  mu_assert("Basic LP test failed early polish: Error in exit flag!",
+            exitflag == exitflag_no_early);
+
+  mu_assert("Basic LP test failed early polish: Error in solver status!",
+      solver->info->status_val == sols_data->status_test);
+
+  mu_assert("Basic LP test failed early polish: Error in number of iterations!",
+            solver->info->iter == iter_no_early);
+}
@@ -1,4 +1,6 @@
 #include <catch2/catch.hpp>
+#include <cstring>
+#include <vector>
 
 #include "osqp_api.h"    /* OSQP API wrapper (public + some private) */
 #include "osqp_tester.h" /* Tester helpers */
@@ -991,3 +993,544 @@ TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: Warm start", "[solve][qp][war
     mu_assert("Basic QP test warm start: Warm start error!", solver->info->iter == 1);
   }
 }
+
+TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: Profile", "[solve][qp]")
+{
+  OSQPInt exitflag;
+  OSQPInt n_iter;
+  OSQPInt n_sec = 32;
+  OSQPProfileSection sections[32];
+
+  // Count every profiler section
+  settings->profiler_level = 2;
+
+  // Setup solver
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  // Setup correct
+  mu_assert("Basic QP test profile: Setup error!", exitflag == 0);
+
+  // Solve the problem twice, the counters cover both solves
+  osqp_solve(solver.get());
+  n_iter = solver->info->iter;
+
+  osqp_cold_start(solver.get());
+  osqp_solve(solver.get());
+  n_iter += solver->info->iter;
+
+  exitflag = osqp_get_profile(solver.get(), sections, &n_sec);
+
+#ifdef OSQP_PROFILER_BUILTIN
+  mu_assert("Basic QP test profile: Error getting the profile!", exitflag == 0);
+  mu_assert("Basic QP test profile: Wrong number of sections!",
+            n_sec == OSQP_PROFILER_SEC_ARRAY_LAST);
+
+  mu_assert("Basic QP test profile: Setup not counted!",
+            sections[OSQP_PROFILER_SEC_SETUP].calls == 1);
+  mu_assert("Basic QP test profile: Solves not counted!",
+            sections[OSQP_PROFILER_SEC_OPT_SOLVE].calls == 2);
+  mu_assert("Basic QP test profile: Iterations not counted!",
+            sections[OSQP_PROFILER_SEC_ADMM_ITER].calls == n_iter);
+  mu_assert("Basic QP test profile: Backsolves not counted!",
+            sections[OSQP_PROFILER_SEC_LINSYS_BACKSOLVE].calls >= n_iter);
+  mu_assert("Basic QP test profile: Memory traffic not estimated!",
+            sections[OSQP_PROFILER_SEC_LINSYS_BACKSOLVE].bytes > 0.0);
+  mu_assert("Basic QP test profile: Time not accumulated!",
+            sections[OSQP_PROFILER_SEC_OPT_SOLVE].time >= sections[OSQP_PROFILER_SEC_ADMM_ITER].time);
+#else
+  mu_assert("Basic QP test profile: Profile available without the builtin profiler!",
+            exitflag == OSQP_FUNC_NOT_IMPLEMENTED);
+#endif
+}
+
+TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: Convergence trace", "[solve][qp]")
+{
+  OSQPInt exitflag;
+  OSQPInt size;
+
+  // Keep the last 4 termination checks
+  settings->trace_size        = 4;
+  settings->check_termination = 5;
+  settings->polishing         = 0;
+  settings->eps_abs           = 1e-6;
+  settings->eps_rel           = 1e-6;
+
+  // Setup solver
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  // Setup correct
+  mu_assert("Basic QP test trace: Setup error!", exitflag == 0);
+
+  // Solve Problem
+  osqp_solve(solver.get());
+
+  mu_assert("Basic QP test trace: Too few checks to fill the trace!",
+            solver->info->iter >= 4 * settings->check_termination);
+
+  SECTION( "Binary export" ) {
+    OSQPTraceRecord records[4];
+
+    // Query the size
+    exitflag = osqp_get_trace(solver.get(), OSQP_TRACE_BINARY, OSQP_NULL, &size);
+    mu_assert("Basic QP test trace: Error querying the size!", exitflag == 0);
+    mu_assert("Basic QP test trace: Wrong binary size!", size == (OSQPInt)sizeof(records));
+
+    exitflag = osqp_get_trace(solver.get(), OSQP_TRACE_BINARY, records, &size);
+    mu_assert("Basic QP test trace: Error exporting the trace!", exitflag == 0);
+
+    // Last record is the final termination check, the ones before are one check apart
+    mu_assert("Basic QP test trace: Wrong last record!",
+              records[3].iter == solver->info->iter);
+    mu_assert("Basic QP test trace: Wrong residuals in last record!",
+              (records[3].prim_res == solver->info->prim_res &&
+               records[3].dual_res == solver->info->dual_res));
+
+    for (int i = 0; i < 3; i++) {
+      mu_assert("Basic QP test trace: Records out of order!",
+                records[i+1].iter - records[i].iter == settings->check_termination);
+      mu_assert("Basic QP test trace: Wrong active set size!",
+                (records[i].n_active >= 0 && records[i].n_active <= data->m));
+      mu_assert("Basic QP test trace: Negative linear system time!",
+                records[i].linsys_time >= 0.0);
+    }
+  }
+
+  SECTION( "CSV export" ) {
+    exitflag = osqp_get_trace(solver.get(), OSQP_TRACE_CSV, OSQP_NULL, &size);
+    mu_assert("Basic QP test trace: Error querying the size!", exitflag == 0);
+
+    std::unique_ptr<char[]> csv(new char[size]);
+
+    // A buffer that is too small is rejected
+    OSQPInt small = size - 1;
+    exitflag = osqp_get_trace(solver.get(), OSQP_TRACE_CSV, csv.get(), &small);
+    mu_assert("Basic QP test trace: Small buffer accepted!", exitflag != 0);
+
+    exitflag = osqp_get_trace(solver.get(), OSQP_TRACE_CSV, csv.get(), &size);
+    mu_assert("Basic QP test trace: Error exporting the trace!", exitflag == 0);
+    mu_assert("Basic QP test trace: CSV not null-terminated!",
+              (OSQPInt)strlen(csv.get()) == size - 1);
+
+    // Header and one line per record
+    OSQPInt lines = 0;
+    for (OSQPInt i = 0; i < size - 1; i++)
+      lines += (csv[i] == '\n');
+
+    mu_assert("Basic QP test trace: Wrong number of lines!", lines == 5);
+  }
+}
+
+TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: KKT ordering", "[solve][qp]")
+{
+  OSQPInt exitflag;
+  OSQPInt dim = data->n + data->m;
+
+  // Orderings only apply to the direct solver
+  if (!isLinsysSupported(OSQP_DIRECT_SOLVER))
+    return;
+
+  std::unique_ptr<OSQPInt[]> perm(new OSQPInt[dim]);
+
+  // Reversed KKT rows
+  for (OSQPInt i = 0; i < dim; i++)
+    perm[i] = dim - 1 - i;
+
+  settings->linsys_solver = OSQP_DIRECT_SOLVER;
+  settings->kkt_system    = OSQP_KKT_SYSTEM_FULL;
+  settings->polishing     = 1;
+  settings->scaling       = 0;
+  settings->warm_starting = 0;
+
+  SECTION( "Missing permutation" ) {
+    settings->kkt_ordering = OSQP_ORDERING_USER;
+
+    exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                          data->A, data->l, data->u,
+                          data->m, data->n, settings.get());
+    solver.reset(tmpSolver);
+
+    mu_assert("Basic QP test ordering: Setup should fail without a permutation!",
+              exitflag == OSQP_SETTINGS_VALIDATION_ERROR);
+  }
+
+  SECTION( "Solve" ) {
+    settings->kkt_ordering = GENERATE(OSQP_ORDERING_AMD, OSQP_ORDERING_NESDIS, OSQP_ORDERING_USER, OSQP_ORDERING_AUTO);
+    settings->kkt_permutation = perm.get();
+
+    CAPTURE(settings->kkt_ordering);
+
+    exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                          data->A, data->l, data->u,
+                          data->m, data->n, settings.get());
+    solver.reset(tmpSolver);
+
+    mu_assert("Basic QP test ordering: Setup error!", exitflag == 0);
+
+    // The factor holds at least the strictly lower part of the KKT matrix
+    mu_assert("Basic QP test ordering: Factor size not reported!",
+              solver->info->factor_nnz > 0);
+
+    osqp_solve(solver.get());
+
+    mu_assert("Basic QP test ordering: Error in solver status!",
+        solver->info->status_val == sols_data->status_test);
+
+    mu_assert("Basic QP test ordering: Error in primal solution!",
+        vec_norm_inf_diff(solver->solution->x, sols_data->x_test,
+              data->n) < TESTS_TOL);
+
+    mu_assert("Basic QP test ordering: Error in dual solution!",
+        vec_norm_inf_diff(solver->solution->y, sols_data->y_test,
+              data->m) < TESTS_TOL);
+  }
+}
+
+TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: KKT system", "[solve][qp]")
+{
+  OSQPInt exitflag;
+
+  /* x0 in the first stage and x1 in the second, with the coupling constraint
+   * x0 + x1 in the second stage and the bounds in the stage of their variable */
+  OSQPInt stages[6] = { 0, 1, 1, 0, 1, 1, };
+
+  // The KKT system choice only applies to the direct solver
+  if (!isLinsysSupported(OSQP_DIRECT_SOLVER))
+    return;
+
+  settings->linsys_solver = OSQP_DIRECT_SOLVER;
+  settings->kkt_system    = GENERATE(OSQP_KKT_SYSTEM_FULL, OSQP_KKT_SYSTEM_REDUCED, OSQP_KKT_SYSTEM_AUTO,
+                                     OSQP_KKT_SYSTEM_DENSE, OSQP_KKT_SYSTEM_STAGED);
+  settings->kkt_stages    = stages;
+  settings->polishing     = GENERATE(0, 1);
+  settings->scaling       = 0;
+  settings->warm_starting = 0;
+
+  CAPTURE(settings->kkt_system, settings->polishing);
+
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  mu_assert("Basic QP test KKT system: Setup error!", exitflag == 0);
+
+  osqp_solve(solver.get());
+
+  mu_assert("Basic QP test KKT system: Error in solver status!",
+      solver->info->status_val == sols_data->status_test);
+
+  mu_assert("Basic QP test KKT system: Error in primal solution!",
+      vec_norm_inf_diff(solver->solution->x, sols_data->x_test,
+            data->n) < TESTS_TOL);
+
+  mu_assert("Basic QP test KKT system: Error in dual solution!",
+      vec_norm_inf_diff(solver->solution->y, sols_data->y_test,
+            data->m) < TESTS_TOL);
+
+  // Refactor with a different rho and solve again
+  exitflag = osqp_update_rho(solver.get(), 10.0);
+
+  mu_assert("Basic QP test KKT system: Error updating rho!", exitflag == 0);
+
+  osqp_solve(solver.get());
+
+  mu_assert("Basic QP test KKT system: Error in primal solution after updating rho!",
+      vec_norm_inf_diff(solver->solution->x, sols_data->x_test,
+            data->n) < TESTS_TOL);
+}
+
+/*
+ * Linear MPC problem over T steps with states x_k (2) and inputs u_k (1). The
+ * variables are x_0, u_0, ..., x_{T-1}, u_{T-1}, x_T and the constraints are
+ * the initial state, the dynamics x_{k+1} = Ad x_k + Bd u_k, the input bounds
+ * and bounds on the second state. Stage k holds x_k, u_k, the dynamics rows
+ * that define x_k and the bounds on x_k and u_k.
+ */
+struct mpc_problem {
+  static const OSQPInt T = 4;
+
+  OSQPInt n;
+  OSQPInt m;
+  std::vector<OSQPFloat> Px, Ax, q, l, u;
+  std::vector<OSQPInt>   Pi, Pp, Ai, Ap, stages;
+  OSQPCscMatrix P;
+  OSQPCscMatrix A;
+
+  mpc_problem(OSQPFloat b0, OSQPFloat b1, OSQPFloat r) {
+    OSQPInt k, i, col;
+    OSQPInt dyn = 2;             // first dynamics row
+    OSQPInt ub  = 2 + 2 * T;     // first input bound row
+    OSQPInt xb  = 2 + 3 * T;     // first state bound row (x_1 to x_T)
+
+    n = 3 * T + 2;
+    m = 2 + 4 * T;
+
+    for (k = 0; k <= T; k++) {
+      for (i = 0; i < 2; i++) {
+        col = 3 * k + i;
+        Pp.push_back((OSQPInt)Pi.size());
+        Ap.push_back((OSQPInt)Ai.size());
+
+        // Tracking cost, heavier at the end of the horizon
+        Pi.push_back(col);
+        Px.push_back((k == T ? 2.0 : 1.0) / (i + 1));
+
+        // Initial state, or the dynamics that define x_k
+        if (k == 0) { Ai.push_back(i); Ax.push_back(1.0); }
+        else        { Ai.push_back(dyn + 2 * (k - 1) + i); Ax.push_back(1.0); }
+
+        // -Ad x_k in the dynamics that define x_{k+1}, with Ad = [1 0.1; 0 1]
+        if (k < T) {
+          if (i == 0) { Ai.push_back(dyn + 2 * k); Ax.push_back(-1.0); }
+          else        { Ai.push_back(dyn + 2 * k); Ax.push_back(-0.1);
+                        Ai.push_back(dyn + 2 * k + 1); Ax.push_back(-1.0); }
+        }
+
+        if (k > 0 && i == 1) { Ai.push_back(xb + k - 1); Ax.push_back(1.0); }
+      }
+
+      if (k == T) break;
+
+      // Input u_k, with a cross term to the second state in the cost
+      Pp.push_back((OSQPInt)Pi.size());
+      Ap.push_back((OSQPInt)Ai.size());
+      Pi.push_back(3 * k + 1); Px.push_back(0.1);
+      Pi.push_back(3 * k + 2); Px.push_back(r);
+      Ai.push_back(dyn + 2 * k);     Ax.push_back(-b0);
+      Ai.push_back(dyn + 2 * k + 1); Ax.push_back(-b1);
+      Ai.push_back(ub + k);          Ax.push_back(1.0);
+    }
+    Pp.push_back((OSQPInt)Pi.size());
+    Ap.push_back((OSQPInt)Ai.size());
+
+    q.assign(n, 0.0);
+    q[3 * T] = -1.0;
+
+    l.assign(m, 0.0);
+    u.assign(m, 0.0);
+    l[0] = u[0] = 2.0;
+    l[1] = u[1] = 0.0;
+    for (k = 0; k < T; k++) {
+      l[ub + k] = -0.5;
+      u[ub + k] =  0.5;
+      l[xb + k] = -0.3;
+      u[xb + k] =  0.3;
+    }
+
+    stages.assign(n + m, 0);
+    for (k = 0; k <= T; k++) {
+      for (i = 0; i < 3 && 3 * k + i < n; i++) stages[3 * k + i] = k;
+    }
+    for (k = 0; k < T; k++) {
+      stages[n + dyn + 2 * k]     = k + 1;
+      stages[n + dyn + 2 * k + 1] = k + 1;
+      stages[n + ub + k]          = k;
+      stages[n + xb + k]          = k + 1;
+    }
+
+    csc_set_data(&P, n, n, (OSQPInt)Px.size(), Px.data(), Pi.data(), Pp.data());
+    csc_set_data(&A, m, n, (OSQPInt)Ax.size(), Ax.data(), Ai.data(), Ap.data());
+  }
+};
+
+TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: Staged KKT system for MPC", "[solve][qp]")
+{
+  OSQPInt exitflag;
+  OSQPInt i;
+
+  mpc_problem mpc(0.005, 0.1, 0.1);
+  mpc_problem mpc_new(0.01, 0.2, 0.5);
+
+  OSQPSolver*    tmpFull = nullptr;
+  OSQPSolver_ptr full{nullptr};
+
+  // The KKT system choice only applies to the direct solver
+  if (!isLinsysSupported(OSQP_DIRECT_SOLVER))
+    return;
+
+  settings->linsys_solver = OSQP_DIRECT_SOLVER;
+  settings->scaling       = GENERATE(0, 10);
+  settings->polishing     = 0;
+  settings->eps_abs       = 1e-7;
+  settings->eps_rel       = 1e-7;
+  settings->max_iter      = 10000;
+
+  CAPTURE(settings->scaling);
+
+  // Reference solution with the full KKT system
+  settings->kkt_system = OSQP_KKT_SYSTEM_FULL;
+  exitflag = osqp_setup(&tmpFull, &mpc.P, mpc.q.data(), &mpc.A, mpc.l.data(), mpc.u.data(),
+                        mpc.m, mpc.n, settings.get());
+  full.reset(tmpFull);
+
+  mu_assert("Basic QP test staged MPC: Setup error with the full system!", exitflag == 0);
+
+  settings->kkt_system = OSQP_KKT_SYSTEM_STAGED;
+  settings->kkt_stages = mpc.stages.data();
+  exitflag = osqp_setup(&tmpSolver, &mpc.P, mpc.q.data(), &mpc.A, mpc.l.data(), mpc.u.data(),
+                        mpc.m, mpc.n, settings.get());
+  solver.reset(tmpSolver);
+
+  mu_assert("Basic QP test staged MPC: Setup error with the staged system!", exitflag == 0);
+
+  SECTION( "Solve" ) {
+  }
+  SECTION( "Matrix update" ) {
+    // New input matrix and input weight, with the same sparsity
+    exitflag = osqp_update_data_mat(full.get(), mpc_new.Px.data(), OSQP_NULL, (OSQPInt)mpc_new.Px.size(),
+                                    mpc_new.Ax.data(), OSQP_NULL, (OSQPInt)mpc_new.Ax.size());
+    mu_assert("Basic QP test staged MPC: Error updating the full system!", exitflag == 0);
+
+    exitflag = osqp_update_data_mat(solver.get(), mpc_new.Px.data(), OSQP_NULL, (OSQPInt)mpc_new.Px.size(),
+                                    mpc_new.Ax.data(), OSQP_NULL, (OSQPInt)mpc_new.Ax.size());
+    mu_assert("Basic QP test staged MPC: Error updating the staged system!", exitflag == 0);
+  }
+  SECTION( "Rho update" ) {
+    exitflag = osqp_update_rho(full.get(), 2.0);
+    mu_assert("Basic QP test staged MPC: Error updating rho of the full system!", exitflag == 0);
+
+    exitflag = osqp_update_rho(solver.get(), 2.0);
+    mu_assert("Basic QP test staged MPC: Error updating rho of the staged system!", exitflag == 0);
+  }
+
+  osqp_solve(full.get());
+  osqp_solve(solver.get());
+
+  mu_assert("Basic QP test staged MPC: Error in solver status of the full system!",
+      full->info->status_val == OSQP_SOLVED);
+  mu_assert("Basic QP test staged MPC: Error in solver status!",
+      solver->info->status_val == OSQP_SOLVED);
+
+  mu_assert("Basic QP test staged MPC: Error in primal solution!",
+      vec_norm_inf_diff(solver->solution->x, full->solution->x, mpc.n) < TESTS_TOL);
+  mu_assert("Basic QP test staged MPC: Error in dual solution!",
+      vec_norm_inf_diff(solver->solution->y, full->solution->y, mpc.m) < TESTS_TOL);
+
+  // Some inputs and states must be at their bounds for the coupling to matter
+  OSQPInt n_active = 0;
+  for (i = 2 + 2 * mpc_problem::T; i < mpc.m; i++)
+    n_active += (c_absval(full->solution->y[i]) > TESTS_TOL);
+
+  mu_assert("Basic QP test staged MPC: No active bounds!", n_active > 0);
+}
+
+TEST_CASE_METHOD(basic_qp_test_fixture, "Basic QP: Invalid KKT stages", "[solve][qp]")
+{
+  OSQPInt exitflag;
+
+  // x0 and x1 are coupled by P but their stages are not consecutive
+  OSQPInt stages[6] = { 0, 2, 2, 0, 2, 2, };
+
+  if (!isLinsysSupported(OSQP_DIRECT_SOLVER))
+    return;
+
+  settings->linsys_solver = OSQP_DIRECT_SOLVER;
+  settings->kkt_system    = OSQP_KKT_SYSTEM_STAGED;
+
+  // The stages are required
+  tmpSolver = nullptr;
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  mu_assert("Basic QP test KKT stages: Setup should result in error due to missing stages",
+            exitflag == OSQP_SETTINGS_VALIDATION_ERROR);
+
+  tmpSolver = nullptr;
+  settings->kkt_stages = stages;
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  mu_assert("Basic QP test KKT stages: Setup should result in error due to non-consecutive stages",
+            exitflag == OSQP_LINSYS_SOLVER_INIT_ERROR);
+}
+
+TEST_CASE("Basic QP: Dynamic regularization", "[solve][qp]")
+{
+  /* Singular P = [1 1; 1 1] with box constraints. Factoring the primal block
+   * first with a negligible sigma leaves an exactly zero pivot. */
+  OSQPFloat P_x[3] = { 1.0, 1.0, 1.0, };
+  OSQPInt   P_i[3] = { 0, 0, 1, };
+  OSQPInt   P_p[3] = { 0, 1, 3, };
+  OSQPFloat q[2]   = { 1.0, 1.0, };
+  OSQPFloat A_x[2] = { 1.0, 1.0, };
+  OSQPInt   A_i[2] = { 0, 1, };
+  OSQPInt   A_p[3] = { 0, 1, 2, };
+  OSQPFloat l[2]   = { -1.0, -1.0, };
+  OSQPFloat u[2]   = { 1.0, 1.0, };
+  OSQPInt   perm[4] = { 0, 1, 2, 3, };
+  OSQPInt   n = 2;
+  OSQPInt   m = 2;
+
+  OSQPInt exitflag;
+
+  OSQPSolver*      tmpSolver = nullptr;
+  OSQPSolver_ptr   solver{nullptr};
+  OSQPSettings_ptr settings{(OSQPSettings *)malloc(sizeof(OSQPSettings))};
+
+  OSQPCscMatrix_ptr P{(OSQPCscMatrix*)malloc(sizeof(OSQPCscMatrix))};
+  OSQPCscMatrix_ptr A{(OSQPCscMatrix*)malloc(sizeof(OSQPCscMatrix))};
+
+  // The regularization only applies to the direct solver
+  if (!isLinsysSupported(OSQP_DIRECT_SOLVER))
+    return;
+
+  csc_set_data(P.get(), n, n, 3, P_x, P_i, P_p);
+  csc_set_data(A.get(), m, n, 2, A_x, A_i, A_p);
+
+  osqp_set_default_settings(settings.get());
+  settings->linsys_solver   = OSQP_DIRECT_SOLVER;
+  settings->verbose         = 0;
+  settings->scaling         = 0;
+  settings->sigma           = 1e-17;
+  settings->eps_abs         = 1e-7;
+  settings->eps_rel         = 1e-7;
+  settings->kkt_ordering    = OSQP_ORDERING_USER;
+  settings->kkt_permutation = perm;
+
+  SECTION( "Disabled" ) {
+    settings->dyn_reg = 0;
+
+    exitflag = osqp_setup(&tmpSolver, P.get(), q, A.get(), l, u, m, n, settings.get());
+    solver.reset(tmpSolver);
+
+    mu_assert("Basic QP test dynamic regularization: Factorization should fail!",
+              exitflag == OSQP_NONCVX_ERROR);
+  }
+
+  SECTION( "Enabled" ) {
+    settings->dyn_reg   = 1;
+    settings->polishing = GENERATE(0, 1);
+
+    exitflag = osqp_setup(&tmpSolver, P.get(), q, A.get(), l, u, m, n, settings.get());
+    solver.reset(tmpSolver);
+
+    mu_assert("Basic QP test dynamic regularization: Setup error!", exitflag == 0);
+
+    osqp_solve(solver.get());
+
+    mu_assert("Basic QP test dynamic regularization: Error in solver status!",
+              solver->info->status_val == OSQP_SOLVED);
+
+    mu_assert("Basic QP test dynamic regularization: Error in objective value!",
+              c_absval(solver->info->obj_val + 0.5) < TESTS_TOL);
+
+    // Refactor with a new rho
+    exitflag = osqp_update_rho(solver.get(), 1e6);
+    mu_assert("Basic QP test dynamic regularization: Error updating rho!", exitflag == 0);
+
+    osqp_solve(solver.get());
+
+    mu_assert("Basic QP test dynamic regularization: Error in solver status after rho update!",
+              solver->info->status_val == OSQP_SOLVED);
+  }
+}
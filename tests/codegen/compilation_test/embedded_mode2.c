@@ -15,8 +15,40 @@
 #include "data_nonconvex_2_embedded_2_workspace.h"
 #include "data_unconstrained_embedded_2_workspace.h"
 
+#include "fixed_point_16_embedded_2_workspace.h"
+#include "fixed_point_16_embedded_2_fixed.h"
+#include "fixed_point_32_embedded_2_workspace.h"
+#include "fixed_point_32_embedded_2_fixed.h"
+
+static fixed_point_16_embedded_2_fixed_workspace fixed_16_work;
+static fixed_point_16_embedded_2_fx fixed_16_x[FIXED_POINT_16_EMBEDDED_2_FIXED_N];
+static fixed_point_16_embedded_2_fx fixed_16_y[FIXED_POINT_16_EMBEDDED_2_FIXED_M];
+
+static fixed_point_32_embedded_2_fixed_workspace fixed_32_work;
+static fixed_point_32_embedded_2_fx fixed_32_x[FIXED_POINT_32_EMBEDDED_2_FIXED_N];
+static fixed_point_32_embedded_2_fx fixed_32_y[FIXED_POINT_32_EMBEDDED_2_FIXED_M];
+
+/* Largest difference between the fixed-point and floating-point primal solutions */
+static double fixed_error(const double* x_fixed,
+                          const OSQPFloat* x,
+                          int n) {
+  int i;
+  double e, err = 0.0;
+
+  for( i = 0; i < n; i++ ) {
+    e = x_fixed[i] - x[i];
+    if( e < 0 ) e = -e;
+    if( e > err ) err = e;
+  }
+
+  return err;
+}
+
 int main() {
   OSQPInt exitflag;
+  double  x_fixed[FIXED_POINT_32_EMBEDDED_2_FIXED_N];
+  double  err;
+  int     i;
 
   printf( "Embedded test program for embedded mode 2 settings.\n");
 
@@ -109,5 +141,56 @@ int main() {
     printf( "  Solved non-nonconvex problem with no error.\n" );
   }
 
+  /*
+   * Fixed-point solvers, run for as many iterations as the floating-point solver
+   */
+  exitflag = osqp_solve( &fixed_point_16_embedded_2_solver );
+
+  if( exitflag > 0 ) {
+    printf( "  OSQP errored on fixed_point_16: %s\n", osqp_error_message(exitflag));
+    return (int)exitflag;
+  }
+
+  fixed_point_16_embedded_2_fixed_init( &fixed_16_work );
+  fixed_point_16_embedded_2_fixed_solve( &fixed_16_work, (int)fixed_point_16_embedded_2_solver.info->iter );
+  fixed_point_16_embedded_2_fixed_solution( &fixed_16_work, fixed_16_x, fixed_16_y );
+
+  for( i = 0; i < FIXED_POINT_16_EMBEDDED_2_FIXED_N; i++ ) {
+    x_fixed[i] = fixed_16_x[i] / (double)((fixed_point_16_embedded_2_fx_wide)1 << FIXED_POINT_16_EMBEDDED_2_FIXED_FRAC_X_OUT);
+  }
+  err = fixed_error( x_fixed, fixed_point_16_embedded_2_solver.solution->x, FIXED_POINT_16_EMBEDDED_2_FIXED_N );
+
+  if( fixed_16_work.overflows || err > 1e-1 ) {
+    printf( "  Fixed-point 16-bit solve is off: %lu overflows, max primal error %e\n",
+            (unsigned long)fixed_16_work.overflows, err );
+    return 1;
+  } else {
+    printf( "  Solved fixed_point_16 with max primal error %e.\n", err );
+  }
+
+  exitflag = osqp_solve( &fixed_point_32_embedded_2_solver );
+
+  if( exitflag > 0 ) {
+    printf( "  OSQP errored on fixed_point_32: %s\n", osqp_error_message(exitflag));
+    return (int)exitflag;
+  }
+
+  fixed_point_32_embedded_2_fixed_init( &fixed_32_work );
+  fixed_point_32_embedded_2_fixed_solve( &fixed_32_work, (int)fixed_point_32_embedded_2_solver.info->iter );
+  fixed_point_32_embedded_2_fixed_solution( &fixed_32_work, fixed_32_x, fixed_32_y );
+
+  for( i = 0; i < FIXED_POINT_32_EMBEDDED_2_FIXED_N; i++ ) {
+    x_fixed[i] = fixed_32_x[i] / (double)((fixed_point_32_embedded_2_fx_wide)1 << FIXED_POINT_32_EMBEDDED_2_FIXED_FRAC_X_OUT);
+  }
+  err = fixed_error( x_fixed, fixed_point_32_embedded_2_solver.solution->x, FIXED_POINT_32_EMBEDDED_2_FIXED_N );
+
+  if( fixed_32_work.overflows || err > 1e-3 ) {
+    printf( "  Fixed-point 32-bit solve is off: %lu overflows, max primal error %e\n",
+            (unsigned long)fixed_32_work.overflows, err );
+    return 1;
+  } else {
+    printf( "  Solved fixed_point_32 with max primal error %e.\n", err );
+  }
+
   return 0;
 }
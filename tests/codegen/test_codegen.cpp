@@ -1,5 +1,13 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "osqp_api.h"    /* OSQP API wrapper (public + some private) */
 #include "osqp_tester.h" /* Tester helpers */
 #include "test_utils.h"  /* Testing Helper functions */
@@ -373,6 +381,254 @@ TEST_CASE_METHOD(codegen_test_fixture, "Codegen: defines", "[codegen]")
     mu_assert("Non Convex codegen: derivative define should have worked!",
               exitflag == expected_flag);
   }
+
+  SECTION( "codegen define: unrolled LDL solve" ) {
+    OSQPInt test_input;
+    OSQPInt expected_flag;
+    std::tie( test_input, expected_flag ) =
+        GENERATE( table<OSQPInt, OSQPInt>(
+            { /* first is input, second is expected error */
+              std::make_tuple( -1, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple(  0, OSQP_NO_ERROR ),
+              std::make_tuple(  1, OSQP_NO_ERROR ),
+              std::make_tuple(  2, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple(  3, OSQP_CODEGEN_DEFINES_ERROR ) } ) );
+
+    defines->ldl_unroll_enable = test_input;
+
+    CAPTURE(defines->ldl_unroll_enable);
+
+    exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "defines_ldl_unroll_", defines.get());
+
+    // Codegen should work or error as appropriate
+    mu_assert("ldl_unroll_enable define should have worked!",
+              exitflag == expected_flag);
+  }
+
+  SECTION( "codegen define: unrolled matrix-vector products" ) {
+    OSQPInt test_input;
+    OSQPInt expected_flag;
+    std::tie( test_input, expected_flag ) =
+        GENERATE( table<OSQPInt, OSQPInt>(
+            { /* first is input, second is expected error */
+              std::make_tuple( -1, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple(  0, OSQP_NO_ERROR ),
+              std::make_tuple(  1, OSQP_NO_ERROR ),
+              std::make_tuple(  2, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple(  3, OSQP_CODEGEN_DEFINES_ERROR ) } ) );
+
+    defines->spmv_unroll_enable = test_input;
+
+    CAPTURE(defines->spmv_unroll_enable);
+
+    exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "defines_spmv_unroll_", defines.get());
+
+    // Codegen should work or error as appropriate
+    mu_assert("spmv_unroll_enable define should have worked!",
+              exitflag == expected_flag);
+  }
+
+  SECTION( "codegen define: fixed-point solver" ) {
+    OSQPInt test_input;
+    OSQPInt expected_flag;
+    std::tie( test_input, expected_flag ) =
+        GENERATE( table<OSQPInt, OSQPInt>(
+            { /* first is input, second is expected error */
+              std::make_tuple( -1, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple(  0, OSQP_NO_ERROR ),
+              std::make_tuple(  8, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple( 16, OSQP_NO_ERROR ),
+              std::make_tuple( 32, OSQP_NO_ERROR ),
+              std::make_tuple( 64, OSQP_CODEGEN_DEFINES_ERROR ) } ) );
+
+    defines->fixed_point_bits = test_input;
+
+    CAPTURE(defines->fixed_point_bits);
+
+    // The fixed-point formats come from the iterates, so solve first
+    osqp_solve(solver.get());
+
+    exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "defines_fixed_point_", defines.get());
+
+    // Codegen should work or error as appropriate
+    mu_assert("fixed_point_bits define should have worked!",
+              exitflag == expected_flag);
+
+    // Export the solvers for the compilation test, which runs them against
+    // the floating-point solution
+    if (test_input && expected_flag == OSQP_NO_ERROR) {
+      char name[100];
+      snprintf(name, 100, "fixed_point_%d_embedded_2_", (int)test_input);
+
+      defines->embedded_mode = 2;
+      defines->float_type    = 1;
+
+      exitflag = osqp_codegen(solver.get(), CODEGEN2_DIR, name, defines.get());
+
+      mu_assert("Fixed-point export should have worked!",
+                exitflag == OSQP_NO_ERROR);
+    }
+  }
+
+  SECTION( "codegen define: multiple instances" ) {
+    OSQPInt test_mode;
+    OSQPInt test_input;
+    OSQPInt expected_flag;
+    std::tie( test_mode, test_input, expected_flag ) =
+        GENERATE( table<OSQPInt, OSQPInt, OSQPInt>(
+            { /* embedded mode, input, expected error */
+              std::make_tuple( 1, -1, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple( 1,  0, OSQP_NO_ERROR ),
+              std::make_tuple( 1,  1, OSQP_NO_ERROR ),
+              std::make_tuple( 1,  2, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple( 2,  0, OSQP_NO_ERROR ),
+              /* The shared matrices cannot be updated */
+              std::make_tuple( 2,  1, OSQP_CODEGEN_DEFINES_ERROR ) } ) );
+
+    defines->embedded_mode         = test_mode;
+    defines->multi_instance_enable = test_input;
+
+    CAPTURE(defines->embedded_mode, defines->multi_instance_enable);
+
+    exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "defines_multi_instance_", defines.get());
+
+    // Codegen should work or error as appropriate
+    mu_assert("multi_instance_enable define should have worked!",
+              exitflag == expected_flag);
+  }
+
+  SECTION( "codegen define: compact indices" ) {
+    OSQPInt test_input;
+    OSQPInt expected_flag;
+    std::tie( test_input, expected_flag ) =
+        GENERATE( table<OSQPInt, OSQPInt>(
+            { /* first is input, second is expected error */
+              std::make_tuple( -1, OSQP_CODEGEN_DEFINES_ERROR ),
+              std::make_tuple(  0, OSQP_NO_ERROR ),
+              std::make_tuple(  1, OSQP_NO_ERROR ),
+              std::make_tuple(  2, OSQP_CODEGEN_DEFINES_ERROR ) } ) );
+
+    defines->compact_index_enable = test_input;
+
+    CAPTURE(defines->compact_index_enable);
+
+    exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "defines_compact_index_", defines.get());
+
+    // Codegen should work or error as appropriate
+    mu_assert("compact_index_enable define should have worked!",
+              exitflag == expected_flag);
+  }
+
+  SECTION( "codegen footprint report" ) {
+    OSQPInt test_mode;
+    OSQPInt test_instances;
+    std::tie( test_mode, test_instances ) =
+        GENERATE( table<OSQPInt, OSQPInt>(
+            { /* embedded mode, multiple instances */
+              std::make_tuple( 1, 0 ),
+              std::make_tuple( 2, 0 ),
+              std::make_tuple( 1, 1 ) } ) );
+
+    defines->embedded_mode         = test_mode;
+    defines->multi_instance_enable = test_instances;
+
+    CAPTURE(defines->embedded_mode, defines->multi_instance_enable);
+
+    exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "defines_footprint_", defines.get());
+
+    mu_assert("Footprint codegen should have worked!",
+              exitflag == OSQP_NO_ERROR);
+
+    std::ifstream report(CODEGEN_DIR "defines_footprint_footprint.json");
+    mu_assert("Footprint report not written!", report.good());
+
+    std::stringstream buf;
+    buf << report.rdbuf();
+    std::string json = buf.str();
+
+    // Add up the arrays of each section
+    std::map<std::string, long> sums;
+    std::vector<std::string>    flash_names;
+    std::regex entry("\"name\": \"([^\"]+)\", \"section\": \"(\\w+)\", \"bytes\": (\\d+)");
+    for (std::sregex_iterator it(json.begin(), json.end(), entry), end; it != end; ++it) {
+      sums[(*it)[2]] += std::stol((*it)[3]);
+      if ((*it)[2] == "flash") flash_names.push_back((*it)[1]);
+    }
+
+    // The totals are the sums of the arrays
+    std::smatch total;
+    for (const char* sec : {"flash", "ram", "instance"}) {
+      std::regex total_re(std::string("\"") + sec + "_bytes\": (\\d+)");
+
+      CAPTURE(sec);
+      mu_assert("Footprint total missing!", std::regex_search(json, total, total_re));
+      mu_assert("Footprint total does not match its arrays!",
+                std::stol(total[1]) == sums[sec]);
+    }
+
+    // The constant data goes to flash and the solver state to RAM, or to the
+    // instance with multiple instances
+    mu_assert("No constant data in flash!", sums["flash"] > 0);
+    if (test_instances) {
+      mu_assert("No instance data!", sums["instance"] > 0);
+    } else {
+      mu_assert("No solver data in RAM!", sums["ram"] > 0);
+    }
+
+    // The flash arrays are declared with the placement qualifier
+    std::ifstream src(CODEGEN_DIR "defines_footprint_workspace.c");
+    mu_assert("Workspace source not written!", src.good());
+
+    std::stringstream srcbuf;
+    srcbuf << src.rdbuf();
+    std::string code = srcbuf.str();
+
+    for (const std::string& name : flash_names) {
+      CAPTURE(name);
+      mu_assert("Flash array not qualified with OSQP_CODEGEN_FLASH!",
+                std::regex_search(code, std::regex("OSQP_CODEGEN_FLASH const [\\w ]+ " + name + "\\[")));
+    }
+  }
+}
+
+TEST_CASE_METHOD(codegen_test_fixture, "Codegen: Dense KKT system with a user ordering", "[codegen]")
+{
+  OSQPInt exitflag;
+  OSQPInt n_plus_m = data->n + data->m;
+
+  // Codegen defines
+  OSQPCodegenDefines_ptr defines{(OSQPCodegenDefines *)c_malloc(sizeof(OSQPCodegenDefines))};
+
+  // User ordering, which the dense solver does not use
+  std::vector<OSQPInt> perm(n_plus_m);
+  for (OSQPInt k = 0; k < n_plus_m; k++)
+    perm[k] = n_plus_m - 1 - k;
+
+  // Test-specific solver settings
+  settings->kkt_system      = OSQP_KKT_SYSTEM_DENSE;
+  settings->kkt_ordering    = OSQP_ORDERING_USER;
+  settings->kkt_permutation = perm.data();
+
+  // Define codegen settings
+  osqp_set_default_codegen_defines(defines.get());
+
+  // Setup solver
+  exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                        data->A, data->l, data->u,
+                        data->m, data->n, settings.get());
+  solver.reset(tmpSolver);
+
+  // Setup correct
+  mu_assert("Setup error!", exitflag == 0);
+
+  // The permutation belongs to the caller, who may reuse it after the setup
+  std::fill(perm.begin(), perm.end(), 0);
+
+  exitflag = osqp_codegen(solver.get(), CODEGEN_DIR, "dense_user_ordering_", defines.get());
+
+  // Codegen factors the KKT matrix without the user permutation
+  mu_assert("Codegen read the user permutation!",
+            exitflag == OSQP_NO_ERROR);
 }
 
 TEST_CASE_METHOD(codegen_test_fixture, "Codegen: Error propgatation", "[codegen]")
@@ -147,6 +147,408 @@ TEST_CASE_METHOD(derivative_adjoint_test_fixture, "Adjoint derivative: basic tes
 }
 
 
+TEST_CASE_METHOD(derivative_adjoint_test_fixture, "Adjoint derivative: Multiple seeds", "[derivative],[adjoint]")
+{
+    OSQPInt exitflag;
+    OSQPInt retval;
+    OSQPInt i, k;
+
+    OSQPInt n = data->n;
+    OSQPInt m = data->m;
+    OSQPInt P_nnz = data->P->p[n];
+    OSQPInt A_nnz = data->A->p[n];
+
+    // Setup workspace
+    exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                          data->A, data->l, data->u,
+                          data->m, data->n, settings.get());
+    solver.reset(tmpSolver);
+
+    // Setup correct
+    mu_assert("Setup error!", exitflag == 0);
+
+    // Solve Problem first time
+    osqp_solve(solver.get());
+
+    mu_assert("Error in solver status!",
+        solver->info->status_val == sols_data->status_test);
+
+    // Stack the seeds (dx_1, dy_1), (dx_1, 0) and (0, dy_1)
+    std::unique_ptr<OSQPFloat[]> dx(new OSQPFloat[3*n]);
+    std::unique_ptr<OSQPFloat[]> dy(new OSQPFloat[3*m]);
+
+    for (i = 0; i < n; i++) {
+        dx[i]     = sols_data->dx_1[i];
+        dx[n+i]   = sols_data->dx_1[i];
+        dx[2*n+i] = sols_data->dx_zeros[i];
+    }
+    for (i = 0; i < m; i++) {
+        dy[i]     = sols_data->dy_1[i];
+        dy[m+i]   = sols_data->dy_zeros[i];
+        dy[2*m+i] = sols_data->dy_1[i];
+    }
+
+    std::unique_ptr<OSQPFloat[]> dq(new OSQPFloat[3*n]);
+    std::unique_ptr<OSQPFloat[]> dl(new OSQPFloat[3*m]);
+    std::unique_ptr<OSQPFloat[]> du(new OSQPFloat[3*m]);
+
+    OSQPCscMatrix_ptr dP{(OSQPCscMatrix*) malloc(sizeof(OSQPCscMatrix))};
+    OSQPCscMatrix_ptr dA{(OSQPCscMatrix*) malloc(sizeof(OSQPCscMatrix))};
+
+    std::unique_ptr<OSQPFloat[]> dPx(new OSQPFloat[3*P_nnz]);
+    std::unique_ptr<OSQPFloat[]> dAx(new OSQPFloat[3*A_nnz]);
+
+    csc_set_data(dP.get(), n, n, P_nnz, dPx.get(), data->P->i, data->P->p);
+    csc_set_data(dA.get(), m, n, A_nnz, dAx.get(), data->A->i, data->A->p);
+
+    retval = osqp_adjoint_derivative_compute_multi(solver.get(), 3, dx.get(), dy.get(),
+                                                   dq.get(), dl.get(), du.get(),
+                                                   dP.get(), dA.get());
+
+    mu_assert("Error computing derivatives",
+              retval == OSQP_NO_ERROR);
+
+    // Every seed must agree with the single right-hand side computation
+    std::unique_ptr<OSQPFloat[]> dq1(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> dl1(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> du1(new OSQPFloat[m]);
+
+    OSQPCscMatrix_ptr dP1{(OSQPCscMatrix*) malloc(sizeof(OSQPCscMatrix))};
+    OSQPCscMatrix_ptr dA1{(OSQPCscMatrix*) malloc(sizeof(OSQPCscMatrix))};
+
+    std::unique_ptr<OSQPFloat[]> dPx1(new OSQPFloat[P_nnz]);
+    std::unique_ptr<OSQPFloat[]> dAx1(new OSQPFloat[A_nnz]);
+
+    csc_set_data(dP1.get(), n, n, P_nnz, dPx1.get(), data->P->i, data->P->p);
+    csc_set_data(dA1.get(), m, n, A_nnz, dAx1.get(), data->A->i, data->A->p);
+
+    for (k = 0; k < 3; k++) {
+        retval = osqp_adjoint_derivative_compute(solver.get(), dx.get() + k*n, dy.get() + k*m);
+
+        mu_assert("Error computing derivatives",
+                  retval == OSQP_NO_ERROR);
+
+        osqp_adjoint_derivative_get_vec(solver.get(), dq1.get(), dl1.get(), du1.get());
+        osqp_adjoint_derivative_get_mat(solver.get(), dP1.get(), dA1.get());
+
+        mu_assert("Error in dq!",
+                  vec_norm_inf_diff(dq1.get(), dq.get() + k*n, n) < TESTS_TOL);
+        mu_assert("Error in dl!",
+                  vec_norm_inf_diff(dl1.get(), dl.get() + k*m, m) < TESTS_TOL);
+        mu_assert("Error in du!",
+                  vec_norm_inf_diff(du1.get(), du.get() + k*m, m) < TESTS_TOL);
+        mu_assert("Error in dP!",
+                  vec_norm_inf_diff(dPx1.get(), dPx.get() + k*P_nnz, P_nnz) < TESTS_TOL);
+        mu_assert("Error in dA!",
+                  vec_norm_inf_diff(dAx1.get(), dAx.get() + k*A_nnz, A_nnz) < TESTS_TOL);
+    }
+}
+
+
+TEST_CASE_METHOD(derivative_adjoint_test_fixture, "Adjoint derivative: Batch of problems", "[derivative],[adjoint]")
+{
+    OSQPInt exitflag;
+    OSQPInt retval;
+    OSQPInt i, k;
+
+    OSQPInt n = data->n;
+    OSQPInt m = data->m;
+
+    // Two copies of the problem share the symbolic factorization
+    OSQPSolver* solvers[2];
+
+    for (k = 0; k < 2; k++) {
+        exitflag = osqp_setup(&solvers[k], data->P, data->q,
+                              data->A, data->l, data->u,
+                              data->m, data->n, settings.get());
+        mu_assert("Setup error!", exitflag == 0);
+
+        osqp_solve(solvers[k]);
+        mu_assert("Error in solver status!",
+            solvers[k]->info->status_val == sols_data->status_test);
+    }
+    OSQPSolver_ptr solver0{solvers[0]};
+    OSQPSolver_ptr solver1{solvers[1]};
+
+    // Seed (dx_1, dy_1) for the first problem and (dx_1, 0) for the second
+    std::unique_ptr<OSQPFloat[]> dx(new OSQPFloat[2*n]);
+    std::unique_ptr<OSQPFloat[]> dy(new OSQPFloat[2*m]);
+
+    for (i = 0; i < n; i++) {
+        dx[i]   = sols_data->dx_1[i];
+        dx[n+i] = sols_data->dx_1[i];
+    }
+    for (i = 0; i < m; i++) {
+        dy[i]   = sols_data->dy_1[i];
+        dy[m+i] = sols_data->dy_zeros[i];
+    }
+
+    retval = osqp_adjoint_derivative_compute_batch(solvers, 2, dx.get(), dy.get());
+
+    mu_assert("Error computing derivatives",
+              retval == OSQP_NO_ERROR);
+
+    // Each problem must agree with the single problem computation
+    std::unique_ptr<OSQPFloat[]> dq(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> dl(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> du(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> dq1(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> dl1(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> du1(new OSQPFloat[m]);
+
+    for (k = 0; k < 2; k++) {
+        osqp_adjoint_derivative_get_vec(solvers[k], dq.get(), dl.get(), du.get());
+
+        retval = osqp_adjoint_derivative_compute(solvers[k], dx.get() + k*n, dy.get() + k*m);
+
+        mu_assert("Error computing derivatives",
+                  retval == OSQP_NO_ERROR);
+
+        osqp_adjoint_derivative_get_vec(solvers[k], dq1.get(), dl1.get(), du1.get());
+
+        mu_assert("Error in dq!",
+                  vec_norm_inf_diff(dq.get(), dq1.get(), n) < TESTS_TOL);
+        mu_assert("Error in dl!",
+                  vec_norm_inf_diff(dl.get(), dl1.get(), m) < TESTS_TOL);
+        mu_assert("Error in du!",
+                  vec_norm_inf_diff(du.get(), du1.get(), m) < TESTS_TOL);
+    }
+}
+
+
+TEST_CASE_METHOD(derivative_adjoint_test_fixture, "Forward derivative: agrees with adjoint", "[derivative],[forward]")
+{
+    OSQPInt exitflag;
+    OSQPInt retval;
+    OSQPInt i;
+
+    OSQPInt n = data->n;
+    OSQPInt m = data->m;
+
+    // Setup workspace
+    exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                          data->A, data->l, data->u,
+                          data->m, data->n, settings.get());
+    solver.reset(tmpSolver);
+
+    // Setup correct
+    mu_assert("Setup error!", exitflag == 0);
+
+    // Solve Problem first time
+    osqp_solve(solver.get());
+
+    mu_assert("Error in solver status!",
+        solver->info->status_val == sols_data->status_test);
+
+    // Adjoint derivative of the loss dx_1'x with respect to q
+    retval = osqp_adjoint_derivative_compute(solver.get(), sols_data->dx_1, sols_data->dy_zeros);
+
+    mu_assert("Error computing adjoint derivatives",
+              retval == OSQP_NO_ERROR);
+
+    std::unique_ptr<OSQPFloat[]> dq_adj(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> dl_adj(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> du_adj(new OSQPFloat[m]);
+
+    osqp_adjoint_derivative_get_vec(solver.get(), dq_adj.get(), dl_adj.get(), du_adj.get());
+
+    // Forward derivative along each unit direction of q must give the same sensitivity
+    std::unique_ptr<OSQPFloat[]> dq(new OSQPFloat[n*n]);
+    std::unique_ptr<OSQPFloat[]> dx(new OSQPFloat[n*n]);
+    std::unique_ptr<OSQPFloat[]> dy(new OSQPFloat[m*n]);
+
+    for (i = 0; i < n*n; i++) dq[i] = 0.0;
+    for (i = 0; i < n; i++)   dq[i*n + i] = 1.0;
+
+    retval = osqp_forward_derivative_compute_multi(solver.get(), n, OSQP_NULL, dq.get(), OSQP_NULL,
+                                                   OSQP_NULL, OSQP_NULL, dx.get(), dy.get());
+
+    mu_assert("Error computing forward derivatives",
+              retval == OSQP_NO_ERROR);
+
+    for (i = 0; i < n; i++) {
+        OSQPFloat jvp = 0.0;
+        OSQPInt j;
+        for (j = 0; j < n; j++) jvp += sols_data->dx_1[j] * dx[i*n + j];
+
+        mu_assert("Error in forward derivative!",
+                  c_absval(jvp - dq_adj[i]) < TESTS_TOL);
+    }
+}
+
+
+/*
+ * Solve the test problem with its data moved by t along the direction dP, dA, dl, du
+ * (any of which may be OSQP_NULL) and store the polished solution in x and y
+ */
+static void solve_moved(const OSQPTestData* data,
+                        OSQPSettings*       settings,
+                        const OSQPFloat*    l,
+                        OSQPFloat           t,
+                        const OSQPFloat*    dPx,
+                        const OSQPFloat*    dAx,
+                        const OSQPFloat*    dl,
+                        const OSQPFloat*    du,
+                        OSQPFloat*          x,
+                        OSQPFloat*          y)
+{
+    OSQPInt i;
+    OSQPInt exitflag;
+    OSQPSolver* tmpSolver = nullptr;
+
+    OSQPInt n     = data->n;
+    OSQPInt m     = data->m;
+    OSQPInt P_nnz = data->P->p[n];
+    OSQPInt A_nnz = data->A->p[n];
+
+    std::unique_ptr<OSQPFloat[]> Px(new OSQPFloat[P_nnz]);
+    std::unique_ptr<OSQPFloat[]> Ax(new OSQPFloat[A_nnz]);
+    std::unique_ptr<OSQPFloat[]> lt(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> ut(new OSQPFloat[m]);
+
+    for (i = 0; i < P_nnz; i++) Px[i] = data->P->x[i] + (dPx ? t * dPx[i] : 0.0);
+    for (i = 0; i < A_nnz; i++) Ax[i] = data->A->x[i] + (dAx ? t * dAx[i] : 0.0);
+    for (i = 0; i < m; i++)     lt[i] = l[i] + (dl ? t * dl[i] : 0.0);
+    for (i = 0; i < m; i++)     ut[i] = data->u[i] + (du ? t * du[i] : 0.0);
+
+    OSQPCscMatrix Pt;
+    OSQPCscMatrix At;
+    csc_set_data(&Pt, n, n, P_nnz, Px.get(), data->P->i, data->P->p);
+    csc_set_data(&At, m, n, A_nnz, Ax.get(), data->A->i, data->A->p);
+
+    exitflag = osqp_setup(&tmpSolver, &Pt, data->q, &At, lt.get(), ut.get(), m, n, settings);
+    OSQPSolver_ptr solver{tmpSolver};
+
+    mu_assert("Setup error!", exitflag == 0);
+
+    osqp_solve(solver.get());
+
+    mu_assert("Error in solver status!",
+              solver->info->status_val == OSQP_SOLVED);
+    mu_assert("Error in polish status!",
+              solver->info->status_polish == OSQP_POLISH_SUCCESS);
+
+    for (i = 0; i < n; i++) x[i] = solver->solution->x[i];
+    for (i = 0; i < m; i++) y[i] = solver->solution->y[i];
+}
+
+
+TEST_CASE_METHOD(derivative_adjoint_test_fixture, "Forward derivative: finite differences", "[derivative],[forward]")
+{
+    OSQPInt exitflag;
+    OSQPInt retval;
+    OSQPInt i;
+
+    OSQPInt n     = data->n;
+    OSQPInt m     = data->m;
+    OSQPInt P_nnz = data->P->p[n];
+    OSQPInt A_nnz = data->A->p[n];
+
+    // Step of the central differences, which are exact up to O(h^2)
+    OSQPFloat h = 1e-4;
+
+    // The polished solutions are exact, so the differences are not limited by the tolerances
+    settings->polishing = 1;
+
+    std::unique_ptr<OSQPFloat[]> l(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> dPx(new OSQPFloat[P_nnz]);
+    std::unique_ptr<OSQPFloat[]> dAx(new OSQPFloat[A_nnz]);
+    std::unique_ptr<OSQPFloat[]> dl(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> du(new OSQPFloat[m]);
+
+    for (i = 0; i < m; i++) {
+        l[i]  = data->l[i];
+        dl[i] = 0.0;
+        du[i] = 0.0;
+    }
+
+    // Row 0 is an equality and row 2 is an active upper bound at the solution
+    const OSQPFloat* dP_dir = OSQP_NULL;
+    const OSQPFloat* dA_dir = OSQP_NULL;
+    const OSQPFloat* dl_dir = OSQP_NULL;
+    const OSQPFloat* du_dir = OSQP_NULL;
+
+    SECTION("dP") {
+        const OSQPFloat dir[3] = {1.0, 0.5, -1.0};
+        for (i = 0; i < P_nnz; i++) dPx[i] = dir[i % 3];
+        dP_dir = dPx.get();
+    }
+    SECTION("dA") {
+        const OSQPFloat dir[5] = {0.5, -0.3, 0.2, 0.4, -0.1};
+        for (i = 0; i < A_nnz; i++) dAx[i] = dir[i % 5];
+        dA_dir = dAx.get();
+    }
+    SECTION("du of an active upper bound") {
+        du[2]  = 1.0;
+        du_dir = du.get();
+    }
+    SECTION("dl of an active lower bound") {
+        // Raising the lower bound of row 1 above 0.3 makes it active
+        l[1]   = 0.4;
+        dl[1]  = 1.0;
+        dl_dir = dl.get();
+    }
+    SECTION("dl and du of an equality row") {
+        dl[0]  = 1.0;
+        du[0]  = 1.0;
+        dl_dir = dl.get();
+        du_dir = du.get();
+    }
+
+    // Setup workspace at the unperturbed problem
+    exitflag = osqp_setup(&tmpSolver, data->P, data->q,
+                          data->A, l.get(), data->u,
+                          data->m, data->n, settings.get());
+    solver.reset(tmpSolver);
+
+    mu_assert("Setup error!", exitflag == 0);
+
+    osqp_solve(solver.get());
+
+    mu_assert("Error in solver status!",
+        solver->info->status_val == OSQP_SOLVED);
+
+    // Forward derivative along the direction
+    OSQPCscMatrix dP;
+    OSQPCscMatrix dA;
+    csc_set_data(&dP, n, n, P_nnz, dPx.get(), data->P->i, data->P->p);
+    csc_set_data(&dA, m, n, A_nnz, dAx.get(), data->A->i, data->A->p);
+
+    std::unique_ptr<OSQPFloat[]> dx(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> dy(new OSQPFloat[m]);
+
+    retval = osqp_forward_derivative_compute(solver.get(),
+                                             dP_dir ? &dP : OSQP_NULL, OSQP_NULL,
+                                             dA_dir ? &dA : OSQP_NULL,
+                                             dl_dir, du_dir, dx.get(), dy.get());
+
+    mu_assert("Error computing forward derivatives",
+              retval == OSQP_NO_ERROR);
+
+    // Central differences of the solution
+    std::unique_ptr<OSQPFloat[]> x_plus(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> y_plus(new OSQPFloat[m]);
+    std::unique_ptr<OSQPFloat[]> x_minus(new OSQPFloat[n]);
+    std::unique_ptr<OSQPFloat[]> y_minus(new OSQPFloat[m]);
+
+    solve_moved(data.get(), settings.get(), l.get(),  h,
+                dP_dir, dA_dir, dl_dir, du_dir, x_plus.get(), y_plus.get());
+    solve_moved(data.get(), settings.get(), l.get(), -h,
+                dP_dir, dA_dir, dl_dir, du_dir, x_minus.get(), y_minus.get());
+
+    for (i = 0; i < n; i++) {
+        CAPTURE(i, dx[i]);
+        mu_assert("Error in forward derivative of x!",
+                  c_absval((x_plus[i] - x_minus[i]) / (2 * h) - dx[i]) < TESTS_TOL);
+    }
+    for (i = 0; i < m; i++) {
+        CAPTURE(i, dy[i]);
+        mu_assert("Error in forward derivative of y!",
+                  c_absval((y_plus[i] - y_minus[i]) / (2 * h) - dy[i]) < TESTS_TOL);
+    }
+}
+
+
 TEST_CASE_METHOD(derivative_adjoint_test_fixture, "Adjoint derivative: Not setup", "[derivative],[adjoint]")
 {
     OSQPInt exitflag;
@@ -36,3 +36,143 @@ TEST_CASE_METHOD(OSQPTestFixture, "Large QP solve", "[solve],[qp]")
   mu_assert("Large QP test solve: Error in objective value!",
             c_absval(solver->info->obj_val - prob1_obj_val)/(c_absval(prob1_obj_val)) < TESTS_TOL);
 }
+
+#if defined(OSQP_ALGEBRA_BUILTIN) && defined(_OPENMP)
+#include <omp.h>
+#include <vector>
+
+#include "qdldl_interface.h"
+
+/*
+ * Block diagonal QP with nblk independent blocks of b variables, each with a
+ * dense block of P, box constraints and a constraint on the sum of the block.
+ * The elimination tree of the KKT matrix is a forest of nblk trees of height
+ * about 2b + 1, so every level has about nblk rows.
+ */
+struct block_qp {
+  OSQPInt n;
+  OSQPInt m;
+  std::vector<OSQPFloat> Px, Ax, q, l, u;
+  std::vector<OSQPInt>   Pi, Pp, Ai, Ap;
+  OSQPCscMatrix P;
+  OSQPCscMatrix A;
+
+  block_qp(OSQPInt nblk, OSQPInt b, OSQPFloat shift) {
+    OSQPInt k, i, j, col;
+
+    n = nblk * b;
+    m = nblk * (b + 1);
+
+    for (k = 0; k < nblk; k++) {
+      for (j = 0; j < b; j++) {
+        col = k * b + j;
+        Pp.push_back((OSQPInt)Pi.size());
+        Ap.push_back((OSQPInt)Ai.size());
+
+        for (i = 0; i <= j; i++) {
+          Pi.push_back(k * b + i);
+          Px.push_back(i == j ? b + 1.0 : 0.1 * ((i + j + k) % 5) - 0.2 + shift);
+        }
+
+        Ai.push_back(k * (b + 1) + j); Ax.push_back(1.0);
+        Ai.push_back(k * (b + 1) + b); Ax.push_back(1.0 + shift * (j % 3));
+
+        q.push_back(0.1 * ((col * 7) % 11) - 0.5);
+      }
+      for (i = 0; i < b; i++) { l.push_back(-0.05); u.push_back(0.05); }
+      l.push_back(0.1);
+      u.push_back(0.2);
+    }
+    Pp.push_back((OSQPInt)Pi.size());
+    Ap.push_back((OSQPInt)Ai.size());
+
+    csc_set_data(&P, n, n, (OSQPInt)Px.size(), Px.data(), Pi.data(), Pp.data());
+    csc_set_data(&A, m, n, (OSQPInt)Ax.size(), Ax.data(), Ai.data(), Ap.data());
+  }
+};
+
+/* Solve the KKT system of the ADMM iterations of both solvers with the same right-hand side */
+static void check_level_solve(OSQPSolver* serial, OSQPSolver* levels, const char* msg) {
+  OSQPInt dim = serial->work->data->n + serial->work->data->m;
+  std::vector<OSQPFloat> b(dim);
+
+  for (OSQPInt i = 0; i < dim; i++) b[i] = 0.01 * ((i * 13) % 17) - 0.08;
+
+  OSQPVectorf_ptr b_serial{OSQPVectorf_new(b.data(), dim)};
+  OSQPVectorf_ptr b_levels{OSQPVectorf_new(b.data(), dim)};
+
+  serial->work->linsys_solver->solve(serial->work->linsys_solver, b_serial.get(), 2);
+  levels->work->linsys_solver->solve(levels->work->linsys_solver, b_levels.get(), 2);
+
+  INFO(msg);
+  mu_assert("Level scheduled LDL test: solution differs from the serial solve!",
+            OSQPVectorf_norm_inf_diff(b_serial.get(), b_levels.get()) < TESTS_TOL);
+}
+
+TEST_CASE_METHOD(OSQPTestFixture, "Large QP: Level scheduled LDL solves", "[solve],[qp]")
+{
+  OSQPInt exitflag;
+
+  block_qp prob(100, 10, 0.0);
+  block_qp prob_new(100, 10, 0.05);
+
+  OSQPSolver*    tmpSerial = nullptr;
+  OSQPSolver_ptr serial{nullptr};
+
+  settings->linsys_solver = OSQP_DIRECT_SOLVER;
+  settings->kkt_system    = OSQP_KKT_SYSTEM_FULL;
+  settings->verbose       = 0;
+
+  int nthreads = omp_get_max_threads();
+
+  // The levels are only set up when the solver is created with several threads
+  omp_set_num_threads(1);
+  exitflag = osqp_setup(&tmpSerial, &prob.P, prob.q.data(), &prob.A, prob.l.data(), prob.u.data(),
+                        prob.m, prob.n, settings.get());
+  serial.reset(tmpSerial);
+
+  mu_assert("Level scheduled LDL test: Setup error of the serial solver!", exitflag == 0);
+
+  omp_set_num_threads(4);
+  exitflag = osqp_setup(&tmpSolver, &prob.P, prob.q.data(), &prob.A, prob.l.data(), prob.u.data(),
+                        prob.m, prob.n, settings.get());
+  solver.reset(tmpSolver);
+
+  mu_assert("Level scheduled LDL test: Setup error!", exitflag == 0);
+
+  qdldl_solver* s_serial = (qdldl_solver *)serial->work->linsys_solver;
+  qdldl_solver* s_levels = (qdldl_solver *)solver->work->linsys_solver;
+
+  mu_assert("Level scheduled LDL test: Serial solver uses levels!", s_serial->lvl_p == OSQP_NULL);
+  mu_assert("Level scheduled LDL test: Levels not set up!", s_levels->lvl_p != OSQP_NULL);
+  mu_assert("Level scheduled LDL test: Too few entries per level!",
+            s_levels->L->p[s_levels->L->n] >= (OSQPInt)s_levels->nlevels * 500);
+
+  check_level_solve(serial.get(), solver.get(), "After setup");
+
+  exitflag  = osqp_update_rho(serial.get(), 0.7);
+  exitflag |= osqp_update_rho(solver.get(), 0.7);
+  mu_assert("Level scheduled LDL test: Error updating rho!", exitflag == 0);
+
+  check_level_solve(serial.get(), solver.get(), "After updating rho");
+
+  exitflag  = osqp_update_data_mat(serial.get(), prob_new.Px.data(), OSQP_NULL, (OSQPInt)prob_new.Px.size(),
+                                   prob_new.Ax.data(), OSQP_NULL, (OSQPInt)prob_new.Ax.size());
+  exitflag |= osqp_update_data_mat(solver.get(), prob_new.Px.data(), OSQP_NULL, (OSQPInt)prob_new.Px.size(),
+                                   prob_new.Ax.data(), OSQP_NULL, (OSQPInt)prob_new.Ax.size());
+  mu_assert("Level scheduled LDL test: Error updating the matrices!", exitflag == 0);
+
+  check_level_solve(serial.get(), solver.get(), "After updating the matrices");
+
+  // Both solvers reach the same solution
+  osqp_solve(serial.get());
+  osqp_solve(solver.get());
+
+  mu_assert("Level scheduled LDL test: Error in solver status!",
+            solver->info->status_val == OSQP_SOLVED);
+  mu_assert("Level scheduled LDL test: Error in primal solution!",
+            vec_norm_inf_diff(solver->solution->x, serial->solution->x, prob.n) < TESTS_TOL);
+
+  omp_set_num_threads(nthreads);
+}
+#endif /* if defined(OSQP_ALGEBRA_BUILTIN) && defined(_OPENMP) */
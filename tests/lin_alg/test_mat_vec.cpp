@@ -147,3 +147,104 @@ TEST_CASE("Matrix-vector: Empty matrix multiplication", "[mat-vec][operation]")
     "Linear algebra tests: error with no column matrix, matrix-transpose-vector multiplication",
     OSQPVectorf_norm_inf_diff(result.get(), ee.get()) < TESTS_TOL);
 }
+
+#if defined(OSQP_ALGEBRA_BUILTIN) && defined(_OPENMP)
+#include <omp.h>
+#include <vector>
+
+#include "algebra_impl.h"
+#include "csc_math.h"
+
+/* Compare the products with the full symmetric copy of P against the products with its upper triangle */
+static void check_symm_products(const OSQPMatrix* P, const std::vector<OSQPFloat>& xv, const char* msg) {
+  OSQPInt n = P->csc->n;
+  std::vector<OSQPFloat> y0(n);
+  std::vector<OSQPFloat> ref(n);
+
+  for (OSQPInt i = 0; i < n; i++) y0[i] = 0.01 * (i % 7) - 0.03;
+
+  OSQPVectorf_ptr x{OSQPVectorf_new(xv.data(), n)};
+  OSQPVectorf_ptr y{OSQPVectorf_new(y0.data(), n)};
+  OSQPVectorf_ptr yref{nullptr};
+
+  ref = y0;
+  csc_Axpy_sym_triu(P->csc, xv.data(), ref.data(), 0.5, 2.0);
+  yref.reset(OSQPVectorf_new(ref.data(), n));
+
+  OSQPMatrix_Axpy(P, x.get(), y.get(), 0.5, 2.0);
+  INFO(msg);
+  mu_assert("Linear algebra tests: error in threaded symmetric matrix-vector multiplication",
+            OSQPVectorf_norm_inf_diff(y.get(), yref.get()) < TESTS_TOL);
+
+  OSQPVectorf_from_raw(y.get(), y0.data());
+  OSQPMatrix_Atxpy(P, x.get(), y.get(), 0.5, 2.0);
+  mu_assert("Linear algebra tests: error in threaded symmetric matrix-transpose-vector multiplication",
+            OSQPVectorf_norm_inf_diff(y.get(), yref.get()) < TESTS_TOL);
+}
+
+TEST_CASE("Matrix-vector: Threaded symmetric multiplication", "[mat-vec][operation]") {
+  // Banded upper triangle with enough entries to store both triangles (SYMM_SPMV_MIN_NNZ)
+  OSQPInt n  = 500;
+  OSQPInt bw = 30;
+
+  std::vector<OSQPFloat> Px;
+  std::vector<OSQPInt>   Pi;
+  std::vector<OSQPInt>   Pp;
+  std::vector<OSQPFloat> xv(n);
+  std::vector<OSQPFloat> dv(n);
+
+  for (OSQPInt j = 0; j < n; j++) {
+    Pp.push_back((OSQPInt)Pi.size());
+    for (OSQPInt i = (j > bw ? j - bw : 0); i <= j; i++) {
+      Pi.push_back(i);
+      Px.push_back(i == j ? 4.0 : 0.1 * ((3 * i + 5 * j) % 11) - 0.5);
+    }
+    xv[j] = 0.02 * (j % 13) - 0.1;
+    dv[j] = 0.5 + 0.1 * (j % 5);
+  }
+  Pp.push_back((OSQPInt)Pi.size());
+
+  REQUIRE(Pp[n] >= 10000);
+
+  OSQPCscMatrix Pcsc;
+  csc_set_data(&Pcsc, n, n, Pp[n], Px.data(), Pi.data(), Pp.data());
+
+  // The copy is only made when the products run on several threads
+  int nthreads = omp_get_max_threads();
+  omp_set_num_threads(4);
+
+  OSQPMatrix_ptr  P{OSQPMatrix_new_from_csc(&Pcsc, 1)};
+  OSQPVectorf_ptr d{OSQPVectorf_new(dv.data(), n)};
+
+  mu_assert("Linear algebra tests: full symmetric copy not made",
+            P->symm != OSQP_NULL);
+
+  check_symm_products(P.get(), xv, "Initial values");
+
+  // Update a subset of the entries
+  std::vector<OSQPFloat> Px_new;
+  std::vector<OSQPInt>   Px_new_idx;
+  for (OSQPInt k = 0; k < Pp[n]; k += 3) {
+    Px_new.push_back(Px[k] + 0.25);
+    Px_new_idx.push_back(k);
+  }
+  OSQPMatrix_update_values(P.get(), Px_new.data(), Px_new_idx.data(), (OSQPInt)Px_new.size());
+  check_symm_products(P.get(), xv, "After updating a subset of the values");
+
+  // Update all the entries
+  for (OSQPInt k = 0; k < Pp[n]; k++) Px[k] = -Px[k];
+  OSQPMatrix_update_values(P.get(), Px.data(), OSQP_NULL, Pp[n]);
+  check_symm_products(P.get(), xv, "After updating all the values");
+
+  OSQPMatrix_mult_scalar(P.get(), 1.5);
+  check_symm_products(P.get(), xv, "After scaling");
+
+  OSQPMatrix_lmult_diag(P.get(), d.get());
+  check_symm_products(P.get(), xv, "After the left diagonal scaling");
+
+  OSQPMatrix_rmult_diag(P.get(), d.get());
+  check_symm_products(P.get(), xv, "After the right diagonal scaling");
+
+  omp_set_num_threads(nthreads);
+}
+#endif /* if defined(OSQP_ALGEBRA_BUILTIN) && defined(_OPENMP) */
@@ -1,4 +1,5 @@
 #include <catch2/catch.hpp>
+#include <vector>
 
 #include "osqp_api.h"    /* OSQP API wrapper (public + some private) */
 #include "osqp_tester.h" /* Tester helpers */
@@ -88,6 +89,204 @@ TEST_CASE("Test updating KKT matrix", "[kkt],[update]")
   c_free(PtoKKT);
 }
 
+/* Compare the upper triangles of two CSC matrices whose row indices may be in any order */
+static OSQPInt csc_dense_eq(OSQPCscMatrix* A,
+                            OSQPCscMatrix* B,
+                            OSQPFloat      tol) {
+  OSQPInt n = A->n;
+
+  if (B->n != n || A->p[n] != B->p[n]) return 0;
+
+  std::vector<OSQPFloat> dense(n * n, 0.0);
+
+  for (OSQPInt j = 0; j < n; j++) {
+    for (OSQPInt k = A->p[j]; k < A->p[j+1]; k++) dense[A->i[k] * n + j] += A->x[k];
+    for (OSQPInt k = B->p[j]; k < B->p[j+1]; k++) dense[B->i[k] * n + j] -= B->x[k];
+  }
+
+  for (OSQPInt k = 0; k < n * n; k++) {
+    if (c_absval(dense[k]) > tol) return 0;
+  }
+
+  return 1;
+}
+
+TEST_CASE("Test forming permuted KKT matrix", "[kkt],[update]")
+{
+  update_matrices_sols_data* data = generate_problem_update_matrices_sols_data();
+
+  OSQPFloat sigma = data->test_form_KKT_sigma;
+  OSQPInt   n     = data->test_form_KKT_Pu->n;
+  OSQPInt   m     = data->test_form_KKT_A->m;
+  OSQPInt   dim   = n + m;
+
+  std::unique_ptr<OSQPFloat[]> rho_inv_vec(new OSQPFloat[m]);
+  std::unique_ptr<OSQPInt[]>   perm(new OSQPInt[dim]);
+  std::unique_ptr<OSQPInt[]>   PtoKKT(new OSQPInt[data->test_form_KKT_Pu->p[n]]);
+  std::unique_ptr<OSQPInt[]>   AtoKKT(new OSQPInt[data->test_form_KKT_A->p[n]]);
+
+  for (OSQPInt i = 0; i < m; i++)
+    rho_inv_vec[i] = 1.0 / data->test_form_KKT_rho;
+
+  // Interleave the primal and dual rows so that the blocks get mixed
+  for (OSQPInt k = 0; k < dim; k++)
+    perm[k] = (k % 2) ? dim - 1 - k / 2 : k / 2;
+
+  OSQPInt* Pinv = csc_pinv(perm.get(), dim);
+
+  OSQPCscMatrix* KKT = form_KKT_perm(data->test_form_KKT_Pu,
+                                     data->test_form_KKT_A,
+                                     sigma,
+                                     rho_inv_vec.get(),
+                                     1.0,                   // dummy
+                                     Pinv,
+                                     PtoKKT.get(),
+                                     AtoKKT.get(),
+                                     OSQP_NULL);
+
+  // Same matrix as permuting the KKT matrix after forming it
+  OSQPCscMatrix* KKT_ref = csc_symperm(data->test_form_KKT_KKTu, Pinv, OSQP_NULL, 1);
+
+  mu_assert("Update matrices: error in forming permuted KKT matrix!",
+            csc_dense_eq(KKT, KKT_ref, TESTS_TOL));
+
+  // The index maps point into the permuted matrix
+  update_KKT_A(KKT,
+               data->test_form_KKT_A_new,
+               data->test_form_KKT_A_new_idx,
+               data->test_form_KKT_A_new_n,
+               AtoKKT.get());
+
+  update_KKT_P(KKT,
+               data->test_form_KKT_Pu_new,
+               data->test_form_KKT_Pu_new_idx,
+               data->test_form_KKT_Pu_new_n,
+               PtoKKT.get(), sigma, 0);
+
+  csc_spfree(KKT_ref);
+  KKT_ref = csc_symperm(data->test_form_KKT_KKTu_new, Pinv, OSQP_NULL, 1);
+
+  mu_assert("Update matrices: error in updating permuted KKT matrix!",
+            csc_dense_eq(KKT, KKT_ref, TESTS_TOL));
+
+  // Cleanup
+  clean_problem_update_matrices_sols_data(data);
+  csc_spfree(KKT);
+  csc_spfree(KKT_ref);
+  c_free(Pinv);
+}
+
+/* Dense upper triangle of P + sigma I + rho A'A */
+static OSQPCscMatrix* reduced_KKT_dense(const OSQPCscMatrix* P,
+                                        const OSQPCscMatrix* A,
+                                        OSQPFloat            sigma,
+                                        OSQPFloat            rho) {
+  OSQPInt n = P->n;
+  std::vector<OSQPFloat> dense(n * n, 0.0);
+
+  for (OSQPInt j = 0; j < n; j++) {
+    dense[j * n + j] += sigma;
+    for (OSQPInt k = P->p[j]; k < P->p[j+1]; k++) dense[P->i[k] * n + j] += P->x[k];
+    for (OSQPInt i = 0; i <= j; i++) {
+      for (OSQPInt ki = A->p[i]; ki < A->p[i+1]; ki++) {
+        for (OSQPInt kj = A->p[j]; kj < A->p[j+1]; kj++) {
+          if (A->i[ki] == A->i[kj]) dense[i * n + j] += rho * A->x[ki] * A->x[kj];
+        }
+      }
+    }
+  }
+
+  OSQPCscMatrix* D = csc_spalloc(n, n, n * (n + 1) / 2, 1, 0);
+  OSQPInt nz = 0;
+  for (OSQPInt j = 0; j < n; j++) {
+    D->p[j] = nz;
+    for (OSQPInt i = 0; i <= j; i++) {
+      D->i[nz]   = i;
+      D->x[nz++] = dense[i * n + j];
+    }
+  }
+  D->p[n] = nz;
+
+  return D;
+}
+
+/* Compare a sparse upper triangle against a dense one */
+static OSQPInt csc_dense_upper_eq(OSQPCscMatrix* A,
+                                  OSQPCscMatrix* D,
+                                  OSQPFloat      tol) {
+  OSQPInt n = A->n;
+  std::vector<OSQPFloat> dense(n * n, 0.0);
+
+  for (OSQPInt j = 0; j < n; j++) {
+    for (OSQPInt k = A->p[j]; k < A->p[j+1]; k++) {
+      if (A->i[k] > j) return 0;
+      dense[A->i[k] * n + j] += A->x[k];
+    }
+    for (OSQPInt k = D->p[j]; k < D->p[j+1]; k++) dense[D->i[k] * n + j] -= D->x[k];
+  }
+
+  for (OSQPInt k = 0; k < n * n; k++) {
+    if (c_absval(dense[k]) > tol) return 0;
+  }
+
+  return 1;
+}
+
+TEST_CASE("Test forming reduced KKT matrix", "[kkt],[update]")
+{
+  update_matrices_sols_data* data = generate_problem_update_matrices_sols_data();
+
+  OSQPFloat sigma = data->test_form_KKT_sigma;
+  OSQPFloat rho   = data->test_form_KKT_rho;
+  OSQPInt   n     = data->test_form_KKT_Pu->n;
+  OSQPInt   m     = data->test_form_KKT_A->m;
+
+  std::unique_ptr<OSQPFloat[]> rho_vec(new OSQPFloat[m]);
+  std::unique_ptr<OSQPFloat[]> work(new OSQPFloat[n]);
+  std::unique_ptr<OSQPInt[]>   AtoAt(new OSQPInt[data->test_form_KKT_A->p[n]]);
+
+  for (OSQPInt i = 0; i < m; i++)
+    rho_vec[i] = rho;
+
+  OSQPCscMatrix* At = csc_transpose(data->test_form_KKT_A, AtoAt.get());
+  OSQPCscMatrix* R  = form_reduced_KKT_pattern(data->test_form_KKT_Pu, data->test_form_KKT_A, At);
+  R->x = (OSQPFloat*) c_malloc(R->p[n] * sizeof(OSQPFloat));
+
+  // Vector and scalar weights give the same matrix
+  OSQPCscMatrix* R_ref = reduced_KKT_dense(data->test_form_KKT_Pu, data->test_form_KKT_A, sigma, rho);
+
+  update_reduced_KKT(R, OSQP_NULL, R, data->test_form_KKT_Pu, data->test_form_KKT_A, At,
+                     sigma, rho_vec.get(), 1.0, work.get());
+
+  mu_assert("Update matrices: error in forming reduced KKT matrix!",
+            csc_dense_upper_eq(R, R_ref, TESTS_TOL));
+
+  update_reduced_KKT(R, OSQP_NULL, R, data->test_form_KKT_Pu, data->test_form_KKT_A, At,
+                     sigma, OSQP_NULL, rho, work.get());
+
+  mu_assert("Update matrices: error in forming reduced KKT matrix with scalar rho!",
+            csc_dense_upper_eq(R, R_ref, TESTS_TOL));
+
+  // New values of A are copied into At through the index map
+  for (OSQPInt k = 0; k < data->test_form_KKT_A_new->p[n]; k++)
+    At->x[AtoAt[k]] = data->test_form_KKT_A_new->x[k];
+
+  update_reduced_KKT(R, OSQP_NULL, R, data->test_form_KKT_Pu_new, data->test_form_KKT_A_new, At,
+                     sigma, rho_vec.get(), 1.0, work.get());
+
+  csc_spfree(R_ref);
+  R_ref = reduced_KKT_dense(data->test_form_KKT_Pu_new, data->test_form_KKT_A_new, sigma, rho);
+
+  mu_assert("Update matrices: error in updating reduced KKT matrix!",
+            csc_dense_upper_eq(R, R_ref, TESTS_TOL));
+
+  // Cleanup
+  clean_problem_update_matrices_sols_data(data);
+  csc_spfree(R);
+  csc_spfree(R_ref);
+  csc_spfree(At);
+}
+
 #endif /* ifndef OSQP_ALGEBRA_CUDA */
 
 
@@ -107,7 +306,10 @@ TEST_CASE_METHOD(OSQPTestFixture, "Test updating P and A", "[update]")
   /* Test all possible linear system solvers in this test case */
   settings->linsys_solver = GENERATE(filter(&isLinsysSupported, values({OSQP_DIRECT_SOLVER, OSQP_INDIRECT_SOLVER})));
 
-  CAPTURE(settings->linsys_solver);
+  /* Update both the sparse and the dense factorization of the direct solver */
+  settings->kkt_system = GENERATE(OSQP_KKT_SYSTEM_FULL, OSQP_KKT_SYSTEM_DENSE);
+
+  CAPTURE(settings->linsys_solver, settings->kkt_system);
 
   // Setup solver
   exitflag = osqp_setup(&tmpSolver, data->test_solve_Pu, data->test_solve_q,